@@ -0,0 +1,51 @@
+//=======================================================================================
+// HOST BENCHMARK ENTRY POINT:
+//=======================================================================================
+// Runs the same cases as the on-board benchmark build ([env:disco_f429zi_bench]) on the
+// development machine. Built as 'bench_host' by the host CMake project:
+//   cmake -S host -B build-host && cmake --build build-host -j && build-host/bench_host
+//
+//   bench_host [--json results.json]
+//
+// With --json the results are also written as JSON (see gyro_bench.h) for comparison
+// between builds. The LCD cases only exist on the board.
+//=======================================================================================
+#include "gyro_bench.h"
+#include "cycle_counter.h"
+#include <stdio.h>
+#include <string.h>
+
+int main(int argc, char **argv)
+{
+    const char *jsonPath = 0;
+    if (argc == 3 && strcmp(argv[1], "--json") == 0)
+    {
+        jsonPath = argv[2];
+    }
+    else if (argc != 1)
+    {
+        fprintf(stderr, "usage: %s [--json results.json]\n", argv[0]);
+        return 2;
+    }
+
+    cycleCounterInit();
+    printf("\nHOST BENCHMARKS [%s/op]\n", BENCH_UNIT);
+    benchRunVecMath();
+    benchRunHampel();
+    benchRunPipeline();
+    benchRunFormat();
+    benchRunFft();
+
+    if (jsonPath)
+    {
+        FILE *f = fopen(jsonPath, "w");
+        if (f == NULL)
+        {
+            perror(jsonPath);
+            return 1;
+        }
+        benchWriteJson(f, "host");
+        fclose(f);
+    }
+    return 0;
+}
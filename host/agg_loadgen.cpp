@@ -0,0 +1,501 @@
+//=======================================================================================
+// TELEMETRY LOAD GENERATOR (HOST, LINUX):
+//=======================================================================================
+// Simulates many units streaming telemetry frames to host/agg_server, one TCP connection
+// per device, to measure the sustained ingest rate and latency:
+//
+//   agg_loadgen [--host ADDR] [--port P] [--devices N] [--first-id N] [--odr HZ]
+//               [--batch N] [--speed X] [--threads N] [--seconds S] [--clock-ppm P]
+//
+// Every device streams its own synthetic gait (tools/gait_synth, seeded with its id) at
+// --odr, --batch samples per frame, --speed times faster than real time (so 300 devices
+// at 190 Hz, 8 samples per frame and speed 1 offer 7125 frames/s). Each sender thread
+// owns a slice of the devices and sends their frames round-robin on a fixed schedule; the
+// send stamp in every frame is this host's CLOCK_MONOTONIC, so the server measures the
+// end-to-end latency. Reported every second and at the end: frames/s actually sent
+// against the offered rate, and how far the senders fell behind schedule (if they did, the
+// server or the link is the bottleneck, and the rate is what it sustains).
+//
+// With --clock-ppm every unit runs on a clock of its own instead (random offset, rate off
+// by up to +/-P ppm) and synchronizes it against the server like a real unit: time-sync
+// requests go out on its connection, a receive thread stamps the responses as they arrive,
+// and once synced its frames carry TF_FLAG_SYNCED and shared-time stamps. Since the true
+// host time is known here, the sync error of every frame is measured and reported.
+//=======================================================================================
+#include "clock_sync.h"
+#include "gait_synth.h"
+#include "latency_hist.h"
+#include "telemetry_frame.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <math.h>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#define AGG_DEFAULT_PORT 7450
+
+struct LoadConfig
+{
+    const char *host;
+    int port;
+    int devices;
+    int firstId;
+    float odrHz;
+    int batch;
+    double speed;
+    unsigned threads;
+    double seconds;
+    double clockPpm;                                // 0: UNITS STAMP THIS HOST'S CLOCK DIRECTLY
+};
+
+struct SimUnit
+{
+    uint16_t id;
+    int fd;
+    uint16_t seq;
+    GaitSynth synth;
+    GaitConfig cfg;
+
+    // Private clock (--clock-ppm): local = offset + host time * rate
+    int64_t clockOffsetUs;
+    double clockRate;
+    std::mutex syncMutex;                           // SENDER THREAD VS. RECEIVE THREAD
+    ClockSync sync;
+    uint8_t rx[256];
+    size_t rxLen;
+};
+
+struct SenderStats
+{
+    std::atomic<uint64_t> frames{ 0 }, bytes{ 0 }, errors{ 0 };
+    std::atomic<uint64_t> maxLagUs{ 0 };
+    std::atomic<uint64_t> lagSumUs{ 0 };
+    LatencyHist syncError;                          // |SHARED TIME - TRUE HOST TIME| OF EVERY SYNCED FRAME (SENDER THREAD ONLY)
+};
+
+static std::atomic<bool> stopping{ false };
+
+static uint64_t monoUs64()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static uint32_t monoUs()
+{
+    return (uint32_t)monoUs64();
+}
+
+static uint32_t unitClock(const SimUnit *u, uint64_t hostUs)
+{
+    return (uint32_t)(u->clockOffsetUs + (int64_t)llround((double)hostUs * u->clockRate));
+}
+
+static bool sendAll(int fd, const uint8_t *p, size_t n)
+{
+    while (n > 0)
+    {
+        ssize_t w = send(fd, p, n, MSG_NOSIGNAL);
+        if (w <= 0)
+        {
+            return false;
+        }
+        p += w;
+        n -= (size_t)w;
+    }
+    return true;
+}
+
+static int connectTo(const LoadConfig &c)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)c.port);
+    if (fd < 0 || inet_pton(AF_INET, c.host, &addr.sin_addr) != 1 || connect(fd, (sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+// NEXT FRAME OF A UNIT, ITS SYNTHETIC GAIT STARTING OVER WHEN THE SCRIPT ENDS. ON A PRIVATE
+// CLOCK THE FRAME IS STAMPED IN SHARED TIME ONCE SYNCED (AND THE SYNC ERROR RECORDED), BEFORE
+// THAT WITH NO SEND TIME
+static size_t nextFrame(SimUnit *u, const LoadConfig *c, SenderStats *stats, uint8_t *out)
+{
+    const int batch = c->batch;
+    int16_t raw[TF_MAX_SAMPLES][GP_DIM_COUNT];
+    TfHeader h = {};
+    for (int i = 0; i < batch; i++)
+    {
+        TraceSample s;
+        if (!gsNext(&u->synth, &s))
+        {
+            gsInit(&u->synth, u->cfg);
+            gsNext(&u->synth, &s);
+        }
+        if (i == 0)
+        {
+            h.t0Us = s.tUs;
+        }
+        memcpy(raw[i], s.g, sizeof(raw[i]));
+    }
+    h.count = (uint8_t)batch;
+    h.deviceId = u->id;
+    h.seq = u->seq++;
+    h.periodUs = (uint16_t)lroundf(1.0e6f / u->cfg.odrHz);
+    if (c->clockPpm <= 0.0)
+    {
+        h.sendUs = monoUs();
+        return tfEncode(out, &h, raw);
+    }
+
+    uint64_t host = monoUs64();
+    uint32_t local = unitClock(u, host);
+    CsModel model;
+    {
+        std::lock_guard<std::mutex> lock(u->syncMutex);
+        model = u->sync.model;
+    }
+    h.t0Us = local - (uint32_t)(batch - 1) * h.periodUs;   // The frame's samples end now on the unit's clock
+    if (model.synced)
+    {
+        h.flags = TF_FLAG_SYNCED;
+        h.t0Us = csToShared(&model, h.t0Us);
+        h.sendUs = csToShared(&model, local);
+        int32_t err = (int32_t)(h.sendUs - (uint32_t)host);
+        lhAdd(&stats->syncError, (uint32_t)(err < 0 ? -err : err));
+    }
+    else
+    {
+        h.sendUs = 0;
+    }
+    return tfEncode(out, &h, raw);
+}
+
+// A TIME-SYNC REQUEST WHEN ONE IS DUE; t1 IS TAKEN JUST BEFORE IT GOES OUT
+static bool sendSyncRequest(SimUnit *u)
+{
+    std::lock_guard<std::mutex> lock(u->syncMutex);
+    TfHeader h = {};
+    h.deviceId = u->id;
+    h.flags = TF_FLAG_SYNC_REQ;
+    h.sendUs = unitClock(u, monoUs64());
+    if (!csPoll(&u->sync, h.sendUs, &h.seq))
+    {
+        return true;
+    }
+    uint8_t out[TF_FRAME_SIZE(0)];
+    size_t n = tfEncode(out, &h, NULL);
+    return sendAll(u->fd, out, n);
+}
+
+// RECEIVE THREAD: STAMPS AND HANDS EVERY TIME-SYNC RESPONSE TO ITS UNIT'S ESTIMATOR
+static void syncLoop(std::vector<SimUnit *> units)
+{
+    int ep = epoll_create1(0);
+    for (SimUnit *u : units)
+    {
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.ptr = u;
+        epoll_ctl(ep, EPOLL_CTL_ADD, u->fd, &ev);
+    }
+    epoll_event events[64];
+    while (!stopping.load())
+    {
+        int n = epoll_wait(ep, events, 64, 100);
+        for (int i = 0; i < n; i++)
+        {
+            SimUnit *u = (SimUnit *)events[i].data.ptr;
+            uint32_t t4 = unitClock(u, monoUs64());
+            ssize_t got = recv(u->fd, u->rx + u->rxLen, sizeof(u->rx) - u->rxLen, MSG_DONTWAIT);
+            if (got <= 0)
+            {
+                if (got == 0)
+                {
+                    epoll_ctl(ep, EPOLL_CTL_DEL, u->fd, NULL);
+                }
+                continue;
+            }
+            u->rxLen += (size_t)got;
+            size_t off = 0;
+            while (off < u->rxLen)
+            {
+                TfView v;
+                size_t used;
+                TfStatus st = tfParse(u->rx + off, u->rxLen - off, &v, &used);
+                off += used;
+                if (st == TF_NEED_MORE)
+                {
+                    break;
+                }
+                if (st == TF_OK && (v.header.flags & TF_FLAG_SYNC_RESP))
+                {
+                    std::lock_guard<std::mutex> lock(u->syncMutex);
+                    csResponse(&u->sync, v.header.seq, v.header.t0Us, v.header.sendUs, t4);
+                }
+            }
+            memmove(u->rx, u->rx + off, u->rxLen - off);
+            u->rxLen -= off;
+        }
+    }
+    close(ep);
+}
+
+static void senderLoop(const LoadConfig *c, std::vector<SimUnit *> units, SenderStats *stats, std::chrono::steady_clock::time_point start)
+{
+    const double framePeriodS = c->batch / c->odrHz / c->speed;
+    const size_t n = units.size();
+    const auto end = start + std::chrono::duration<double>(c->seconds);
+    uint8_t frame[TF_MAX_FRAME_SIZE];
+    for (uint64_t slot = 0; !units.empty(); slot++)
+    {
+        // Device slot % n sends its frame (slot / n), staggered evenly across the frame period
+        auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                               std::chrono::duration<double>(framePeriodS * ((double)(slot / n) + (double)(slot % n) / n)));
+        if (due >= end)
+        {
+            break;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (due > now)
+        {
+            std::this_thread::sleep_until(due);
+        }
+        else
+        {
+            uint64_t lag = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(now - due).count();
+            stats->lagSumUs.fetch_add(lag, std::memory_order_relaxed);
+            if (lag > stats->maxLagUs.load(std::memory_order_relaxed))
+            {
+                stats->maxLagUs.store(lag, std::memory_order_relaxed);
+            }
+        }
+        SimUnit *u = units[slot % n];
+        if (u->fd < 0)
+        {
+            continue;
+        }
+        size_t len = nextFrame(u, c, stats, frame);
+        if ((c->clockPpm > 0.0 && !sendSyncRequest(u)) || !sendAll(u->fd, frame, len))
+        {
+            stats->errors.fetch_add(1, std::memory_order_relaxed);
+            close(u->fd);
+            u->fd = -1;
+            continue;
+        }
+        stats->frames.fetch_add(1, std::memory_order_relaxed);
+        stats->bytes.fetch_add(len, std::memory_order_relaxed);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    LoadConfig c = { "127.0.0.1", AGG_DEFAULT_PORT, 300, 1, 190.0f, 8, 1.0, 4, 10.0, 0.0 };
+    bool ok = true;
+    for (int i = 1; i < argc && ok; i += 2)
+    {
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (val == NULL)
+        {
+            ok = false;
+        }
+        else if (strcmp(argv[i], "--host") == 0)
+        {
+            c.host = val;
+        }
+        else if (strcmp(argv[i], "--port") == 0)
+        {
+            c.port = atoi(val);
+        }
+        else if (strcmp(argv[i], "--devices") == 0)
+        {
+            c.devices = atoi(val);
+        }
+        else if (strcmp(argv[i], "--first-id") == 0)
+        {
+            c.firstId = atoi(val);
+        }
+        else if (strcmp(argv[i], "--odr") == 0)
+        {
+            c.odrHz = (float)atof(val);
+        }
+        else if (strcmp(argv[i], "--batch") == 0)
+        {
+            c.batch = atoi(val);
+        }
+        else if (strcmp(argv[i], "--speed") == 0)
+        {
+            c.speed = atof(val);
+        }
+        else if (strcmp(argv[i], "--threads") == 0)
+        {
+            c.threads = (unsigned)atoi(val);
+        }
+        else if (strcmp(argv[i], "--seconds") == 0)
+        {
+            c.seconds = atof(val);
+        }
+        else if (strcmp(argv[i], "--clock-ppm") == 0)
+        {
+            c.clockPpm = atof(val);
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+    if (!ok || c.devices < 1 || c.firstId < 0 || c.firstId + c.devices > 65536 || c.odrHz <= 0.0f || c.batch < 1 ||
+        c.batch > TF_MAX_SAMPLES || c.speed <= 0.0 || c.threads < 1 || c.seconds <= 0.0 ||
+        c.clockPpm < 0.0 || c.clockPpm > CS_MAX_DRIFT_PPB / 1000)
+    {
+        fprintf(stderr,
+                "usage: %s [--host ADDR] [--port P] [--devices N] [--first-id N] [--odr HZ] [--batch N<=%d]\n"
+                "          [--speed X] [--threads N] [--seconds S] [--clock-ppm P]\n",
+                argv[0], TF_MAX_SAMPLES);
+        return 2;
+    }
+
+    std::vector<std::unique_ptr<SimUnit>> units;
+    for (int i = 0; i < c.devices; i++)
+    {
+        std::unique_ptr<SimUnit> u(new SimUnit);
+        u->id = (uint16_t)(c.firstId + i);
+        u->seq = 0;
+        gsDefaults(&u->cfg);
+        u->cfg.odrHz = c.odrHz;
+        u->cfg.seed = u->id;
+        gsInit(&u->synth, u->cfg);
+        srand(u->id);
+        u->clockOffsetUs = ((int64_t)rand() << 8) ^ rand();
+        u->clockRate = 1.0 + c.clockPpm * 1.0e-6 * (2.0 * rand() / RAND_MAX - 1.0);
+        csInit(&u->sync);
+        u->rxLen = 0;
+        u->fd = connectTo(c);
+        if (u->fd < 0)
+        {
+            fprintf(stderr, "device %u: cannot connect to %s:%d\n", u->id, c.host, c.port);
+            return 1;
+        }
+        units.push_back(std::move(u));
+    }
+
+    const double offered = c.devices * c.odrHz * c.speed / c.batch;
+    printf("agg_loadgen: %d devices -> %s:%d, %.0f Hz x%.1f, %d samples/frame, %u threads: offering %.0f frames/s for %.0f s\n", c.devices,
+           c.host, c.port, c.odrHz, c.speed, c.batch, c.threads, offered, c.seconds);
+    fflush(stdout);
+
+    std::vector<SenderStats> stats(c.threads);
+    for (auto &st : stats)
+    {
+        lhInit(&st.syncError, "sync error");
+    }
+    std::vector<std::thread> threads;
+    std::thread receiver;
+    if (c.clockPpm > 0.0)
+    {
+        std::vector<SimUnit *> all;
+        for (auto &u : units)
+        {
+            all.push_back(u.get());
+        }
+        receiver = std::thread(syncLoop, all);
+    }
+    auto start = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+    for (unsigned t = 0; t < c.threads; t++)
+    {
+        std::vector<SimUnit *> slice;
+        for (size_t i = t; i < units.size(); i += c.threads)
+        {
+            slice.push_back(units[i].get());
+        }
+        threads.emplace_back(senderLoop, &c, slice, &stats[t], start);
+    }
+
+    uint64_t lastFrames = 0;
+    for (int s = 1; s < (int)ceil(c.seconds); s++)
+    {
+        std::this_thread::sleep_until(start + std::chrono::seconds(s));
+        uint64_t frames = 0, errors = 0;
+        for (auto &st : stats)
+        {
+            frames += st.frames.load();
+            errors += st.errors.load();
+        }
+        printf("t=%4ds %8llu frames/s sent (offered %.0f)%s\n", s, (unsigned long long)(frames - lastFrames), offered,
+               errors ? "  SEND ERRORS" : "");
+        fflush(stdout);
+        lastFrames = frames;
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    stopping.store(true);
+    if (receiver.joinable())
+    {
+        receiver.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t frames = 0, bytes = 0, errors = 0, maxLag = 0, lagSum = 0;
+    for (auto &st : stats)
+    {
+        frames += st.frames.load();
+        bytes += st.bytes.load();
+        errors += st.errors.load();
+        lagSum += st.lagSumUs.load();
+        maxLag = st.maxLagUs.load() > maxLag ? st.maxLagUs.load() : maxLag;
+    }
+    printf("sent %llu frames (%.2f MB) in %.1f s: %.0f frames/s of %.0f offered (%.1f%%), schedule lag mean %.0f us max %llu us, %llu send errors\n",
+           (unsigned long long)frames, bytes * 1.0e-6, elapsed, frames / elapsed, offered, 100.0 * frames / elapsed / offered,
+           frames ? (double)lagSum / frames : 0.0, (unsigned long long)maxLag, (unsigned long long)errors);
+    if (c.clockPpm > 0.0)
+    {
+        LatencyHist err;
+        lhInit(&err, "sync error");
+        uint32_t synced = 0, exchanges = 0, timeouts = 0;
+        for (auto &st : stats)
+        {
+            lhMerge(&err, &st.syncError);
+        }
+        for (auto &u : units)
+        {
+            synced += u->sync.model.synced ? 1 : 0;
+            exchanges += u->sync.exchanges;
+            timeouts += u->sync.timeouts;
+        }
+        printf("clock sync: %u of %zu units synced, %u exchanges, %u timeouts; error over %llu synced frames p50 <%lu p99 <%lu max %lu us\n",
+               synced, units.size(), exchanges, timeouts, (unsigned long long)err.count, (unsigned long)lhPercentile(&err, 0.5f),
+               (unsigned long)lhPercentile(&err, 0.99f), (unsigned long)err.max);
+    }
+    for (auto &u : units)
+    {
+        if (u->fd >= 0)
+        {
+            close(u->fd);
+        }
+    }
+    return errors ? 1 : 0;
+}
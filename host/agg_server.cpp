@@ -0,0 +1,667 @@
+//=======================================================================================
+// TELEMETRY AGGREGATION SERVER (HOST, LINUX):
+//=======================================================================================
+// Ingests the telemetry frames (lib/GyroDSP/telemetry_frame) of many units at once, runs
+// one GyroPipeline per device and publishes the aggregate:
+//
+//   agg_server [--port P] [--serial PATH [--baud B]]... [--shards N] [--report-s S]
+//              [--seconds S] [--metrics FILE]
+//
+// Sources are TCP connections on 127.0.0.1:P (the stand-in for serial links; see
+// host/agg_loadgen) and serial ports opened raw and non-blocking. Each shard is a thread
+// with its own epoll loop that owns a set of connections and the pipelines of the devices
+// whose id maps to it (id % shards). A connection starts on any shard; when its first
+// frame names a device owned by another shard it moves there once, with whatever bytes are
+// already buffered. From then on frames are parsed in place in the connection's receive
+// buffer and fed straight into the device pipeline on the same thread: no copies, no locks
+// on the data path.
+//
+// Every --report-s seconds the main thread prints frames/s, samples/s, lost and corrupt
+// frames and the end-to-end latency percentiles (frames whose send stamp is in this host's
+// CLOCK_MONOTONIC, as the load generator writes it), and rewrites --metrics (JSON, written
+// to a temporary file and renamed) with the per-device distance, steps and activity.
+// Runs until SIGINT / SIGTERM or for --seconds.
+//
+// The server is also the time reference of the units (lib/GyroDSP/clock_sync): a time-sync
+// request is answered on the spot on the link it came in on, with t2 = when its bytes were
+// read and t3 = just before the response is written, both in CLOCK_MONOTONIC. Units that
+// have converged flag their frames TF_FLAG_SYNCED; their timestamps are then in that same
+// timebase, so the latency percentiles and the device times line up across units.
+//=======================================================================================
+#include "gyro_pipeline.h"
+#include "latency_hist.h"
+#include "telemetry_frame.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <errno.h>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#define AGG_DEFAULT_PORT 7450
+#define AGG_CONN_BUF (64 * 1024)                    // RECEIVE BUFFER PER CONNECTION
+#define AGG_EPOLL_EVENTS 64
+#define AGG_POLL_MS 100                             // HOW OFTEN IDLE LOOPS CHECK FOR SHUTDOWN
+
+// ONE DEVICE: ITS PIPELINE IS TOUCHED ONLY BY THE OWNING SHARD, THE COUNTERS ARE READ BY THE REPORTER
+struct DeviceState
+{
+    uint16_t id;
+    std::unique_ptr<GyroPipeline> pipeline;
+    bool seen;
+    uint16_t nextSeq;
+    bool timebaseSynced;                            // TIMEBASE OF THE LAST FRAME
+    uint32_t pipeShiftUs;                           // FRAME TIME - PIPELINE TIME
+    uint32_t pipeNextUs;                            // PIPELINE TIME OF THE NEXT SAMPLE
+    std::atomic<uint64_t> frames{ 0 }, samples{ 0 }, lostFrames{ 0 };
+    std::atomic<long> steps{ 0 };
+    std::atomic<float> distance{ 0.0f };
+    std::atomic<uint8_t> activity{ ACT_IDLE };
+    std::atomic<bool> synced{ false };              // LAST FRAME WAS STAMPED IN THE SHARED TIMEBASE
+    std::atomic<uint32_t> lastSampleUs{ 0 };        // TIME OF ITS NEWEST SAMPLE
+};
+
+struct Conn
+{
+    int fd;
+    bool serial;
+    std::string name;
+    std::vector<uint8_t> buf;
+    size_t len;
+    DeviceState *dev;                               // BOUND BY THE FIRST FRAME
+    uint32_t rxUs;                                  // WHEN THE LAST BYTES WERE READ (t2 OF A SYNC REQUEST)
+};
+
+struct Shard
+{
+    unsigned index;
+    int ep;
+    int wake;                                       // eventfd: NEW CONNECTIONS IN THE MAILBOX
+    std::thread thread;
+    std::mutex mailboxMutex;
+    std::vector<Conn *> mailbox;
+    std::mutex devMutex;                            // DEVICE MAP INSERTS (SHARD) VS. ITERATION (REPORTER)
+    std::unordered_map<uint16_t, std::unique_ptr<DeviceState>> devices;
+    std::atomic<uint64_t> frames{ 0 }, samples{ 0 }, bytes{ 0 }, badFrames{ 0 }, misrouted{ 0 }, syncs{ 0 };
+    std::atomic<int> connections{ 0 };
+    std::mutex latMutex;
+    LatencyHist latInterval, latTotal;
+};
+
+static std::vector<std::unique_ptr<Shard>> shards;
+static std::atomic<bool> stopping{ false };
+
+static void onSignal(int)
+{
+    stopping.store(true);
+}
+
+static uint32_t monoUs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+}
+
+static void shardPost(Shard *s, Conn *c)
+{
+    {
+        std::lock_guard<std::mutex> lock(s->mailboxMutex);
+        s->mailbox.push_back(c);
+    }
+    uint64_t one = 1;
+    if (write(s->wake, &one, sizeof(one)) < 0)
+    {
+        perror("eventfd");
+    }
+}
+
+static void closeConn(Shard *s, Conn *c)
+{
+    epoll_ctl(s->ep, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    s->connections.fetch_sub(1);
+    delete c;
+}
+
+static DeviceState *deviceFor(Shard *s, uint16_t id)
+{
+    auto it = s->devices.find(id);
+    if (it != s->devices.end())
+    {
+        return it->second.get();
+    }
+    std::unique_ptr<DeviceState> d(new DeviceState);
+    d->id = id;
+    d->pipeline.reset(new GyroPipeline);
+    gpInit(d->pipeline.get(), GP_ACT_WINDOW_MS);
+    d->seen = false;
+    d->nextSeq = 0;
+    d->timebaseSynced = false;
+    d->pipeShiftUs = 0;
+    d->pipeNextUs = 0;
+    DeviceState *raw = d.get();
+    std::lock_guard<std::mutex> lock(s->devMutex);
+    s->devices.emplace(id, std::move(d));
+    return raw;
+}
+
+// RUN ONE FRAME THROUGH ITS DEVICE'S PIPELINE, STRAIGHT FROM THE RECEIVE BUFFER
+static void handleFrame(Shard *s, DeviceState *d, const TfView *v)
+{
+    const TfHeader &h = v->header;
+    if (d->seen && h.seq != d->nextSeq)
+    {
+        d->lostFrames.fetch_add((uint16_t)(h.seq - d->nextSeq), std::memory_order_relaxed);
+    }
+    // The pipeline runs on one continuous timeline: when the unit switches to the shared
+    // timebase its stamps jump by the clock offset, which the pipeline must not see as a gap
+    bool synced = (h.flags & TF_FLAG_SYNCED) != 0;
+    if (!d->seen)
+    {
+        d->pipeShiftUs = 0;
+    }
+    else if (synced != d->timebaseSynced)
+    {
+        d->pipeShiftUs = h.t0Us - d->pipeNextUs;
+    }
+    d->timebaseSynced = synced;
+    d->seen = true;
+    d->nextSeq = (uint16_t)(h.seq + 1);
+
+    GyroPipeline *p = d->pipeline.get();
+    long steps = 0;
+    for (uint8_t i = 0; i < h.count; i++)
+    {
+        int16_t raw[GP_DIM_COUNT];
+        tfSample(v, i, raw);
+        uint32_t before = p->stepCnt;
+        gpProcess(p, h.t0Us + (uint32_t)i * h.periodUs - d->pipeShiftUs, raw);
+        steps += (long)(p->stepCnt - before);
+    }
+    d->pipeNextUs = h.t0Us + (uint32_t)h.count * h.periodUs - d->pipeShiftUs;
+    d->frames.fetch_add(1, std::memory_order_relaxed);
+    d->samples.fetch_add(h.count, std::memory_order_relaxed);
+    d->steps.fetch_add(steps, std::memory_order_relaxed);
+    d->distance.store(p->totalDist, std::memory_order_relaxed);
+    d->activity.store(p->activity.current, std::memory_order_relaxed);
+    d->synced.store(synced, std::memory_order_relaxed);
+    d->lastSampleUs.store(h.t0Us + (uint32_t)(h.count - 1) * h.periodUs, std::memory_order_relaxed);
+    s->frames.fetch_add(1, std::memory_order_relaxed);
+    s->samples.fetch_add(h.count, std::memory_order_relaxed);
+
+    if (h.sendUs != 0)
+    {
+        int32_t latency = (int32_t)(monoUs() - h.sendUs);
+        latency = latency < 0 ? 0 : latency;        // A synced unit's stamp can lead this clock by its sync error
+        std::lock_guard<std::mutex> lock(s->latMutex);
+        lhAdd(&s->latInterval, (uint32_t)latency);
+        lhAdd(&s->latTotal, (uint32_t)latency);
+    }
+}
+
+// ANSWER A TIME-SYNC REQUEST ON THE LINK IT ARRIVED ON. A FAILED WRITE ONLY COSTS THE UNIT ONE EXCHANGE
+static void answerSync(Shard *s, Conn *c, const TfHeader *req)
+{
+    TfHeader h = {};
+    h.deviceId = req->deviceId;
+    h.seq = req->seq;
+    h.flags = TF_FLAG_SYNC_RESP;
+    h.t0Us = c->rxUs;
+    uint8_t out[TF_FRAME_SIZE(0)];
+    h.sendUs = monoUs();
+    size_t n = tfEncode(out, &h, NULL);
+    if (write(c->fd, out, n) == (ssize_t)n)
+    {
+        s->syncs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// PARSE EVERY COMPLETE FRAME IN THE BUFFER; FALSE IF THE CONNECTION WAS HANDED TO ANOTHER SHARD
+static bool parseConn(Shard *s, Conn *c)
+{
+    size_t off = 0;
+    Shard *moveTo = NULL;
+    while (off < c->len)
+    {
+        TfView v;
+        size_t used;
+        TfStatus st = tfParse(c->buf.data() + off, c->len - off, &v, &used);
+        if (st == TF_NEED_MORE)
+        {
+            off += used;
+            break;
+        }
+        if (st == TF_BAD_FRAME)
+        {
+            s->badFrames.fetch_add(1, std::memory_order_relaxed);
+            off += used;
+            continue;
+        }
+        if (v.header.flags & TF_SYNC_FLAGS)
+        {
+            if (v.header.flags & TF_FLAG_SYNC_REQ)
+            {
+                answerSync(s, c, &v.header);       // Answered by whichever shard holds the link, before any migration
+            }
+            off += used;
+            continue;
+        }
+        if (c->dev == NULL)
+        {
+            Shard *owner = shards[v.header.deviceId % shards.size()].get();
+            if (owner != s)
+            {
+                // First frame of a device another shard owns: move the connection there, this frame included
+                off += used - TF_FRAME_SIZE(v.header.count);
+                epoll_ctl(s->ep, EPOLL_CTL_DEL, c->fd, NULL);
+                s->connections.fetch_sub(1);
+                moveTo = owner;
+                break;
+            }
+            c->dev = deviceFor(s, v.header.deviceId);
+        }
+        off += used;
+        if (v.header.deviceId != c->dev->id)
+        {
+            s->misrouted.fetch_add(1, std::memory_order_relaxed);   // One link, one device: frames of another are dropped
+            continue;
+        }
+        handleFrame(s, c->dev, &v);
+    }
+    if (off > 0)
+    {
+        memmove(c->buf.data(), c->buf.data() + off, c->len - off);
+        c->len -= off;
+    }
+    if (moveTo != NULL)
+    {
+        shardPost(moveTo, c);
+    }
+    return moveTo == NULL;
+}
+
+// READ UNTIL THE SOCKET OR PORT WOULD BLOCK, PARSING AS THE BUFFER FILLS
+static void serviceConn(Shard *s, Conn *c)
+{
+    while (true)
+    {
+        if (c->len == c->buf.size())
+        {
+            c->len = 0;                             // Full of bytes that never formed a frame: start over
+            s->badFrames.fetch_add(1, std::memory_order_relaxed);
+        }
+        ssize_t n = read(c->fd, c->buf.data() + c->len, c->buf.size() - c->len);
+        if (n > 0)
+        {
+            c->rxUs = monoUs();
+            s->bytes.fetch_add((uint64_t)n, std::memory_order_relaxed);
+            c->len += (size_t)n;
+            if (!parseConn(s, c))
+            {
+                return;
+            }
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return;
+        }
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        closeConn(s, c);                            // EOF or a hard error
+        return;
+    }
+}
+
+static void shardLoop(Shard *s)
+{
+    epoll_event events[AGG_EPOLL_EVENTS];
+    while (!stopping.load())
+    {
+        int n = epoll_wait(s->ep, events, AGG_EPOLL_EVENTS, AGG_POLL_MS);
+        for (int i = 0; i < n; i++)
+        {
+            Conn *c = (Conn *)events[i].data.ptr;
+            if (c != NULL)
+            {
+                serviceConn(s, c);
+                continue;
+            }
+            uint64_t count;
+            if (read(s->wake, &count, sizeof(count)) < 0 && errno != EAGAIN)
+            {
+                perror("eventfd");
+            }
+            std::vector<Conn *> incoming;
+            {
+                std::lock_guard<std::mutex> lock(s->mailboxMutex);
+                incoming.swap(s->mailbox);
+            }
+            for (Conn *nc : incoming)
+            {
+                epoll_event ev = {};
+                ev.events = EPOLLIN;
+                ev.data.ptr = nc;
+                epoll_ctl(s->ep, EPOLL_CTL_ADD, nc->fd, &ev);
+                s->connections.fetch_add(1);
+                if (nc->len > 0 && !parseConn(s, nc))
+                {
+                    continue;                       // Bytes it brought along belong to yet another shard
+                }
+                serviceConn(s, nc);
+            }
+        }
+    }
+}
+
+static bool openSerial(const char *path, int baud, Conn **out)
+{
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0)
+    {
+        perror(path);
+        return false;
+    }
+    termios tio;
+    if (tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        speed_t speed = baud >= 921600 ? B921600 : baud >= 460800 ? B460800 : baud >= 230400 ? B230400 : B115200;
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    Conn *c = new Conn{ fd, true, path, std::vector<uint8_t>(AGG_CONN_BUF), 0, NULL, 0 };
+    *out = c;
+    return true;
+}
+
+static void printLatency(const char *label, const LatencyHist &h)
+{
+    if (h.count == 0)
+    {
+        printf("%s n/a", label);
+        return;
+    }
+    printf("%s p50 <%lu p99 <%lu p99.9 <%lu max %lu us", label, (unsigned long)lhPercentile(&h, 0.5f), (unsigned long)lhPercentile(&h, 0.99f),
+           (unsigned long)lhPercentile(&h, 0.999f), (unsigned long)h.max);
+}
+
+static void writeMetrics(const char *path, double elapsedS, double fps)
+{
+    std::string tmp = std::string(path) + ".tmp";
+    FILE *f = fopen(tmp.c_str(), "w");
+    if (f == NULL)
+    {
+        perror(tmp.c_str());
+        return;
+    }
+    fprintf(f, "{\"elapsed_s\":%.3f,\"frames_per_s\":%.1f,\"devices\":[", elapsedS, fps);
+    bool first = true;
+    double distance = 0.0;
+    long steps = 0;
+    unsigned perActivity[ACT_CLASS_COUNT] = { 0 };
+    for (auto &s : shards)
+    {
+        std::lock_guard<std::mutex> lock(s->devMutex);
+        for (auto &kv : s->devices)
+        {
+            const DeviceState &d = *kv.second;
+            float dist = d.distance.load(std::memory_order_relaxed);
+            long st = d.steps.load(std::memory_order_relaxed);
+            ActivityClass act = (ActivityClass)d.activity.load(std::memory_order_relaxed);
+            fprintf(f, "%s\n {\"id\":%u,\"frames\":%llu,\"samples\":%llu,\"lost_frames\":%llu,\"distance_m\":%.3f,\"steps\":%ld,\"activity\":\"%s\",\"synced\":%s,\"last_sample_us\":%lu}",
+                    first ? "" : ",", d.id, (unsigned long long)d.frames.load(), (unsigned long long)d.samples.load(),
+                    (unsigned long long)d.lostFrames.load(), dist, st, actName(act), d.synced.load() ? "true" : "false",
+                    (unsigned long)d.lastSampleUs.load());
+            first = false;
+            distance += dist;
+            steps += st;
+            perActivity[act < ACT_CLASS_COUNT ? act : ACT_IDLE]++;
+        }
+    }
+    fprintf(f, "],\n\"total\":{\"distance_m\":%.3f,\"steps\":%ld", distance, steps);
+    for (int a = 0; a < ACT_CLASS_COUNT; a++)
+    {
+        fprintf(f, ",\"%s\":%u", actName((ActivityClass)a), perActivity[a]);
+    }
+    fprintf(f, "}}\n");
+    if (fclose(f) != 0 || rename(tmp.c_str(), path) != 0)
+    {
+        perror(path);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int port = AGG_DEFAULT_PORT;
+    int baud = 921600;
+    unsigned shardCount = std::thread::hardware_concurrency();
+    double reportS = 1.0, seconds = 0.0;
+    const char *metricsPath = NULL;
+    std::vector<const char *> serialPaths;
+    bool ok = true;
+    for (int i = 1; i < argc && ok; i += 2)
+    {
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (val == NULL)
+        {
+            ok = false;
+        }
+        else if (strcmp(argv[i], "--port") == 0)
+        {
+            port = atoi(val);
+        }
+        else if (strcmp(argv[i], "--serial") == 0)
+        {
+            serialPaths.push_back(val);
+        }
+        else if (strcmp(argv[i], "--baud") == 0)
+        {
+            baud = atoi(val);
+        }
+        else if (strcmp(argv[i], "--shards") == 0)
+        {
+            shardCount = (unsigned)atoi(val);
+        }
+        else if (strcmp(argv[i], "--report-s") == 0)
+        {
+            reportS = atof(val);
+        }
+        else if (strcmp(argv[i], "--seconds") == 0)
+        {
+            seconds = atof(val);
+        }
+        else if (strcmp(argv[i], "--metrics") == 0)
+        {
+            metricsPath = val;
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+    if (!ok || port <= 0 || port > 65535 || reportS <= 0.0)
+    {
+        fprintf(stderr,
+                "usage: %s [--port P] [--serial PATH [--baud B]]... [--shards N] [--report-s S] [--seconds S] [--metrics FILE]\n",
+                argv[0]);
+        return 2;
+    }
+    if (shardCount == 0)
+    {
+        shardCount = 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    int lfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    int one = 1;
+    setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (lfd < 0 || bind(lfd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(lfd, 1024) != 0)
+    {
+        perror("listen");
+        return 1;
+    }
+    int lep = epoll_create1(0);
+    epoll_event lev = {};
+    lev.events = EPOLLIN;
+    epoll_ctl(lep, EPOLL_CTL_ADD, lfd, &lev);
+
+    for (unsigned i = 0; i < shardCount; i++)
+    {
+        std::unique_ptr<Shard> s(new Shard);
+        s->index = i;
+        s->ep = epoll_create1(0);
+        s->wake = eventfd(0, EFD_NONBLOCK);
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.ptr = NULL;
+        epoll_ctl(s->ep, EPOLL_CTL_ADD, s->wake, &ev);
+        lhInit(&s->latInterval, "interval");
+        lhInit(&s->latTotal, "total");
+        shards.push_back(std::move(s));
+    }
+    for (auto &s : shards)
+    {
+        s->thread = std::thread(shardLoop, s.get());
+    }
+    unsigned nextShard = 0;
+    for (const char *path : serialPaths)
+    {
+        Conn *c;
+        if (!openSerial(path, baud, &c))
+        {
+            stopping.store(true);
+            break;
+        }
+        shardPost(shards[nextShard++ % shardCount].get(), c);
+    }
+    printf("agg_server: 127.0.0.1:%d, %zu serial ports, %u shards\n", port, serialPaths.size(), shardCount);
+    fflush(stdout);
+
+    timespec startTs;
+    clock_gettime(CLOCK_MONOTONIC, &startTs);
+    auto elapsed = [&startTs]() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (double)(ts.tv_sec - startTs.tv_sec) + (double)(ts.tv_nsec - startTs.tv_nsec) * 1.0e-9;
+    };
+    double nextReport = reportS, lastReport = 0.0;
+    uint64_t lastFrames = 0, lastSamples = 0, lastBytes = 0;
+    uint64_t peakFps = 0;
+    while (!stopping.load() && (seconds <= 0.0 || elapsed() < seconds))
+    {
+        epoll_event ev;
+        if (epoll_wait(lep, &ev, 1, AGG_POLL_MS) > 0)
+        {
+            int fd;
+            while ((fd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK)) >= 0)
+            {
+                char name[32];
+                snprintf(name, sizeof(name), "tcp:%d", fd);
+                shardPost(shards[nextShard++ % shardCount].get(), new Conn{ fd, false, name, std::vector<uint8_t>(AGG_CONN_BUF), 0, NULL, 0 });
+            }
+        }
+
+        double now = elapsed();
+        if (now < nextReport)
+        {
+            continue;
+        }
+        uint64_t frames = 0, samples = 0, bytes = 0, bad = 0, misrouted = 0, lost = 0, syncs = 0;
+        int conns = 0;
+        size_t devices = 0, synced = 0;
+        LatencyHist lat;
+        lhInit(&lat, "interval");
+        for (auto &s : shards)
+        {
+            frames += s->frames.load();
+            samples += s->samples.load();
+            bytes += s->bytes.load();
+            bad += s->badFrames.load();
+            misrouted += s->misrouted.load();
+            conns += s->connections.load();
+            syncs += s->syncs.load();
+            {
+                std::lock_guard<std::mutex> lock(s->latMutex);
+                lhMerge(&lat, &s->latInterval);
+                lhInit(&s->latInterval, "interval");
+            }
+            std::lock_guard<std::mutex> lock(s->devMutex);
+            devices += s->devices.size();
+            for (auto &kv : s->devices)
+            {
+                lost += kv.second->lostFrames.load();
+                synced += kv.second->synced.load() ? 1 : 0;
+            }
+        }
+        double dt = now - lastReport;
+        uint64_t fps = (uint64_t)((frames - lastFrames) / dt);
+        peakFps = fps > peakFps ? fps : peakFps;
+        printf("t=%6.1fs conns %4d devices %4zu (%zu synced, %llu syncs)  %8llu frames/s %9.0f samples/s %6.2f MB/s  lost %llu bad %llu  ",
+               now, conns, devices, synced, (unsigned long long)syncs, (unsigned long long)fps, (samples - lastSamples) / dt,
+               (bytes - lastBytes) / dt * 1.0e-6, (unsigned long long)lost, (unsigned long long)(bad + misrouted));
+        printLatency("latency", lat);
+        printf("\n");
+        fflush(stdout);
+        if (metricsPath)
+        {
+            writeMetrics(metricsPath, now, (double)fps);
+        }
+        lastFrames = frames;
+        lastSamples = samples;
+        lastBytes = bytes;
+        lastReport = now;
+        nextReport = now + reportS;
+    }
+
+    stopping.store(true);
+    for (auto &s : shards)
+    {
+        s->thread.join();
+    }
+    double total = elapsed();
+    uint64_t frames = 0, samples = 0, bad = 0;
+    LatencyHist lat;
+    lhInit(&lat, "total");
+    for (auto &s : shards)
+    {
+        frames += s->frames.load();
+        samples += s->samples.load();
+        bad += s->badFrames.load() + s->misrouted.load();
+        lhMerge(&lat, &s->latTotal);
+    }
+    printf("total: %llu frames, %llu samples in %.1f s (%.0f frames/s mean, %llu peak), %llu bad; ", (unsigned long long)frames,
+           (unsigned long long)samples, total, frames / total, (unsigned long long)peakFps, (unsigned long long)bad);
+    printLatency("latency", lat);
+    printf("\n");
+    if (metricsPath)
+    {
+        writeMetrics(metricsPath, total, frames / total);
+    }
+    return 0;
+}
@@ -0,0 +1,282 @@
+//=======================================================================================
+// CLOCK SYNCHRONIZATION SIMULATION (HOST):
+//=======================================================================================
+// Runs the units' time-sync estimator (lib/GyroDSP/clock_sync) against a simulated host
+// reference over simulated jittery links, in simulated time:
+//
+//   clock_sync_sim [--units N] [--ppm P] [--wander-ppb W] [--base-us B] [--jitter-us J]
+//                  [--asym-us A] [--loss L] [--turnaround-us T] [--seconds S]
+//                  [--settle-s S] [--limit-us U] [--seed N]
+//
+// Every unit has its own 32-bit microsecond clock with a random offset and a rate off by
+// up to +-P ppm, whose frequency also random-walks by W ppb per sqrt(second) (temperature).
+// Each message takes B us plus an exponentially distributed queueing delay of mean J us,
+// the unit -> host direction A us more (an asymmetry no two-way scheme can see), and is
+// lost with probability L; the host answers T us (uniform 0..T) after a request arrives.
+//
+// Every 10 ms of simulated time each synced unit converts its current clock reading to
+// shared time, which is compared with the true host time. Reported after --settle-s:
+// the error percentiles per unit and over all units, the cross-unit error (spread of the
+// units' errors at the same instant, i.e. how far apart two simultaneous samples are
+// stamped), time to first sync and the drift estimate against the true drift.
+// Exit status 1 if the p99 error exceeds --limit-us (or a unit never synced), 2 on bad usage.
+//=======================================================================================
+#include "clock_sync.h"
+#include "latency_hist.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define SIM_STEP_S 0.001                            // SIMULATION STEP (REQUESTS LEAVE ON A STEP)
+#define SIM_CHECK_S 0.010                           // ERROR SAMPLING PERIOD
+
+struct SimConfig
+{
+    int units;
+    double ppm;
+    double wanderPpb;
+    double baseUs;
+    double jitterUs;
+    double asymUs;
+    double loss;
+    double turnaroundUs;
+    double seconds;
+    double settleS;
+    double limitUs;
+    uint32_t seed;
+};
+
+struct SimUnit
+{
+    double offsetUs;                                // CLOCK READING AT TRUE TIME 0
+    double phaseUs;                                 // CLOCK READING MINUS OFFSET AT THE CURRENT STEP
+    double rate;                                    // CLOCK RATE (1 = PERFECT)
+    ClockSync cs;
+
+    // The exchange in flight
+    bool inFlight;
+    uint16_t seq;
+    uint32_t t2Us, t3Us;
+    double backS;                                   // TRUE TIME THE RESPONSE ARRIVES
+
+    double syncedAtS;                               // FIRST SYNC (-1 = NEVER)
+    LatencyHist error;
+};
+
+static uint64_t rngState;
+
+static double simRandom()                           // UNIFORM [0, 1)
+{
+    rngState ^= rngState >> 12;                     // xorshift64*
+    rngState ^= rngState << 25;
+    rngState ^= rngState >> 27;
+    return ((rngState * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double simGauss()
+{
+    double u = simRandom() + 1.0e-12, v = simRandom();
+    return sqrt(-2.0 * log(u)) * cos(2.0 * 3.14159265358979323846 * v);
+}
+
+static double linkDelayS(const SimConfig &c, bool uplink)
+{
+    double us = c.baseUs - c.jitterUs * log(1.0 - simRandom()) + (uplink ? c.asymUs : 0.0);
+    return us * 1.0e-6;
+}
+
+// UNIT CLOCK READING AT TRUE TIME 'atS' WITHIN THE CURRENT STEP (STARTED AT 'stepS'); 1 us TICKS, WRAPPING
+static uint32_t unitClock(const SimUnit &u, double stepS, double atS)
+{
+    return (uint32_t)(uint64_t)floor(u.offsetUs + u.phaseUs + (atS - stepS) * 1.0e6 * u.rate);
+}
+
+// SHARED (HOST) TIME: THE HOST COUNTER STARTS AT AN ARBITRARY VALUE TOO
+static uint32_t hostClock(double hostOffsetUs, double atS)
+{
+    return (uint32_t)(uint64_t)floor(hostOffsetUs + atS * 1.0e6);
+}
+
+int main(int argc, char **argv)
+{
+    SimConfig c = { 8, 50.0, 20.0, 2000.0, 1000.0, 0.0, 0.02, 200.0, 600.0, 30.0, 1000.0, 1 };
+    bool ok = true;
+    for (int i = 1; i < argc && ok; i += 2)
+    {
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (val == NULL)
+        {
+            ok = false;
+        }
+        else if (strcmp(argv[i], "--units") == 0)
+        {
+            c.units = atoi(val);
+        }
+        else if (strcmp(argv[i], "--ppm") == 0)
+        {
+            c.ppm = atof(val);
+        }
+        else if (strcmp(argv[i], "--wander-ppb") == 0)
+        {
+            c.wanderPpb = atof(val);
+        }
+        else if (strcmp(argv[i], "--base-us") == 0)
+        {
+            c.baseUs = atof(val);
+        }
+        else if (strcmp(argv[i], "--jitter-us") == 0)
+        {
+            c.jitterUs = atof(val);
+        }
+        else if (strcmp(argv[i], "--asym-us") == 0)
+        {
+            c.asymUs = atof(val);
+        }
+        else if (strcmp(argv[i], "--loss") == 0)
+        {
+            c.loss = atof(val);
+        }
+        else if (strcmp(argv[i], "--turnaround-us") == 0)
+        {
+            c.turnaroundUs = atof(val);
+        }
+        else if (strcmp(argv[i], "--seconds") == 0)
+        {
+            c.seconds = atof(val);
+        }
+        else if (strcmp(argv[i], "--settle-s") == 0)
+        {
+            c.settleS = atof(val);
+        }
+        else if (strcmp(argv[i], "--limit-us") == 0)
+        {
+            c.limitUs = atof(val);
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+            c.seed = (uint32_t)strtoul(val, NULL, 10);
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+    if (!ok || c.units < 1 || c.ppm < 0.0 || c.ppm * 1000.0 > CS_MAX_DRIFT_PPB || c.baseUs < 0.0 || c.jitterUs < 0.0 || c.loss < 0.0 ||
+        c.loss >= 1.0 || c.turnaroundUs < 0.0 || c.seconds <= c.settleS || c.settleS < 0.0)
+    {
+        fprintf(stderr,
+                "usage: %s [--units N] [--ppm P] [--wander-ppb W] [--base-us B] [--jitter-us J] [--asym-us A] [--loss L]\n"
+                "          [--turnaround-us T] [--seconds S] [--settle-s S] [--limit-us U] [--seed N]\n",
+                argv[0]);
+        return 2;
+    }
+    rngState = 0x9E3779B97F4A7C15ULL ^ c.seed;
+
+    const double hostOffsetUs = simRandom() * 4294967296.0;
+    std::vector<SimUnit> units(c.units);
+    for (SimUnit &u : units)
+    {
+        u.offsetUs = simRandom() * 4294967296.0;
+        u.phaseUs = 0.0;
+        u.rate = 1.0 + c.ppm * 1.0e-6 * (2.0 * simRandom() - 1.0);
+        csInit(&u.cs);
+        u.inFlight = false;
+        u.syncedAtS = -1.0;
+        lhInit(&u.error, "unit");
+    }
+
+    LatencyHist all, cross;
+    lhInit(&all, "all");
+    lhInit(&cross, "cross-unit");
+    const long steps = lround(c.seconds / SIM_STEP_S);
+    const long checkEvery = lround(SIM_CHECK_S / SIM_STEP_S);
+    const double wanderPerStep = c.wanderPpb * 1.0e-9 * sqrt(SIM_STEP_S);
+    uint64_t sent = 0, lost = 0;
+    for (long k = 0; k < steps; k++)
+    {
+        const double t = k * SIM_STEP_S;
+        double errMin = 0.0, errMax = 0.0;
+        int errCount = 0;
+        for (SimUnit &u : units)
+        {
+            // A response due within this step arrives, stamped at its true arrival time
+            if (u.inFlight && u.backS < t + SIM_STEP_S)
+            {
+                u.inFlight = false;
+                csResponse(&u.cs, u.seq, u.t2Us, u.t3Us, unitClock(u, t, u.backS));
+                if (u.cs.model.synced && u.syncedAtS < 0.0)
+                {
+                    u.syncedAtS = u.backS;
+                }
+            }
+
+            // A request leaves now if one is due; it (or its response) may get lost
+            uint16_t seq;
+            if (csPoll(&u.cs, unitClock(u, t, t), &seq))
+            {
+                sent++;
+                if (simRandom() < c.loss || simRandom() < c.loss)
+                {
+                    lost++;
+                }
+                else
+                {
+                    double arriveS = t + linkDelayS(c, true);
+                    double replyS = arriveS + c.turnaroundUs * 1.0e-6 * simRandom();
+                    u.inFlight = true;
+                    u.seq = seq;
+                    u.t2Us = hostClock(hostOffsetUs, arriveS);
+                    u.t3Us = hostClock(hostOffsetUs, replyS);
+                    u.backS = replyS + linkDelayS(c, false);
+                }
+            }
+
+            // Sample the conversion error as a sample stamped now would carry it
+            if (k % checkEvery == 0 && u.cs.model.synced && t >= c.settleS)
+            {
+                int32_t err = (int32_t)(csToShared(&u.cs.model, unitClock(u, t, t)) - hostClock(hostOffsetUs, t));
+                uint32_t absErr = (uint32_t)(err < 0 ? -err : err);
+                lhAdd(&u.error, absErr);
+                lhAdd(&all, absErr);
+                errMin = (errCount == 0 || err < errMin) ? err : errMin;
+                errMax = (errCount == 0 || err > errMax) ? err : errMax;
+                errCount++;
+            }
+
+            u.phaseUs += SIM_STEP_S * 1.0e6 * u.rate;
+            u.rate += wanderPerStep * simGauss();
+        }
+        if (errCount > 1)
+        {
+            lhAdd(&cross, (uint32_t)(errMax - errMin));
+        }
+    }
+
+    printf("clock_sync_sim: %d units +-%.0f ppm (wander %.0f ppb/sqrt(s)), link %.0f us + exp(%.0f us), asymmetry %.0f us, loss %.1f%%, %.0f s\n",
+           c.units, c.ppm, c.wanderPpb, c.baseUs, c.jitterUs, c.asymUs, 100.0 * c.loss, c.seconds);
+    printf("unit  synced-at-s  exchanges  used  min-rtt-us  drift-ppb (true)     err-p50  err-p99  err-max us\n");
+    bool allSynced = true;
+    for (size_t i = 0; i < units.size(); i++)
+    {
+        const SimUnit &u = units[i];
+        double trueDriftPpb = (1.0 / u.rate - 1.0) * 1.0e9;  // d(shared - local) / d(local)
+        allSynced = allSynced && u.syncedAtS >= 0.0;
+        printf("%4zu %12.2f %10lu %5lu %11lu %10ld (%7.0f) %10lu %8lu %10lu\n", i, u.syncedAtS, (unsigned long)u.cs.exchanges,
+               (unsigned long)u.cs.used, (unsigned long)u.cs.minDelayUs, (long)u.cs.model.driftPpb, trueDriftPpb,
+               (unsigned long)lhPercentile(&u.error, 0.5f), (unsigned long)lhPercentile(&u.error, 0.99f), (unsigned long)u.error.max);
+    }
+    printf("requests %llu, lost %llu\n", (unsigned long long)sent, (unsigned long long)lost);
+    printf("error vs host time: p50 <%lu p99 <%lu max %lu us (mean %.1f us)\n", (unsigned long)lhPercentile(&all, 0.5f),
+           (unsigned long)lhPercentile(&all, 0.99f), (unsigned long)all.max, all.count ? (double)all.sum / all.count : 0.0);
+    printf("cross-unit spread: p50 <%lu p99 <%lu max %lu us\n", (unsigned long)lhPercentile(&cross, 0.5f),
+           (unsigned long)lhPercentile(&cross, 0.99f), (unsigned long)cross.max);
+    if (!allSynced || all.count == 0 || lhPercentile(&all, 0.99f) > c.limitUs)
+    {
+        printf("FAIL: %s\n", allSynced ? "p99 error above the limit" : "a unit never synced");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+//=======================================================================================
+// HOST PIPELINE REPLAY:
+//=======================================================================================
+// Runs the firmware's processing pipeline (lib/GyroDSP/gyro_pipeline) over recorded raw
+// traces on the host, paced by the SampleReplay stub at a multiple of real time:
+//
+//   pipeline_replay [--speed X] trace1.csv [trace2.csv ...]
+//
+// --speed 100 (the default) replays 100x faster than the trace was captured; 0 replays
+// as fast as possible (pure throughput). For every trace it reports the final distance,
+// step count and activity, the per-sample processing cost, and how many samples were
+// processed late (after the next one was already due), which is the real-time margin.
+//=======================================================================================
+#include "cycle_counter.h"
+#include "gyro_pipeline.h"
+#include "latency_hist.h"
+#include "sample_replay.h"
+#include "trace_io.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_UNIT_HOST "ns"                        // cycleCounterNow() TICKS ON THE HOST
+
+static GyroPipeline pipeline;                       // ~25KB, kept off the stack
+
+int main(int argc, char **argv)
+{
+    double speed = 100.0;
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "--speed") == 0)
+    {
+        speed = atof(argv[2]);
+        first = 3;
+    }
+    if (first >= argc)
+    {
+        fprintf(stderr, "usage: %s [--speed X] trace.csv [...]\n", argv[0]);
+        return 2;
+    }
+
+    cycleCounterInit();
+    for (int f = first; f < argc; f++)
+    {
+        Trace trace;
+        if (!traceLoad(argv[f], &trace))
+        {
+            return 1;
+        }
+        if (trace.samples.empty())
+        {
+            printf("%s: no samples\n", argv[f]);
+            continue;
+        }
+
+        gpInit(&pipeline, GP_ACT_WINDOW_MS);
+        SampleReplay replay;
+        replayInit(&replay, &trace, speed);
+        LatencyHist cost, late;
+        lhInit(&cost, "process");
+        lhInit(&late, "late");
+        uint32_t periodUs = trace.samples.size() > 1 ? (trace.samples.back().tUs - trace.samples[0].tUs) / (uint32_t)(trace.samples.size() - 1) : 0;
+        uint32_t overruns = 0;
+
+        uint8_t frame[GP_FRAME_SIZE];
+        uint32_t tUs, lateUs;
+        auto wallStart = std::chrono::steady_clock::now();
+        while (replayNext(&replay, frame, &tUs, &lateUs))
+        {
+            uint32_t start = cycleCounterNow();
+            int16_t raw[GP_DIM_COUNT];
+            gpDecodeFrame(frame, raw);
+            gpProcess(&pipeline, tUs, raw);
+            lhAdd(&cost, cycleCounterNow() - start);
+            lhAdd(&late, lateUs);
+            if (speed > 0.0 && lateUs * speed > periodUs)
+            {
+                overruns++;                         // Still busy when the next sample came due (in trace time)
+            }
+        }
+        double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        rsAdvance(&pipeline.stats, tUs / 1000);
+
+        double traceS = (trace.samples.back().tUs - trace.samples[0].tUs) * 1.0e-6;
+        printf("%s\n", argv[f]);
+        printf("  samples %zu over %.2f s of trace, replayed in %.3f s (%.1fx real time, requested %s%.0fx)\n",
+               trace.samples.size(), traceS, wallS, wallS > 0.0 ? traceS / wallS : 0.0, speed > 0.0 ? "" : "unpaced ", speed);
+        printf("  distance %.3f m, steps %d, activity %s, state %s\n", pipeline.totalDist, pipeline.stepCnt,
+               actName(pipeline.activity.current), pipeline.state == GP_IDLE ? "IDLE" : "MOVING");
+        printf("  throughput %.2f Msamples/s of pipeline time, %lu samples late\n",
+               cost.sum ? cost.count * 1.0e3 / (double)cost.sum : 0.0, (unsigned long)overruns);
+        lhPrintHeader(BENCH_UNIT_HOST);
+        lhPrint(&cost);
+        lhPrintHeader("us");
+        lhPrint(&late);
+    }
+    return 0;
+}
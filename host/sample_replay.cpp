@@ -0,0 +1,53 @@
+//=======================================================================================
+// HOST SENSOR STUB: TIMED SAMPLE REPLAY
+//=======================================================================================
+#include "sample_replay.h"
+#include <thread>
+
+void replayInit(SampleReplay *r, const Trace *trace, double speed)
+{
+    r->trace = trace;
+    r->next = 0;
+    r->speed = speed;
+    r->started = false;
+    r->traceStartUs = trace->samples.empty() ? 0 : trace->samples[0].tUs;
+}
+
+bool replayNext(SampleReplay *r, uint8_t frame[GP_FRAME_SIZE], uint32_t *tUs, uint32_t *lateUs)
+{
+    if (r->next >= r->trace->samples.size())
+    {
+        return false;
+    }
+    const TraceSample &s = r->trace->samples[r->next++];
+    *lateUs = 0;
+
+    if (r->speed > 0.0)
+    {
+        if (!r->started)
+        {
+            r->wallStart = std::chrono::steady_clock::now();
+            r->started = true;
+        }
+        auto due = r->wallStart + std::chrono::nanoseconds((int64_t)((double)(s.tUs - r->traceStartUs) * 1000.0 / r->speed));
+        auto now = std::chrono::steady_clock::now();
+        if (now < due)
+        {
+            std::this_thread::sleep_until(due);     // "Wait for DRDY"
+        }
+        else
+        {
+            *lateUs = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(now - due).count();
+        }
+    }
+
+    // The frame the sensor clocks out for a 7-byte auto-increment read of OUT_X_L..OUT_Z_H
+    frame[0] = 0xFF;
+    for (int d = 0; d < GP_DIM_COUNT; d++)
+    {
+        frame[1 + 2 * d] = (uint8_t)((uint16_t)s.g[d] & 0xFF);
+        frame[2 + 2 * d] = (uint8_t)((uint16_t)s.g[d] >> 8);
+    }
+    *tUs = s.tUs;
+    return true;
+}
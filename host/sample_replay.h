@@ -0,0 +1,36 @@
+//=======================================================================================
+// HOST SENSOR STUB: TIMED SAMPLE REPLAY
+//=======================================================================================
+// Stands in for the gyroscope, its DRDY interrupt and the SPI burst read on the host.
+// replayNext() waits until the next sample of a trace is "due" (its t_us divided by the
+// speed-up factor, measured from the first call) and returns it as the 7-byte SPI frame
+// the real sensor would have clocked out, so the host run goes through the same
+// gpDecodeFrame() as the firmware. A speed of 0 replays as fast as possible.
+//
+// 'lateUs' is how far behind schedule the consumer was when the sample came due; a
+// consumer that keeps up at the requested speed sees it stay near zero.
+//=======================================================================================
+#ifndef SAMPLE_REPLAY_H
+#define SAMPLE_REPLAY_H
+
+#include <stdint.h>
+#include <chrono>
+#include "gyro_pipeline.h"
+#include "trace_io.h"
+
+struct SampleReplay
+{
+    const Trace *trace;
+    size_t next;                                    // INDEX OF THE NEXT SAMPLE
+    double speed;                                   // REAL-TIME MULTIPLE, 0 = UNPACED
+    bool started;
+    std::chrono::steady_clock::time_point wallStart;
+    uint32_t traceStartUs;                          // t_us OF THE FIRST SAMPLE
+};
+
+void replayInit(SampleReplay *r, const Trace *trace, double speed);
+
+// NEXT SAMPLE AS AN SPI FRAME PLUS ITS CAPTURE TIME; FALSE AT THE END OF THE TRACE
+bool replayNext(SampleReplay *r, uint8_t frame[GP_FRAME_SIZE], uint32_t *tUs, uint32_t *lateUs);
+
+#endif // SAMPLE_REPLAY_H
@@ -0,0 +1,343 @@
+//=======================================================================================
+// MULTI-SENSOR BUS SIMULATION (HOST):
+//=======================================================================================
+// Runs the firmware's SensorManager (lib/GyroDSP/sensor_manager) against simulated
+// L3GD20-class gyros on a simulated shared SPI bus, in simulated time:
+//
+//   sensor_sim [--devices N] [--groups 0,0,1,1] [--odr HZ] [--ppm P] [--jitter-us J]
+//              [--spi-hz F] [--overhead-us O] [--consumer-ms M] [--align-hz HZ]
+//              [--seconds S] [--seed N]
+//
+// Each DRDY group has its own crystal (a random error within +-P ppm and a random phase),
+// so groups drift against each other. At every DRDY edge the group's devices latch the
+// same body motion (a sum of gait-band sines, scaled per device); the interrupt timestamp
+// lags the edge by up to J us. A read occupies the bus for its bytes at F Hz plus O us of
+// chip-select / DMA set-up. A consumer thread wakes every M ms and drains the aligner.
+//
+// Reported: per-device samples, missed samples, stream drops and worst DRDY -> read wait;
+// bus utilization; and the error of the aligned samples against the true motion at the
+// grid time, next to the error of simply holding each device's latest sample (what an
+// unaligned consumer would see). Exit status 1 if any sample was lost, 2 on bad usage.
+//=======================================================================================
+#include "sensor_manager.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_PI 3.14159265358979323846
+
+struct SimConfig
+{
+    int devices;
+    uint8_t group[SM_MAX_DEVICES];
+    double odrHz;
+    double ppm;
+    double jitterUs;
+    double spiHz;
+    double overheadUs;
+    double consumerMs;
+    double alignHz;
+    double seconds;
+    uint32_t seed;
+};
+
+struct SimGroup
+{
+    double periodS;                                 // THIS GROUP'S ACTUAL SAMPLE PERIOD
+    double nextS;                                   // NEXT DRDY EDGE (TRUE TIME)
+};
+
+struct SimDevice
+{
+    float gain;                                     // MOUNTING: HOW STRONGLY THE DEVICE SEES THE MOTION
+    int16_t latched[GP_DIM_COUNT];                  // OUTPUT REGISTERS
+};
+
+static uint64_t rngState;
+
+static double simRandom()                           // UNIFORM [0, 1)
+{
+    rngState ^= rngState >> 12;                     // xorshift64*
+    rngState ^= rngState << 25;
+    rngState ^= rngState >> 27;
+    return ((rngState * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// TRUE ANGULAR RATE (RAW COUNTS) OF AXIS 'k' AT TIME 't', AS SEEN BY A DEVICE OF GAIN 1
+static double motion(int k, double t)
+{
+    const double phase = k * 2.1;
+    return 6000.0 * sin(2.0 * SIM_PI * 1.8 * t + phase) + 2500.0 * sin(2.0 * SIM_PI * 3.6 * t + 2.0 * phase) +
+           800.0 * sin(2.0 * SIM_PI * 9.0 * t + 3.0 * phase);
+}
+
+static uint32_t toUs(double t)
+{
+    return (uint32_t)(uint64_t)llround(t * 1.0e6);  // Wraps like the firmware's 32-bit microsecond stamps
+}
+
+static bool parseGroups(const char *text, SimConfig *c)
+{
+    int n = 0;
+    for (const char *p = text; *p && n < SM_MAX_DEVICES; n++)
+    {
+        char *end;
+        long g = strtol(p, &end, 10);
+        if (end == p || g < 0 || g >= SM_MAX_GROUPS)
+        {
+            return false;
+        }
+        c->group[n] = (uint8_t)g;
+        p = (*end == ',') ? end + 1 : end;
+    }
+    c->devices = n;
+    return n > 0;
+}
+
+int main(int argc, char **argv)
+{
+    SimConfig c = { 4, { 0, 0, 1, 1 }, 760.0, 200.0, 3.0, 1.0e6, 4.0, 5.0, 0.0, 60.0, 1 };
+    bool groupsGiven = false;
+    bool ok = true;
+    for (int i = 1; i < argc && ok; i += 2)
+    {
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (val == NULL)
+        {
+            ok = false;
+        }
+        else if (strcmp(argv[i], "--devices") == 0)
+        {
+            c.devices = atoi(val);
+        }
+        else if (strcmp(argv[i], "--groups") == 0)
+        {
+            ok = parseGroups(val, &c);
+            groupsGiven = true;
+        }
+        else if (strcmp(argv[i], "--odr") == 0)
+        {
+            c.odrHz = atof(val);
+        }
+        else if (strcmp(argv[i], "--ppm") == 0)
+        {
+            c.ppm = atof(val);
+        }
+        else if (strcmp(argv[i], "--jitter-us") == 0)
+        {
+            c.jitterUs = atof(val);
+        }
+        else if (strcmp(argv[i], "--spi-hz") == 0)
+        {
+            c.spiHz = atof(val);
+        }
+        else if (strcmp(argv[i], "--overhead-us") == 0)
+        {
+            c.overheadUs = atof(val);
+        }
+        else if (strcmp(argv[i], "--consumer-ms") == 0)
+        {
+            c.consumerMs = atof(val);
+        }
+        else if (strcmp(argv[i], "--align-hz") == 0)
+        {
+            c.alignHz = atof(val);
+        }
+        else if (strcmp(argv[i], "--seconds") == 0)
+        {
+            c.seconds = atof(val);
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+            c.seed = (uint32_t)strtoul(val, NULL, 10);
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+    if (!ok || c.devices < 1 || c.devices > SM_MAX_DEVICES || c.odrHz <= 0.0 || c.spiHz <= 0.0 || c.consumerMs <= 0.0)
+    {
+        fprintf(stderr,
+                "usage: %s [--devices N<=%d] [--groups 0,0,1,1] [--odr HZ] [--ppm P] [--jitter-us J]\n"
+                "          [--spi-hz F] [--overhead-us O] [--consumer-ms M] [--align-hz HZ] [--seconds S] [--seed N]\n",
+                argv[0], SM_MAX_DEVICES);
+        return 2;
+    }
+    if (!groupsGiven)
+    {
+        for (int i = 0; i < c.devices; i++)
+        {
+            c.group[i] = (uint8_t)(i / 2);
+        }
+    }
+    if (c.alignHz <= 0.0)
+    {
+        c.alignHz = c.odrHz;
+    }
+    rngState = 0x9E3779B97F4A7C15ULL ^ c.seed;
+
+    // Devices, groups and the manager
+    SimGroup groups[SM_MAX_GROUPS];
+    int groupCount = 0;
+    SimDevice devs[SM_MAX_DEVICES];
+    SmDeviceConfig config[SM_MAX_DEVICES];
+    for (int i = 0; i < c.devices; i++)
+    {
+        config[i] = SmDeviceConfig{ c.group[i], true };
+        devs[i].gain = (float)(0.6 + 0.8 * simRandom());
+        memset(devs[i].latched, 0, sizeof(devs[i].latched));
+        if (c.group[i] + 1 > groupCount)
+        {
+            groupCount = c.group[i] + 1;
+        }
+    }
+    for (int g = 0; g < groupCount; g++)
+    {
+        groups[g].periodS = 1.0 / (c.odrHz * (1.0 + (2.0 * simRandom() - 1.0) * c.ppm * 1.0e-6));
+        groups[g].nextS = simRandom() * groups[g].periodS;
+    }
+    static SensorManager mgr;
+    smInit(&mgr, (uint8_t)c.devices, config, 0);
+    SmAligner aligner;
+    smAlignInit(&aligner, (uint32_t)lround(1.0e6 / c.alignHz));
+
+    const double readS = GP_FRAME_SIZE * 8.0 / c.spiHz + c.overheadUs * 1.0e-6;
+    bool busBusy = false;
+    double busEndS = 0.0;
+    SmRead active;
+    double consumerS = c.consumerMs * 1.0e-3;
+
+    uint64_t aligned = 0;
+    double interpSq = 0.0, holdSq = 0.0, interpMax = 0.0, holdMax = 0.0;
+    uint32_t spanMax = 0;
+    double busyTotalUs = 0.0;
+    double reportS = 1.0, peakUtil = 0.0;
+
+    double now = 0.0;
+    while (now < c.seconds)
+    {
+        // Next event: a DRDY edge, the end of the read on the bus, or the consumer waking up
+        int g = 0;
+        for (int k = 1; k < groupCount; k++)
+        {
+            if (groups[k].nextS < groups[g].nextS)
+            {
+                g = k;
+            }
+        }
+        double next = groups[g].nextS;
+        int kind = 0;
+        if (busBusy && busEndS <= next)
+        {
+            next = busEndS;
+            kind = 1;
+        }
+        if (consumerS < next)
+        {
+            next = consumerS;
+            kind = 2;
+        }
+        now = next;
+
+        if (kind == 0)
+        {
+            for (int i = 0; i < c.devices; i++)
+            {
+                if (c.group[i] != g)
+                {
+                    continue;
+                }
+                for (int k = 0; k < GP_DIM_COUNT; k++)
+                {
+                    double v = devs[i].gain * motion(k, now);
+                    devs[i].latched[k] = (int16_t)(v > 32767.0 ? 32767.0 : (v < -32768.0 ? -32768.0 : lround(v)));
+                }
+            }
+            smDataReady(&mgr, (uint8_t)g, toUs(now + simRandom() * c.jitterUs * 1.0e-6));
+            groups[g].nextS += groups[g].periodS;
+        }
+        else if (kind == 1)
+        {
+            uint8_t *rx = active.rx;                // The sensor clocks out its output registers behind the address byte
+            const int16_t *reg = devs[active.device].latched;
+            rx[0] = 0xFF;
+            for (int k = 0; k < GP_DIM_COUNT; k++)
+            {
+                rx[1 + 2 * k] = (uint8_t)(reg[k] & 0xFF);
+                rx[2 + 2 * k] = (uint8_t)((uint16_t)reg[k] >> 8);
+            }
+            smReadDone(&mgr, active.device, rx, (uint32_t)lround(readS * 1.0e6));
+            busyTotalUs += readS * 1.0e6;
+            busBusy = false;
+        }
+        else
+        {
+            SmAligned a;
+            while (smAlignNext(&aligner, &mgr, &a))
+            {
+                // The grid time is in the interrupt timebase; compare against the motion at that instant
+                double t = (double)a.tUs * 1.0e-6;
+                while (t + 2147.483648 < now)
+                {
+                    t += 4294.967296;               // Undo the 32-bit wrap for the comparison
+                }
+                for (int i = 0; i < c.devices; i++)
+                {
+                    for (int k = 0; k < GP_DIM_COUNT; k++)
+                    {
+                        double truth = devs[i].gain * motion(k, t);
+                        double ei = fabs(a.raw[i][k] - truth);
+                        double eh = fabs((double)aligner.prev[i].raw[k] - truth);
+                        interpSq += ei * ei;
+                        holdSq += eh * eh;
+                        interpMax = ei > interpMax ? ei : interpMax;
+                        holdMax = eh > holdMax ? eh : holdMax;
+                    }
+                }
+                spanMax = a.spanUs > spanMax ? a.spanUs : spanMax;
+                aligned++;
+            }
+            consumerS += c.consumerMs * 1.0e-3;
+            if (now >= reportS)
+            {
+                SmBusReport bus;                    // Per-second utilization, as the firmware reports it
+                smBusReport(&mgr, toUs(now), &bus);
+                peakUtil = bus.utilization > peakUtil ? bus.utilization : peakUtil;
+                reportS += 1.0;
+            }
+        }
+
+        // Keep the bus busy: the next pending read goes out as soon as the previous one ends
+        if (!busBusy && smNextRead(&mgr, toUs(now), &active))
+        {
+            busBusy = true;
+            busEndS = now + readS;
+        }
+    }
+
+    printf("sensor_sim: %d devices in %d DRDY groups, %.0f Hz +-%.0f ppm, SPI %.2f MHz (%.1f us per read), %.0f s\n", c.devices,
+           groupCount, c.odrHz, c.ppm, c.spiHz * 1.0e-6, readS * 1.0e6, c.seconds);
+    printf("dev grp   samples   missed    drops  max-wait-us\n");
+    uint64_t lost = 0;
+    for (int i = 0; i < c.devices; i++)
+    {
+        const SmDevice *d = &mgr.dev[i];
+        printf("%3d %3u %9lu %8lu %8lu %12lu\n", i, c.group[i], (unsigned long)d->samples, (unsigned long)d->missed,
+               (unsigned long)d->streamDrops, (unsigned long)d->maxWaitUs);
+        lost += d->missed + d->streamDrops;
+    }
+    printf("bus: utilization %.1f%% mean, %.1f%% worst second\n", 100.0 * busyTotalUs / (now * 1.0e6), 100.0 * peakUtil);
+    double n = (double)aligned * c.devices * GP_DIM_COUNT;
+    printf("alignment @ %.0f Hz: %llu frames, widest span %lu us\n", c.alignHz, (unsigned long long)aligned, (unsigned long)spanMax);
+    printf("  interpolated  rms %8.2f  max %8.2f counts\n", n > 0 ? sqrt(interpSq / n) : 0.0, interpMax);
+    printf("  latest held   rms %8.2f  max %8.2f counts\n", n > 0 ? sqrt(holdSq / n) : 0.0, holdMax);
+    if (lost > 0)
+    {
+        printf("%llu samples lost\n", (unsigned long long)lost);
+        return 1;
+    }
+    return 0;
+}
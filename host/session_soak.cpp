@@ -0,0 +1,295 @@
+//=======================================================================================
+// LONG-SESSION SOAK TEST (HOST):
+//=======================================================================================
+// Runs one GyroPipeline for hours of simulated time, as fast as the host allows, the way
+// the continuous firmware build (GYRO_CONTINUOUS) runs it for a whole outing:
+//
+//   session_soak [--hours H] [--odr HZ] [--start-us U] [--script S] [--seed N]
+//                [--slow-limit X]
+//
+// A synthetic gait (tools/gait_synth, default a 10-minute mix of rest, walk, jog and run)
+// is generated once and replayed end to end with fresh timestamps. The 32-bit microsecond
+// timestamps start at --start-us (default one minute before they wrap) and wrap every
+// 71.6 minutes, as the firmware's do.
+//
+// The pipeline's trace gives every resultant distance, from which the tool keeps its own
+// reference in 64-bit integers and doubles: step count, total distance, distance per
+// second. After every sample it checks that the statistics close at most one second and,
+// at every second boundary, that:
+//   - the closed seconds and minutes match the elapsed time (no burst at a timestamp wrap)
+//   - the step count equals the reference exactly
+//   - the fixed-point total is within its rounding bound of the reference
+//   - the last 20 s, last minute and session distance sums match the reference
+//   - the session rate summary has counted every sample
+// One line per simulated hour shows the totals, what a float accumulator would read by
+// then, and the pipeline time per sample (gpProcess only).
+// Exit status 1 if a check fails or an hour runs more than (1 + X) times slower per
+// sample than the fastest hour (default X = 0.5), 2 on bad usage.
+//=======================================================================================
+#include "gait_synth.h"
+#include "gyro_pipeline.h"
+#include <chrono>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define SOAK_RING 64                                // REFERENCE DISTANCE PER SECOND, LAST SOAK_RING SECONDS
+#define SOAK_DEFAULT_SCRIPT "rest:30,walk:120,jog:60,run:45,turn:3:90,walk:90,rest:60,jog:60,run:30,walk:75,rest:40"
+#define SOAK_MAX_FAILURES 10                        // FAILED CHECKS PRINTED BEFORE STOPPING
+
+struct SoakConfig
+{
+    double hours;
+    float odrHz;
+    uint32_t startUs;
+    const char *script;
+    uint32_t seed;
+    double slowLimit;
+};
+
+// Reference totals, fed by the pipeline's trace
+struct SoakRef
+{
+    float mulFactor2;
+    float stepThreshold;
+    uint64_t steps;
+    uint64_t moving;                                // RESULTANT DISTANCES TAKEN (FIXED-POINT ROUNDINGS)
+    double distance;
+    float floatDistance;                            // WHAT A float ACCUMULATOR READS
+    double perSecond[SOAK_RING];                    // DISTANCE IN EACH OF THE LAST SECONDS
+    uint64_t second;                                // SECOND OF THE CURRENT SAMPLE
+};
+
+static void soakTrace(void *ctx, GpTrace kind, int32_t, float v0, float, float, float)
+{
+    if (kind != GP_TRACE_CALC)
+    {
+        return;
+    }
+    SoakRef *r = (SoakRef *)ctx;
+    float distStep = v0 * r->mulFactor2;            // As gpRunFSM scales it
+    r->moving++;
+    r->distance += distStep;
+    r->floatDistance += distStep;
+    r->perSecond[r->second % SOAK_RING] += distStep;
+    if (v0 >= r->stepThreshold)
+    {
+        r->steps++;
+    }
+}
+
+static double refRecent(const SoakRef *r, uint64_t closed, int n)
+{
+    double sum = 0.0;
+    for (int k = 1; k <= n && (uint64_t)k <= closed; k++)
+    {
+        sum += r->perSecond[(closed - k) % SOAK_RING];
+    }
+    return sum;
+}
+
+static bool near(double got, double want, double tol)
+{
+    return fabs(got - want) <= tol;
+}
+
+int main(int argc, char **argv)
+{
+    SoakConfig c = { 8.0, 190.0f, 0xFFFFFFFFu - 60000000u, SOAK_DEFAULT_SCRIPT, 7, 0.5 };
+    bool ok = true;
+    for (int i = 1; i < argc && ok; i += 2)
+    {
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (val == NULL)
+        {
+            ok = false;
+        }
+        else if (strcmp(argv[i], "--hours") == 0)
+        {
+            c.hours = atof(val);
+        }
+        else if (strcmp(argv[i], "--odr") == 0)
+        {
+            c.odrHz = (float)atof(val);
+        }
+        else if (strcmp(argv[i], "--start-us") == 0)
+        {
+            c.startUs = (uint32_t)strtoul(val, NULL, 0);
+        }
+        else if (strcmp(argv[i], "--script") == 0)
+        {
+            c.script = val;
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+            c.seed = (uint32_t)strtoul(val, NULL, 0);
+        }
+        else if (strcmp(argv[i], "--slow-limit") == 0)
+        {
+            c.slowLimit = atof(val);
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+    GaitConfig gc;
+    gsDefaults(&gc);
+    gc.odrHz = c.odrHz;
+    gc.seed = c.seed;
+    if (!ok || c.hours <= 0.0 || c.odrHz <= 0.0f || !gsParseScript(c.script, &gc.script))
+    {
+        fprintf(stderr, "usage: session_soak [--hours H] [--odr HZ] [--start-us U] [--script S] [--seed N] [--slow-limit X]\n");
+        return 2;
+    }
+
+    // One pass of the script, replayed with fresh timestamps
+    std::vector<int16_t> raw;
+    GaitSynth synth;
+    gsInit(&synth, gc);
+    TraceSample s;
+    while (gsNext(&synth, &s))
+    {
+        raw.insert(raw.end(), s.g, s.g + GP_DIM_COUNT);
+    }
+    const uint64_t loopLen = raw.size() / GP_DIM_COUNT;
+    const uint64_t total = (uint64_t)llround(c.hours * 3600.0 * c.odrHz);
+    const uint64_t perHour = (uint64_t)llround(3600.0 * c.odrHz);
+    if (loopLen == 0)
+    {
+        fprintf(stderr, "session_soak: the script is empty\n");
+        return 2;
+    }
+
+    static GyroPipeline p;
+    static SoakRef ref;
+    gpInit(&p, GP_ACT_WINDOW_MS, soakTrace, &ref);
+    ref.mulFactor2 = p.params.mulFactor2;
+    ref.stepThreshold = p.params.stepThreshold;
+
+    printf("session_soak: %.1f h at %.0f Hz (%llu samples, a %.0f s script replayed), clock starts at %lu us\n",
+           c.hours, c.odrHz, (unsigned long long)total, (double)loopLen / c.odrHz, (unsigned long)c.startUs);
+    printf(" hour     steps    distance m   fx err m  float err m  last 20 s m  last min m  wraps  ns/sample\n");
+
+    const double periodUs = 1.0e6 / c.odrHz;
+    const uint64_t startMs = (uint64_t)c.startUs / 1000;
+    int failures = 0;
+    uint32_t wraps = 0, lastUs = c.startUs;
+    uint64_t closed = 0;
+    double hourNs = 0.0, bestNs = 0.0;
+    std::vector<double> nsPerHour;
+    auto chunkStart = std::chrono::steady_clock::now();
+    RsSummary recent20, recent60, session, rate;
+
+    auto fail = [&](const char *what, uint64_t n, double got, double want) {
+        if (failures < SOAK_MAX_FAILURES)
+        {
+            printf("FAIL at %.3f h (sample %llu): %s = %.9g, expected %.9g\n", (double)n / c.odrHz / 3600.0,
+                   (unsigned long long)n, what, got, want);
+        }
+        failures++;
+    };
+
+    for (uint64_t n = 0; n < total && failures < SOAK_MAX_FAILURES; n++)
+    {
+        // Absolute time in 64 bits for the reference, its low 32 bits for the pipeline
+        uint64_t absUs = (uint64_t)c.startUs + (uint64_t)llround((double)n * periodUs);
+        uint32_t tUs = (uint32_t)absUs;
+        wraps += (tUs < lastUs) ? 1u : 0u;
+        lastUs = tUs;
+        uint64_t second = (absUs / 1000 - startMs) / 1000;
+
+        bool newSecond = (second != ref.second);
+        if (newSecond)
+        {
+            ref.second = second;
+            ref.perSecond[second % SOAK_RING] = 0.0;
+        }
+
+        uint32_t before = p.stats.secondsClosed;
+        gpProcess(&p, tUs, &raw[(n % loopLen) * GP_DIM_COUNT]);
+        if (p.stats.secondsClosed - before > 1u)
+        {
+            fail("seconds closed by one sample", n, p.stats.secondsClosed - before, 1.0);
+        }
+
+        if (newSecond)
+        {
+            // The first sample of a second closed the previous one: stop the clock and check it
+            hourNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - chunkStart).count();
+            closed = second;
+            if (p.stats.secondsClosed != (uint32_t)closed)
+            {
+                fail("seconds closed", n, p.stats.secondsClosed, (double)closed);
+            }
+            if (p.stats.minutesClosed != (uint32_t)(closed / 60))
+            {
+                fail("minutes closed", n, p.stats.minutesClosed, (double)(closed / 60));
+            }
+            if (p.stepCnt != (uint32_t)ref.steps)
+            {
+                fail("steps", n, p.stepCnt, (double)ref.steps);
+            }
+            double fx = (double)p.totalDistFx / (double)(1LL << GP_DIST_FX_BITS);
+            if (!near(fx, ref.distance, (double)ref.moving / (double)(2LL << GP_DIST_FX_BITS) + 1e-9 * ref.distance))
+            {
+                fail("fixed-point distance", n, fx, ref.distance);
+            }
+            rsRecent(&p.stats, RS_DISTANCE, RS_LEVEL_SECOND, 20, &recent20);
+            rsRecent(&p.stats, RS_DISTANCE, RS_LEVEL_SECOND, 60, &recent60);
+            rsCurrent(&p.stats, RS_DISTANCE, RS_LEVEL_SESSION, &session);
+            rsCurrent(&p.stats, RS_RATE, RS_LEVEL_SESSION, &rate);
+            double want20 = refRecent(&ref, closed, 20), want60 = refRecent(&ref, closed, 60);
+            if (!near(recent20.sum, want20, 1e-9 * want20 + 1e-12))
+            {
+                fail("last 20 s distance", n, recent20.sum, want20);
+            }
+            if (!near(recent60.sum, want60, 1e-9 * want60 + 1e-12))
+            {
+                fail("last minute distance", n, recent60.sum, want60);
+            }
+            if (!near(session.sum, ref.distance, 1e-9 * ref.distance + 1e-12))
+            {
+                fail("session distance", n, session.sum, ref.distance);
+            }
+            if (rate.count != n + 1)
+            {
+                fail("session rate samples", n, (double)rate.count, (double)(n + 1));
+            }
+            chunkStart = std::chrono::steady_clock::now();
+        }
+
+        if ((n + 1) % perHour == 0 || n + 1 == total)
+        {
+            hourNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - chunkStart).count();
+            uint64_t inHour = (n % perHour) + 1;
+            double ns = hourNs / (double)inHour;
+            if (inHour == perHour)
+            {
+                nsPerHour.push_back(ns);
+                bestNs = (nsPerHour.size() == 1 || ns < bestNs) ? ns : bestNs;
+            }
+            double fx = (double)p.totalDistFx / (double)(1LL << GP_DIST_FX_BITS);
+            printf("%5.1f %9lu %13.3f %10.2e %12.3f %12.3f %11.3f %6lu %10.1f\n", (double)(n + 1) / c.odrHz / 3600.0,
+                   (unsigned long)p.stepCnt, fx, fx - ref.distance, (double)ref.floatDistance - ref.distance, recent20.sum,
+                   recent60.sum, (unsigned long)wraps, ns);
+            hourNs = 0.0;
+            chunkStart = std::chrono::steady_clock::now();
+        }
+    }
+
+    for (size_t h = 0; h < nsPerHour.size(); h++)
+    {
+        if (nsPerHour[h] > (1.0 + c.slowLimit) * bestNs)
+        {
+            printf("FAIL: hour %zu took %.1f ns/sample, the fastest hour %.1f (limit +%.0f%%)\n", h + 1, nsPerHour[h], bestNs,
+                   100.0 * c.slowLimit);
+            failures++;
+        }
+    }
+    printf("%s: %d failed check%s\n", failures ? "FAIL" : "ok", failures, failures == 1 ? "" : "s");
+    return failures ? 1 : 0;
+}
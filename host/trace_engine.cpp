@@ -0,0 +1,279 @@
+//=======================================================================================
+// BULK TRACE ENGINE (HOST):
+//=======================================================================================
+// Pushes whole sessions of raw int16 xyz samples through the SIMD kernels of
+// host/trace_kernels in chunks (bias removal and scaling, moving average, per-axis
+// distance increments, resultant distance, magnitude) and reports the throughput of each
+// stage in GB/s of raw sensor data (6 bytes per sample), plus per-session totals.
+// Every stage runs on every sample, for throughput. The pipeline itself feeds the velocity
+// stages one sample per GP_FSM_PERIOD_US, so the dist3 sum is a checksum of the kernel
+// outputs, not a distance: golden_check and batch_process report those.
+//
+//   trace_engine [--isa auto|scalar|avx2|neon] [--reps N] [--no-verify] session...
+//
+// A session is a trace file or a synthetic spec (tools/gait_synth, "synth:seed=N,...").
+// The zero-rate bias of each axis is the mean of the session's first second (sessions
+// start at rest). Unless --no-verify, every chunk is also run through the scalar
+// reference and must match bit for bit.
+// Exit status 1 if any SIMD result differs from the scalar reference.
+//=======================================================================================
+#include "gait_synth.h"
+#include "gyro_pipeline.h"
+#include "trace_io.h"
+#include "trace_kernels.h"
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define TK_CHUNK 4096                               // SAMPLES PER CHUNK (~100KB OF WORKING SET)
+#define TK_PAD 8                                    // FLOATS KEPT IN FRONT OF EACH BUFFER (>= TK_HISTORY)
+
+enum TkStage : uint8_t
+{
+    TK_STAGE_SCALE = 0,
+    TK_STAGE_AVG,
+    TK_STAGE_DIMS,
+    TK_STAGE_DIST,
+    TK_STAGE_NORM,
+    TK_STAGE_COUNT
+};
+
+static const char *const kStageNames[TK_STAGE_COUNT] = { "scale+bias", "moving-average", "dims", "dist3", "norm3" };
+
+// ONE AXIS-SET OF CHUNK BUFFERS WITH LOOK-BACK HISTORY IN FRONT
+struct ChunkBuffers
+{
+    float lin[GP_DIM_COUNT][TK_PAD + TK_CHUNK];     // (raw - bias) * GP_SCALING_FACTOR
+    float avg[GP_DIM_COUNT][TK_PAD + TK_CHUNK];
+    float dims[GP_DIM_COUNT][TK_PAD + TK_CHUNK];
+    float dist[TK_CHUNK];
+    float norm[TK_CHUNK];
+
+    void reset() { memset(this, 0, sizeof(*this)); }
+
+    // CARRY THE LAST TK_PAD SAMPLES OF THIS CHUNK IN FRONT OF THE NEXT
+    void carry(uint32_t n)
+    {
+        for (int d = 0; d < GP_DIM_COUNT; d++)
+        {
+            memmove(lin[d], lin[d] + n, TK_PAD * sizeof(float));
+            memmove(dims[d], dims[d] + n, TK_PAD * sizeof(float));
+        }
+    }
+};
+
+struct EngineResult
+{
+    double distSum;                                 // SUM OF THE dist3 OUTPUTS (EVERY SAMPLE, NO FSM)
+    double meanNorm;
+    double stageS[TK_STAGE_COUNT];
+    uint64_t mismatches;                            // SIMD != SCALAR (FLOATS)
+};
+
+static ChunkBuffers bufs, refBufs;                  // ~500KB, kept off the stack
+
+typedef std::chrono::steady_clock Clock;
+
+static void runChunk(const TkKernels *k, ChunkBuffers *b, const int16_t *raw, uint32_t n, const float bias[GP_DIM_COUNT], double *stageS)
+{
+    auto t0 = Clock::now();
+    k->scale(raw, n, bias, GP_SCALING_FACTOR, b->lin[0] + TK_PAD, b->lin[1] + TK_PAD, b->lin[2] + TK_PAD);
+    auto t1 = Clock::now();
+    for (int d = 0; d < GP_DIM_COUNT; d++)
+    {
+        k->movingAvg(b->lin[d] + TK_PAD, b->avg[d] + TK_PAD, n);
+    }
+    auto t2 = Clock::now();
+    for (int d = 0; d < GP_DIM_COUNT; d++)
+    {
+        k->dims(b->avg[d] + TK_PAD, b->dims[d] + TK_PAD, n);
+    }
+    auto t3 = Clock::now();
+    k->dist3(b->dims[0] + TK_PAD, b->dims[1] + TK_PAD, b->dims[2] + TK_PAD, b->dist, n);
+    auto t4 = Clock::now();
+    k->norm3(b->lin[0] + TK_PAD, b->lin[1] + TK_PAD, b->lin[2] + TK_PAD, b->norm, n);
+    auto t5 = Clock::now();
+    if (stageS)
+    {
+        stageS[TK_STAGE_SCALE] += std::chrono::duration<double>(t1 - t0).count();
+        stageS[TK_STAGE_AVG] += std::chrono::duration<double>(t2 - t1).count();
+        stageS[TK_STAGE_DIMS] += std::chrono::duration<double>(t3 - t2).count();
+        stageS[TK_STAGE_DIST] += std::chrono::duration<double>(t4 - t3).count();
+        stageS[TK_STAGE_NORM] += std::chrono::duration<double>(t5 - t4).count();
+    }
+}
+
+static uint64_t countMismatches(const float *a, const float *b, uint32_t n)
+{
+    uint64_t bad = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        bad += memcmp(&a[i], &b[i], sizeof(float)) != 0 ? 1 : 0;
+    }
+    return bad;
+}
+
+static void runSession(const TkKernels *k, const std::vector<int16_t> &raw, const float bias[GP_DIM_COUNT], bool verify, EngineResult *out)
+{
+    memset(out, 0, sizeof(*out));
+    bufs.reset();
+    refBufs.reset();
+    const TkKernels *ref = tkSelect(TK_ISA_SCALAR);
+    uint32_t total = (uint32_t)(raw.size() / GP_DIM_COUNT);
+    double normSum = 0.0;
+
+    for (uint32_t start = 0; start < total; start += TK_CHUNK)
+    {
+        uint32_t n = (total - start < TK_CHUNK) ? total - start : TK_CHUNK;
+        const int16_t *chunk = raw.data() + (size_t)start * GP_DIM_COUNT;
+        runChunk(k, &bufs, chunk, n, bias, out->stageS);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            out->distSum += bufs.dist[i];
+            normSum += bufs.norm[i];
+        }
+
+        if (verify)
+        {
+            runChunk(ref, &refBufs, chunk, n, bias, NULL);
+            for (int d = 0; d < GP_DIM_COUNT; d++)
+            {
+                out->mismatches += countMismatches(bufs.lin[d] + TK_PAD, refBufs.lin[d] + TK_PAD, n);
+                out->mismatches += countMismatches(bufs.avg[d] + TK_PAD, refBufs.avg[d] + TK_PAD, n);
+                out->mismatches += countMismatches(bufs.dims[d] + TK_PAD, refBufs.dims[d] + TK_PAD, n);
+            }
+            out->mismatches += countMismatches(bufs.dist, refBufs.dist, n);
+            out->mismatches += countMismatches(bufs.norm, refBufs.norm, n);
+            refBufs.carry(n);
+        }
+        bufs.carry(n);
+    }
+    out->meanNorm = total ? normSum / total : 0.0;
+}
+
+static bool loadSession(const char *spec, std::vector<int16_t> *raw, float bias[GP_DIM_COUNT], double *odrHz)
+{
+    Trace trace;
+    if (!(gsIsSpec(spec) ? gsLoadSpec(spec, &trace) : traceLoad(spec, &trace)) || trace.samples.size() < 2)
+    {
+        return false;
+    }
+    raw->resize(trace.samples.size() * GP_DIM_COUNT);
+    for (size_t i = 0; i < trace.samples.size(); i++)
+    {
+        memcpy(raw->data() + i * GP_DIM_COUNT, trace.samples[i].g, sizeof(trace.samples[i].g));
+    }
+    *odrHz = trace.odrHz > 0.0f ? trace.odrHz
+                                : 1.0e6 * (trace.samples.size() - 1) / (uint32_t)(trace.samples.back().tUs - trace.samples[0].tUs);
+
+    size_t restN = (size_t)*odrHz < trace.samples.size() ? (size_t)*odrHz : trace.samples.size();
+    for (int d = 0; d < GP_DIM_COUNT; d++)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < restN; i++)
+        {
+            sum += trace.samples[i].g[d];
+        }
+        bias[d] = (float)(sum / restN);
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    TkIsa isa = TK_ISA_AUTO;
+    int reps = 3;
+    bool verify = true;
+    int first = 1;
+    for (; first < argc && argv[first][0] == '-'; first++)
+    {
+        if (strcmp(argv[first], "--no-verify") == 0)
+        {
+            verify = false;
+        }
+        else if (strcmp(argv[first], "--isa") == 0 && first + 1 < argc)
+        {
+            isa = tkParseIsa(argv[++first]);
+        }
+        else if (strcmp(argv[first], "--reps") == 0 && first + 1 < argc)
+        {
+            reps = atoi(argv[++first]) > 0 ? atoi(argv[first]) : 1;
+        }
+        else
+        {
+            first = argc;
+        }
+    }
+    if (first >= argc)
+    {
+        fprintf(stderr, "usage: %s [--isa auto|scalar|avx2|neon] [--reps N] [--no-verify] session...\n", argv[0]);
+        return 2;
+    }
+    const TkKernels *k = tkSelect(isa);
+    if (k == NULL)
+    {
+        fprintf(stderr, "requested ISA is not available in this build or on this CPU\n");
+        return 2;
+    }
+    printf("kernels: %s (scalar reference for verification)\n", k->name);
+
+    double stageS[TK_STAGE_COUNT] = {};
+    uint64_t samples = 0, mismatches = 0;
+    printf("%-40s %9s %7s %12s %10s\n", "session", "samples", "bias-x", "dist3 sum", "mean|v|");
+    for (int f = first; f < argc; f++)
+    {
+        std::vector<int16_t> raw;
+        float bias[GP_DIM_COUNT];
+        double odrHz;
+        if (!loadSession(argv[f], &raw, bias, &odrHz))
+        {
+            fprintf(stderr, "%s: cannot load\n", argv[f]);
+            return 2;
+        }
+
+        // Best of 'reps' per stage; the results are identical every time
+        EngineResult r, best = {};
+        for (int rep = 0; rep < reps; rep++)
+        {
+            runSession(k, raw, bias, verify && rep == 0, &r);
+            if (rep == 0)
+            {
+                best = r;
+            }
+            for (int s = 0; s < TK_STAGE_COUNT; s++)
+            {
+                best.stageS[s] = r.stageS[s] < best.stageS[s] ? r.stageS[s] : best.stageS[s];
+            }
+        }
+        for (int s = 0; s < TK_STAGE_COUNT; s++)
+        {
+            stageS[s] += best.stageS[s];
+        }
+        uint64_t n = raw.size() / GP_DIM_COUNT;
+        samples += n;
+        mismatches += best.mismatches;
+        printf("%-40.40s %9llu %7.1f %12.6f %10.5f%s\n", argv[f], (unsigned long long)n, bias[0], best.distSum,
+               best.meanNorm, best.mismatches ? "  SIMD MISMATCH" : "");
+    }
+
+    double bytes = (double)samples * GP_DIM_COUNT * sizeof(int16_t);
+    double totalS = 0.0;
+    printf("\n%-16s %10s %10s %12s\n", "stage", "time[ms]", "GB/s", "Msamples/s");
+    for (int s = 0; s < TK_STAGE_COUNT; s++)
+    {
+        totalS += stageS[s];
+        printf("%-16s %10.3f %10.2f %12.1f\n", kStageNames[s], stageS[s] * 1.0e3, stageS[s] > 0.0 ? bytes / stageS[s] * 1.0e-9 : 0.0,
+               stageS[s] > 0.0 ? samples / stageS[s] * 1.0e-6 : 0.0);
+    }
+    printf("%-16s %10.3f %10.2f %12.1f\n", "whole engine", totalS * 1.0e3, totalS > 0.0 ? bytes / totalS * 1.0e-9 : 0.0,
+           totalS > 0.0 ? samples / totalS * 1.0e-6 : 0.0);
+    if (verify)
+    {
+        printf("%llu of %llu floats differ from the scalar reference\n", (unsigned long long)mismatches,
+               (unsigned long long)(samples * (3 * GP_DIM_COUNT + 2)));
+    }
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,324 @@
+//=======================================================================================
+// BULK TRACE KERNELS (HOST, SIMD):
+//=======================================================================================
+// Built with -ffp-contract=off (host/CMakeLists.txt): a fused multiply-add in one
+// implementation and not in another would break bit compatibility.
+//=======================================================================================
+#include "trace_kernels.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TK_HAVE_AVX2 1
+#endif
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define TK_HAVE_NEON 1
+#endif
+
+static const float kDimsScale = GP_RADIUS;          // dims = avg * GP_RADIUS * 0.5f, LEFT TO RIGHT
+
+//---------------------------------------------------------------------------------------
+// SCALAR REFERENCE
+//---------------------------------------------------------------------------------------
+static void scaleScalar(const int16_t *xyz, uint32_t n, const float bias[GP_DIM_COUNT], float scale, float *x, float *y, float *z)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        x[i] = ((float)xyz[3 * i] - bias[0]) * scale;
+        y[i] = ((float)xyz[3 * i + 1] - bias[1]) * scale;
+        z[i] = ((float)xyz[3 * i + 2] - bias[2]) * scale;
+    }
+}
+
+static void movingAvgScalar(const float *in, float *out, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const float *w = in + i - TK_HISTORY;
+        float sum = w[0];
+        for (int k = 1; k < GP_WINDOW_SIZE; k++)
+        {
+            sum += w[k];
+        }
+        out[i] = sum / GP_WINDOW_SIZE;
+    }
+}
+
+static void dimsScalar(const float *avg, float *out, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        out[i] = avg[i] * kDimsScale * 0.5f;
+    }
+}
+
+static void dist3Scalar(const float *x, const float *y, const float *z, float *out, uint32_t n)
+{
+    const float *px = x - 1, *py = y - 1, *pz = z - 1;      // Previous increment, x[-1] at i = 0
+    for (uint32_t i = 0; i < n; i++)
+    {
+        float dx = x[i] - px[i];
+        float dy = y[i] - py[i];
+        float dz = z[i] - pz[i];
+        out[i] = sqrtf(dx * dx + dy * dy + dz * dz);
+    }
+}
+
+static void norm3Scalar(const float *x, const float *y, const float *z, float *out, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        out[i] = sqrtf(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+    }
+}
+
+static const TkKernels kScalar = { TK_ISA_SCALAR, "scalar", scaleScalar, movingAvgScalar, dimsScalar, dist3Scalar, norm3Scalar };
+
+//---------------------------------------------------------------------------------------
+// AVX2: 8 FLOAT LANES; RAW xyz DEINTERLEAVED 8 SAMPLES (48 BYTES) AT A TIME WITH PSHUFB
+//---------------------------------------------------------------------------------------
+#if TK_HAVE_AVX2
+#define TK_AVX2 __attribute__((target("avx2")))
+
+// 24 int16 (x0 y0 z0 x1 ... z7) in three 16-byte registers -> x0..x7, y0..y7, z0..z7
+TK_AVX2 static inline void deinterleave8(const int16_t *p, __m128i *x, __m128i *y, __m128i *z)
+{
+    const __m128i a = _mm_loadu_si128((const __m128i *)p);
+    const __m128i b = _mm_loadu_si128((const __m128i *)(p + 8));
+    const __m128i c = _mm_loadu_si128((const __m128i *)(p + 16));
+    const __m128i xa = _mm_setr_epi8(0, 1, 6, 7, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i xb = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 3, 8, 9, 14, 15, -1, -1, -1, -1);
+    const __m128i xc = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 4, 5, 10, 11);
+    const __m128i ya = _mm_setr_epi8(2, 3, 8, 9, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i yb = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 4, 5, 10, 11, -1, -1, -1, -1, -1, -1);
+    const __m128i yc = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 1, 6, 7, 12, 13);
+    const __m128i za = _mm_setr_epi8(4, 5, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i zb = _mm_setr_epi8(-1, -1, -1, -1, 0, 1, 6, 7, 12, 13, -1, -1, -1, -1, -1, -1);
+    const __m128i zc = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 3, 8, 9, 14, 15);
+    *x = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, xa), _mm_shuffle_epi8(b, xb)), _mm_shuffle_epi8(c, xc));
+    *y = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, ya), _mm_shuffle_epi8(b, yb)), _mm_shuffle_epi8(c, yc));
+    *z = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, za), _mm_shuffle_epi8(b, zb)), _mm_shuffle_epi8(c, zc));
+}
+
+TK_AVX2 static void scaleAvx2(const int16_t *xyz, uint32_t n, const float bias[GP_DIM_COUNT], float scale, float *x, float *y, float *z)
+{
+    const __m256 s = _mm256_set1_ps(scale);
+    const __m256 bx = _mm256_set1_ps(bias[0]);
+    const __m256 by = _mm256_set1_ps(bias[1]);
+    const __m256 bz = _mm256_set1_ps(bias[2]);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i rx, ry, rz;
+        deinterleave8(xyz + 3 * i, &rx, &ry, &rz);
+        __m256 fx = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(rx));
+        __m256 fy = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(ry));
+        __m256 fz = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(rz));
+        _mm256_storeu_ps(x + i, _mm256_mul_ps(_mm256_sub_ps(fx, bx), s));
+        _mm256_storeu_ps(y + i, _mm256_mul_ps(_mm256_sub_ps(fy, by), s));
+        _mm256_storeu_ps(z + i, _mm256_mul_ps(_mm256_sub_ps(fz, bz), s));
+    }
+    scaleScalar(xyz + 3 * i, n - i, bias, scale, x + i, y + i, z + i);
+}
+
+TK_AVX2 static void movingAvgAvx2(const float *in, float *out, uint32_t n)
+{
+    const __m256 len = _mm256_set1_ps((float)GP_WINDOW_SIZE);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const float *w = in + i - TK_HISTORY;
+        __m256 sum = _mm256_loadu_ps(w);
+        for (int k = 1; k < GP_WINDOW_SIZE; k++)
+        {
+            sum = _mm256_add_ps(sum, _mm256_loadu_ps(w + k));
+        }
+        _mm256_storeu_ps(out + i, _mm256_div_ps(sum, len));
+    }
+    movingAvgScalar(in + i, out + i, n - i);
+}
+
+TK_AVX2 static void dimsAvx2(const float *avg, float *out, uint32_t n)
+{
+    const __m256 r = _mm256_set1_ps(kDimsScale);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(avg + i), r), half));
+    }
+    dimsScalar(avg + i, out + i, n - i);
+}
+
+TK_AVX2 static inline __m256 sumSquares(__m256 a, __m256 b, __m256 c)
+{
+    return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a, a), _mm256_mul_ps(b, b)), _mm256_mul_ps(c, c));
+}
+
+TK_AVX2 static void dist3Avx2(const float *x, const float *y, const float *z, float *out, uint32_t n)
+{
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(x + i - 1));
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + i), _mm256_loadu_ps(y + i - 1));
+        __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(z + i), _mm256_loadu_ps(z + i - 1));
+        _mm256_storeu_ps(out + i, _mm256_sqrt_ps(sumSquares(dx, dy, dz)));
+    }
+    dist3Scalar(x + i, y + i, z + i, out + i, n - i);
+}
+
+TK_AVX2 static void norm3Avx2(const float *x, const float *y, const float *z, float *out, uint32_t n)
+{
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        _mm256_storeu_ps(out + i, _mm256_sqrt_ps(sumSquares(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), _mm256_loadu_ps(z + i))));
+    }
+    norm3Scalar(x + i, y + i, z + i, out + i, n - i);
+}
+
+static const TkKernels kAvx2 = { TK_ISA_AVX2, "avx2", scaleAvx2, movingAvgAvx2, dimsAvx2, dist3Avx2, norm3Avx2 };
+#endif
+
+//---------------------------------------------------------------------------------------
+// NEON (AArch64): 4 FLOAT LANES; vld3q_s16 DEINTERLEAVES 8 RAW SAMPLES PER LOAD
+//---------------------------------------------------------------------------------------
+#if TK_HAVE_NEON
+static void scaleNeon(const int16_t *xyz, uint32_t n, const float bias[GP_DIM_COUNT], float scale, float *x, float *y, float *z)
+{
+    const float32x4_t s = vdupq_n_f32(scale);
+    float *const dst[GP_DIM_COUNT] = { x, y, z };
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        int16x8x3_t raw = vld3q_s16(xyz + 3 * i);
+        for (int d = 0; d < GP_DIM_COUNT; d++)
+        {
+            const float32x4_t b = vdupq_n_f32(bias[d]);
+            float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(raw.val[d])));
+            float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(raw.val[d])));
+            vst1q_f32(dst[d] + i, vmulq_f32(vsubq_f32(lo, b), s));
+            vst1q_f32(dst[d] + i + 4, vmulq_f32(vsubq_f32(hi, b), s));
+        }
+    }
+    scaleScalar(xyz + 3 * i, n - i, bias, scale, x + i, y + i, z + i);
+}
+
+static void movingAvgNeon(const float *in, float *out, uint32_t n)
+{
+    const float32x4_t len = vdupq_n_f32((float)GP_WINDOW_SIZE);
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        const float *w = in + i - TK_HISTORY;
+        float32x4_t sum = vld1q_f32(w);
+        for (int k = 1; k < GP_WINDOW_SIZE; k++)
+        {
+            sum = vaddq_f32(sum, vld1q_f32(w + k));
+        }
+        vst1q_f32(out + i, vdivq_f32(sum, len));
+    }
+    movingAvgScalar(in + i, out + i, n - i);
+}
+
+static void dimsNeon(const float *avg, float *out, uint32_t n)
+{
+    const float32x4_t r = vdupq_n_f32(kDimsScale);
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        vst1q_f32(out + i, vmulq_f32(vmulq_f32(vld1q_f32(avg + i), r), half));
+    }
+    dimsScalar(avg + i, out + i, n - i);
+}
+
+static inline float32x4_t sumSquaresNeon(float32x4_t a, float32x4_t b, float32x4_t c)
+{
+    return vaddq_f32(vaddq_f32(vmulq_f32(a, a), vmulq_f32(b, b)), vmulq_f32(c, c));
+}
+
+static void dist3Neon(const float *x, const float *y, const float *z, float *out, uint32_t n)
+{
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4_t dx = vsubq_f32(vld1q_f32(x + i), vld1q_f32(x + i - 1));
+        float32x4_t dy = vsubq_f32(vld1q_f32(y + i), vld1q_f32(y + i - 1));
+        float32x4_t dz = vsubq_f32(vld1q_f32(z + i), vld1q_f32(z + i - 1));
+        vst1q_f32(out + i, vsqrtq_f32(sumSquaresNeon(dx, dy, dz)));
+    }
+    dist3Scalar(x + i, y + i, z + i, out + i, n - i);
+}
+
+static void norm3Neon(const float *x, const float *y, const float *z, float *out, uint32_t n)
+{
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        vst1q_f32(out + i, vsqrtq_f32(sumSquaresNeon(vld1q_f32(x + i), vld1q_f32(y + i), vld1q_f32(z + i))));
+    }
+    norm3Scalar(x + i, y + i, z + i, out + i, n - i);
+}
+
+static const TkKernels kNeon = { TK_ISA_NEON, "neon", scaleNeon, movingAvgNeon, dimsNeon, dist3Neon, norm3Neon };
+#endif
+
+//---------------------------------------------------------------------------------------
+// DISPATCH
+//---------------------------------------------------------------------------------------
+const TkKernels *tkSelect(TkIsa isa)
+{
+    switch (isa)
+    {
+        case TK_ISA_SCALAR:
+            return &kScalar;
+
+        case TK_ISA_AVX2:
+#if TK_HAVE_AVX2
+            if (__builtin_cpu_supports("avx2"))
+            {
+                return &kAvx2;
+            }
+#endif
+            return 0;
+
+        case TK_ISA_NEON:
+#if TK_HAVE_NEON
+            return &kNeon;
+#else
+            return 0;
+#endif
+
+        case TK_ISA_AUTO:
+        default:
+        {
+            const TkKernels *k = tkSelect(TK_ISA_AVX2);
+            if (k == 0)
+            {
+                k = tkSelect(TK_ISA_NEON);
+            }
+            return k ? k : &kScalar;
+        }
+    }
+}
+
+TkIsa tkParseIsa(const char *name)
+{
+    if (strcmp(name, "scalar") == 0)
+    {
+        return TK_ISA_SCALAR;
+    }
+    if (strcmp(name, "avx2") == 0)
+    {
+        return TK_ISA_AVX2;
+    }
+    if (strcmp(name, "neon") == 0)
+    {
+        return TK_ISA_NEON;
+    }
+    return TK_ISA_AUTO;
+}
@@ -0,0 +1,59 @@
+//=======================================================================================
+// BULK TRACE KERNELS (HOST, SIMD):
+//=======================================================================================
+// Structure-of-arrays batch forms of the arithmetic in gpFilter() and gpDist3Dim(), for
+// pushing whole sessions of raw int16 xyz data through on the host (the pipeline applies
+// the velocity stages once per GP_FSM_PERIOD_US; the kernels take whatever they are given):
+//   scale      interleaved raw xyz -> x[], y[], z[] = (raw - bias) * scale
+//   movingAvg  GP_WINDOW_SIZE-sample moving average of one axis
+//   dims       per-axis distance increment, avg * GP_RADIUS * 0.5
+//   dist3      resultant distance between consecutive increments (gpDist3Dim)
+//   norm3      magnitude of an x/y/z triple (the rate magnitude fed to the classifier)
+// Three implementations sit behind one function table picked at run time: AVX2 (8 float
+// lanes, 8 raw samples per shuffle) when the CPU has it, NEON (vld3q_s16 deinterleave,
+// 4 float lanes) on AArch64, and the portable scalar reference everywhere.
+//
+// BIT COMPATIBILITY: every kernel performs the same IEEE operations in the same order in
+// all implementations (no FMA contraction, sums in chronological order, true division and
+// correctly rounded sqrt), so the SIMD results are bit-identical to the scalar reference.
+// Compared with gpFilter() itself they skip the (non-linear) Hampel stage and sum the
+// moving-average window oldest-first instead of in ring order, which can move the average
+// by a few ulp. Those differences are expected; differences from the scalar reference are
+// bugs (host/trace_engine checks for them).
+//
+// Kernels that look back read before the start of their input: movingAvg reads
+// in[-(GP_WINDOW_SIZE - 1)] and dist3 reads x/y/z[-1]. Callers keep that history in front
+// of each chunk (zeros at the start of a session, like gpInit()).
+//=======================================================================================
+#ifndef TRACE_KERNELS_H
+#define TRACE_KERNELS_H
+
+#include <stdint.h>
+#include "gyro_pipeline.h"
+
+#define TK_HISTORY (GP_WINDOW_SIZE - 1)             // SAMPLES OF LOOK-BACK THE KERNELS MAY READ
+
+enum TkIsa : uint8_t
+{
+    TK_ISA_AUTO = 0,                                // BEST THE CPU SUPPORTS
+    TK_ISA_SCALAR,
+    TK_ISA_AVX2,
+    TK_ISA_NEON
+};
+
+struct TkKernels
+{
+    TkIsa isa;
+    const char *name;
+    void (*scale)(const int16_t *xyz, uint32_t n, const float bias[GP_DIM_COUNT], float scale, float *x, float *y, float *z);
+    void (*movingAvg)(const float *in, float *out, uint32_t n);
+    void (*dims)(const float *avg, float *out, uint32_t n);
+    void (*dist3)(const float *x, const float *y, const float *z, float *out, uint32_t n);
+    void (*norm3)(const float *x, const float *y, const float *z, float *out, uint32_t n);
+};
+
+// KERNEL TABLE FOR 'isa'; NULL IF THIS BUILD / CPU CANNOT RUN IT
+const TkKernels *tkSelect(TkIsa isa);
+TkIsa tkParseIsa(const char *name);
+
+#endif // TRACE_KERNELS_H
@@ -0,0 +1,65 @@
+//=======================================================================================
+// FFT CASES (BUNDLED FFT LIBRARY):
+//=======================================================================================
+// Times the FFT library pulled in by platformio.ini (tinyu-zhao/FFT): the real transform
+// rfft() and the complex split_radix_fft() it is built on. The plans (twiddle factors and
+// buffers, which fft_init() mallocs) are created once outside the timed region. Builds
+// without the library (e.g. a host checkout without .pio/libdeps) report the cases as
+// skipped.
+//=======================================================================================
+#include "gyro_bench.h"
+#include <stdio.h>
+#include <math.h>
+
+#if __has_include("fft.h")
+#include "fft.h"
+
+#define BENCH_FFT_N 256                             // TRANSFORM SIZE (SAMPLES)
+
+static fft_config_t *fftReal = 0;
+static fft_config_t *fftComplex = 0;
+extern volatile float benchSinkF;
+
+static void caseRfft(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        rfft(fftReal->input, fftReal->output, fftReal->twiddle_factors, BENCH_FFT_N);
+    }
+    benchSinkF = fftReal->output[1];
+}
+
+static void caseSplitRadix(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        split_radix_fft(fftComplex->input, fftComplex->output, BENCH_FFT_N, 2, fftComplex->twiddle_factors, 2);
+    }
+    benchSinkF = fftComplex->output[1];
+}
+
+void benchRunFft()
+{
+    if (fftReal == 0)
+    {
+        fftReal = fft_init(BENCH_FFT_N, FFT_REAL, FFT_FORWARD, 0, 0);
+        fftComplex = fft_init(BENCH_FFT_N, FFT_COMPLEX, FFT_FORWARD, 0, 0);
+    }
+    for (int i = 0; i < BENCH_FFT_N; i++)
+    {
+        fftReal->input[i] = sinf(6.2831853f * 7.0f * i / BENCH_FFT_N);
+        fftComplex->input[2 * i] = fftReal->input[i];
+        fftComplex->input[2 * i + 1] = 0.0f;
+    }
+    benchPrint(benchRun("fft/rfft-256", caseRfft, 16, 16));
+    benchPrint(benchRun("fft/split-radix-256", caseSplitRadix, 16, 16));
+}
+
+#else
+
+void benchRunFft()
+{
+    printf("fft/*                        skipped (FFT library not available)\n");
+}
+
+#endif
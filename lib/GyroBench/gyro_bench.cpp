@@ -0,0 +1,431 @@
+//=======================================================================================
+// MICRO-BENCHMARK RUNNER:
+//=======================================================================================
+#include "gyro_bench.h"
+#include "cycle_counter.h"
+#include "vec_math.h"
+#include "hampel_filter.h"
+#include "gyro_pipeline.h"
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+
+#define BENCH_VEC_LEN 64                            // SAMPLES PER BATCH IN THE VECTOR MATH CASES
+
+volatile float benchSinkF;                          // Results are written here so the kernels are not optimised away
+volatile uint32_t benchSinkU;
+
+static BenchResult benchResults[BENCH_MAX_RESULTS];
+static uint32_t benchResultCount = 0;
+
+BenchResult benchRun(const char *name, BenchFn fn, uint32_t ops, uint32_t reps)
+{
+    uint32_t ticks[BENCH_MAX_REPS];
+    float sum = 0.0f, sumSq = 0.0f;
+
+    if (reps > BENCH_MAX_REPS)
+    {
+        reps = BENCH_MAX_REPS;
+    }
+    if (reps == 0)
+    {
+        reps = 1;
+    }
+
+    fn(ops);                                        // Warm-up pass (caches, flash accelerator, branch history)
+    for (uint32_t r = 0; r < reps; r++)
+    {
+        uint32_t start = cycleCounterNow();
+        fn(ops);
+        ticks[r] = cycleCounterNow() - start;
+        float perOp = (float)ticks[r] / ops;
+        sum += perOp;
+        sumSq += perOp * perOp;
+    }
+
+    // Insertion sort; 'reps' is small
+    for (uint32_t i = 1; i < reps; i++)
+    {
+        uint32_t v = ticks[i];
+        uint32_t j = i;
+        while (j > 0 && ticks[j - 1] > v)
+        {
+            ticks[j] = ticks[j - 1];
+            j--;
+        }
+        ticks[j] = v;
+    }
+
+    BenchResult res;
+    res.name = name;
+    res.reps = reps;
+    res.ops = ops;
+    res.minPerOp = (float)ticks[0] / ops;
+    res.medianPerOp = (float)ticks[reps / 2] / ops;
+    res.maxPerOp = (float)ticks[reps - 1] / ops;
+    res.meanPerOp = sum / reps;
+    float var = sumSq / reps - res.meanPerOp * res.meanPerOp;
+    res.stddevPerOp = var > 0.0f ? sqrtf(var) : 0.0f;
+    return res;
+}
+
+void benchPrint(const BenchResult &r)
+{
+    printf("%-28s min %9.2f  med %9.2f  max %9.2f  sd %7.2f  %s/op  (%lu x %lu)\n", r.name,
+           r.minPerOp, r.medianPerOp, r.maxPerOp, r.stddevPerOp, BENCH_UNIT,
+           (unsigned long)r.reps, (unsigned long)r.ops);
+    if (benchResultCount < BENCH_MAX_RESULTS)
+    {
+        benchResults[benchResultCount++] = r;
+    }
+}
+
+void benchWriteJson(FILE *out, const char *platform)
+{
+    fprintf(out, "{\"platform\":\"%s\",\"unit\":\"%s\",\"results\":[", platform, BENCH_UNIT);
+    for (uint32_t i = 0; i < benchResultCount; i++)
+    {
+        const BenchResult &r = benchResults[i];
+        fprintf(out, "%s\n{\"name\":\"%s\",\"reps\":%lu,\"ops\":%lu,\"min\":%.3f,\"median\":%.3f,\"mean\":%.3f,\"max\":%.3f,\"stddev\":%.3f}",
+                i ? "," : "", r.name, (unsigned long)r.reps, (unsigned long)r.ops,
+                r.minPerOp, r.medianPerOp, r.meanPerOp, r.maxPerOp, r.stddevPerOp);
+    }
+    fprintf(out, "\n]}\n");
+    benchResultCount = 0;
+}
+
+
+//=======================================================================================
+// VECTOR MATH CASES:
+//=======================================================================================
+static float vecX[BENCH_VEC_LEN], vecY[BENCH_VEC_LEN], vecZ[BENCH_VEC_LEN], vecOut[BENCH_VEC_LEN];
+static int16_t vecRaw[3 * BENCH_VEC_LEN];
+static uint16_t vecRawOut[BENCH_VEC_LEN];
+
+static void vecFill()
+{
+    uint32_t seed = 12345u;
+    for (int i = 0; i < BENCH_VEC_LEN; i++)
+    {
+        for (int a = 0; a < 3; a++)
+        {
+            seed = seed * 1664525u + 1013904223u;   // LCG, deterministic inputs across runs
+            vecRaw[3 * i + a] = (int16_t)(seed >> 16);
+        }
+        vecX[i] = vecRaw[3 * i] * 1.0e-6f;
+        vecY[i] = vecRaw[3 * i + 1] * 1.0e-6f;
+        vecZ[i] = vecRaw[3 * i + 2] * 1.0e-6f;
+    }
+}
+
+static void caseLibmSqrt(uint32_t ops)
+{
+    float acc = 0.0f;
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        uint32_t k = i % BENCH_VEC_LEN;
+        acc += sqrt(vecX[k] * vecX[k] + vecY[k] * vecY[k] + vecZ[k] * vecZ[k]);  // Previous calculateDist3Dim() path
+    }
+    benchSinkF = acc;
+}
+
+static void caseNorm3F(uint32_t ops)
+{
+    float acc = 0.0f;
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        uint32_t k = i % BENCH_VEC_LEN;
+        acc += vmNorm3F(vecX[k], vecY[k], vecZ[k]);
+    }
+    benchSinkF = acc;
+}
+
+static void caseNorm3FastF(uint32_t ops)
+{
+    float acc = 0.0f;
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        uint32_t k = i % BENCH_VEC_LEN;
+        acc += vmNorm3FastF(vecX[k], vecY[k], vecZ[k]);
+    }
+    benchSinkF = acc;
+}
+
+static void caseNorm3I16(uint32_t ops)
+{
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        uint32_t k = i % BENCH_VEC_LEN;
+        acc += vmNorm3I16(vecRaw[3 * k], vecRaw[3 * k + 1], vecRaw[3 * k + 2]);
+    }
+    benchSinkU = acc;
+}
+
+static void caseNorm3FBatch(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i += BENCH_VEC_LEN)
+    {
+        vmNorm3FBatch(vecX, vecY, vecZ, vecOut, BENCH_VEC_LEN);
+    }
+    benchSinkF = vecOut[0];
+}
+
+static void caseNorm3I16Batch(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i += BENCH_VEC_LEN)
+    {
+        vmNorm3I16Batch(vecRaw, vecRawOut, BENCH_VEC_LEN);
+    }
+    benchSinkU = vecRawOut[0];
+}
+
+void benchRunVecMath()
+{
+    vecFill();
+    benchPrint(benchRun("norm3/libm-double-sqrt", caseLibmSqrt, 1024, 16));
+    benchPrint(benchRun("norm3/vsqrt-f32", caseNorm3F, 1024, 16));
+    benchPrint(benchRun("norm3/rsqrt-newton", caseNorm3FastF, 1024, 16));
+    benchPrint(benchRun("norm3/int16-isqrt", caseNorm3I16, 1024, 16));
+    benchPrint(benchRun("norm3/vsqrt-f32-batch", caseNorm3FBatch, 1024, 16));
+    benchPrint(benchRun("norm3/int16-isqrt-batch", caseNorm3I16Batch, 1024, 16));
+}
+
+
+//=======================================================================================
+// HAMPEL CASES:
+//=======================================================================================
+#define BENCH_HAMPEL_LEN 1024                       // LENGTH OF THE SYNTHETIC INPUT SEQUENCE
+
+static int16_t hampelIn[BENCH_HAMPEL_LEN];
+
+static void hampelFill()
+{
+    uint32_t seed = 777u;
+    for (int i = 0; i < BENCH_HAMPEL_LEN; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        hampelIn[i] = (int16_t)((seed >> 24) - 128);
+        if ((i % 97) == 0)
+        {
+            hampelIn[i] = 30000;                    // Inject a glitch every 97 samples
+        }
+    }
+}
+
+template <typename T>
+static void insertionSort(T *a, uint16_t n)
+{
+    for (uint16_t i = 1; i < n; i++)
+    {
+        T v = a[i];
+        uint16_t j = i;
+        while (j > 0 && v < a[j - 1])
+        {
+            a[j] = a[j - 1];
+            j--;
+        }
+        a[j] = v;
+    }
+}
+
+// Baseline: copy the window, sort it for the median, sort the deviations for the MAD.
+template <uint16_t N>
+struct NaiveHampel
+{
+    int16_t ring[N];
+    uint16_t count = 0, head = 0;
+
+    int16_t update(int16_t x)
+    {
+        ring[head] = x;
+        head = (uint16_t)((head + 1) % N);
+        if (count < N)
+        {
+            count++;
+        }
+        int16_t sorted[N];
+        float dev[N];
+        for (uint16_t i = 0; i < count; i++)
+        {
+            sorted[i] = ring[i];
+        }
+        insertionSort(sorted, count);
+        int16_t med = sorted[(count - 1) / 2];
+        for (uint16_t i = 0; i < count; i++)
+        {
+            dev[i] = fabsf((float)sorted[i] - med);
+        }
+        insertionSort(dev, count);
+        float scale = HAMPEL_MAD_TO_SIGMA * dev[(count - 1) / 2];
+        return (fabsf((float)x - med) > 3.0f * scale) ? med : x;
+    }
+};
+
+template <uint16_t N>
+static void caseHampelHeap(uint32_t ops)
+{
+    static HampelFilter<int16_t, N> f;
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        acc += (uint16_t)f.update(hampelIn[i % BENCH_HAMPEL_LEN]);
+    }
+    benchSinkU = acc;
+}
+
+template <uint16_t N>
+static void caseHampelNaive(uint32_t ops)
+{
+    static NaiveHampel<N> f;
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        acc += (uint16_t)f.update(hampelIn[i % BENCH_HAMPEL_LEN]);
+    }
+    benchSinkU = acc;
+}
+
+void benchRunHampel()
+{
+    hampelFill();
+    benchPrint(benchRun("hampel/heap-7", caseHampelHeap<7>, 1024, 8));
+    benchPrint(benchRun("hampel/naive-sort-7", caseHampelNaive<7>, 1024, 8));
+    benchPrint(benchRun("hampel/heap-31", caseHampelHeap<31>, 1024, 8));
+    benchPrint(benchRun("hampel/naive-sort-31", caseHampelNaive<31>, 1024, 8));
+    benchPrint(benchRun("hampel/heap-127", caseHampelHeap<127>, 1024, 8));
+    benchPrint(benchRun("hampel/naive-sort-127", caseHampelNaive<127>, 256, 8));
+}
+
+
+//=======================================================================================
+// PIPELINE CASES:
+//=======================================================================================
+#define BENCH_PIPE_LEN 1024                         // LENGTH OF THE SYNTHETIC RAW SEQUENCE
+#define BENCH_PIPE_PERIOD_US 5263                   // 190 Hz ODR
+
+static int16_t pipeRaw[BENCH_PIPE_LEN][GP_DIM_COUNT];
+static GyroPipeline benchPipe;                      // Too large for the stack of the benchmark thread
+static uint32_t pipeTimeUs = 0;                     // Sample clock, keeps running across repetitions
+
+static void pipeFill()
+{
+    uint32_t seed = 4242u;
+    for (int i = 0; i < BENCH_PIPE_LEN; i++)
+    {
+        for (int a = 0; a < GP_DIM_COUNT; a++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            // Walking-like swing (~1.8 Hz at 190 Hz) plus noise, well inside the 500 dps range
+            float swing = 9000.0f * sinf(6.2831853f * 1.8f * i / 190.0f + 2.0f * a);
+            pipeRaw[i][a] = (int16_t)(swing + (float)((int32_t)(seed >> 24) - 128));
+        }
+    }
+    gpInit(&benchPipe, GP_ACT_WINDOW_MS);
+    pipeTimeUs = 0;
+}
+
+// Filter stage only: glitch filter and classifier features on every sample, moving average and per-axis
+// distance once per GP_FSM_PERIOD_US of sample time
+static void caseMovingAverage(uint32_t ops)
+{
+    float acc = 0.0f;
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        pipeTimeUs += BENCH_PIPE_PERIOD_US;
+        float *d = gpFilter(&benchPipe, pipeTimeUs, pipeRaw[i % BENCH_PIPE_LEN]);
+        acc += (d != NULL) ? d[0] : 0.0f;
+    }
+    benchSinkF = acc;
+}
+
+static void caseDist3Dim(uint32_t ops)
+{
+    float acc = 0.0f;
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        uint32_t k = i % BENCH_PIPE_LEN;
+        float d[GP_DIM_COUNT] = { pipeRaw[k][0] * 1.0e-6f, pipeRaw[k][1] * 1.0e-6f, pipeRaw[k][2] * 1.0e-6f };
+        acc += gpDist3Dim(&benchPipe, d);
+    }
+    benchSinkF = acc;
+}
+
+static void caseWholePipeline(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        pipeTimeUs += BENCH_PIPE_PERIOD_US;
+        gpProcess(&benchPipe, pipeTimeUs, pipeRaw[i % BENCH_PIPE_LEN]);
+    }
+    benchSinkF = benchPipe.totalDist;
+}
+
+void benchRunPipeline()
+{
+    pipeFill();
+    benchPrint(benchRun("pipe/moving-average-stage", caseMovingAverage, 1024, 16));
+    benchPrint(benchRun("pipe/calculateDist3Dim", caseDist3Dim, 1024, 16));
+    benchPrint(benchRun("pipe/whole-sample", caseWholePipeline, 1024, 16));
+}
+
+
+//=======================================================================================
+// FORMATTING CASES:
+//=======================================================================================
+static char fmtBuf[32];
+
+// Minimal reference: unsigned decimal, digits written backwards then reversed
+static int benchUtoa(uint32_t v, char *out)
+{
+    char tmp[10];
+    int n = 0;
+    do
+    {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    for (int i = 0; i < n; i++)
+    {
+        out[i] = tmp[n - 1 - i];
+    }
+    out[n] = '\0';
+    return n;
+}
+
+static void caseSnprintfInt(uint32_t ops)
+{
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        acc += snprintf(fmtBuf, sizeof(fmtBuf), "Current Step Cnt: %d", (int)(i * 7u));
+    }
+    benchSinkU = acc;
+}
+
+static void caseSnprintfFloat(uint32_t ops)
+{
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        acc += snprintf(fmtBuf, sizeof(fmtBuf), "Current Calc: %.3f m", i * 0.137f);
+    }
+    benchSinkU = acc;
+}
+
+static void caseUtoa(uint32_t ops)
+{
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        acc += benchUtoa(i * 7u, fmtBuf);
+    }
+    benchSinkU = acc;
+}
+
+void benchRunFormat()
+{
+    benchPrint(benchRun("fmt/snprintf-int", caseSnprintfInt, 256, 16));
+    benchPrint(benchRun("fmt/snprintf-float", caseSnprintfFloat, 256, 16));
+    benchPrint(benchRun("fmt/utoa-loop", caseUtoa, 256, 16));
+}
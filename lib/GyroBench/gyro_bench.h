@@ -0,0 +1,68 @@
+//=======================================================================================
+// MICRO-BENCHMARK RUNNER:
+//=======================================================================================
+// Runs a kernel 'reps' times over 'ops' operations each and reports min/median/mean/max and
+// the standard deviation of the ticks per operation. Ticks come from 'cycleCounterNow()':
+// CPU cycles on the board, ns on host. The same cases are built for both, so numbers can be
+// compared run-to-run per platform.
+//
+// Every printed result is also kept (up to BENCH_MAX_RESULTS) so a run can end with
+// benchWriteJson(), the machine-readable copy used to spot regressions between builds:
+//   {"platform":"host","unit":"ns","results":[{"name":"...","reps":16,"ops":1024,
+//     "min":1.0,"median":1.1,"mean":1.1,"max":1.4,"stddev":0.1}, ...]}
+//=======================================================================================
+#ifndef GYRO_BENCH_H
+#define GYRO_BENCH_H
+
+#include <stdint.h>
+
+#include <stdio.h>
+
+#define BENCH_MAX_REPS 32                           // MAXIMUM REPETITIONS KEPT FOR THE MEDIAN
+#define BENCH_MAX_RESULTS 64                        // RESULTS KEPT FOR THE JSON EXPORT
+
+#if defined(__MBED__)
+#define BENCH_UNIT "cyc"
+#else
+#define BENCH_UNIT "ns"
+#endif
+
+typedef void (*BenchFn)(uint32_t ops);              // KERNEL UNDER TEST, PERFORMS 'ops' OPERATIONS
+
+struct BenchResult
+{
+    const char *name;                               // CASE NAME
+    uint32_t reps;                                  // REPETITIONS MEASURED
+    uint32_t ops;                                   // OPERATIONS PER REPETITION
+    float minPerOp;                                 // FASTEST REPETITION, TICKS PER OPERATION
+    float medianPerOp;                              // MEDIAN REPETITION, TICKS PER OPERATION
+    float meanPerOp;                                // MEAN OVER ALL REPETITIONS, TICKS PER OPERATION
+    float maxPerOp;                                 // SLOWEST REPETITION, TICKS PER OPERATION
+    float stddevPerOp;                              // STANDARD DEVIATION ACROSS REPETITIONS
+};
+
+// RUN ONE CASE (ONE UNTIMED WARM-UP PASS, THEN 'reps' TIMED PASSES)
+BenchResult benchRun(const char *name, BenchFn fn, uint32_t ops, uint32_t reps);
+
+// PRINT ONE RESULT LINE ON THE CONSOLE (AND KEEP IT FOR THE JSON EXPORT)
+void benchPrint(const BenchResult &r);
+
+// WRITE EVERY KEPT RESULT AS ONE JSON DOCUMENT, THEN FORGET THEM
+void benchWriteJson(FILE *out, const char *platform);
+
+// VECTOR MATH CASES: libm double sqrt vs VSQRT vs rsqrt vs integer norm, scalar and batched
+void benchRunVecMath();
+
+// HAMPEL CASES: O(log N) two-heap filter vs. sort-per-sample baseline at several window lengths
+void benchRunHampel();
+
+// PIPELINE CASES: moving-average/filter stage, 3D distance, whole per-sample pipeline
+void benchRunPipeline();
+
+// FORMATTING CASES: integer and float to string, as done for every LCD / console update
+void benchRunFormat();
+
+// FFT CASES: the bundled FFT library's rfft() and split_radix_fft() (SKIPPED WHEN NOT AVAILABLE)
+void benchRunFft();
+
+#endif // GYRO_BENCH_H
@@ -0,0 +1,155 @@
+//=======================================================================================
+// STREAMING ACTIVITY CLASSIFIER: IDLE / WALK / JOG / RUN
+//=======================================================================================
+#include "activity_classifier.h"
+#include "ccm.h"
+#include "cycle_counter.h"
+#include "vec_math.h"
+
+//=======================================================================================
+// DECISION TREE:
+//=======================================================================================
+// Shank-mounted gyro: the swing phase peak grows from ~3 rad/s (walk) to >8 rad/s (run)
+// and the stride rate from ~0.9 Hz to ~1.5 Hz. Thresholds are starting points; re-tune
+// them with tools/activity_eval over labelled traces.
+static const ActTreeNode kActTree[] CCM_CONST =
+{
+    /* 0 */ { ACT_F_STD,       0.35f, 1, 2 },       // Barely moving -> IDLE
+    /* 1 */ { -1,              0.0f,  ACT_IDLE, 0 },
+    /* 2 */ { ACT_F_MEAN,      2.2f,  3, 4 },
+    /* 3 */ { ACT_F_PEAK_RATE, 2.6f,  5, 6 },       // Low intensity: fast cadence means a slow jog
+    /* 4 */ { ACT_F_MEAN,      4.0f,  6, 7 },
+    /* 5 */ { -1,              0.0f,  ACT_WALK, 0 },
+    /* 6 */ { -1,              0.0f,  ACT_JOG, 0 },
+    /* 7 */ { -1,              0.0f,  ACT_RUN, 0 },
+};
+
+static const char *const kActNames[ACT_CLASS_COUNT] = { "IDLE", "WALK", "JOG", "RUN" };
+
+
+static void actResetWindow(ActivityClassifier *c, uint32_t tUs)
+{
+    c->n = 0;
+    c->sum = 0.0f;
+    c->sumSq = 0.0f;
+    c->lowEnergy = 0.0f;
+    c->highEnergy = 0.0f;
+    c->zeroCross = 0;
+    c->peaks = 0;
+    c->tStart = tUs;
+}
+
+void actInit(ActivityClassifier *c, uint16_t windowMs)
+{
+    c->windowMs = windowMs ? windowMs : ACT_DEFAULT_WINDOW_MS;
+    c->lowTauUs = ACT_DEFAULT_LOW_TAU_US;
+    c->peakThreshold = ACT_DEFAULT_PEAK_THRESHOLD;
+    actResetWindow(c, 0);
+    c->low = 0.0f;
+    c->prevHigh = 0.0f;
+    c->prev = 0.0f;
+    c->prevPrev = 0.0f;
+    c->prevUs = 0;
+    c->started = false;
+    c->peakArmed = true;
+    for (int i = 0; i < ACT_FEATURE_COUNT; i++)
+    {
+        c->features[i] = 0.0f;
+    }
+    c->current = ACT_IDLE;
+    c->windows = 0;
+    c->lastCycles = 0;
+    c->maxCycles = 0;
+    c->overBudget = 0;
+}
+
+ActivityClass actClassify(const float *features)
+{
+    uint8_t node = 0;
+    while (kActTree[node].feature >= 0)
+    {
+        const ActTreeNode &t = kActTree[node];
+        node = (features[t.feature] < t.threshold) ? t.below : t.above;
+    }
+    return (ActivityClass)kActTree[node].below;
+}
+
+const char *actName(ActivityClass a)
+{
+    return (a < ACT_CLASS_COUNT) ? kActNames[a] : "?";
+}
+
+bool actUpdate(ActivityClassifier *c, float rateMag, uint32_t tUs)
+{
+    uint32_t start = cycleCounterNow();
+    bool closed = false;
+
+    if (c->n == 0 && c->windows == 0)
+    {
+        c->tStart = tUs;                            // Later windows start where the previous one closed
+    }
+
+    // Band split and running moments; the one-pole coefficient follows the sample interval (dt / (tau + dt))
+    float dtUs = c->started ? (float)(tUs - c->prevUs) : 0.0f;
+    c->low += dtUs / ((float)c->lowTauUs + dtUs) * (rateMag - c->low);
+    float high = rateMag - c->low;
+    c->sum += rateMag;
+    c->sumSq += rateMag * rateMag;
+    c->lowEnergy += c->low * c->low;
+    c->highEnergy += high * high;
+
+    // Zero crossings of the high band
+    if ((high >= 0.0f) != (c->prevHigh >= 0.0f))
+    {
+        c->zeroCross++;
+    }
+    c->prevHigh = high;
+
+    // Peak on the previous sample: strictly above its left neighbour, not below its right one. One per swing: noise
+    // ripples on the same swing (more of them at higher ODRs) wait until the magnitude has fallen back below the re-arm level.
+    if (rateMag < ACT_PEAK_REARM * c->peakThreshold)
+    {
+        c->peakArmed = true;
+    }
+    if (c->peakArmed && c->prev > c->peakThreshold && c->prev > c->prevPrev && c->prev >= rateMag)
+    {
+        c->peaks++;
+        c->peakArmed = false;
+    }
+    c->prevPrev = c->prev;
+    c->prev = rateMag;
+    c->prevUs = tUs;
+    c->started = true;
+
+    c->n++;
+    if (tUs - c->tStart >= (uint32_t)c->windowMs * 1000u && c->n > 1)
+    {
+        float inv = 1.0f / c->n;
+        float mean = c->sum * inv;
+        float var = c->sumSq * inv - mean * mean;
+        uint32_t spanUs = tUs - c->tStart;
+        float perSec = (spanUs > 0) ? 1.0e6f / (float)spanUs : 0.0f;
+
+        c->features[ACT_F_MEAN] = mean;
+        c->features[ACT_F_STD] = (var > 0.0f) ? vmSqrtF(var) : 0.0f;
+        c->features[ACT_F_LOW_ENERGY] = c->lowEnergy * inv;
+        c->features[ACT_F_HIGH_ENERGY] = c->highEnergy * inv;
+        c->features[ACT_F_ZC_RATE] = c->zeroCross * perSec;
+        c->features[ACT_F_PEAK_RATE] = c->peaks * perSec;
+        c->current = actClassify(c->features);
+        c->windows++;
+        actResetWindow(c, tUs);
+        closed = true;
+    }
+
+    c->lastCycles = cycleCounterNow() - start;
+    if (c->lastCycles > c->maxCycles)
+    {
+        c->maxCycles = c->lastCycles;
+    }
+    if (c->lastCycles > ACT_CYCLE_BUDGET)
+    {
+        c->overBudget++;
+    }
+    return closed;
+}
@@ -0,0 +1,104 @@
+//=======================================================================================
+// STREAMING ACTIVITY CLASSIFIER: IDLE / WALK / JOG / RUN
+//=======================================================================================
+// Consumes one angular-rate magnitude sample (rad/s) at a time and keeps the window
+// features up to date incrementally, so no sample history is stored:
+//   mean / std-dev      running sum and sum of squares
+//   band energies       one-pole low-pass split; mean square of the low and high bands
+//   zero-crossing rate  sign changes of the high band (mag - low band), per second
+//   peak rate           local maxima above 'peakThreshold' (rad/s), per second; after a
+//                       peak the magnitude must drop below ACT_PEAK_REARM of the threshold
+//                       before the next one counts
+// When 'windowMs' have elapsed the compile-time decision tree below runs once and the
+// window restarts. The window length and the low-band time constant are times (the one-pole
+// coefficient follows each sample interval) and peaks are separated by level, not by sample
+// count, so the features do not move with the sensor ODR.
+//
+// Cost is tracked per sample with the cycle counter and compared with ACT_CYCLE_BUDGET.
+//=======================================================================================
+#ifndef ACTIVITY_CLASSIFIER_H
+#define ACTIVITY_CLASSIFIER_H
+
+#include <stdint.h>
+
+#define ACT_DEFAULT_WINDOW_MS 1350                  // CLASSIFICATION WINDOW (ms, ~TWO STRIDES)
+#define ACT_DEFAULT_LOW_TAU_US 21000                // LOW-BAND ONE-POLE TIME CONSTANT (us, ~7.5 Hz; alpha = 0.2 @ 190 Hz)
+#define ACT_DEFAULT_PEAK_THRESHOLD 1.5f             // MINIMUM PEAK HEIGHT (rad/s) COUNTED AS A STRIDE PEAK
+#define ACT_PEAK_REARM 0.5f                         // FRACTION OF THE PEAK THRESHOLD THAT RE-ARMS PEAK COUNTING
+#define ACT_CYCLE_BUDGET 400u                       // CYCLES PER SAMPLE ALLOWED FOR THE CLASSIFIER ON TARGET
+
+enum ActivityClass : uint8_t
+{
+    ACT_IDLE = 0,
+    ACT_WALK,
+    ACT_JOG,
+    ACT_RUN,
+    ACT_CLASS_COUNT
+};
+
+enum ActFeature : uint8_t
+{
+    ACT_F_MEAN = 0,                                 // MEAN MAGNITUDE (rad/s)
+    ACT_F_STD,                                      // STANDARD DEVIATION OF THE MAGNITUDE (rad/s)
+    ACT_F_LOW_ENERGY,                               // MEAN SQUARE OF THE LOW BAND ((rad/s)^2)
+    ACT_F_HIGH_ENERGY,                              // MEAN SQUARE OF THE HIGH BAND ((rad/s)^2)
+    ACT_F_ZC_RATE,                                  // HIGH-BAND ZERO CROSSINGS PER SECOND
+    ACT_F_PEAK_RATE,                                // PEAKS PER SECOND
+    ACT_FEATURE_COUNT
+};
+
+// DECISION TREE NODE: INTERNAL NODES COMPARE ONE FEATURE, LEAVES HAVE feature = -1
+struct ActTreeNode
+{
+    int8_t feature;                                 // ActFeature INDEX, OR -1 FOR A LEAF
+    float threshold;                                // GO TO 'below' IF feature < threshold, ELSE 'above'
+    uint8_t below;                                  // CHILD INDEX (OR CLASS FOR A LEAF)
+    uint8_t above;                                  // CHILD INDEX
+};
+
+struct ActivityClassifier
+{
+    // Configuration
+    uint16_t windowMs;
+    uint32_t lowTauUs;
+    float peakThreshold;
+
+    // Running window accumulators
+    uint32_t n;
+    float sum, sumSq;
+    float lowEnergy, highEnergy;
+    uint16_t zeroCross, peaks;
+    uint32_t tStart;
+
+    // Sample-to-sample filter state (persists across windows)
+    float low;
+    float prevHigh;
+    float prev, prevPrev;
+    uint32_t prevUs;                                // TIMESTAMP OF 'prev'
+    bool started;
+    bool peakArmed;                                 // THE NEXT LOCAL MAXIMUM ABOVE peakThreshold COUNTS
+
+    // Output
+    float features[ACT_FEATURE_COUNT];              // FEATURES OF THE LAST CLOSED WINDOW
+    ActivityClass current;                          // CLASS OF THE LAST CLOSED WINDOW
+    uint32_t windows;                               // WINDOWS CLASSIFIED SO FAR
+
+    // Cost accounting
+    uint32_t lastCycles;                            // COST OF THE LAST UPDATE
+    uint32_t maxCycles;                             // WORST UPDATE SEEN
+    uint32_t overBudget;                            // UPDATES ABOVE ACT_CYCLE_BUDGET
+};
+
+// RESET THE CLASSIFIER WITH THE DEFAULT CONFIGURATION AND THE GIVEN WINDOW LENGTH (ms, 0 = DEFAULT)
+void actInit(ActivityClassifier *c, uint16_t windowMs);
+
+// FEED ONE MAGNITUDE SAMPLE (rad/s) TAKEN AT 'tUs' MICROSECONDS; RETURNS TRUE WHEN A WINDOW CLOSED
+bool actUpdate(ActivityClassifier *c, float rateMag, uint32_t tUs);
+
+// RUN THE DECISION TREE ON A FEATURE VECTOR
+ActivityClass actClassify(const float *features);
+
+// SHORT UPPER-CASE NAME FOR DISPLAY ("IDLE", "WALK", ...)
+const char *actName(ActivityClass a);
+
+#endif // ACTIVITY_CLASSIFIER_H
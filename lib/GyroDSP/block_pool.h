@@ -0,0 +1,166 @@
+//=======================================================================================
+// FIXED-BLOCK POOL:
+//=======================================================================================
+// BlockPool<T, N> owns N statically allocated blocks of T and hands them out through a
+// free list of indices: alloc() and free() are O(1), never touch the heap and are safe
+// from interrupt context on the target (a few instructions inside a critical section).
+// On the host a mutex stands in for the critical section.
+//
+// Blocks are returned as they were last left (not constructed or cleared); the pipeline
+// messages are plain structs that the producer fills in completely.
+//
+// Every pool keeps allocation statistics so the pipeline report can show how close each
+// one came to running dry (high-water mark) and how often it did (failures).
+//=======================================================================================
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+#include <stdint.h>
+
+#if defined(__MBED__)
+#include "platform/mbed_critical.h"
+
+static inline void blockPoolLock()
+{
+    core_util_critical_section_enter();
+}
+
+static inline void blockPoolUnlock()
+{
+    core_util_critical_section_exit();
+}
+
+#else
+#include <mutex>
+
+static inline std::mutex &blockPoolMutex()
+{
+    static std::mutex m;
+    return m;
+}
+
+static inline void blockPoolLock()
+{
+    blockPoolMutex().lock();
+}
+
+static inline void blockPoolUnlock()
+{
+    blockPoolMutex().unlock();
+}
+#endif
+
+#define BLOCK_POOL_END 0xFFFF                    // END OF THE FREE LIST
+
+// SNAPSHOT OF ONE POOL'S COUNTERS
+struct BlockPoolStats
+{
+    uint16_t capacity;                           // BLOCKS IN THE POOL
+    uint16_t inUse;                              // BLOCKS HANDED OUT NOW
+    uint16_t highWater;                          // MAXIMUM 'inUse' SEEN
+    uint32_t allocs;                             // SUCCESSFUL alloc() CALLS
+    uint32_t frees;                              // SUCCESSFUL free() CALLS
+    uint32_t failures;                           // alloc() CALLS THAT FOUND THE POOL EMPTY
+    uint32_t badFrees;                           // free() OF A FOREIGN POINTER OR A FREE BLOCK
+};
+
+template <typename T, uint16_t N>
+class BlockPool
+{
+    static_assert(N >= 1 && N < BLOCK_POOL_END, "pool size out of range");
+
+public:
+    BlockPool() { reset(); }
+
+    // RETURN EVERY BLOCK TO THE FREE LIST AND CLEAR THE STATISTICS (NOT WHILE BLOCKS ARE IN USE)
+    void reset()
+    {
+        for (uint16_t i = 0; i < N; i++)
+        {
+            next[i] = (uint16_t)(i + 1);
+            used[i] = false;
+        }
+        next[N - 1] = BLOCK_POOL_END;
+        head = 0;
+        inUse = 0;
+        highWater = 0;
+        allocs = 0;
+        frees = 0;
+        failures = 0;
+        badFrees = 0;
+    }
+
+    // TAKE A BLOCK, OR NULL WHEN THE POOL IS EMPTY
+    T *alloc()
+    {
+        blockPoolLock();
+        uint16_t i = head;
+        if (i == BLOCK_POOL_END)
+        {
+            failures++;
+            blockPoolUnlock();
+            return 0;
+        }
+        head = next[i];
+        used[i] = true;
+        allocs++;
+        if (++inUse > highWater)
+        {
+            highWater = inUse;
+        }
+        blockPoolUnlock();
+        return &blocks[i];
+    }
+
+    // GIVE A BLOCK BACK. FOREIGN POINTERS AND DOUBLE FREES ARE COUNTED AND IGNORED
+    void free(T *p)
+    {
+        uintptr_t offset = (uintptr_t)p - (uintptr_t)blocks;     // Wraps to a huge value below the pool
+        uint32_t i = (uint32_t)(offset / sizeof(T));
+        blockPoolLock();
+        if (offset >= sizeof(blocks) || offset % sizeof(T) != 0 || !used[i])
+        {
+            badFrees++;
+            blockPoolUnlock();
+            return;
+        }
+        used[i] = false;
+        next[i] = head;
+        head = (uint16_t)i;
+        inUse--;
+        frees++;
+        blockPoolUnlock();
+    }
+
+    bool owns(const T *p) const
+    {
+        return p >= blocks && p < blocks + N;
+    }
+
+    void stats(BlockPoolStats *out) const
+    {
+        blockPoolLock();
+        out->capacity = N;
+        out->inUse = inUse;
+        out->highWater = highWater;
+        out->allocs = allocs;
+        out->frees = frees;
+        out->failures = failures;
+        out->badFrees = badFrees;
+        blockPoolUnlock();
+    }
+
+private:
+    T blocks[N];
+    uint16_t next[N];                            // FREE-LIST LINK OF EACH FREE BLOCK
+    bool used[N];                                // GUARDS AGAINST DOUBLE FREES
+    uint16_t head;                               // FIRST FREE BLOCK
+    uint16_t inUse;
+    uint16_t highWater;
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t failures;
+    uint32_t badFrees;
+};
+
+#endif // BLOCK_POOL_H
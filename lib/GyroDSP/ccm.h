@@ -0,0 +1,35 @@
+//=======================================================================================
+// CORE-COUPLED MEMORY PLACEMENT (HARDWARE INDEPENDENT)
+//=======================================================================================
+// The STM32F429 has 64 KB of CCM RAM on the core's D-bus: zero wait states and no
+// arbitration against the DMA masters (DMA2D fills, LTDC scanout, SPI DMA) that share the
+// bus matrix with the main SRAM. Hot per-sample state, the realtime thread stacks and small
+// lookup tables read on every sample go there; the linker script linker/stm32f429xi_ccm.ld
+// provides the sections and src/proj.cpp initializes them before the C++ constructors.
+//
+//   CCM_BSS    zero-initialized variables (DSP state, thread stacks)
+//   CCM_DATA   initialized variables
+//   CCM_CONST  const tables (a section of their own: GCC will not mix const and non-const
+//              objects in one section)
+//
+// Put the macro after the declarator:  static GyroPipeline pipe CCM_BSS;
+//
+// CCM is CPU-only: no DMA stream can read or write it, so never place DMA buffers there
+// (SPI frames, SensorManager rx/tx buffers, DMA2D sources and targets, framebuffers). It is
+// not executable either. Without GYRO_CCM (the host tools, or a build without the linker
+// script) the macros expand to nothing and everything stays in the default sections.
+//=======================================================================================
+#ifndef CCM_H
+#define CCM_H
+
+#if defined(GYRO_CCM)
+#define CCM_BSS __attribute__((section(".ccm_bss")))
+#define CCM_DATA __attribute__((section(".ccm_data")))
+#define CCM_CONST __attribute__((section(".ccm_data.rodata")))
+#else
+#define CCM_BSS
+#define CCM_DATA
+#define CCM_CONST
+#endif
+
+#endif // CCM_H
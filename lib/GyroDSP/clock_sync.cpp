@@ -0,0 +1,194 @@
+//=======================================================================================
+// CLOCK SYNCHRONIZATION: TWO-WAY TIME TRANSFER (HARDWARE INDEPENDENT)
+//=======================================================================================
+#include "clock_sync.h"
+#include <math.h>
+#include <string.h>
+
+#define CS_REBASE_US (1 << 24)                      // FINE OFFSET BEYOND WHICH THE COARSE BASE MOVES (~16 s)
+
+void csInit(ClockSync *cs)
+{
+    memset(cs, 0, sizeof(*cs));
+}
+
+// CLIENT TIME EXTENDED TO 64 BIT, SO THE FIT IS UNAFFECTED BY THE 32-BIT WRAP
+static int64_t csExtend(ClockSync *cs, uint32_t localUs)
+{
+    if (!cs->started)
+    {
+        cs->started = true;
+        cs->localHighUs = localUs;
+    }
+    else
+    {
+        cs->localHighUs += (int32_t)(localUs - cs->lastLocalUs);
+    }
+    cs->lastLocalUs = localUs;
+    return cs->localHighUs;
+}
+
+bool csPoll(ClockSync *cs, uint32_t nowUs, uint16_t *seq)
+{
+    if (cs->waiting)
+    {
+        if ((uint32_t)(nowUs - cs->t1Us) < CS_TIMEOUT_US)
+        {
+            return false;
+        }
+        cs->waiting = false;
+        cs->timeouts++;
+    }
+    uint32_t interval = cs->model.synced ? CS_INTERVAL_US : CS_FAST_INTERVAL_US;
+    if (cs->lastRequestUs != 0 && (uint32_t)(nowUs - cs->lastRequestUs) < interval)
+    {
+        return false;
+    }
+    cs->waiting = true;
+    cs->seq++;
+    cs->t1Us = nowUs;
+    cs->lastRequestUs = nowUs != 0 ? nowUs : 1;
+    *seq = cs->seq;
+    return true;
+}
+
+// MOVE THE COARSE BASE SO THE FINE OFFSETS STAY SMALL
+static void csRebase(ClockSync *cs, int32_t shiftUs)
+{
+    cs->model.baseUs += (uint32_t)shiftUs;
+    cs->model.offsetNs -= (int64_t)shiftUs * 1000;
+    for (uint8_t i = 0; i < cs->count; i++)
+    {
+        cs->history[i].offsetUs2 -= 2 * shiftUs;
+    }
+}
+
+// DELAY LIMIT OF THE EXCHANGES USED: THE LOWER HALF OF THE WINDOW, AND AT LEAST EVERYTHING
+// WITHIN CS_DELAY_SLACK_US OF THE MINIMUM (A FEW LOW-DELAY EXCHANGES CLOSE TOGETHER WOULD
+// GIVE A STEEP, BADLY DETERMINED SLOPE)
+static uint32_t csDelayLimit(const ClockSync *cs, uint32_t *minDelay)
+{
+    uint32_t sorted[CS_HISTORY];
+    for (uint8_t i = 0; i < cs->count; i++)
+    {
+        uint32_t d = cs->history[i].delayUs;        // Insertion sort, at most CS_HISTORY entries
+        uint8_t j = i;
+        for (; j > 0 && sorted[j - 1] > d; j--)
+        {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = d;
+    }
+    *minDelay = sorted[0];
+    uint32_t median = sorted[(cs->count - 1) / 2];
+    return median > sorted[0] + CS_DELAY_SLACK_US ? median : sorted[0] + CS_DELAY_SLACK_US;
+}
+
+// FIT THE OFFSET LINE THROUGH THE LOW-DELAY EXCHANGES OF THE WINDOW
+static void csFit(ClockSync *cs, int64_t xNewUs)
+{
+    uint32_t minDelay;
+    const uint32_t limit = csDelayLimit(cs, &minDelay);
+
+    // Means first (x relative to the newest exchange keeps the doubles exact)
+    double sx = 0.0, sy = 0.0, xMin = 0.0, xMax = 0.0;
+    uint32_t n = 0;
+    for (uint8_t i = 0; i < cs->count; i++)
+    {
+        const CsExchange *e = &cs->history[i];
+        if (e->delayUs > limit)
+        {
+            continue;
+        }
+        double x = (double)(e->xUs - xNewUs);
+        sx += x;
+        sy += 0.5 * e->offsetUs2;
+        xMin = (n == 0 || x < xMin) ? x : xMin;
+        xMax = (n == 0 || x > xMax) ? x : xMax;
+        n++;
+    }
+    double mx = sx / n, my = sy / n;
+
+    double slope = cs->model.driftPpb * 1.0e-9;
+    if (n >= 2 && xMax - xMin >= CS_MIN_SPAN_US)
+    {
+        double sxx = 0.0, sxy = 0.0;
+        for (uint8_t i = 0; i < cs->count; i++)
+        {
+            const CsExchange *e = &cs->history[i];
+            if (e->delayUs <= limit)
+            {
+                double dx = (double)(e->xUs - xNewUs) - mx;
+                sxx += dx * dx;
+                sxy += dx * (0.5 * e->offsetUs2 - my);
+            }
+        }
+        slope = sxy / sxx;
+        if (slope > CS_MAX_DRIFT_PPB * 1.0e-9)
+        {
+            slope = CS_MAX_DRIFT_PPB * 1.0e-9;
+        }
+        else if (slope < -CS_MAX_DRIFT_PPB * 1.0e-9)
+        {
+            slope = -CS_MAX_DRIFT_PPB * 1.0e-9;
+        }
+    }
+    double offsetUs = my - slope * mx;              // The line evaluated at the newest exchange (x = 0)
+
+    double r2 = 0.0;
+    for (uint8_t i = 0; i < cs->count; i++)
+    {
+        const CsExchange *e = &cs->history[i];
+        if (e->delayUs <= limit)
+        {
+            double r = 0.5 * e->offsetUs2 - (offsetUs + slope * (double)(e->xUs - xNewUs));
+            r2 += r * r;
+        }
+    }
+
+    cs->minDelayUs = minDelay;
+    cs->used = n;
+    cs->residualUs = (float)sqrt(r2 / n);
+    cs->model.refLocalUs = (uint32_t)xNewUs;
+    cs->model.offsetNs = (int64_t)llround(offsetUs * 1000.0);
+    cs->model.driftPpb = (int32_t)lround(slope * 1.0e9);
+    cs->model.synced = cs->count >= CS_SYNC_EXCHANGES;
+    if (offsetUs > CS_REBASE_US || offsetUs < -CS_REBASE_US)
+    {
+        csRebase(cs, (int32_t)lround(offsetUs));
+    }
+}
+
+bool csResponse(ClockSync *cs, uint16_t seq, uint32_t t2Us, uint32_t t3Us, uint32_t t4Us)
+{
+    if (!cs->waiting || seq != cs->seq)
+    {
+        cs->stale++;
+        return false;
+    }
+    cs->waiting = false;
+    uint32_t t1Us = cs->t1Us;
+    int32_t delay = (int32_t)((t4Us - t1Us) - (t3Us - t2Us));
+    if (delay < 0 || (uint32_t)(t4Us - t1Us) >= CS_TIMEOUT_US)
+    {
+        cs->stale++;                                // Turnaround longer than the round trip, or too late: not usable
+        return false;
+    }
+    cs->exchanges++;
+    if (cs->count == 0)
+    {
+        cs->model.baseUs = t2Us - t1Us;             // Coarse offset from the first exchange
+    }
+
+    CsExchange *e = &cs->history[cs->next];
+    e->xUs = csExtend(cs, t1Us + (t4Us - t1Us) / 2);
+    e->offsetUs2 = (int32_t)(t2Us - t1Us - cs->model.baseUs) + (int32_t)(t3Us - t4Us - cs->model.baseUs);
+    e->delayUs = (uint32_t)delay;
+    cs->next = (uint8_t)((cs->next + 1) % CS_HISTORY);
+    if (cs->count < CS_HISTORY)
+    {
+        cs->count++;
+    }
+    csFit(cs, e->xUs);
+    return true;
+}
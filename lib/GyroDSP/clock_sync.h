@@ -0,0 +1,108 @@
+//=======================================================================================
+// CLOCK SYNCHRONIZATION: TWO-WAY TIME TRANSFER (HARDWARE INDEPENDENT)
+//=======================================================================================
+// Every unit counts time with its own timer, so samples from several units cannot be lined
+// up. A unit (the client) estimates the offset and drift of its clock against one shared
+// reference clock (the host) with NTP/PTP-style two-way exchanges over the telemetry link:
+//
+//   t1  client sends a request                 (client clock)
+//   t2  reference receives it                  (reference clock)
+//   t3  reference sends the response           (reference clock)
+//   t4  client receives the response           (client clock)
+//
+//   offset = ((t2 - t1) + (t3 - t4)) / 2       reference minus client, exact if both
+//                                              directions take equally long
+//   delay  = (t4 - t1) - (t3 - t2)             round trip spent on the link
+//
+// Queueing on a busy link only ever adds delay, and a delayed exchange carries an offset
+// error of up to half its extra delay, so the estimator keeps the last CS_HISTORY exchanges,
+// uses only the lower-delay half of them (and any within CS_DELAY_SLACK_US of the minimum),
+// and fits a line through their offsets over client time: the intercept is the offset, the slope the
+// drift (rate difference of the two oscillators). Between exchanges the fitted line
+// extrapolates, so converting a timestamp never waits on the link.
+//
+// All times are 32-bit microsecond counters that wrap (71 minutes); the offset between the
+// two counters is arbitrary. The current fit is published as a small CsModel that can be
+// copied to another thread (the one stamping samples) and applied there with csToShared().
+//=======================================================================================
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include <stdint.h>
+
+#define CS_HISTORY 64                               // EXCHANGES KEPT FOR THE FIT
+#define CS_DELAY_SLACK_US 200                       // EXTRA DELAY OVER THE WINDOW MINIMUM ALWAYS USED
+#define CS_MIN_SPAN_US 2000000                      // CLIENT TIME SPANNED BEFORE THE DRIFT IS FITTED
+#define CS_MAX_DRIFT_PPB 500000                     // DRIFT CLAMP (500 ppm, WELL ABOVE ANY CRYSTAL)
+#define CS_SYNC_EXCHANGES 4                         // EXCHANGES BEFORE THE CLOCK COUNTS AS SYNCED
+#define CS_FAST_INTERVAL_US 250000                  // REQUEST INTERVAL UNTIL SYNCED
+#define CS_INTERVAL_US 1000000                      // REQUEST INTERVAL ONCE SYNCED
+#define CS_TIMEOUT_US 500000                        // A RESPONSE LATER THAN THIS IS IGNORED
+
+// CLIENT -> SHARED TIME MAPPING: shared = local + base + (offsetNs + (local - refLocal) * driftPpb / 10^6) / 1000
+struct CsModel
+{
+    bool synced;
+    uint32_t refLocalUs;                            // CLIENT TIME THE FIT IS ANCHORED AT
+    uint32_t baseUs;                                // COARSE OFFSET (MODULO 2^32)
+    int64_t offsetNs;                               // FINE OFFSET AT refLocalUs, RELATIVE TO baseUs
+    int32_t driftPpb;                               // REFERENCE RATE MINUS CLIENT RATE, PARTS PER BILLION
+};
+
+struct CsExchange
+{
+    int64_t xUs;                                    // CLIENT TIME OF THE EXCHANGE (MIDPOINT OF t1, t4), EXTENDED TO 64 BIT
+    int32_t offsetUs2;                              // 2 x OFFSET RELATIVE TO THE MODEL BASE, us
+    uint32_t delayUs;
+};
+
+struct ClockSync
+{
+    CsModel model;
+
+    // Pending request
+    bool waiting;
+    uint16_t seq;
+    uint32_t t1Us;
+    uint32_t lastRequestUs;
+
+    // Client time extended to 64 bit
+    bool started;
+    uint32_t lastLocalUs;
+    int64_t localHighUs;
+
+    CsExchange history[CS_HISTORY];
+    uint8_t count;                                  // VALID ENTRIES
+    uint8_t next;                                   // RING INDEX OF THE NEXT ENTRY
+
+    // Statistics
+    uint32_t exchanges;                             // RESPONSES MATCHED TO A REQUEST
+    uint32_t timeouts;                              // REQUESTS WITHOUT A TIMELY RESPONSE
+    uint32_t stale;                                 // RESPONSES TO AN OLD OR UNKNOWN REQUEST
+    uint32_t used;                                  // EXCHANGES IN THE LAST FIT
+    uint32_t minDelayUs;                            // SMALLEST ROUND TRIP IN THE WINDOW
+    float residualUs;                               // RMS DISTANCE OF THE USED OFFSETS FROM THE FIT
+};
+
+void csInit(ClockSync *cs);
+
+// TRUE WHEN A REQUEST IS DUE AT CLIENT TIME nowUs; THEN SEND ONE WITH THE RETURNED *seq AND
+// t1 = nowUs (THE TIME IT GOES OUT, AS CLOSE TO THE WIRE AS POSSIBLE)
+bool csPoll(ClockSync *cs, uint32_t nowUs, uint16_t *seq);
+
+// A RESPONSE ARRIVED AT CLIENT TIME t4Us. RETURNS TRUE WHEN IT UPDATED THE MODEL
+bool csResponse(ClockSync *cs, uint16_t seq, uint32_t t2Us, uint32_t t3Us, uint32_t t4Us);
+
+// CLIENT TIME -> SHARED (REFERENCE) TIME. UNSYNCED MODELS RETURN THE CLIENT TIME UNCHANGED
+static inline uint32_t csToShared(const CsModel *m, uint32_t localUs)
+{
+    if (!m->synced)
+    {
+        return localUs;
+    }
+    int64_t dt = (int32_t)(localUs - m->refLocalUs);
+    int64_t ns = m->offsetNs + dt * m->driftPpb / 1000000;
+    return localUs + m->baseUs + (uint32_t)(int32_t)((ns >= 0 ? ns + 500 : ns - 500) / 1000);
+}
+
+#endif // CLOCK_SYNC_H
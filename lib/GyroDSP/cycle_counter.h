@@ -0,0 +1,56 @@
+//=======================================================================================
+// CYCLE COUNTER:
+//=======================================================================================
+// Thin timing shim shared by the benchmarks and the cycle budgets of the DSP stages.
+// On the Cortex-M4 target it reads the DWT cycle counter (1 tick = 1 CPU cycle @ 180 MHz).
+// On the host it falls back to a monotonic clock (1 tick = 1 ns).
+// Counts are 32-bit and wrap, so always take differences with unsigned arithmetic.
+//=======================================================================================
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+#include <stdint.h>
+
+#if defined(__MBED__)
+#include "cmsis.h"
+
+// ENABLE THE DWT CYCLE COUNTER (TRACE MUST BE ENABLED IN DEMCR FIRST)
+static inline void cycleCounterInit()
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+// CURRENT CYCLE COUNT
+static inline uint32_t cycleCounterNow()
+{
+    return DWT->CYCCNT;
+}
+
+// TICKS PER SECOND OF 'cycleCounterNow()'
+static inline uint32_t cycleCounterHz()
+{
+    return SystemCoreClock;
+}
+
+#else
+#include <chrono>
+
+static inline void cycleCounterInit()
+{
+}
+
+static inline uint32_t cycleCounterNow()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static inline uint32_t cycleCounterHz()
+{
+    return 1000000000u;
+}
+#endif
+
+#endif // CYCLE_COUNTER_H
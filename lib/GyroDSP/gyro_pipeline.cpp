@@ -0,0 +1,356 @@
+//=======================================================================================
+// GYRO PROCESSING PIPELINE (HARDWARE INDEPENDENT):
+//=======================================================================================
+#include "gyro_pipeline.h"
+#include "gyro_units.h"
+#include "vec_math.h"
+#include <math.h>
+#include <string.h>
+
+static inline void gpTrace(GyroPipeline *p, GpTrace kind, int32_t i, float v0, float v1 = 0.0f, float v2 = 0.0f, float v3 = 0.0f)
+{
+    if (p->trace)
+    {
+        p->trace(p->traceCtx, kind, i, v0, v1, v2, v3);
+    }
+}
+
+void gpDefaultParams(GpParams *out)
+{
+    out->windowSize = GP_WINDOW_SIZE;
+    out->threshold = GP_THRESHOLD;
+    out->stepThreshold = GP_STEP_THRESHOLD;
+    out->radius = GP_RADIUS;
+    out->mulFactor1 = GP_MULFACTOR1;
+    out->mulFactor2 = GP_MULFACTOR2;
+}
+
+void gpConfigure(GyroPipeline *p, const GpParams *params)
+{
+    p->params = *params;
+    if (p->params.windowSize < 1)
+    {
+        p->params.windowSize = 1;
+    }
+    else if (p->params.windowSize > GP_WINDOW_MAX)
+    {
+        p->params.windowSize = GP_WINDOW_MAX;
+    }
+    tunerInit(&p->tuner, p->params.threshold);
+}
+
+void gpInit(GyroPipeline *p, uint16_t activityWindow, GpTraceFn trace, void *traceCtx)
+{
+    gpDefaultParams(&p->params);
+    for (int d = 0; d < GP_DIM_COUNT; d++)
+    {
+        p->glitch[d] = HampelFilter<int16_t, GP_HAMPEL_WINDOW>(GP_HAMPEL_K, GP_HAMPEL_MIN_SIGMA);
+        p->ref[d] = 0.0f;
+        p->dims[d] = 0.0f;
+    }
+    actInit(&p->activity, activityWindow);
+    tunerInit(&p->tuner, p->params.threshold);
+    rsInit(&p->stats);
+
+    memset(p->angularVelocity, 0, sizeof(p->angularVelocity));
+    memset(p->linearVelocity, 0, sizeof(p->linearVelocity));
+    memset(p->window, 0, sizeof(p->window));
+    p->iCnt = 0;
+    p->jCnt = 0;
+    p->windowIndex = 0;
+    p->fsmStarted = false;
+    p->fsmNextUs = 0;
+
+    p->state = GP_IDLE;
+    p->totalDistFx = 0;
+    p->totalDist = 0.0f;
+    p->stepCnt = 0;
+    p->clockStarted = false;
+    p->clockLastUs = 0;
+    p->clockMs = 0;
+    p->clockFracUs = 0;
+    p->calState = GP_CAL_OFF;
+    p->calLeft = 0;
+    p->calSamples = 0;
+    p->calCount = 0;
+    p->trace = trace;
+    p->traceCtx = traceCtx;
+}
+
+// EVERY SAMPLE: GLITCH FILTER, CLASSIFIER AND RATE STATISTICS
+static void gpFilterSample(GyroPipeline *p, uint32_t tUs, const int16_t raw[GP_DIM_COUNT], int16_t out[GP_DIM_COUNT])
+{
+    // Glitch rejection: single-sample spikes (SPI glitches, impacts) are replaced by the window median
+    // before they can be spread over the moving average window or trigger a false MOVING_DATARECORD.
+    out[0] = p->glitch[0].update(raw[0]);
+    out[1] = p->glitch[1].update(raw[1]);
+    out[2] = p->glitch[2].update(raw[2]);
+
+    // Activity classification: feed the angular-rate magnitude (rad/s) into the streaming classifier and the rolling statistics.
+    // The integer norm is exact on the raw counts, so only one float multiply is needed per sample.
+    float rate_mag = vmNorm3I16(out[0], out[1], out[2]) * GYRO_RAW_TO_RADS_500DPS;
+    rsAddRate(&p->stats, gpSessionMs(p, tUs), rate_mag);
+    if (actUpdate(&p->activity, rate_mag, tUs))
+    {
+        gpTrace(p, GP_TRACE_ACTIVITY, p->activity.current, p->activity.features[ACT_F_MEAN], p->activity.features[ACT_F_PEAK_RATE], (float)p->activity.maxCycles);
+    }
+}
+
+// TRUE ONCE PER GP_FSM_PERIOD_US OF SAMPLE TIME (THE FIRST SAMPLE INCLUDED)
+static bool gpFsmDue(GyroPipeline *p, uint32_t tUs)
+{
+    if (p->fsmStarted && (int32_t)(tUs - p->fsmNextUs) < 0)
+    {
+        return false;
+    }
+    // Keep the 0.5s grid; after a gap (or at the start) restart it from this sample
+    bool onGrid = p->fsmStarted && (int32_t)(tUs - p->fsmNextUs) < GP_FSM_PERIOD_US;
+    p->fsmNextUs = (onGrid ? p->fsmNextUs : tUs) + GP_FSM_PERIOD_US;
+    p->fsmStarted = true;
+    return true;
+}
+
+float *gpFilter(GyroPipeline *p, uint32_t tUs, const int16_t raw[GP_DIM_COUNT])
+{
+    int16_t filtered[GP_DIM_COUNT];
+    gpFilterSample(p, tUs, raw, filtered);
+    if (!gpFsmDue(p, tUs))
+    {
+        return 0;
+    }
+    int16_t raw_gx = filtered[0];
+    int16_t raw_gy = filtered[1];
+    int16_t raw_gz = filtered[2];
+
+    // Storing the filtered angular velocity values for each FSM step into the 'angularVelocity' history:
+    float *ang = p->angularVelocity[p->iCnt];
+    ang[0] = raw_gx;
+    ang[1] = raw_gy;
+    ang[2] = raw_gy;
+    gpTrace(p, GP_TRACE_ANG_VEL, 0, ang[0], ang[1], ang[2], ang[0] + ang[1] + ang[2] / GP_DIM_COUNT);
+    p->iCnt = (p->iCnt + 1) % GP_HISTORY_LEN;
+
+    // Conversion of filtered angular velocity to linear velocity, into the moving average window:
+    p->window[0][p->windowIndex] = ((float)raw_gx) * GP_SCALING_FACTOR;   // X-Dimension
+    p->window[1][p->windowIndex] = ((float)raw_gy) * GP_SCALING_FACTOR;   // Y-Dimension
+    p->window[2][p->windowIndex] = ((float)raw_gz) * GP_SCALING_FACTOR;   // Z-Dimension
+
+    // Moving average filter over the last windowSize linear velocities of each co-ordinate:
+    const int windowSize = p->params.windowSize;
+    float avg[GP_DIM_COUNT] = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < windowSize; i++)
+    {
+        avg[0] += p->window[0][i];
+        avg[1] += p->window[1][i];
+        avg[2] += p->window[2][i];
+    }
+    float *lin = p->linearVelocity[p->jCnt];
+    for (int d = 0; d < GP_DIM_COUNT; d++)
+    {
+        avg[d] /= windowSize;
+        lin[d] = avg[d];
+    }
+    gpTrace(p, GP_TRACE_LIN_VEL, 0, lin[0], lin[1], lin[2], lin[0] + lin[1] + lin[2] / GP_DIM_COUNT);
+    p->jCnt = (p->jCnt + 1) % GP_HISTORY_LEN;
+
+    // Individual co-ordinate distance = (filtered) linear velocity * radius * time; where time = 0.5s (GP_FSM_PERIOD_US)
+    for (int d = 0; d < GP_DIM_COUNT; d++)
+    {
+        p->dims[d] = avg[d] * p->params.radius * 0.5f;
+    }
+
+    p->windowIndex = (p->windowIndex + 1) % windowSize;
+    return p->dims;
+}
+
+uint32_t gpSessionMs(GyroPipeline *p, uint32_t tUs)
+{
+    // Dividing the timestamp itself (tUs / 1000) jumps back 4294967 ms when it wraps, and the
+    // rolling statistics would then close ~4.3 million seconds in one call.
+    if (!p->clockStarted)
+    {
+        p->clockStarted = true;
+        p->clockMs = tUs / 1000;
+        p->clockFracUs = tUs % 1000;
+    }
+    else
+    {
+        int32_t stepUs = (int32_t)(tUs - p->clockLastUs);
+        uint32_t us = p->clockFracUs + (stepUs > 0 ? (uint32_t)stepUs : 0u);
+        p->clockMs += us / 1000;
+        p->clockFracUs = us % 1000;
+    }
+    p->clockLastUs = tUs;
+    return p->clockMs;
+}
+
+float gpDist3Dim(GyroPipeline *p, const float dims[GP_DIM_COUNT])
+{
+    // Distance calculation using the 3 dimensional distance formula (single-precision VSQRT, not the double libm path):
+    float xSqr = (dims[0] - p->ref[0]) * (dims[0] - p->ref[0]);
+    float ySqr = (dims[1] - p->ref[1]) * (dims[1] - p->ref[1]);
+    float zSqr = (dims[2] - p->ref[2]) * (dims[2] - p->ref[2]);
+    float distcalc = vmSqrtF(xSqr + ySqr + zSqr);
+    gpTrace(p, GP_TRACE_CALC, 0, distcalc);
+
+    // Updating the reference point to the newly moved point as the person moves:
+    p->ref[0] = dims[0];
+    p->ref[1] = dims[1];
+    p->ref[2] = dims[2];
+
+    if (distcalc >= p->params.stepThreshold)        // Post multiple trials, this threshold was found efficient in determining the step count
+    {
+        ++p->stepCnt;
+    }
+    return distcalc;
+}
+
+void gpRunFSM(GyroPipeline *p, float *dims, uint32_t tUs)
+{
+    if (dims == 0)                                  // Between FSM steps
+    {
+        return;
+    }
+
+    // Motion decision against the auto-tuned thresholds. The multiplication factor raises the magnitude of the low intensity
+    // readings; the tuner removes the per-axis bias learnt at rest and applies hysteresis (entry from IDLE, lower exit while MOVING).
+    const float mul1 = p->params.mulFactor1;
+    float scaled[GP_DIM_COUNT] = { dims[0] * mul1, dims[1] * mul1, dims[2] * mul1 };
+    bool motionDetected = tunerUpdate(&p->tuner, scaled);
+
+    switch (p->state)
+    {
+        case GP_IDLE:                               // At rest: no change in the total distance or the step count
+            if (motionDetected)
+            {
+                p->state = GP_MOVING_DATARECORD;
+            }
+            else
+            {
+                dims[0] = 0.0f;                     // Zero readings so rest has no impact on the distance calculations
+                dims[1] = 0.0f;
+                dims[2] = 0.0f;
+            }
+            break;
+
+        case GP_MOVING_DATARECORD:                  // Moving: accumulate the resultant distance and count steps
+        {
+            uint32_t prevStepCnt = p->stepCnt;
+            float distStep = gpDist3Dim(p, dims) * p->params.mulFactor2;
+            p->totalDistFx += (int64_t)llrintf(distStep * (float)(1L << GP_DIST_FX_BITS));   // A float sum stops absorbing increments after hours
+            p->totalDist = (float)p->totalDistFx * (1.0f / (float)(1L << GP_DIST_FX_BITS));
+
+            // Reporting the increments to the rolling statistics (speed and cadence are derived per second):
+            uint32_t tMs = gpSessionMs(p, tUs);
+            rsAddDistance(&p->stats, tMs, distStep);
+            rsAddSteps(&p->stats, tMs, p->stepCnt - prevStepCnt);
+            gpTrace(p, GP_TRACE_TOTAL, (int32_t)p->stepCnt, p->totalDist);
+
+            // Stay while any co-ordinate is still above its (lower) exit threshold:
+            p->state = motionDetected ? GP_MOVING_DATARECORD : GP_IDLE;
+        }
+        break;
+    }
+}
+
+void gpProcess(GyroPipeline *p, uint32_t tUs, const int16_t raw[GP_DIM_COUNT])
+{
+    float *dims = gpFilter(p, tUs, raw);
+    gpRunFSM(p, dims, tUs);
+}
+
+void gpStartCalibration(GyroPipeline *p, uint16_t settleSamples, uint16_t calSamples)
+{
+    p->calState = (settleSamples > 0) ? GP_CAL_SETTLING : GP_CAL_PRIMING;
+    p->calLeft = (settleSamples > 0) ? settleSamples : GP_HAMPEL_WINDOW;
+    p->calSamples = calSamples;
+    p->calCount = 0;
+    for (int d = 0; d < GP_DIM_COUNT; d++)
+    {
+        p->calMean[d] = 0.0f;
+        p->calM2[d] = 0.0f;
+    }
+}
+
+// END OF THE MEASURING PHASE: SEED THE TUNER UNLESS THE SPREAD SAYS THE SENSOR WAS MOVING
+static void gpFinishCalibration(GyroPipeline *p)
+{
+    // The tuner sees moving averages of windowSize FSM steps, 0.5s apart: the rest mean scaled to its units, and the
+    // per-sample variance divided by windowSize (rest noise is uncorrelated over 0.5s).
+    const uint16_t measured = p->calCount;
+    const float toTuner = p->params.radius * 0.5f * p->params.mulFactor1;
+    float mean[GP_DIM_COUNT], var[GP_DIM_COUNT];
+    bool rest = measured > 1;
+    for (int d = 0; d < GP_DIM_COUNT; d++)
+    {
+        mean[d] = p->calMean[d] * toTuner;
+        var[d] = rest ? p->calM2[d] / (float)(measured - 1) * toTuner * toTuner / (float)p->params.windowSize : 0.0f;
+        // Noise beyond what the tuner would ever accept as an entry threshold: not at rest
+        rest = rest && p->tuner.kEntry * vmSqrtF(var[d]) <= p->tuner.maxThreshold;
+    }
+    if (rest)
+    {
+        tunerSeed(&p->tuner, mean, var);
+        // Start the moving average at the rest mean instead of pulling the first FSM steps towards zero
+        for (int d = 0; d < GP_DIM_COUNT; d++)
+        {
+            for (int i = 0; i < GP_WINDOW_MAX; i++)
+            {
+                p->window[d][i] = p->calMean[d];
+            }
+        }
+    }
+    p->calState = rest ? GP_CAL_SEEDED : GP_CAL_MOVED;
+}
+
+bool gpCalibrate(GyroPipeline *p, uint32_t tUs, const int16_t raw[GP_DIM_COUNT])
+{
+    int16_t filtered[GP_DIM_COUNT];
+    switch (p->calState)
+    {
+        case GP_CAL_SETTLING:                       // Turn-on: the outputs are not valid yet, keep them out of every filter
+            if (--p->calLeft == 0)
+            {
+                p->calState = GP_CAL_PRIMING;
+                p->calLeft = GP_HAMPEL_WINDOW;
+            }
+            return false;
+
+        case GP_CAL_PRIMING:                        // Until the glitch filter window is full its median is pulled towards zero
+            gpFilterSample(p, tUs, raw, filtered);
+            if (--p->calLeft == 0)
+            {
+                p->calState = GP_CAL_MEASURING;
+                p->calLeft = p->calSamples;
+                if (p->calLeft == 0)
+                {
+                    gpFinishCalibration(p);
+                    return true;
+                }
+            }
+            return false;
+
+        case GP_CAL_MEASURING:
+        {
+            // Every sample, in linear velocity (the FSM's own steps are 0.5s apart, far too few for a boot calibration)
+            gpFilterSample(p, tUs, raw, filtered);
+            p->calCount++;
+            for (int d = 0; d < GP_DIM_COUNT; d++)
+            {
+                float x = (float)filtered[d] * GP_SCALING_FACTOR;
+                float delta = x - p->calMean[d];
+                p->calMean[d] += delta / (float)p->calCount;
+                p->calM2[d] += delta * (x - p->calMean[d]);
+            }
+            if (--p->calLeft == 0)
+            {
+                gpFinishCalibration(p);
+                return true;
+            }
+            return false;
+        }
+
+        default:
+            return true;
+    }
+}
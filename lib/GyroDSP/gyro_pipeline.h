@@ -0,0 +1,187 @@
+//=======================================================================================
+// GYRO PROCESSING PIPELINE (HARDWARE INDEPENDENT):
+//=======================================================================================
+// Everything between the SPI frame and the distance / step count, with all state in one
+// GyroPipeline instance so several pipelines (sensors, sessions, host replays) can run
+// side by side:
+//   gpDecodeFrame   7-byte OUT_X_L..OUT_Z_H burst read -> raw int16 x, y, z
+//   gpFilter        every sample: Hampel glitch filter, rate magnitude -> activity
+//                   classifier and rolling statistics; every GP_FSM_PERIOD_US: moving
+//                   average, per-axis distance increments
+//   gpRunFSM        auto-tuned IDLE / MOVING_DATARECORD state machine, resultant
+//                   distance and step detection, once per GP_FSM_PERIOD_US
+//   gpCalibrate     optional boot calibration before the first gpRunFSM: skips the
+//                   sensor's turn-on samples, then measures the bias and noise at rest
+//                   and seeds the motion threshold tuner with them
+// The distance and step constants (radius * 0.5s, GP_STEP_THRESHOLD, the motion threshold)
+// were tuned on one sample per 0.5s cycle, so the velocity path and the FSM still see one
+// sample per GP_FSM_PERIOD_US of sample time whatever the sensor ODR; only the glitch
+// filter, classifier and rate statistics use every sample.
+// Sessions are unbounded: the distance is summed in 64-bit fixed point, the step count is
+// 32-bit, and the statistics run on a session millisecond clock that survives the 32-bit
+// sample timestamps wrapping (every 71.6 minutes).
+// No mbed, HAL or LCD dependency: the firmware (src/proj.cpp) and the host build
+// (host/CMakeLists.txt) run exactly this code. Diagnostics leave through an optional
+// trace callback instead of printf, so the caller decides how (and whether) to log them.
+//=======================================================================================
+#ifndef GYRO_PIPELINE_H
+#define GYRO_PIPELINE_H
+
+#include <stdint.h>
+#include "activity_classifier.h"
+#include "hampel_filter.h"
+#include "rolling_stats.h"
+#include "threshold_tuner.h"
+
+#define GP_DIM_COUNT 3                              // DIMENSIONS COUNT = 3 [X,Y,Z]
+#define GP_FRAME_SIZE 7                             // SPI BURST: ADDRESS BYTE + OUT_X_L..OUT_Z_H
+#define GP_SCALING_FACTOR (1.0f * 0.017453292519943295769236907684886f / 1000.0f)   // SCALING FACTOR FOR ANGULAR TO DEGREE CONVERSION
+#define GP_RADIUS 0.5f                              // RADIUS IN METERS
+#define GP_WINDOW_SIZE 6                            // MOVING AVERAGE LENGTH (FSM STEPS) FOR EACH X,Y,Z CO-ORDINATE LINEAR VELOCITY
+#define GP_HISTORY_LEN 40                           // ANGULAR / LINEAR VELOCITY HISTORY (FSM STEPS)
+#define GP_MULFACTOR1 1000000                       // SCALING OF THE INDIVIDUAL CO-ORDINATE DISTANCES FOR THE MOTION DECISION
+#define GP_MULFACTOR2 100                           // SCALING OF THE RESULTANT DISTANCE
+#define GP_THRESHOLD 104.85f                        // INITIAL IDLE -> MOVING_DATARECORD THRESHOLD (THE TUNER LEARNS THE REAL ONES)
+#define GP_STEP_THRESHOLD 0.00280f                  // RESULTANT DISTANCE (m) THAT COUNTS AS ONE STEP
+#define GP_HAMPEL_WINDOW 7                          // GLITCH FILTER WINDOW LENGTH (SAMPLES PER AXIS)
+#define GP_HAMPEL_K 3.0f                            // GLITCH FILTER REJECTION THRESHOLD (IN SIGMAS)
+#define GP_HAMPEL_MIN_SIGMA 30.0f                   // GLITCH FILTER NOISE FLOOR (RAW COUNTS)
+#define GP_WINDOW_MAX 16                            // LARGEST MOVING AVERAGE GpParams::windowSize ACCEPTS
+#define GP_DIST_FX_BITS 20                          // FRACTION BITS OF THE FIXED-POINT TOTAL DISTANCE
+#define GP_ACT_WINDOW_MS 1350                       // ACTIVITY CLASSIFICATION WINDOW (ms): THE FIRMWARE AND EVERY HOST TOOL PASS THIS TO gpInit()
+#define GP_FSM_PERIOD_US 500000                     // FSM TIME STEP (us): THE 0.5s CYCLE THE DISTANCE / STEP CONSTANTS ABOVE WERE TUNED FOR
+
+enum GpState : int8_t
+{
+    GP_IDLE = 0,                                    // AT REST
+    GP_MOVING_DATARECORD = 1                        // MOVING [WALK/JOG/RUN]
+};
+
+// BOOT CALIBRATION PHASES (gpStartCalibration / gpCalibrate)
+enum GpCalState : int8_t
+{
+    GP_CAL_OFF = 0,                                 // NOT CALIBRATING (gpInit: THE TUNER WARMS UP ONLINE)
+    GP_CAL_SETTLING,                                // DISCARDING THE SENSOR'S TURN-ON SAMPLES
+    GP_CAL_PRIMING,                                 // FILLING THE GLITCH FILTER WINDOW
+    GP_CAL_MEASURING,                               // AVERAGING REST SAMPLES
+    GP_CAL_SEEDED,                                  // DONE: THE TUNER STARTS FROM THE MEASURED BIAS AND NOISE
+    GP_CAL_MOVED                                    // DONE: TOO NOISY TO BE REST, THE TUNER WARMS UP ONLINE INSTEAD
+};
+
+// DIAGNOSTIC RECORDS PASSED TO THE TRACE CALLBACK
+enum GpTrace : uint8_t
+{
+    GP_TRACE_ANG_VEL = 0,                           // v[0..2] = x,y,z ANGULAR VELOCITY, v[3] = AVERAGE
+    GP_TRACE_LIN_VEL,                               // v[0..2] = x,y,z LINEAR VELOCITY, v[3] = AVERAGE
+    GP_TRACE_CALC,                                  // v[0] = CURRENT RESULTANT DISTANCE
+    GP_TRACE_TOTAL,                                 // v[0] = TOTAL DISTANCE, i = STEP COUNT
+    GP_TRACE_ACTIVITY                               // i = ActivityClass, v[0] = MEAN, v[1] = PEAK RATE, v[2] = WORST CYCLES
+};
+
+// TUNABLE CONSTANTS; gpInit() LOADS THE GP_* DEFAULTS ABOVE, gpConfigure() OVERRIDES THEM
+struct GpParams
+{
+    uint8_t windowSize;                             // GP_WINDOW_SIZE, 1..GP_WINDOW_MAX
+    float threshold;                                // GP_THRESHOLD
+    float stepThreshold;                            // GP_STEP_THRESHOLD
+    float radius;                                   // GP_RADIUS
+    float mulFactor1;                               // GP_MULFACTOR1
+    float mulFactor2;                               // GP_MULFACTOR2
+};
+
+typedef void (*GpTraceFn)(void *ctx, GpTrace kind, int32_t i, float v0, float v1, float v2, float v3);
+
+struct GyroPipeline
+{
+    // Glitch filter, classifier, tuner and statistics
+    HampelFilter<int16_t, GP_HAMPEL_WINDOW> glitch[GP_DIM_COUNT];
+    ActivityClassifier activity;
+    ThresholdTuner tuner;
+    RollingStats stats;
+
+    // Velocity history and moving average
+    float angularVelocity[GP_HISTORY_LEN][GP_DIM_COUNT];
+    float linearVelocity[GP_HISTORY_LEN][GP_DIM_COUNT];
+    int iCnt, jCnt;
+    float window[GP_DIM_COUNT][GP_WINDOW_MAX];
+    int windowIndex;
+    bool fsmStarted;
+    uint32_t fsmNextUs;                             // SAMPLE TIME OF THE NEXT FSM STEP
+
+    GpParams params;
+
+    // Distance FSM
+    GpState state;
+    float ref[GP_DIM_COUNT];                        // DISTANCE REFERENCE POINT
+    float dims[GP_DIM_COUNT];                       // LATEST PER-AXIS DISTANCE INCREMENTS
+    int64_t totalDistFx;                            // TOTAL DISTANCE, GP_DIST_FX_BITS FRACTION BITS (EXACT SUM OVER ANY SESSION LENGTH)
+    float totalDist;                                // METERS (SCALED BY params.mulFactor2): totalDistFx, FOR DISPLAY AND REPORTS
+    uint32_t stepCnt;
+
+    // Session clock for the statistics (gpSessionMs)
+    bool clockStarted;
+    uint32_t clockLastUs;                           // TIMESTAMP OF THE LAST SAMPLE
+    uint32_t clockMs;                               // SESSION MILLISECONDS (WRAPS AFTER 49.7 DAYS: THE STATISTICS ONLY USE DIFFERENCES)
+    uint32_t clockFracUs;                           // MICROSECONDS PAST clockMs
+
+    // Boot calibration
+    GpCalState calState;
+    uint16_t calLeft;                               // SAMPLES LEFT IN THE CURRENT PHASE
+    uint16_t calSamples;                            // REST SAMPLES TO MEASURE
+    uint16_t calCount;                              // REST SAMPLES MEASURED
+    float calMean[GP_DIM_COUNT];                    // RUNNING MEAN / SUM OF SQUARED DEVIATIONS (WELFORD), LINEAR VELOCITY
+    float calM2[GP_DIM_COUNT];
+
+    GpTraceFn trace;                                // OPTIONAL, MAY BE NULL
+    void *traceCtx;
+};
+
+// RESET EVERYTHING FOR A NEW SESSION
+void gpInit(GyroPipeline *p, uint16_t activityWindow, GpTraceFn trace = 0, void *traceCtx = 0);
+
+// DEFAULT PARAMETERS (THE GP_* CONSTANTS)
+void gpDefaultParams(GpParams *out);
+
+// REPLACE THE PARAMETERS AFTER gpInit() AND BEFORE THE FIRST SAMPLE (windowSize IS CLAMPED)
+void gpConfigure(GyroPipeline *p, const GpParams *params);
+
+// DECODE ONE SPI BURST FRAME (BYTE 0 IS THE ONE CLOCKED OUT WITH THE ADDRESS)
+static inline void gpDecodeFrame(const uint8_t *frame, int16_t raw[GP_DIM_COUNT])
+{
+    raw[0] = (int16_t)((((uint16_t)frame[2]) << 8) | ((uint16_t)frame[1]));   // OUT_X_H:OUT_X_L
+    raw[1] = (int16_t)((((uint16_t)frame[4]) << 8) | ((uint16_t)frame[3]));   // OUT_Y_H:OUT_Y_L
+    raw[2] = (int16_t)((((uint16_t)frame[6]) << 8) | ((uint16_t)frame[5]));   // OUT_Z_H:OUT_Z_L
+}
+
+// FILTER ONE RAW SAMPLE CAPTURED AT 'tUs'; RETURNS THE PER-AXIS DISTANCE INCREMENTS (p->dims) WHEN
+// AN FSM STEP IS DUE (ONCE PER GP_FSM_PERIOD_US), NULL BETWEEN STEPS
+float *gpFilter(GyroPipeline *p, uint32_t tUs, const int16_t raw[GP_DIM_COUNT]);
+
+// RUN THE DISTANCE / STEP FSM ON THE INCREMENTS FROM gpFilter (MAY ZERO THEM WHILE IDLE; NULL IS A NO-OP)
+void gpRunFSM(GyroPipeline *p, float *dims, uint32_t tUs);
+
+// gpFilter + gpRunFSM
+void gpProcess(GyroPipeline *p, uint32_t tUs, const int16_t raw[GP_DIM_COUNT]);
+
+// START A BOOT CALIBRATION AFTER gpInit()/gpConfigure(): THE NEXT 'settleSamples' ARE DISCARDED,
+// THE GLITCH FILTER WINDOW IS FILLED, THEN 'calSamples' AT REST GIVE THE TUNER'S BIAS AND NOISE
+// AND THE MOVING AVERAGE'S STARTING POINT
+void gpStartCalibration(GyroPipeline *p, uint16_t settleSamples, uint16_t calSamples);
+
+// FEED ONE SAMPLE INSTEAD OF gpProcess() WHILE CALIBRATING (THE FSM DOES NOT RUN). RETURNS TRUE
+// ONCE THE CALIBRATION IS OVER (p->calState IS THEN GP_CAL_SEEDED OR GP_CAL_MOVED, OR GP_CAL_OFF)
+bool gpCalibrate(GyroPipeline *p, uint32_t tUs, const int16_t raw[GP_DIM_COUNT]);
+
+static inline bool gpCalibrating(const GyroPipeline *p)
+{
+    return p->calState >= GP_CAL_SETTLING && p->calState <= GP_CAL_MEASURING;
+}
+
+// SESSION MILLISECONDS AT SAMPLE TIME 'tUs': ADVANCES BY THE TIMESTAMP DIFFERENCE, SO THE 32-BIT
+// MICROSECOND WRAP IS INVISIBLE (A TIMESTAMP THAT STEPS BACK, e.g. A RE-SYNCED CLOCK, DOES NOT MOVE IT)
+uint32_t gpSessionMs(GyroPipeline *p, uint32_t tUs);
+
+// RESULTANT DISTANCE FROM THE REFERENCE POINT, MOVES THE REFERENCE AND COUNTS A STEP
+float gpDist3Dim(GyroPipeline *p, const float dims[GP_DIM_COUNT]);
+
+#endif // GYRO_PIPELINE_H
@@ -0,0 +1,17 @@
+//=======================================================================================
+// L3GD20 / I3G4250D RAW-TO-PHYSICAL CONVERSION:
+//=======================================================================================
+// Sensitivity per full-scale setting (datasheet, typical), in millidegrees/s per LSB, and
+// the matching factor from a raw int16 count straight to rad/s.
+//=======================================================================================
+#ifndef GYRO_UNITS_H
+#define GYRO_UNITS_H
+
+#define GYRO_SENS_250DPS_MDPS 8.75f                                     // 250 DPS FULL SCALE
+#define GYRO_SENS_500DPS_MDPS 17.5f                                     // 500 DPS FULL SCALE (CTRL_REG4 FS = 01)
+#define GYRO_SENS_2000DPS_MDPS 70.0f                                    // 2000 DPS FULL SCALE
+
+#define GYRO_DEG_TO_RAD 0.017453292519943295769236907684886f
+#define GYRO_RAW_TO_RADS_500DPS (GYRO_SENS_500DPS_MDPS * 1.0e-3f * GYRO_DEG_TO_RAD)   // RAW COUNT -> rad/s @ 500 DPS
+
+#endif // GYRO_UNITS_H
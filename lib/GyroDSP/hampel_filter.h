@@ -0,0 +1,239 @@
+//=======================================================================================
+// SLIDING MEDIAN / HAMPEL GLITCH FILTER:
+//=======================================================================================
+// SlidingMedian<T, N> keeps the last N samples in a fixed ring plus two indexed heaps
+// (max-heap of the lower half, min-heap of the upper half). Each push overwrites the
+// oldest ring slot in place and repairs both heaps: O(log N), no allocation, no copying
+// of the window. The median returned is the lower median when the window is even.
+//
+// HampelFilter<T, N> rejects isolated spikes (SPI glitches, impacts) before they reach
+// the moving average: a sample further than k * 1.4826 * MAD from the window median is
+// replaced by the median. The MAD is streamed as the sliding median of each sample's
+// distance to the median at its arrival (causal form), which keeps the whole update
+// O(log N); 'minScale' stops a perfectly flat window from rejecting everything.
+//=======================================================================================
+#ifndef HAMPEL_FILTER_H
+#define HAMPEL_FILTER_H
+
+#include <stdint.h>
+
+#define HAMPEL_MAD_TO_SIGMA 1.4826f                 // MAD -> STANDARD DEVIATION FOR GAUSSIAN NOISE
+
+template <typename T, uint16_t N>
+class SlidingMedian
+{
+    static_assert(N >= 1, "window must hold at least one sample");
+
+public:
+    SlidingMedian() { reset(); }
+
+    void reset()
+    {
+        count = 0;
+        head = 0;
+        lowCount = 0;
+        highCount = 0;
+    }
+
+    // ADD A SAMPLE (EVICTING THE OLDEST WHEN FULL) AND RETURN THE NEW MEDIAN
+    T push(T x)
+    {
+        if (count < N)
+        {
+            uint16_t s = count++;
+            val[s] = x;
+            if (lowCount == 0 || !(val[low[0]] < x))
+            {
+                heapInsert(low, lowCount, true, s);
+            }
+            else
+            {
+                heapInsert(high, highCount, false, s);
+            }
+            rebalance();
+        }
+        else
+        {
+            uint16_t s = head;
+            head = (uint16_t)((head + 1) == N ? 0 : head + 1);
+            val[s] = x;
+            if (inLow[s])
+            {
+                heapFix(low, lowCount, true, pos[s]);
+            }
+            else
+            {
+                heapFix(high, highCount, false, pos[s]);
+            }
+            // Only one value changed, so at most one exchange restores low <= high
+            if (highCount > 0 && val[high[0]] < val[low[0]])
+            {
+                uint16_t a = low[0], b = high[0];
+                place(low, true, 0, b);
+                place(high, false, 0, a);
+                siftDown(low, lowCount, true, 0);
+                siftDown(high, highCount, false, 0);
+            }
+        }
+        return median();
+    }
+
+    T median() const { return val[low[0]]; }
+    uint16_t size() const { return count; }
+
+private:
+    T val[N];                                       // RING OF SAMPLES (SLOT = ARRIVAL ORDER MOD N)
+    uint16_t pos[N];                                // HEAP POSITION OF EACH SLOT
+    bool inLow[N];                                  // WHICH HEAP EACH SLOT IS IN
+    uint16_t low[N / 2 + 1];                        // MAX-HEAP OF SLOT INDICES, LOWER HALF (+1 WHILE REBALANCING)
+    uint16_t high[N / 2 + 1];                       // MIN-HEAP OF SLOT INDICES, UPPER HALF (+1 WHILE REBALANCING)
+    uint16_t lowCount, highCount;
+    uint16_t count;                                 // SAMPLES IN THE WINDOW
+    uint16_t head;                                  // OLDEST SLOT ONCE FULL
+
+    // 'a' SHOULD SIT ABOVE 'b' IN THE HEAP
+    bool above(bool isMax, uint16_t a, uint16_t b) const
+    {
+        return isMax ? (val[b] < val[a]) : (val[a] < val[b]);
+    }
+
+    void place(uint16_t *h, bool isLow, uint16_t i, uint16_t slot)
+    {
+        h[i] = slot;
+        pos[slot] = i;
+        inLow[slot] = isLow;
+    }
+
+    void siftUp(uint16_t *h, bool isMax, uint16_t i)
+    {
+        uint16_t slot = h[i];
+        while (i > 0)
+        {
+            uint16_t parent = (uint16_t)((i - 1) / 2);
+            if (!above(isMax, slot, h[parent]))
+            {
+                break;
+            }
+            place(h, isMax, i, h[parent]);
+            i = parent;
+        }
+        place(h, isMax, i, slot);
+    }
+
+    void siftDown(uint16_t *h, uint16_t n, bool isMax, uint16_t i)
+    {
+        uint16_t slot = h[i];
+        for (;;)
+        {
+            uint16_t child = (uint16_t)(2 * i + 1);
+            if (child >= n)
+            {
+                break;
+            }
+            if (child + 1 < n && above(isMax, h[child + 1], h[child]))
+            {
+                child++;
+            }
+            if (!above(isMax, h[child], slot))
+            {
+                break;
+            }
+            place(h, isMax, i, h[child]);
+            i = child;
+        }
+        place(h, isMax, i, slot);
+    }
+
+    void heapFix(uint16_t *h, uint16_t n, bool isMax, uint16_t i)
+    {
+        if (i > 0 && above(isMax, h[i], h[(i - 1) / 2]))
+        {
+            siftUp(h, isMax, i);
+        }
+        else
+        {
+            siftDown(h, n, isMax, i);
+        }
+    }
+
+    void heapInsert(uint16_t *h, uint16_t &n, bool isMax, uint16_t slot)
+    {
+        place(h, isMax, n, slot);
+        siftUp(h, isMax, n);
+        n++;
+    }
+
+    uint16_t heapPop(uint16_t *h, uint16_t &n, bool isMax)
+    {
+        uint16_t top = h[0];
+        n--;
+        if (n > 0)
+        {
+            place(h, isMax, 0, h[n]);
+            siftDown(h, n, isMax, 0);
+        }
+        return top;
+    }
+
+    // KEEP lowCount == highCount OR lowCount == highCount + 1 WHILE FILLING
+    void rebalance()
+    {
+        if (lowCount > highCount + 1)
+        {
+            heapInsert(high, highCount, false, heapPop(low, lowCount, true));
+        }
+        else if (highCount > lowCount)
+        {
+            heapInsert(low, lowCount, true, heapPop(high, highCount, false));
+        }
+    }
+};
+
+
+template <typename T, uint16_t N>
+class HampelFilter
+{
+public:
+    HampelFilter(float kSigma = 3.0f, float minSigma = 0.0f) : k(kSigma), minScale(minSigma), rejectedCount(0) {}
+
+    void reset()
+    {
+        window.reset();
+        deviation.reset();
+        rejectedCount = 0;
+    }
+
+    // FILTER ONE SAMPLE: RETURNS THE SAMPLE, OR THE WINDOW MEDIAN IF IT IS AN OUTLIER
+    T update(T x)
+    {
+        T med = window.push(x);
+        float dev = (float)x - (float)med;
+        if (dev < 0.0f)
+        {
+            dev = -dev;
+        }
+        float mad = deviation.push(dev);
+        float scale = HAMPEL_MAD_TO_SIGMA * mad;
+        if (scale < minScale)
+        {
+            scale = minScale;
+        }
+        if (window.size() == N && dev > k * scale)
+        {
+            rejectedCount++;
+            return med;
+        }
+        return x;
+    }
+
+    uint32_t rejected() const { return rejectedCount; }
+
+private:
+    SlidingMedian<T, N> window;                     // SAMPLES
+    SlidingMedian<float, N> deviation;              // |SAMPLE - MEDIAN AT ARRIVAL|
+    float k;                                        // REJECTION THRESHOLD IN SIGMAS
+    float minScale;                                 // FLOOR ON THE SIGMA ESTIMATE (SAMPLE UNITS)
+    uint32_t rejectedCount;                         // SAMPLES REPLACED SO FAR
+};
+
+#endif // HAMPEL_FILTER_H
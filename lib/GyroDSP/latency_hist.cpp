@@ -0,0 +1,98 @@
+//=======================================================================================
+// LOG2 LATENCY HISTOGRAM:
+//=======================================================================================
+#include "latency_hist.h"
+#include <stdio.h>
+#include <string.h>
+
+void lhInit(LatencyHist *h, const char *name)
+{
+    memset(h, 0, sizeof(*h));
+    h->name = name;
+}
+
+uint8_t lhBucket(uint32_t us)
+{
+    if (us == 0)
+    {
+        return 0;
+    }
+    uint8_t b = (uint8_t)(32 - __builtin_clz(us));  // 1 -> 1, 2..3 -> 2, 4..7 -> 3, ...
+    return b < LH_BUCKETS ? b : LH_BUCKETS - 1;
+}
+
+uint32_t lhBucketUpper(uint8_t b)
+{
+    if (b >= LH_BUCKETS - 1)
+    {
+        return UINT32_MAX;
+    }
+    return 1u << b;
+}
+
+void lhAdd(LatencyHist *h, uint32_t us)
+{
+    h->count++;
+    h->sum += us;
+    if (us > h->max)
+    {
+        h->max = us;
+    }
+    h->bucket[lhBucket(us)]++;
+}
+
+void lhMerge(LatencyHist *into, const LatencyHist *h)
+{
+    into->count += h->count;
+    into->sum += h->sum;
+    if (h->max > into->max)
+    {
+        into->max = h->max;
+    }
+    for (int b = 0; b < LH_BUCKETS; b++)
+    {
+        into->bucket[b] += h->bucket[b];
+    }
+}
+
+uint32_t lhPercentile(const LatencyHist *h, float p)
+{
+    if (h->count == 0)
+    {
+        return 0;
+    }
+    uint32_t rank = (uint32_t)(p * (float)(h->count - 1)) + 1;   // 1-based rank of the percentile sample
+    uint32_t seen = 0;
+    for (uint8_t b = 0; b < LH_BUCKETS; b++)
+    {
+        seen += h->bucket[b];
+        if (seen >= rank)
+        {
+            uint32_t upper = lhBucketUpper(b);
+            return upper < h->max ? upper : h->max;              // Never report more than the real maximum
+        }
+    }
+    return h->max;
+}
+
+void lhPrintHeader(const char *unit)
+{
+    printf("  hop                count     mean      p50      p99      max  [%s]\n", unit);
+}
+
+void lhPrint(const LatencyHist *h)
+{
+    printf("  %-16s %7lu %8lu %8lu %8lu %8lu\n", h->name, (unsigned long)h->count,
+           (unsigned long)(h->count ? h->sum / h->count : 0),
+           (unsigned long)lhPercentile(h, 0.5f), (unsigned long)lhPercentile(h, 0.99f), (unsigned long)h->max);
+}
+
+void lhDump(const LatencyHist *h)
+{
+    printf("#LAT,%s,%lu,%llu,%lu", h->name, (unsigned long)h->count, (unsigned long long)h->sum, (unsigned long)h->max);
+    for (uint8_t b = 0; b < LH_BUCKETS; b++)
+    {
+        printf(",%lu", (unsigned long)h->bucket[b]);
+    }
+    printf("\n");
+}
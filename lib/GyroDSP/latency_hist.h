@@ -0,0 +1,52 @@
+//=======================================================================================
+// LOG2 LATENCY HISTOGRAM:
+//=======================================================================================
+// Fixed-size histogram of latencies in microseconds with power-of-two buckets:
+//   bucket 0      0 us
+//   bucket k      [2^(k-1), 2^k) us       (k = 1 .. LH_BUCKETS-2)
+//   last bucket   everything from 2^(LH_BUCKETS-2) us up
+// Adding a value is a CLZ and an increment, so it is cheap enough for every sample of
+// every pipeline hop. Percentiles are reported as the upper edge of their bucket (at most
+// 2x pessimistic); the exact maximum and sum are kept alongside.
+//
+// lhDump() writes one machine-readable line per histogram for host tools:
+//   #LAT,<name>,<count>,<sum_us>,<max_us>,<bucket 0>,...,<bucket LH_BUCKETS-1>
+//=======================================================================================
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+
+#define LH_BUCKETS 24                               // LAST BUCKET STARTS AT 2^22 us (~4.2 s)
+
+struct LatencyHist
+{
+    const char *name;
+    uint32_t count;
+    uint32_t max;                                   // WORST LATENCY (us)
+    uint64_t sum;                                   // FOR THE MEAN (us)
+    uint32_t bucket[LH_BUCKETS];
+};
+
+// CLEAR THE COUNTERS AND NAME THE HISTOGRAM
+void lhInit(LatencyHist *h, const char *name);
+
+// RECORD ONE LATENCY
+void lhAdd(LatencyHist *h, uint32_t us);
+
+// ADD THE COUNTS OF 'h' TO 'into' (E.G. PER-THREAD HISTOGRAMS INTO ONE)
+void lhMerge(LatencyHist *into, const LatencyHist *h);
+
+// BUCKET OF A LATENCY AND THE UPPER EDGE (us, EXCLUSIVE) OF A BUCKET
+uint8_t lhBucket(uint32_t us);
+uint32_t lhBucketUpper(uint8_t b);
+
+// UPPER EDGE OF THE BUCKET HOLDING THE p-TH PERCENTILE (p IN [0, 1]); 0 WHEN EMPTY
+uint32_t lhPercentile(const LatencyHist *h, float p);
+
+// ONE HUMAN-READABLE TABLE ROW (SEE lhPrintHeader) AND ONE '#LAT' DUMP LINE
+void lhPrintHeader(const char *unit = "us");
+void lhPrint(const LatencyHist *h);
+void lhDump(const LatencyHist *h);
+
+#endif // LATENCY_HIST_H
@@ -0,0 +1,240 @@
+//=======================================================================================
+// HIERARCHICAL ROLLING STATISTICS: SECOND / MINUTE / SESSION
+//=======================================================================================
+#include "rolling_stats.h"
+#include "ccm.h"
+#include <string.h>
+
+#define RS_SECOND_MS 1000u
+#define RS_SECONDS_PER_MINUTE 60u
+
+// Histogram upper edges; values above land in the last bin
+static const float kRangeMax[RS_METRIC_COUNT] CCM_CONST =
+{
+    240.0f,                                         // RS_CADENCE   (steps/min)
+    16.0f,                                          // RS_RATE      (rad/s)
+    0.5f,                                           // RS_DISTANCE  (m per increment)
+    8.0f,                                           // RS_SPEED     (m/s)
+};
+
+float rsRangeMax(RsMetric m)
+{
+    return kRangeMax[m];
+}
+
+static void summaryClear(RsSummary *s)
+{
+    memset(s, 0, sizeof(*s));
+}
+
+static void summaryHalve(RsSummary *s)
+{
+    for (int b = 0; b < RS_HIST_BINS; b++)
+    {
+        s->hist[b] = (uint16_t)((s->hist[b] + 1u) >> 1);
+    }
+}
+
+static void summaryAdd(RsSummary *s, RsMetric m, float v)
+{
+    if (s->count == 0 || v < s->min)
+    {
+        s->min = v;
+    }
+    if (s->count == 0 || v > s->max)
+    {
+        s->max = v;
+    }
+    s->count++;
+    s->sum += v;
+
+    int b = (v <= 0.0f) ? 0 : (int)(v * (RS_HIST_BINS / kRangeMax[m]));
+    if (b >= RS_HIST_BINS)
+    {
+        b = RS_HIST_BINS - 1;
+    }
+    if (s->hist[b] == UINT16_MAX)
+    {
+        summaryHalve(s);
+    }
+    s->hist[b]++;
+}
+
+static void summaryMerge(RsSummary *dst, const RsSummary *src)
+{
+    if (src->count == 0)
+    {
+        return;
+    }
+    if (dst->count == 0 || src->min < dst->min)
+    {
+        dst->min = src->min;
+    }
+    if (dst->count == 0 || src->max > dst->max)
+    {
+        dst->max = src->max;
+    }
+    dst->count += src->count;
+    dst->sum += src->sum;
+
+    uint16_t srcHist[RS_HIST_BINS];
+    memcpy(srcHist, src->hist, sizeof(srcHist));
+    for (int b = 0; b < RS_HIST_BINS; b++)
+    {
+        while ((uint32_t)dst->hist[b] + srcHist[b] > UINT16_MAX)
+        {
+            summaryHalve(dst);
+            for (int k = 0; k < RS_HIST_BINS; k++)
+            {
+                srcHist[k] = (uint16_t)((srcHist[k] + 1u) >> 1);
+            }
+        }
+        dst->hist[b] = (uint16_t)(dst->hist[b] + srcHist[b]);
+    }
+}
+
+void rsInit(RollingStats *rs)
+{
+    memset(rs, 0, sizeof(*rs));
+}
+
+// CLOSE THE OPEN SECOND (AND THE OPEN MINUTE WHEN IT IS COMPLETE)
+static void rsCloseSecond(RollingStats *rs)
+{
+    RsSummary *sec = rs->open[RS_LEVEL_SECOND];
+    summaryAdd(&sec[RS_SPEED], RS_SPEED, rs->distanceThisSecond);
+    summaryAdd(&sec[RS_CADENCE], RS_CADENCE, rs->stepsThisSecond * 60.0f);
+    rs->distanceThisSecond = 0.0f;
+    rs->stepsThisSecond = 0.0f;
+
+    RsSummary *slot = rs->seconds[rs->secondsClosed % RS_SECONDS_RING];
+    for (int m = 0; m < RS_METRIC_COUNT; m++)
+    {
+        slot[m] = sec[m];
+        summaryMerge(&rs->open[RS_LEVEL_MINUTE][m], &sec[m]);
+        summaryClear(&sec[m]);
+    }
+    rs->secondsClosed++;
+    rs->secondsInMinute++;
+
+    if (rs->secondsInMinute == RS_SECONDS_PER_MINUTE)
+    {
+        RsSummary *minute = rs->open[RS_LEVEL_MINUTE];
+        RsSummary *mslot = rs->minutes[rs->minutesClosed % RS_MINUTES_RING];
+        for (int m = 0; m < RS_METRIC_COUNT; m++)
+        {
+            mslot[m] = minute[m];
+            summaryMerge(&rs->open[RS_LEVEL_SESSION][m], &minute[m]);
+            summaryClear(&minute[m]);
+        }
+        rs->minutesClosed++;
+        rs->secondsInMinute = 0;
+    }
+}
+
+void rsAdvance(RollingStats *rs, uint32_t tMs)
+{
+    if (!rs->started)
+    {
+        rs->started = true;
+        rs->secondStartMs = tMs;
+        return;
+    }
+    while ((uint32_t)(tMs - rs->secondStartMs) >= RS_SECOND_MS)
+    {
+        rsCloseSecond(rs);
+        rs->secondStartMs += RS_SECOND_MS;
+    }
+}
+
+void rsAddRate(RollingStats *rs, uint32_t tMs, float rateMag)
+{
+    rsAdvance(rs, tMs);
+    summaryAdd(&rs->open[RS_LEVEL_SECOND][RS_RATE], RS_RATE, rateMag);
+}
+
+void rsAddDistance(RollingStats *rs, uint32_t tMs, float meters)
+{
+    rsAdvance(rs, tMs);
+    summaryAdd(&rs->open[RS_LEVEL_SECOND][RS_DISTANCE], RS_DISTANCE, meters);
+    rs->distanceThisSecond += meters;
+}
+
+void rsAddSteps(RollingStats *rs, uint32_t tMs, uint32_t steps)
+{
+    rsAdvance(rs, tMs);
+    rs->stepsThisSecond += (float)steps;
+}
+
+void rsCurrent(const RollingStats *rs, RsMetric m, RsLevel level, RsSummary *out)
+{
+    summaryClear(out);
+    for (int l = RS_LEVEL_SECOND; l <= level; l++)
+    {
+        summaryMerge(out, &rs->open[l][m]);
+    }
+}
+
+void rsLast(const RollingStats *rs, RsMetric m, RsLevel level, RsSummary *out)
+{
+    rsRecent(rs, m, level, 1, out);
+}
+
+void rsRecent(const RollingStats *rs, RsMetric m, RsLevel level, uint16_t n, RsSummary *out)
+{
+    summaryClear(out);
+    if (level == RS_LEVEL_SESSION)
+    {
+        summaryMerge(out, &rs->open[RS_LEVEL_SESSION][m]);
+        return;
+    }
+
+    uint32_t closed = (level == RS_LEVEL_SECOND) ? rs->secondsClosed : rs->minutesClosed;
+    uint32_t ring = (level == RS_LEVEL_SECOND) ? RS_SECONDS_RING : RS_MINUTES_RING;
+    if (n > closed)
+    {
+        n = (uint16_t)closed;
+    }
+    if (n > ring)
+    {
+        n = (uint16_t)ring;
+    }
+    for (uint32_t k = 1; k <= n; k++)
+    {
+        uint32_t idx = (closed - k) % ring;
+        summaryMerge(out, (level == RS_LEVEL_SECOND) ? &rs->seconds[idx][m] : &rs->minutes[idx][m]);
+    }
+}
+
+float rsMean(const RsSummary *s)
+{
+    return s->count ? (float)(s->sum / (double)s->count) : 0.0f;
+}
+
+float rsPercentile(const RsSummary *s, RsMetric m, float p)
+{
+    uint32_t total = 0;
+    for (int b = 0; b < RS_HIST_BINS; b++)
+    {
+        total += s->hist[b];
+    }
+    if (total == 0)
+    {
+        return 0.0f;
+    }
+
+    float target = p * (float)total;
+    float binWidth = kRangeMax[m] / RS_HIST_BINS;
+    uint32_t below = 0;
+    for (int b = 0; b < RS_HIST_BINS; b++)
+    {
+        if ((float)(below + s->hist[b]) >= target && s->hist[b] > 0)
+        {
+            // Linear interpolation inside the bin, clamped to the observed range
+            float v = binWidth * ((float)b + (target - (float)below) / (float)s->hist[b]);
+            return (v < s->min) ? s->min : ((v > s->max) ? s->max : v);
+        }
+        below += s->hist[b];
+    }
+    return s->max;
+}
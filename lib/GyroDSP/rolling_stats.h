@@ -0,0 +1,97 @@
+//=======================================================================================
+// HIERARCHICAL ROLLING STATISTICS: SECOND / MINUTE / SESSION
+//=======================================================================================
+// Keeps min / max / mean / percentile summaries of the motion metrics at three levels.
+// Raw samples only touch the open one-second bucket; when a second closes its summary is
+// pushed into the seconds ring and merged into the open minute, and when a minute closes
+// it is pushed into the minutes ring and merged into the session. This is the same
+// cascade as a time-series downsampling tree, so readers (display, telemetry) never see
+// raw samples and every per-level query is O(levels):
+//   rsCurrent(level)  open bucket of that level merged with the open buckets below it
+//   rsLast(level)     most recently closed bucket of that level (seconds / minutes)
+//   rsRecent(level,n) merge of the last n closed buckets of that level (O(n))
+//
+// Percentiles come from a fixed per-metric histogram. Histograms are mergeable, so the
+// upper levels stay exact to the bin width; when a 16-bit bin would overflow, every bin of
+// that summary is halved, which preserves the shape (and the percentiles) of the data.
+//
+// Speed (m/s) and cadence (steps/min) are derived once per second from the distance and
+// steps reported in that second.
+//
+// Nothing grows with the session length: the rings are fixed, counts are 64-bit and sums
+// double (a float session sum stops absorbing per-sample values after a few hours), so a
+// session can run indefinitely. The usual windows are rsRecent(RS_LEVEL_SECOND, 20) and
+// (.., 60) for the last 20 s and the last minute, rsCurrent(RS_LEVEL_SESSION) for all of it.
+//=======================================================================================
+#ifndef ROLLING_STATS_H
+#define ROLLING_STATS_H
+
+#include <stdint.h>
+
+#define RS_HIST_BINS 16                             // HISTOGRAM BINS PER SUMMARY
+#define RS_SECONDS_RING 60                          // CLOSED ONE-SECOND BUCKETS KEPT
+#define RS_MINUTES_RING 60                          // CLOSED ONE-MINUTE BUCKETS KEPT
+
+enum RsMetric : uint8_t
+{
+    RS_CADENCE = 0,                                 // STEPS PER MINUTE, ONE VALUE PER SECOND
+    RS_RATE,                                        // ANGULAR RATE MAGNITUDE (rad/s), EVERY SAMPLE
+    RS_DISTANCE,                                    // DISTANCE INCREMENTS (m), SUM = DISTANCE COVERED
+    RS_SPEED,                                       // METERS PER SECOND, ONE VALUE PER SECOND
+    RS_METRIC_COUNT
+};
+
+enum RsLevel : uint8_t
+{
+    RS_LEVEL_SECOND = 0,
+    RS_LEVEL_MINUTE,
+    RS_LEVEL_SESSION,
+    RS_LEVEL_COUNT
+};
+
+struct RsSummary
+{
+    uint64_t count;                                 // SAMPLES SUMMARISED
+    float min, max;
+    double sum;
+    uint16_t hist[RS_HIST_BINS];                    // HISTOGRAM OVER THE METRIC'S RANGE (SEE rsRangeMax)
+};
+
+struct RollingStats
+{
+    uint32_t secondStartMs;                         // START OF THE OPEN SECOND
+    uint16_t secondsInMinute;                       // CLOSED SECONDS IN THE OPEN MINUTE
+    bool started;
+
+    float stepsThisSecond;
+    float distanceThisSecond;
+
+    RsSummary open[RS_LEVEL_COUNT][RS_METRIC_COUNT];                 // OPEN BUCKET PER LEVEL (SESSION = CLOSED MINUTES)
+    RsSummary seconds[RS_SECONDS_RING][RS_METRIC_COUNT];             // CLOSED SECONDS
+    RsSummary minutes[RS_MINUTES_RING][RS_METRIC_COUNT];             // CLOSED MINUTES
+    uint32_t secondsClosed;                                          // TOTAL SECONDS CLOSED (RING HEAD = secondsClosed % RING)
+    uint32_t minutesClosed;                                          // TOTAL MINUTES CLOSED
+};
+
+// RESET ALL LEVELS
+void rsInit(RollingStats *rs);
+
+// ADVANCE TIME TO 'tMs', CLOSING EVERY SECOND (AND MINUTE) THAT HAS ENDED
+void rsAdvance(RollingStats *rs, uint32_t tMs);
+
+// REPORT MEASUREMENTS TAKEN AT 'tMs'
+void rsAddRate(RollingStats *rs, uint32_t tMs, float rateMag);
+void rsAddDistance(RollingStats *rs, uint32_t tMs, float meters);
+void rsAddSteps(RollingStats *rs, uint32_t tMs, uint32_t steps);
+
+// QUERIES (SEE HEADER COMMENT); rsLast / rsRecent RETURN AN EMPTY SUMMARY IF NOTHING CLOSED YET
+void rsCurrent(const RollingStats *rs, RsMetric m, RsLevel level, RsSummary *out);
+void rsLast(const RollingStats *rs, RsMetric m, RsLevel level, RsSummary *out);
+void rsRecent(const RollingStats *rs, RsMetric m, RsLevel level, uint16_t n, RsSummary *out);
+
+// SUMMARY HELPERS
+float rsMean(const RsSummary *s);
+float rsPercentile(const RsSummary *s, RsMetric m, float p);       // p IN [0, 1]
+float rsRangeMax(RsMetric m);                                      // UPPER EDGE OF THE HISTOGRAM
+
+#endif // ROLLING_STATS_H
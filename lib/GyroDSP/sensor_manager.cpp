@@ -0,0 +1,266 @@
+//=======================================================================================
+// SENSOR MANAGER: SEVERAL GYROS ON ONE SPI BUS (HARDWARE INDEPENDENT)
+//=======================================================================================
+#include "sensor_manager.h"
+#include <string.h>
+
+static const uint8_t smReadTx[GP_FRAME_SIZE] = { SM_READ_CMD, 0, 0, 0, 0, 0, 0 };
+
+// SIGNED DIFFERENCE OF TWO WRAPPING MICROSECOND TIMESTAMPS
+static inline int32_t smDiff(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b);
+}
+
+void smInit(SensorManager *m, uint8_t count, const SmDeviceConfig *config, uint32_t nowUs)
+{
+    m->count = count < SM_MAX_DEVICES ? count : SM_MAX_DEVICES;
+    for (uint8_t i = 0; i < SM_MAX_DEVICES; i++)
+    {
+        SmDevice *d = &m->dev[i];
+        d->config = (i < m->count) ? config[i] : SmDeviceConfig{ 0, false };
+        memset(d->frame, 0, sizeof(d->frame));
+        d->pending = false;
+        d->inFlight = false;
+        d->drdyUs = 0;
+        d->waitingUs = 0;
+        d->readDrdyUs = 0;
+        d->samples = 0;
+        d->missed = 0;
+        d->streamDrops = 0;
+        d->maxWaitUs = 0;
+        d->head.store(0, std::memory_order_relaxed);
+        d->tail.store(0, std::memory_order_relaxed);
+    }
+    m->cursor = 0;
+    m->busyUs = 0;
+    m->transfers = 0;
+    m->bytes = 0;
+    m->reportUs = nowUs;
+}
+
+void smDataReady(SensorManager *m, uint8_t group, uint32_t tUs)
+{
+    for (uint8_t i = 0; i < m->count; i++)
+    {
+        SmDevice *d = &m->dev[i];
+        if (d->config.group != group)
+        {
+            continue;
+        }
+        if (d->pending)
+        {
+            d->missed++;                            // The previous sample was never read; the sensor has overwritten it
+        }
+        else
+        {
+            d->waitingUs = tUs;
+        }
+        d->pending = true;
+        d->drdyUs = tUs;
+    }
+}
+
+bool smNextRead(SensorManager *m, uint32_t nowUs, SmRead *out)
+{
+    // Longest waiting first (a sample overwritten while pending keeps its place in line); ties,
+    // such as a group's shared DRDY, go round-robin from the device after the last one read
+    int best = -1;
+    for (uint8_t n = 0; n < m->count; n++)
+    {
+        uint8_t i = (uint8_t)((m->cursor + n) % m->count);
+        const SmDevice *d = &m->dev[i];
+        if (d->pending && !d->inFlight && (best < 0 || smDiff(d->waitingUs, m->dev[best].waitingUs) < 0))
+        {
+            best = i;
+        }
+    }
+    if (best < 0)
+    {
+        return false;
+    }
+    m->cursor = (uint8_t)((best + 1) % m->count);
+    SmDevice *d = &m->dev[best];
+    d->pending = false;
+    d->inFlight = true;
+    d->readDrdyUs = d->drdyUs;
+    int32_t waitUs = smDiff(nowUs, d->waitingUs);
+    if (waitUs > (int32_t)d->maxWaitUs)
+    {
+        d->maxWaitUs = (uint32_t)waitUs;
+    }
+    out->device = (uint8_t)best;
+    out->tx = smReadTx;
+    out->rx = d->frame;
+    out->len = GP_FRAME_SIZE;
+    out->drdyUs = d->drdyUs;
+    return true;
+}
+
+void smReadDone(SensorManager *m, uint8_t device, const uint8_t *frame, uint32_t busyUs)
+{
+    SmDevice *d = &m->dev[device];
+    d->inFlight = false;
+    d->samples++;
+    smBusTransfer(m, GP_FRAME_SIZE, busyUs);
+    if (!d->config.stream)
+    {
+        return;
+    }
+    uint32_t head = d->head.load(std::memory_order_relaxed);
+    if (head - d->tail.load(std::memory_order_acquire) >= SM_STREAM_LEN)
+    {
+        d->streamDrops++;                           // The consumer is behind: drop the newest sample
+        return;
+    }
+    SmSample *s = &d->ring[head & (SM_STREAM_LEN - 1)];
+    s->tUs = d->readDrdyUs;
+    gpDecodeFrame(frame, s->raw);
+    d->head.store(head + 1, std::memory_order_release);
+}
+
+void smReadCancel(SensorManager *m, uint8_t device)
+{
+    SmDevice *d = &m->dev[device];
+    d->inFlight = false;
+    d->missed++;
+}
+
+void smBusTransfer(SensorManager *m, uint32_t bytes, uint32_t busyUs)
+{
+    m->busyUs += busyUs;
+    m->transfers++;
+    m->bytes += bytes;
+}
+
+bool smGroupBusy(const SensorManager *m, uint8_t group)
+{
+    for (uint8_t i = 0; i < m->count; i++)
+    {
+        const SmDevice *d = &m->dev[i];
+        if (d->config.group == group && (d->pending || d->inFlight))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void smBusReport(SensorManager *m, uint32_t nowUs, SmBusReport *out)
+{
+    out->intervalUs = nowUs - m->reportUs;
+    out->busyUs = m->busyUs;
+    out->transfers = m->transfers;
+    out->bytes = m->bytes;
+    out->utilization = out->intervalUs ? (float)out->busyUs / (float)out->intervalUs : 0.0f;
+    m->busyUs = 0;
+    m->transfers = 0;
+    m->bytes = 0;
+    m->reportUs = nowUs;
+}
+
+bool smStreamPop(SensorManager *m, uint8_t device, SmSample *out)
+{
+    SmDevice *d = &m->dev[device];
+    uint32_t tail = d->tail.load(std::memory_order_relaxed);
+    if (tail == d->head.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    *out = d->ring[tail & (SM_STREAM_LEN - 1)];
+    d->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+
+//=======================================================================================
+// TIMESTAMP ALIGNMENT
+//=======================================================================================
+void smAlignInit(SmAligner *a, uint32_t periodUs)
+{
+    memset(a, 0, sizeof(*a));
+    a->periodUs = periodUs;
+}
+
+// ADVANCE DEVICE 'i' (HOLDING AT LEAST ONE SAMPLE) UNTIL ITS NEWEST SAMPLE IS AT OR AFTER 'tUs';
+// FALSE IF ITS STREAM RAN DRY FIRST
+static bool smAlignAdvance(SmAligner *a, SensorManager *m, uint8_t i, uint32_t tUs)
+{
+    while (smDiff(a->cur[i].tUs, tUs) < 0)
+    {
+        SmSample s;
+        if (!smStreamPop(m, i, &s))
+        {
+            return false;
+        }
+        a->prev[i] = a->cur[i];
+        a->cur[i] = s;
+        a->held[i] = 2;
+    }
+    return true;
+}
+
+bool smAlignNext(SmAligner *a, SensorManager *m, SmAligned *out)
+{
+    if (!a->started)
+    {
+        // The grid starts at the newest first sample, the first time every device has data
+        for (uint8_t i = 0; i < m->count; i++)
+        {
+            if (a->held[i] == 0)
+            {
+                if (!smStreamPop(m, i, &a->cur[i]))
+                {
+                    return false;
+                }
+                a->held[i] = 1;
+            }
+        }
+        a->nextUs = a->cur[0].tUs;
+        for (uint8_t i = 1; i < m->count; i++)
+        {
+            if (smDiff(a->cur[i].tUs, a->nextUs) > 0)
+            {
+                a->nextUs = a->cur[i].tUs;
+            }
+        }
+        a->started = true;
+    }
+
+    const uint32_t t = a->nextUs;
+    for (uint8_t i = 0; i < m->count; i++)
+    {
+        if (!smAlignAdvance(a, m, i, t))
+        {
+            return false;                           // Not every device has reached 't' yet; keep what was popped
+        }
+    }
+
+    out->tUs = t;
+    out->spanUs = 0;
+    for (uint8_t i = 0; i < m->count; i++)
+    {
+        const SmSample *c = &a->cur[i];
+        if (c->tUs == t || a->held[i] < 2)
+        {
+            for (int k = 0; k < GP_DIM_COUNT; k++)
+            {
+                out->raw[i][k] = c->raw[k];
+            }
+            continue;
+        }
+        const SmSample *p = &a->prev[i];
+        uint32_t span = c->tUs - p->tUs;
+        float w = (float)(t - p->tUs) / (float)span;
+        for (int k = 0; k < GP_DIM_COUNT; k++)
+        {
+            out->raw[i][k] = (float)p->raw[k] + w * (float)(c->raw[k] - p->raw[k]);
+        }
+        if (span > out->spanUs)
+        {
+            out->spanUs = span;
+        }
+    }
+    a->nextUs = t + a->periodUs;
+    return true;
+}
@@ -0,0 +1,157 @@
+//=======================================================================================
+// SENSOR MANAGER: SEVERAL GYROS ON ONE SPI BUS (HARDWARE INDEPENDENT)
+//=======================================================================================
+// Schedules the burst reads of up to SM_MAX_DEVICES L3GD20-class gyros that share one SPI
+// bus, each with its own chip select. Devices are wired in DRDY groups: one data-ready line
+// (or one device's line standing in for several running at the same ODR) triggers a read
+// of every device in its group. The manager does not touch the bus itself; the caller
+// (the firmware's acquisition queue, or a host simulation) drives it:
+//
+//   smDataReady(group, t)     DRDY edge: every device of the group now has a sample pending
+//   smNextRead(now, &read)    the next read to start (longest waiting first, so a group's reads
+//                             go out back to back); the caller clocks read.tx into read.rx
+//                             with the device's chip select asserted
+//   smReadDone(dev, frame)    the frame arrived: decode it, stamp it with its DRDY time and
+//                             push it to the device's stream
+//   smReadCancel(dev)         the caller could not start the read (counted as missed)
+//
+// All of the above run on one thread. Each device's stream is a single-producer /
+// single-consumer ring, so another thread (the DSP) can pop samples while reads land.
+// SmAligner resamples the streams of all devices onto one common time grid by linear
+// interpolation, so devices in different DRDY groups (or with different ODRs) line up.
+//
+// Bus utilization is the time the caller reports for each transfer (reads and any other
+// traffic such as register writes) over the elapsed time since the last report.
+//=======================================================================================
+#ifndef SENSOR_MANAGER_H
+#define SENSOR_MANAGER_H
+
+#include <atomic>
+#include <stdint.h>
+#include "gyro_pipeline.h"
+
+#define SM_MAX_DEVICES 4                            // GYROS ON THE BUS
+#define SM_MAX_GROUPS 4                             // DRDY LINES
+#define SM_STREAM_LEN 16                            // SAMPLES BUFFERED PER DEVICE (POWER OF TWO)
+#define SM_READ_CMD (0x28 | 0x80 | 0x40)            // OUT_X_L, READ = 1, AUTO-INCREMENT = 1
+
+static_assert((SM_STREAM_LEN & (SM_STREAM_LEN - 1)) == 0, "SM_STREAM_LEN must be a power of two");
+
+// ONE TIMESTAMPED SAMPLE OF ONE DEVICE
+struct SmSample
+{
+    uint32_t tUs;                                   // DRDY TIME OF THE SAMPLE
+    int16_t raw[GP_DIM_COUNT];
+};
+
+struct SmDeviceConfig
+{
+    uint8_t group;                                  // DRDY GROUP, 0..SM_MAX_GROUPS-1
+    bool stream;                                    // PUSH ITS SAMPLES TO ITS STREAM (FALSE: THE CALLER CONSUMES THE FRAME ITSELF)
+};
+
+struct SmDevice
+{
+    SmDeviceConfig config;
+    uint8_t frame[GP_FRAME_SIZE];                   // DEFAULT RECEIVE BUFFER (ONE READ IN FLIGHT PER DEVICE)
+    bool pending;                                   // DRDY SEEN, READ NOT STARTED
+    bool inFlight;                                  // READ STARTED, NOT DONE
+    uint32_t drdyUs;                                // DRDY TIME OF THE PENDING SAMPLE
+    uint32_t waitingUs;                             // FIRST DRDY SINCE THE LAST READ (SCHEDULING ORDER)
+    uint32_t readDrdyUs;                            // DRDY TIME OF THE SAMPLE IN FLIGHT
+
+    // Statistics
+    uint32_t samples;                               // READS COMPLETED
+    uint32_t missed;                                // SAMPLES OVERWRITTEN BEFORE THEY WERE READ, OR CANCELLED
+    uint32_t streamDrops;                           // SAMPLES LOST BECAUSE THE STREAM WAS FULL
+    uint32_t maxWaitUs;                             // WORST FIRST DRDY -> READ ISSUED
+
+    // Stream (producer: smReadDone, consumer: smStreamPop)
+    SmSample ring[SM_STREAM_LEN];
+    std::atomic<uint32_t> head;                     // WRITTEN BY THE PRODUCER
+    std::atomic<uint32_t> tail;                     // WRITTEN BY THE CONSUMER
+};
+
+// ONE READ TO PUT ON THE BUS
+struct SmRead
+{
+    uint8_t device;
+    const uint8_t *tx;                              // SM_READ_CMD FOLLOWED BY DUMMY BYTES
+    uint8_t *rx;                                    // DEVICE FRAME BUFFER; THE CALLER MAY RECEIVE ELSEWHERE
+    uint8_t len;                                    // GP_FRAME_SIZE
+    uint32_t drdyUs;
+};
+
+// BUS UTILIZATION SINCE THE PREVIOUS REPORT
+struct SmBusReport
+{
+    uint32_t intervalUs;
+    uint32_t busyUs;
+    uint32_t transfers;
+    uint32_t bytes;
+    float utilization;                              // busyUs / intervalUs
+};
+
+struct SensorManager
+{
+    uint8_t count;
+    SmDevice dev[SM_MAX_DEVICES];
+    uint8_t cursor;                                 // ROUND-ROBIN START FOR EQUALLY OLD READS
+
+    uint32_t busyUs, transfers, bytes;              // SINCE THE LAST smBusReport()
+    uint32_t reportUs;                              // TIME OF THE LAST smBusReport()
+};
+
+// CONFIGURE 'count' DEVICES AND CLEAR ALL STATE; 'nowUs' STARTS THE FIRST UTILIZATION INTERVAL
+void smInit(SensorManager *m, uint8_t count, const SmDeviceConfig *config, uint32_t nowUs);
+
+// DRDY OF 'group' AT 'tUs'
+void smDataReady(SensorManager *m, uint8_t group, uint32_t tUs);
+
+// TAKE THE NEXT PENDING READ (LONGEST WAITING, TIES ROUND-ROBIN), ISSUED AT 'nowUs'; FALSE IF NOTHING IS PENDING
+bool smNextRead(SensorManager *m, uint32_t nowUs, SmRead *out);
+
+// A READ TAKEN FROM smNextRead() FINISHED; 'frame' IS WHERE ITS BYTES LANDED, 'busyUs' ITS BUS TIME
+void smReadDone(SensorManager *m, uint8_t device, const uint8_t *frame, uint32_t busyUs);
+
+// A READ TAKEN FROM smNextRead() WILL NOT BE STARTED
+void smReadCancel(SensorManager *m, uint8_t device);
+
+// OTHER TRAFFIC ON THE SAME BUS (REGISTER WRITES ...)
+void smBusTransfer(SensorManager *m, uint32_t bytes, uint32_t busyUs);
+
+// TRUE IF ANY DEVICE OF 'group' HAS A READ PENDING OR IN FLIGHT
+bool smGroupBusy(const SensorManager *m, uint8_t group);
+
+// UTILIZATION SINCE THE PREVIOUS CALL (OR smInit), THEN START A NEW INTERVAL
+void smBusReport(SensorManager *m, uint32_t nowUs, SmBusReport *out);
+
+// CONSUMER SIDE OF A DEVICE STREAM; FALSE WHEN EMPTY
+bool smStreamPop(SensorManager *m, uint8_t device, SmSample *out);
+
+//=======================================================================================
+// TIMESTAMP ALIGNMENT (CONSUMER SIDE)
+//=======================================================================================
+// Emits one SmAligned per grid point t = t0 + k * periodUs, where t0 is the first time
+// every device has a sample at or before. Each device's value is interpolated between its
+// two samples around t. smAlignNext() returns false until every stream has reached t.
+struct SmAligned
+{
+    uint32_t tUs;
+    float raw[SM_MAX_DEVICES][GP_DIM_COUNT];        // INTERPOLATED RAW COUNTS
+    uint32_t spanUs;                                // WIDEST SAMPLE GAP INTERPOLATED ACROSS
+};
+
+struct SmAligner
+{
+    uint32_t periodUs;
+    uint32_t nextUs;                                // NEXT GRID POINT
+    bool started;
+    uint8_t held[SM_MAX_DEVICES];                   // SAMPLES HELD PER DEVICE (0..2)
+    SmSample prev[SM_MAX_DEVICES], cur[SM_MAX_DEVICES];
+};
+
+void smAlignInit(SmAligner *a, uint32_t periodUs);
+bool smAlignNext(SmAligner *a, SensorManager *m, SmAligned *out);
+
+#endif // SENSOR_MANAGER_H
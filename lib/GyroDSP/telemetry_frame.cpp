@@ -0,0 +1,135 @@
+//=======================================================================================
+// TELEMETRY FRAME CODEC (HARDWARE INDEPENDENT):
+//=======================================================================================
+#include "telemetry_frame.h"
+#include "ccm.h"
+
+// CRC-16/CCITT-FALSE (POLY 0x1021, INIT 0xFFFF), ONE LOOKUP PER BYTE; THE TABLE IS BUILT AT COMPILE TIME (CCM WHEN ENABLED, ELSE FLASH)
+struct TfCrcTable
+{
+    uint16_t v[256];
+};
+
+static constexpr TfCrcTable tfMakeCrcTable()
+{
+    TfCrcTable t = {};
+    for (int b = 0; b < 256; b++)
+    {
+        uint16_t c = (uint16_t)(b << 8);
+        for (int k = 0; k < 8; k++)
+        {
+            c = (c & 0x8000) ? (uint16_t)((c << 1) ^ 0x1021) : (uint16_t)(c << 1);
+        }
+        t.v[b] = c;
+    }
+    return t;
+}
+
+static constexpr TfCrcTable crcTable CCM_CONST = tfMakeCrcTable();
+
+uint16_t tfCrc16(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc = (uint16_t)((crc << 8) ^ crcTable.v[(uint8_t)((crc >> 8) ^ data[i])]);
+    }
+    return crc;
+}
+
+static inline void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put32(uint8_t *p, uint32_t v)
+{
+    put16(p, (uint16_t)v);
+    put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static inline uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get32(const uint8_t *p)
+{
+    return (uint32_t)get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+size_t tfEncode(uint8_t *out, const TfHeader *h, const int16_t (*raw)[GP_DIM_COUNT])
+{
+    out[0] = TF_SYNC0;
+    out[1] = TF_SYNC1;
+    out[2] = TF_VERSION;
+    out[3] = h->count;
+    put16(out + 4, h->deviceId);
+    put16(out + 6, h->seq);
+    put32(out + 8, h->t0Us);
+    put16(out + 12, h->periodUs);
+    put16(out + 14, h->flags);
+    put32(out + 16, h->sendUs);
+    uint8_t *p = out + TF_HEADER_SIZE;
+    for (uint8_t i = 0; i < h->count; i++)
+    {
+        for (int k = 0; k < GP_DIM_COUNT; k++)
+        {
+            put16(p, (uint16_t)raw[i][k]);
+            p += 2;
+        }
+    }
+    put16(p, tfCrc16(out + 2, (size_t)(p - out - 2)));
+    return (size_t)(p - out) + TF_CRC_SIZE;
+}
+
+TfStatus tfParse(const uint8_t *buf, size_t len, TfView *out, size_t *consumed)
+{
+    // Skip to the next sync pattern
+    size_t start = 0;
+    while (start + 1 < len && !(buf[start] == TF_SYNC0 && buf[start + 1] == TF_SYNC1))
+    {
+        start++;
+    }
+    if (start + 1 >= len)
+    {
+        *consumed = (len > 0 && buf[len - 1] == TF_SYNC0) ? len - 1 : len;   // Keep a trailing first sync byte
+        return TF_NEED_MORE;
+    }
+    if (start + TF_HEADER_SIZE > len)
+    {
+        *consumed = start;                          // A sync pattern with an incomplete header: keep it
+        return TF_NEED_MORE;
+    }
+
+    const uint8_t *f = buf + start;
+    uint8_t count = f[3];
+    if (f[2] != TF_VERSION || count > TF_MAX_SAMPLES || (count == 0) != ((get16(f + 14) & TF_SYNC_FLAGS) != 0))
+    {
+        *consumed = start + 1;                      // Not a frame after all: resync after this sync byte
+        return TF_BAD_FRAME;
+    }
+    size_t size = TF_FRAME_SIZE(count);
+    if (start + size > len)
+    {
+        *consumed = start;
+        return TF_NEED_MORE;
+    }
+    if (tfCrc16(f + 2, size - 2 - TF_CRC_SIZE) != get16(f + size - TF_CRC_SIZE))
+    {
+        *consumed = start + 1;
+        return TF_BAD_FRAME;
+    }
+
+    out->header.count = count;
+    out->header.deviceId = get16(f + 4);
+    out->header.seq = get16(f + 6);
+    out->header.t0Us = get32(f + 8);
+    out->header.periodUs = get16(f + 12);
+    out->header.flags = get16(f + 14);
+    out->header.sendUs = get32(f + 16);
+    out->payload = f + TF_HEADER_SIZE;
+    *consumed = start + size;
+    return TF_OK;
+}
@@ -0,0 +1,97 @@
+//=======================================================================================
+// TELEMETRY FRAME CODEC (HARDWARE INDEPENDENT):
+//=======================================================================================
+// Binary frame a unit streams its raw samples in (serial port, or TCP when simulated),
+// shared by the firmware's telemetry build and the host aggregation tools. All fields are
+// little-endian; the CRC covers everything after the sync bytes:
+//
+//   offset  size  field
+//   0       2     sync 0xA5 0x5A
+//   2       1     version (TF_VERSION)
+//   3       1     count: samples in the frame, 1..TF_MAX_SAMPLES (0: time-sync message)
+//   4       2     device id
+//   6       2     sequence number (wraps; a gap means lost frames)
+//   8       4     t0: device time of the first sample, us
+//   12      2     sample period, us (sample i was taken at t0 + i * period)
+//   14      2     flags (TF_FLAG_*)
+//   16      4     send time, us, in the sender's clock; 0 = unknown (the host load
+//                 generator stamps CLOCK_MONOTONIC so a server on the same host can
+//                 measure end-to-end latency)
+//   20      6n    samples: raw x, y, z int16 each
+//   20+6n   2     CRC-16/CCITT-FALSE of bytes 2 .. 20+6n-1
+//
+// Time-sync messages (see clock_sync.h) are frames without samples, flagged either
+// TF_FLAG_SYNC_REQ (unit -> host: seq = request number, send time = t1 in the unit's clock)
+// or TF_FLAG_SYNC_RESP (host -> unit: seq and device id echoed, t0 = t2 when the request
+// arrived, send time = t3, both in the host's clock).
+//
+// tfParse() works in place on a receive buffer: it finds the next frame and returns a view
+// whose payload points into that buffer, so nothing is copied until the samples are
+// decoded one by one with tfSample().
+//=======================================================================================
+#ifndef TELEMETRY_FRAME_H
+#define TELEMETRY_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "gyro_pipeline.h"
+
+#define TF_SYNC0 0xA5
+#define TF_SYNC1 0x5A
+#define TF_VERSION 1
+#define TF_HEADER_SIZE 20
+#define TF_CRC_SIZE 2
+#define TF_SAMPLE_SIZE (2 * GP_DIM_COUNT)
+#define TF_MAX_SAMPLES 32
+#define TF_FRAME_SIZE(n) (TF_HEADER_SIZE + (n) * TF_SAMPLE_SIZE + TF_CRC_SIZE)
+#define TF_MAX_FRAME_SIZE TF_FRAME_SIZE(TF_MAX_SAMPLES)
+
+#define TF_FLAG_SYNCED 0x0001                       // t0 AND THE SEND TIME ARE IN THE SHARED (TIME-SYNCED) TIMEBASE
+#define TF_FLAG_SYNC_REQ 0x0002                     // TIME-SYNC REQUEST (count = 0)
+#define TF_FLAG_SYNC_RESP 0x0004                    // TIME-SYNC RESPONSE (count = 0)
+#define TF_SYNC_FLAGS (TF_FLAG_SYNC_REQ | TF_FLAG_SYNC_RESP)
+
+struct TfHeader
+{
+    uint8_t count;
+    uint16_t deviceId;
+    uint16_t seq;
+    uint32_t t0Us;
+    uint16_t periodUs;
+    uint16_t flags;
+    uint32_t sendUs;
+};
+
+// A PARSED FRAME; 'payload' POINTS INTO THE BUFFER GIVEN TO tfParse()
+struct TfView
+{
+    TfHeader header;
+    const uint8_t *payload;
+};
+
+enum TfStatus : uint8_t
+{
+    TF_OK = 0,                                      // A FRAME; *consumed = BYTES UP TO AND INCLUDING IT
+    TF_NEED_MORE,                                   // NO COMPLETE FRAME; *consumed = LEADING BYTES THAT CAN BE DISCARDED
+    TF_BAD_FRAME                                    // CRC OR HEADER ERROR; *consumed = BYTES TO SKIP BEFORE RESYNCING
+};
+
+// ENCODE A FRAME OF h->count SAMPLES INTO 'out' (TF_FRAME_SIZE(count) BYTES); RETURNS ITS SIZE
+size_t tfEncode(uint8_t *out, const TfHeader *h, const int16_t (*raw)[GP_DIM_COUNT]);
+
+// FIND AND CHECK THE NEXT FRAME IN buf[0..len)
+TfStatus tfParse(const uint8_t *buf, size_t len, TfView *out, size_t *consumed);
+
+// SAMPLE i OF A PARSED FRAME
+static inline void tfSample(const TfView *v, uint8_t i, int16_t raw[GP_DIM_COUNT])
+{
+    const uint8_t *p = v->payload + i * TF_SAMPLE_SIZE;
+    for (int k = 0; k < GP_DIM_COUNT; k++)
+    {
+        raw[k] = (int16_t)((uint16_t)p[2 * k] | ((uint16_t)p[2 * k + 1] << 8));
+    }
+}
+
+uint16_t tfCrc16(const uint8_t *data, size_t len);
+
+#endif // TELEMETRY_FRAME_H
@@ -0,0 +1,101 @@
+//=======================================================================================
+// ONLINE MOTION THRESHOLD AUTO-TUNING:
+//=======================================================================================
+#include "threshold_tuner.h"
+#include "vec_math.h"
+
+static float clampf(float v, float lo, float hi)
+{
+    return (v < lo) ? lo : ((v > hi) ? hi : v);
+}
+
+void tunerInit(ThresholdTuner *t, float initialThreshold)
+{
+    t->alpha = TUNER_DEFAULT_ALPHA;
+    t->kEntry = TUNER_DEFAULT_K_ENTRY;
+    t->kExit = TUNER_DEFAULT_K_EXIT;
+    t->minThreshold = initialThreshold / 8.0f;
+    t->maxThreshold = initialThreshold * 8.0f;
+    t->warmup = TUNER_DEFAULT_WARMUP;
+    for (int a = 0; a < 3; a++)
+    {
+        t->mean[a] = 0.0f;
+        t->var[a] = 0.0f;
+        t->entry[a] = initialThreshold;
+        t->exit[a] = initialThreshold;
+    }
+    t->restSamples = 0;
+    t->moving = false;
+}
+
+static void tunerUpdateThresholds(ThresholdTuner *t)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        float sigma = vmSqrtF(t->var[i]);
+        t->entry[i] = clampf(t->kEntry * sigma, t->minThreshold, t->maxThreshold);
+        t->exit[i] = clampf(t->kExit * sigma, t->minThreshold, t->maxThreshold);
+    }
+}
+
+bool tunerUpdate(ThresholdTuner *t, const float x[3])
+{
+    // Hysteresis decision against the current thresholds
+    bool anyAboveEntry = false;
+    bool anyAboveExit = false;
+    for (int a = 0; a < 3; a++)
+    {
+        float d = x[a] - t->mean[a];
+        if (d < 0.0f)
+        {
+            d = -d;
+        }
+        anyAboveEntry |= (d >= t->entry[a]);
+        anyAboveExit |= (d >= t->exit[a]);
+    }
+    t->moving = t->moving ? anyAboveExit : anyAboveEntry;
+    if (t->moving)
+    {
+        return true;
+    }
+
+    // At rest: absorb the sample into the bias / noise estimates (West's EW variance update).
+    // The first samples use a larger weight so the estimates converge quickly from zero.
+    t->restSamples++;
+    float a = t->alpha;
+    if (t->restSamples < t->warmup)
+    {
+        a = 1.0f / (float)t->restSamples;
+        if (a < t->alpha)
+        {
+            a = t->alpha;
+        }
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        float delta = x[i] - t->mean[i];
+        t->mean[i] += a * delta;
+        t->var[i] = (1.0f - a) * (t->var[i] + a * delta * delta);
+    }
+
+    if (t->restSamples >= t->warmup)
+    {
+        tunerUpdateThresholds(t);
+    }
+    return false;
+}
+
+void tunerSeed(ThresholdTuner *t, const float mean[3], const float var[3])
+{
+    for (int i = 0; i < 3; i++)
+    {
+        t->mean[i] = mean[i];
+        t->var[i] = var[i];
+    }
+    if (t->restSamples < t->warmup)
+    {
+        t->restSamples = t->warmup;
+    }
+    t->moving = false;
+    tunerUpdateThresholds(t);
+}
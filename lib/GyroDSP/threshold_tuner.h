@@ -0,0 +1,55 @@
+//=======================================================================================
+// ONLINE MOTION THRESHOLD AUTO-TUNING:
+//=======================================================================================
+// Replaces a hand-tuned motion threshold with one derived from the sensor's own noise.
+// While the wearer is at rest, an exponentially weighted mean (bias) and variance (noise
+// floor) are tracked per axis. The thresholds follow them continuously:
+//   entry_i = clamp(kEntry * sigma_i)   IDLE   -> MOVING when any |x_i - bias_i| >= entry_i
+//   exit_i  = clamp(kExit  * sigma_i)   MOVING -> IDLE   when every |x_i - bias_i| <  exit_i
+// kExit < kEntry gives the hysteresis. Because bias and noise are re-estimated at every
+// rest period, the decision adapts to mounting position, sensor scaling and temperature
+// drift. Samples are never buffered: each update is O(1).
+//
+// Until 'warmup' rest samples have been seen the fixed initial threshold is used.
+//=======================================================================================
+#ifndef THRESHOLD_TUNER_H
+#define THRESHOLD_TUNER_H
+
+#include <stdint.h>
+
+#define TUNER_DEFAULT_ALPHA (1.0f / 256.0f)         // EW WEIGHT OF EACH REST SAMPLE
+#define TUNER_DEFAULT_K_ENTRY 6.0f                  // ENTRY THRESHOLD IN NOISE SIGMAS
+#define TUNER_DEFAULT_K_EXIT 3.0f                   // EXIT THRESHOLD IN NOISE SIGMAS
+#define TUNER_DEFAULT_WARMUP 64u                    // REST SAMPLES BEFORE THE LEARNT THRESHOLDS ARE USED
+
+struct ThresholdTuner
+{
+    // Configuration
+    float alpha;
+    float kEntry, kExit;
+    float minThreshold, maxThreshold;               // CLAMP ON THE LEARNT THRESHOLDS (INPUT UNITS)
+    uint32_t warmup;
+
+    // Rest statistics per axis
+    float mean[3];                                  // BIAS ESTIMATE
+    float var[3];                                   // NOISE VARIANCE ESTIMATE
+    uint32_t restSamples;                           // REST SAMPLES ABSORBED SO FAR
+
+    // Current decision
+    float entry[3];
+    float exit[3];
+    bool moving;
+};
+
+// 'initialThreshold' IS USED FOR BOTH ENTRY AND EXIT UNTIL WARM-UP COMPLETES; THE LEARNT
+// THRESHOLDS ARE CLAMPED TO [initialThreshold / 8, initialThreshold * 8]
+void tunerInit(ThresholdTuner *t, float initialThreshold);
+
+// FEED ONE 3-AXIS SAMPLE; RETURNS THE HYSTERESIS MOTION DECISION AND, AT REST, LEARNS FROM IT
+bool tunerUpdate(ThresholdTuner *t, const float x[3]);
+
+// START FROM A MEASURED BIAS AND NOISE VARIANCE (E.G. A BOOT CALIBRATION AT REST) INSTEAD OF
+// WARMING UP: THE LEARNT THRESHOLDS APPLY FROM THE NEXT SAMPLE AND THE EW UPDATE CONTINUES
+void tunerSeed(ThresholdTuner *t, const float mean[3], const float var[3]);
+
+#endif // THRESHOLD_TUNER_H
@@ -0,0 +1,53 @@
+//=======================================================================================
+// VECTOR MATH KERNELS: 3D NORM / HYPOT3
+//=======================================================================================
+#include "vec_math.h"
+
+uint32_t vmISqrt32(uint32_t v)
+{
+    if (v < 2u)
+    {
+        return v;
+    }
+
+    // Seed with 2^ceil(bits/2), which is always >= sqrt(v). From an over-estimate the
+    // Newton sequence decreases monotonically and stops exactly at floor(sqrt(v)).
+    uint32_t bits = 32u - (uint32_t)__builtin_clz(v);
+    uint32_t x = 1u << ((bits + 1u) >> 1);
+    for (;;)
+    {
+        uint32_t y = (x + v / x) >> 1;
+        if (y >= x)
+        {
+            return x;
+        }
+        x = y;
+    }
+}
+
+void vmNorm3FBatch(const float *x, const float *y, const float *z, float *out, uint32_t n)
+{
+    uint32_t i = 0;
+
+    // Two samples per iteration so the FPU multiply-accumulates of one sample overlap
+    // the VSQRT latency of the other.
+    for (; i + 1 < n; i += 2)
+    {
+        float s0 = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+        float s1 = x[i + 1] * x[i + 1] + y[i + 1] * y[i + 1] + z[i + 1] * z[i + 1];
+        out[i] = vmSqrtF(s0);
+        out[i + 1] = vmSqrtF(s1);
+    }
+    if (i < n)
+    {
+        out[i] = vmNorm3F(x[i], y[i], z[i]);
+    }
+}
+
+void vmNorm3I16Batch(const int16_t *xyz, uint16_t *out, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        out[i] = vmNorm3I16(xyz[3 * i], xyz[3 * i + 1], xyz[3 * i + 2]);
+    }
+}
@@ -0,0 +1,80 @@
+//=======================================================================================
+// VECTOR MATH KERNELS: 3D NORM / HYPOT3
+//=======================================================================================
+// Small set of magnitude kernels sized for the Cortex-M4F single-precision FPU.
+// 'sqrt()' on a float expression goes through the double-precision libm path on this
+// core (soft double + errno handling), which costs several hundred cycles per call.
+// These kernels keep everything in single precision or in integers.
+//
+// ERROR BOUNDS (relative to the exact real-valued result):
+//   vmSqrtF          correctly rounded (<= 0.5 ulp), VSQRT.F32 on target
+//   vmNorm3F         <= 2 ulp (3 products + 2 sums rounded, then one correctly rounded sqrt)
+//   vmInvSqrtF       <= 5.0e-6 relative (bit-trick seed + 2 Newton-Raphson steps)
+//   vmNorm3FastF     <= 5.0e-6 relative (s * rsqrt(s), no divide and no VSQRT)
+//   vmISqrt32        exact floor(sqrt(v))
+//   vmNorm3I16       exact floor(|v|) for raw int16 triples (sum of squares fits in 32 bits)
+// Inputs are assumed finite; the float kernels return 0 for a zero vector.
+//=======================================================================================
+#ifndef VEC_MATH_H
+#define VEC_MATH_H
+
+#include <stdint.h>
+#include <math.h>
+
+// SINGLE-PRECISION SQUARE ROOT (VSQRT.F32 WHEN AN FPU IS PRESENT)
+static inline float vmSqrtF(float x)
+{
+#if defined(__ARM_FP) && (__ARM_FP & 0x4)
+    float r;
+    __asm__("vsqrt.f32 %0, %1" : "=t"(r) : "t"(x));
+    return r;
+#else
+    return sqrtf(x);
+#endif
+}
+
+// EUCLIDEAN NORM OF (x, y, z) IN SINGLE PRECISION
+static inline float vmNorm3F(float x, float y, float z)
+{
+    return vmSqrtF(x * x + y * y + z * z);
+}
+
+// RECIPROCAL SQUARE ROOT: BIT-TRICK SEED REFINED BY TWO NEWTON-RAPHSON STEPS
+static inline float vmInvSqrtF(float x)
+{
+    union { float f; uint32_t u; } v = { x };
+    v.u = 0x5f375a86u - (v.u >> 1);                         // Initial estimate (~3.4% error)
+    float half = 0.5f * x;
+    v.f = v.f * (1.5f - half * v.f * v.f);                  // 1st Newton step (~1.7e-3)
+    v.f = v.f * (1.5f - half * v.f * v.f);                  // 2nd Newton step (~5e-6)
+    return v.f;
+}
+
+// EUCLIDEAN NORM VIA RSQRT (ONLY MULTIPLIES, USEFUL WHERE 1/|v| IS ALSO NEEDED)
+static inline float vmNorm3FastF(float x, float y, float z)
+{
+    float s = x * x + y * y + z * z;
+    if (s <= 0.0f)
+    {
+        return 0.0f;
+    }
+    return s * vmInvSqrtF(s);
+}
+
+// INTEGER SQUARE ROOT: floor(sqrt(v)) USING NEWTON ITERATION FROM A CLZ SEED
+uint32_t vmISqrt32(uint32_t v);
+
+// FIXED-POINT NORM OF A RAW int16 TRIPLE: floor(sqrt(x^2 + y^2 + z^2)), RANGE 0..56755
+static inline uint16_t vmNorm3I16(int16_t x, int16_t y, int16_t z)
+{
+    uint32_t s = (uint32_t)((int32_t)x * x) + (uint32_t)((int32_t)y * y) + (uint32_t)((int32_t)z * z);
+    return (uint16_t)vmISqrt32(s);
+}
+
+// BATCHED FORMS:
+// Float form takes structure-of-arrays components, integer form takes interleaved raw
+// xyz triples exactly as they are decoded from the gyroscope output registers.
+void vmNorm3FBatch(const float *x, const float *y, const float *z, float *out, uint32_t n);
+void vmNorm3I16Batch(const int16_t *xyz, uint16_t *out, uint32_t n);
+
+#endif // VEC_MATH_H
@@ -0,0 +1,126 @@
+//=======================================================================================
+// ON-TARGET SRAM VS. CCM PLACEMENT BENCHMARKS (BENCHMARK BUILD ONLY):
+//=======================================================================================
+// Two GyroPipeline instances run the same synthetic 190 Hz swing: one in .bss (main SRAM),
+// one placed with CCM_BSS. Each is timed twice: with the DMA2D idle, and with the DMA2D
+// restarted whenever it finishes on a memory-to-memory copy of a 64x32 strip of the LCD
+// framebuffer (SDRAM) into an SRAM scratch buffer, while the LTDC keeps scanning out. The
+// DMA2D writes then compete with the CPU for the SRAM port of the bus matrix; CCM is on
+// the D-bus and should not notice. The idle and loaded kernels run the same instructions
+// (the restart check is a register read either way), so the difference is the contention.
+//
+// Without GYRO_CCM both instances are in SRAM and the "ccm" rows equal the "sram" rows.
+// The DMA2D is left idle; the BSP reprograms it on its next fill.
+//=======================================================================================
+#ifdef GYRO_BENCH
+#include "ccm_bench.h"
+#include "ccm.h"
+#include "drivers/LCD_DISCO_F429ZI.h"
+#include "gyro_bench.h"
+#include "gyro_pipeline.h"
+#include "stm32f4xx_hal.h"
+#include <math.h>
+
+#define CCM_BENCH_LEN 512                           // LENGTH OF THE SYNTHETIC RAW SEQUENCE
+#define CCM_BENCH_PERIOD_US 5263                    // 190 Hz ODR
+#define CCM_BENCH_DMA_PIXELS 64                     // DMA2D COPY: PIXELS PER LINE (ARGB8888)
+#define CCM_BENCH_DMA_LINES 32                      // DMA2D COPY: LINES (8 KB PER TRANSFER)
+#define CCM_BENCH_LCD_WIDTH 240                     // FRAMEBUFFER LINE LENGTH, PIXELS
+
+static int16_t ccmRaw[CCM_BENCH_LEN][GP_DIM_COUNT];
+static GyroPipeline sramPipe;                       // Main SRAM (.bss)
+static GyroPipeline ccmPipe CCM_BSS;                // CCM with GYRO_CCM
+static uint32_t sramTimeUs = 0, ccmTimeUs = 0;      // Sample clocks, keep running across repetitions
+static uint32_t dmaScratch[CCM_BENCH_DMA_PIXELS * CCM_BENCH_DMA_LINES];  // DMA2D target, main SRAM
+static bool dmaLoad = false;
+static uint32_t dmaTransfers = 0;
+static volatile float ccmSink;
+
+static void ccmFill()
+{
+    uint32_t seed = 4242u;
+    for (int i = 0; i < CCM_BENCH_LEN; i++)
+    {
+        for (int a = 0; a < GP_DIM_COUNT; a++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            float swing = 9000.0f * sinf(6.2831853f * 1.8f * i / 190.0f + 2.0f * a);
+            ccmRaw[i][a] = (int16_t)(swing + (float)((int32_t)(seed >> 24) - 128));
+        }
+    }
+    gpInit(&sramPipe, GP_ACT_WINDOW_MS);
+    gpInit(&ccmPipe, GP_ACT_WINDOW_MS);
+    sramTimeUs = 0;
+    ccmTimeUs = 0;
+}
+
+// Memory-to-memory, ARGB8888 in and out, no interrupts: framebuffer strip -> dmaScratch
+static void dma2dSetup()
+{
+    __HAL_RCC_DMA2D_CLK_ENABLE();
+    while ((DMA2D->CR & DMA2D_CR_START) != 0)
+    {
+    }
+    DMA2D->CR = 0;
+    DMA2D->FGMAR = LCD_FRAME_BUFFER;
+    DMA2D->FGOR = CCM_BENCH_LCD_WIDTH - CCM_BENCH_DMA_PIXELS;
+    DMA2D->FGPFCCR = 0;
+    DMA2D->OMAR = (uint32_t)dmaScratch;
+    DMA2D->OOR = 0;
+    DMA2D->OPFCCR = 0;
+    DMA2D->NLR = ((uint32_t)CCM_BENCH_DMA_PIXELS << DMA2D_NLR_PL_Pos) | CCM_BENCH_DMA_LINES;
+}
+
+static inline void dma2dKeepBusy()
+{
+    if ((DMA2D->CR & DMA2D_CR_START) == 0 && dmaLoad)
+    {
+        DMA2D->CR |= DMA2D_CR_START;
+        dmaTransfers++;
+    }
+}
+
+static void runPipe(GyroPipeline *p, uint32_t *timeUs, uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        dma2dKeepBusy();
+        *timeUs += CCM_BENCH_PERIOD_US;
+        gpProcess(p, *timeUs, ccmRaw[i % CCM_BENCH_LEN]);
+    }
+    ccmSink = p->totalDist;
+}
+
+static void caseSram(uint32_t ops)
+{
+    runPipe(&sramPipe, &sramTimeUs, ops);
+}
+
+static void caseCcm(uint32_t ops)
+{
+    runPipe(&ccmPipe, &ccmTimeUs, ops);
+}
+
+void benchRunCcm()
+{
+    ccmFill();
+    dma2dSetup();
+    printf("ccm/placement: GyroPipeline %u bytes, sram copy at 0x%08lx, ccm copy at 0x%08lx\n", (unsigned)sizeof(GyroPipeline),
+           (unsigned long)(uintptr_t)&sramPipe, (unsigned long)(uintptr_t)&ccmPipe);
+
+    dmaLoad = false;
+    benchPrint(benchRun("ccm/gpProcess-sram", caseSram, 256, 16));
+    benchPrint(benchRun("ccm/gpProcess-ccm", caseCcm, 256, 16));
+
+    dmaLoad = true;
+    dmaTransfers = 0;
+    benchPrint(benchRun("ccm/gpProcess-sram+dma2d", caseSram, 256, 16));
+    benchPrint(benchRun("ccm/gpProcess-ccm+dma2d", caseCcm, 256, 16));
+    dmaLoad = false;
+    while ((DMA2D->CR & DMA2D_CR_START) != 0)
+    {
+    }
+    printf("ccm/dma2d: %lu transfers of %u bytes during the loaded cases\n", (unsigned long)dmaTransfers,
+           (unsigned)sizeof(dmaScratch));
+}
+#endif
@@ -0,0 +1,11 @@
+//=======================================================================================
+// ON-TARGET SRAM VS. CCM PLACEMENT BENCHMARKS (BENCHMARK BUILD ONLY):
+//=======================================================================================
+#ifndef CCM_BENCH_H
+#define CCM_BENCH_H
+
+// TIME THE PER-SAMPLE FILTER/FSM PATH (gpProcess) WITH ITS STATE IN SRAM AND IN CCM, WITH THE
+// DMA2D IDLE AND WITH THE DMA2D COPYING FROM THE LCD FRAMEBUFFER INTO SRAM NON-STOP
+void benchRunCcm();
+
+#endif // CCM_BENCH_H
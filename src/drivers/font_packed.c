@@ -0,0 +1,97 @@
+//=======================================================================================
+// RUN-LENGTH CODED FONT SUBSETS WITH AN SDRAM GLYPH CACHE (see font_packed.h)
+//=======================================================================================
+#include "font_packed.h"
+#include <string.h>
+
+static uint32_t cacheUsed = 0;                      // BYTES OF THE SDRAM CACHE REGION HANDED OUT
+static uint32_t scratchRows[FONT_PACKED_MAX_HEIGHT];  // FALLBACK WHEN A FONT DOES NOT FIT THE CACHE
+
+#ifdef FONT_HOST_CACHE
+static uint32_t hostCache[FONT_CACHE_SIZE / sizeof(uint32_t)];  // HOST BUILDS (tools/font_check.cpp): NO SDRAM
+#define FONT_CACHE_BASE ((uintptr_t)hostCache)
+#else
+#define FONT_CACHE_BASE ((uintptr_t)FONT_CACHE_ADDR)
+#endif
+
+static uint32_t *FONT_CacheAlloc(uint32_t bytes)
+{
+  if (bytes > FONT_CACHE_SIZE - cacheUsed)
+  {
+    return NULL;
+  }
+  uint32_t *rows = (uint32_t *)(FONT_CACHE_BASE + cacheUsed);
+  cacheUsed += bytes;
+  return rows;
+}
+
+// Decodes one glyph's runs into row masks (built in SRAM, written to the cache row by row)
+static void FONT_Unpack(const FontPacked *p, uint8_t index, uint16_t width, uint16_t height, uint32_t *rows)
+{
+  uint32_t local[FONT_PACKED_MAX_HEIGHT];
+  uint32_t x = 0, y = 0, color = 0;
+  uint32_t first = (uint32_t)p->Offset[index] * 2u, last = (uint32_t)p->Offset[index + 1] * 2u;
+
+  memset(local, 0, sizeof(local));
+  for (uint32_t k = first; k < last && y < height; k++)
+  {
+    uint32_t run = (k & 1u) ? (p->Runs[k >> 1] & 0x0Fu) : (p->Runs[k >> 1] >> 4);
+    for (uint32_t n = run; n > 0 && y < height; n--)
+    {
+      local[y] |= color << x;
+      if (++x == width)
+      {
+        x = 0;
+        y++;
+      }
+    }
+    if (run != 15u)
+    {
+      color ^= 1u;
+    }
+  }
+  for (uint32_t i = 0; i < height; i++)
+  {
+    rows[i] = local[i];
+  }
+}
+
+const uint32_t *FONT_Glyph(const sFONT *font, uint8_t Ascii)
+{
+  FontPacked *p = font->Packed;
+  uint8_t index = FONT_PACKED_NONE;
+  if (Ascii >= FONT_PACKED_FIRST && Ascii < FONT_PACKED_FIRST + FONT_PACKED_CHARS)
+  {
+    index = p->Map[Ascii - FONT_PACKED_FIRST];
+  }
+  if (index == FONT_PACKED_NONE)
+  {
+    p->Misses++;
+    index = p->Fallback;
+  }
+
+  if (p->Cache == NULL)
+  {
+    p->Cache = FONT_CacheAlloc((uint32_t)p->Count * font->Height * sizeof(uint32_t));
+    if (p->Cache == NULL)
+    {
+      FONT_Unpack(p, index, font->Width, font->Height, scratchRows);  // No room: unpack on every draw
+      return scratchRows;
+    }
+  }
+  uint32_t *rows = p->Cache + (uint32_t)index * font->Height;
+  if (!p->Valid[index])
+  {
+    FONT_Unpack(p, index, font->Width, font->Height, rows);
+    p->Valid[index] = 1;
+    p->Unpacked++;
+  }
+  return rows;
+}
+
+void FONT_Invalidate(const sFONT *font)
+{
+  FontPacked *p = font->Packed;
+  memset(p->Valid, 0, p->Count);
+  p->Unpacked = 0;
+}
@@ -0,0 +1,61 @@
+//=======================================================================================
+// RUN-LENGTH CODED FONT SUBSETS WITH AN SDRAM GLYPH CACHE
+//=======================================================================================
+// tools/font_subset.py (a PlatformIO extra script) keeps only the glyphs the firmware can
+// draw and generates a FontPacked plus the sFONT pointing at it; the stock font*.c tables
+// are not linked. In flash every glyph is a run-length code of its pixels, row by row from
+// the top left: one nibble per run, runs alternate between background and foreground
+// starting with background, and a 15 is a run of 15 that does not switch colour (so longer
+// runs chain). A glyph starts on a byte boundary and ends with its last foreground run;
+// the pixels after it are background.
+//
+// FONT_Glyph() unpacks a glyph the first time it is drawn into a cache in SDRAM, as one
+// 32-bit mask per row with bit 0 the leftmost column, and returns the cached rows after
+// that. BSP_LCD_DisplayChar() draws packed fonts from those masks straight into the layer.
+// Characters outside the subset draw as the fallback glyph ('?') and are counted in
+// Misses: a non-zero count means the subset misses a character the UI now prints.
+//=======================================================================================
+#ifndef FONT_PACKED_H
+#define FONT_PACKED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fonts.h"
+
+#define FONT_PACKED_FIRST      ' '          /* Map[0] is the glyph of ' ' ... */
+#define FONT_PACKED_CHARS      95           /* ... Map[94] the glyph of '~' */
+#define FONT_PACKED_NONE       0xFF         /* Map entry of a character outside the subset */
+#define FONT_PACKED_MAX_HEIGHT 32           /* Row masks are 32 bits: up to 32x32 pixel glyphs */
+
+/* Glyph cache: SDRAM above the LCD layers and the conversion buffer (LCD_FRAME_BUFFER + 0x300000) */
+#define FONT_CACHE_ADDR        0xD0300000u
+#define FONT_CACHE_SIZE        0x10000u
+
+typedef struct _tFontPacked
+{
+  uint8_t        Count;                     /* Glyphs in the subset */
+  uint8_t        Fallback;                  /* Subset index drawn for characters outside the subset */
+  const uint8_t  *Map;                      /* Ascii - FONT_PACKED_FIRST -> subset index or FONT_PACKED_NONE */
+  const uint16_t *Offset;                   /* Subset index -> first byte of its runs (Count + 1 entries) */
+  const uint8_t  *Runs;                     /* All glyphs' run nibbles, high nibble first */
+  uint8_t        *Valid;                    /* Subset index -> unpacked into the cache yet (SRAM) */
+  uint32_t       *Cache;                    /* Count x Height row masks in SDRAM, allocated on first use */
+  uint32_t       Unpacked;                  /* Glyphs unpacked so far */
+  uint32_t       Misses;                    /* Characters drawn that are not in the subset */
+} FontPacked;
+
+/* Row masks of the glyph for 'Ascii', unpacked on first use; Height entries */
+const uint32_t *FONT_Glyph(const sFONT *font, uint8_t Ascii);
+
+/* Drops every cached glyph of the font, so the next draws unpack again (benchmarks) */
+void FONT_Invalidate(const sFONT *font);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FONT_PACKED_H */
@@ -65,11 +65,14 @@
 /** @defgroup FONTS_Exported_Types
   * @{
   */ 
+struct _tFontPacked;
+
 typedef struct _tFont
 {    
   const uint8_t *table;
   uint16_t Width;
   uint16_t Height;
+  struct _tFontPacked *Packed;  /* Run-length coded subset (font_packed.h); table is NULL then */
   
 } sFONT;
 
@@ -37,10 +37,20 @@
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f429i_discovery.h"
 #include "cmsis_nvic.h" // // Added for mbed
+#include "cmsis_os2.h"
 
 // Added for mbed. This function replaces HAL_Delay()
+// From a thread with the kernel running it sleeps, so the 400 ms of panel power-up
+// delays in ili9341_Init() leave the CPU to the other threads.
 void wait_ms(int ms){
-  HAL_Delay(ms);
+  if ((__get_IPSR() == 0U) && (osKernelGetState() == osKernelRunning))
+  {
+    osDelay((uint32_t)ms);
+  }
+  else
+  {
+    HAL_Delay(ms);
+  }
 };
 
 /** @defgroup BSP BSP
@@ -141,6 +151,7 @@ static uint32_t           SPIx_Read(uint8_t ReadSize);
 static uint8_t            SPIx_WriteRead(uint8_t Byte);
 static void               SPIx_Error(void);
 static void               SPIx_MspInit(SPI_HandleTypeDef *hspi);
+static void               LCD_IO_Acquire(void);
 
 /* Link function for LCD peripheral */
 void                      LCD_IO_Init(void);
@@ -784,6 +795,30 @@ static void SPIx_MspInit(SPI_HandleTypeDef *hspi)
 
 /********************************* LINK LCD ***********************************/
 
+/**
+  * @brief  Shared SPI bus hooks (see stm32f429i_discovery.h). Default: the LCD is the only user.
+  */
+__weak void LCD_IO_BusAcquire(void)
+{
+}
+
+__weak void LCD_IO_BusRelease(void)
+{
+}
+
+/**
+  * @brief  Takes the bus for one LCD access and restores the LCD's SPI configuration,
+  *         which another user of the bus may have changed.
+  */
+static void LCD_IO_Acquire(void)
+{
+  LCD_IO_BusAcquire();
+  if(HAL_SPI_GetState(&SpiHandle) != HAL_SPI_STATE_RESET)
+  {
+    HAL_SPI_Init(&SpiHandle);
+  }
+}
+
 /**
   * @brief  Configures the LCD_SPI interface.
   */
@@ -824,7 +859,9 @@ void LCD_IO_Init(void)
     LCD_CS_LOW();
     LCD_CS_HIGH();
     
+    LCD_IO_BusAcquire();
     SPIx_Init();
+    LCD_IO_BusRelease();
   }
 }
 
@@ -833,6 +870,8 @@ void LCD_IO_Init(void)
   */
 void LCD_IO_WriteData(uint16_t RegValue) 
 {
+  LCD_IO_Acquire();
+
   /* Set WRX to send data */
   LCD_WRX_HIGH();
   
@@ -842,6 +881,8 @@ void LCD_IO_WriteData(uint16_t RegValue)
   
   /* Deselect: Chip Select high */
   LCD_CS_HIGH();
+
+  LCD_IO_BusRelease();
 }
 
 /**
@@ -849,6 +890,8 @@ void LCD_IO_WriteData(uint16_t RegValue)
   */
 void LCD_IO_WriteReg(uint8_t Reg) 
 {
+  LCD_IO_Acquire();
+
   /* Reset WRX to send command */
   LCD_WRX_LOW();
   
@@ -858,6 +901,8 @@ void LCD_IO_WriteReg(uint8_t Reg)
   
   /* Deselect: Chip Select high */
   LCD_CS_HIGH();
+
+  LCD_IO_BusRelease();
 }
 
 /**
@@ -870,6 +915,8 @@ uint32_t LCD_IO_ReadData(uint16_t RegValue, uint8_t ReadSize)
 {
   uint32_t readvalue = 0;
 
+  LCD_IO_Acquire();
+
   /* Select: Chip Select low */
   LCD_CS_LOW();
 
@@ -885,6 +932,8 @@ uint32_t LCD_IO_ReadData(uint16_t RegValue, uint8_t ReadSize)
 
   /* Deselect: Chip Select high */
   LCD_CS_HIGH();
+
+  LCD_IO_BusRelease();
   
   return readvalue;
 }
@@ -324,6 +324,13 @@ void     BSP_LED_Toggle(Led_TypeDef Led);
 void     BSP_PB_Init(Button_TypeDef Button, ButtonMode_TypeDef ButtonMode);
 uint32_t BSP_PB_GetState(Button_TypeDef Button);
 
+/* SPI5 is shared by the LCD controller and the gyroscope. Every LCD register access is
+   wrapped in these two calls; the defaults do nothing, an application that drives the
+   gyroscope on the same bus from another thread overrides them to keep its transfers
+   off the bus meanwhile (the bus configuration is re-applied after the acquire). */
+void     LCD_IO_BusAcquire(void);
+void     LCD_IO_BusRelease(void);
+
 /**
   * @}
   */ 
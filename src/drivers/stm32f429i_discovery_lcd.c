@@ -74,6 +74,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f429i_discovery_lcd.h"
 #include "fonts.h"
+#include "font_packed.h"
 //#include "font24.c"
 //#include "font20.c"
 //#include "font16.c"
@@ -136,6 +137,7 @@ LCD_DrvTypeDef  *LcdDrv;
   * @{
   */ 
 static void DrawChar(uint16_t Xpos, uint16_t Ypos, const uint8_t *c);
+static void DrawGlyph(uint16_t Xpos, uint16_t Ypos, const uint32_t *rows);
 static void FillBuffer(uint32_t LayerIndex, void *pDst, uint32_t xSize, uint32_t ySize, uint32_t OffLine, uint32_t ColorIndex);
 static void ConvertLineToARGB8888(void *pSrc, void *pDst, uint32_t xSize, uint32_t ColorMode);
 /**
@@ -276,7 +278,7 @@ void BSP_LCD_LayerDefaultInit(uint16_t LayerIndex, uint32_t FB_Address)
   HAL_LTDC_ConfigLayer(&LtdcHandler, &Layercfg, LayerIndex); 
 
   DrawProp[LayerIndex].BackColor = LCD_COLOR_WHITE;
-  DrawProp[LayerIndex].pFont     = &Font24;
+  DrawProp[LayerIndex].pFont     = &LCD_DEFAULT_FONT;
   DrawProp[LayerIndex].TextColor = LCD_COLOR_BLACK; 
 
   /* Dithering activation */
@@ -594,6 +596,11 @@ void BSP_LCD_ClearStringLine(uint32_t Line)
   */
 void BSP_LCD_DisplayChar(uint16_t Xpos, uint16_t Ypos, uint8_t Ascii)
 {
+  if(DrawProp[ActiveLayer].pFont->Packed != NULL)
+  {
+    DrawGlyph(Xpos, Ypos, FONT_Glyph(DrawProp[ActiveLayer].pFont, Ascii));
+    return;
+  }
   DrawChar(Xpos, Ypos, &DrawProp[ActiveLayer].pFont->table[(Ascii-' ') *\
               DrawProp[ActiveLayer].pFont->Height * ((DrawProp[ActiveLayer].pFont->Width + 7) / 8)]);
 }
@@ -1365,6 +1372,35 @@ static void DrawChar(uint16_t Xpos, uint16_t Ypos, const uint8_t *c)
   }
 }
 
+/**
+  * @brief  Draws a character of a packed font from its unpacked row masks (font_packed.h).
+  * @param  Xpos: start column address
+  * @param  Ypos: the Line where to display the character shape
+  * @param  rows: one mask per line, bit 0 = leftmost column
+  */
+static void DrawGlyph(uint16_t Xpos, uint16_t Ypos, const uint32_t *rows)
+{
+  uint32_t i = 0, j = 0, bits = 0;
+  uint32_t xsize = BSP_LCD_GetXSize();
+  uint16_t height = DrawProp[ActiveLayer].pFont->Height;
+  uint16_t width  = DrawProp[ActiveLayer].pFont->Width;
+  uint32_t textcolor = DrawProp[ActiveLayer].TextColor;
+  uint32_t backcolor = DrawProp[ActiveLayer].BackColor;
+  __IO uint32_t *pixel = (__IO uint32_t *)LtdcHandler.LayerCfg[ActiveLayer].FBStartAdress + (Ypos * xsize + Xpos);
+
+  /* Same pixels as DrawChar(), without a BSP_LCD_DrawPixel() call and address computation per pixel */
+  for(i = 0; i < height; i++)
+  {
+    bits = rows[i];
+    for(j = 0; j < width; j++)
+    {
+      pixel[j] = (bits & 1U) ? textcolor : backcolor;
+      bits >>= 1;
+    }
+    pixel += xsize;
+  }
+}
+
 /**
   * @brief  Fills buffer.
   * @param  LayerIndex: layer index
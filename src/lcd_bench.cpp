@@ -0,0 +1,69 @@
+//=======================================================================================
+// ON-TARGET LCD RENDERING BENCHMARKS (BENCHMARK BUILD ONLY):
+//=======================================================================================
+// The BSP keeps DrawChar() and FillBuffer() static, so they are timed through the calls
+// the application makes: DisplayChar() is one DrawChar(), DisplayStringAt() is the text
+// path used by CALC_ScreenDisp(), and FillRect() / Clear() are one DMA2D register-to-memory
+// FillBuffer() each (a text line and the whole 240x320 layer). The screen is left cleared.
+// The font is the packed Font16 subset: the "-unpack" case drops the glyph cache before
+// every string, so it adds the run-length decoding of each glyph to the draw.
+//=======================================================================================
+#ifdef GYRO_BENCH
+#include "lcd_bench.h"
+#include "gyro_bench.h"
+#include "drivers/font_packed.h"
+
+static LCD_DISCO_F429ZI *benchLcd;
+
+static void caseDrawChar(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        benchLcd->DisplayChar((uint16_t)((i % 16) * 15), LINE(4), (uint8_t)('A' + i % 26));
+    }
+}
+
+static void caseDisplayStringAt(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        benchLcd->DisplayStringAt(0, LINE(10), (uint8_t *)"Current Calc: 12.345 m", CENTER_MODE);
+    }
+}
+
+static void caseDisplayStringAtUnpack(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        FONT_Invalidate(benchLcd->GetFont());
+        benchLcd->DisplayStringAt(0, LINE(10), (uint8_t *)"Current Calc: 12.345 m", CENTER_MODE);
+    }
+}
+
+static void caseFillLine(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        benchLcd->FillRect(0, LINE(12), 240, 20);
+    }
+}
+
+static void caseClear(uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        benchLcd->Clear(LCD_COLOR_BLACK);
+    }
+}
+
+void benchRunLcd(LCD_DISCO_F429ZI *lcd)
+{
+    benchLcd = lcd;
+    benchPrint(benchRun("lcd/DrawChar", caseDrawChar, 64, 8));
+    benchPrint(benchRun("lcd/DisplayStringAt-22ch", caseDisplayStringAt, 16, 8));
+    benchPrint(benchRun("lcd/DisplayStringAt-22ch-unpack", caseDisplayStringAtUnpack, 16, 8));
+    benchPrint(benchRun("lcd/FillBuffer-240x20", caseFillLine, 16, 8));
+    benchPrint(benchRun("lcd/FillBuffer-240x320", caseClear, 4, 8));
+    lcd->Clear(LCD_COLOR_BLACK);
+}
+#endif
@@ -0,0 +1,12 @@
+//=======================================================================================
+// ON-TARGET LCD RENDERING BENCHMARKS (BENCHMARK BUILD ONLY):
+//=======================================================================================
+#ifndef LCD_BENCH_H
+#define LCD_BENCH_H
+
+#include "drivers/LCD_DISCO_F429ZI.h"
+
+// TIME GLYPH DRAWING (DrawChar), STRING RENDERING (DisplayStringAt) AND DMA2D FILLS (FillBuffer)
+void benchRunLcd(LCD_DISCO_F429ZI *lcd);
+
+#endif // LCD_BENCH_H
@@ -7,8 +7,27 @@
 #include <chrono>                                           //IMPORTING THE CHRONO HEADER FILE
 #include "stm32f4xx_hal.h"                                  //IMPORTING THE STM32F4 HEADER FILE (Additional Features of HAL).
 #include "drivers/LCD_DISCO_F429ZI.h"                       //IMPORTING the STM32F29 LCD-DISPLAY FILE.
+#include "drivers/font_packed.h"                            //IMPORTING THE PACKED FONT SUBSET (GLYPH CACHE STATISTICS)
 #include <stdlib.h>                                         //IMPORTING THE STDLIB HEADER FILE
 #include <float.h>                                          //IMPORTING THE FLOAT HEADER FILE                                
+#include <string.h>                                         //IMPORTING THE STRING.H HEADER FILE
+#include <stdarg.h>                                         //IMPORTING THE STDARG.H HEADER FILE (REPORT TABLE CELLS)
+#include <new>                                              //IMPORTING PLACEMENT NEW (THE LCD OBJECT IS CONSTRUCTED AT BOOT, NOT AT STATIC INIT)
+#include "gyro_pipeline.h"                                  //IMPORTING THE DECODE/FILTER/FSM/DISTANCE PIPELINE (lib/GyroDSP, HARDWARE INDEPENDENT)
+#include "cycle_counter.h"                                  //IMPORTING THE DWT CYCLE COUNTER SHIM (PER-THREAD CPU ACCOUNTING)
+#include "block_pool.h"                                     //IMPORTING THE FIXED-BLOCK POOL (ALL PIPELINE BUFFERS)
+#include "latency_hist.h"                                   //IMPORTING THE LOG2 LATENCY HISTOGRAMS (PER PIPELINE HOP)
+#include "sensor_manager.h"                                 //IMPORTING THE MULTI-GYRO SPI BUS SCHEDULER (DRDY GROUPS, PER-DEVICE STREAMS)
+#include "ccm.h"                                            //IMPORTING THE CORE-COUPLED MEMORY PLACEMENT MACROS (CCM_BSS / CCM_DATA / CCM_CONST)
+#ifdef GYRO_BENCH
+#include "gyro_bench.h"                                     //IMPORTING THE KERNEL BENCHMARKS (ONLY IN THE BENCHMARK BUILD)
+#include "lcd_bench.h"                                      //IMPORTING THE LCD RENDERING BENCHMARKS (ONLY IN THE BENCHMARK BUILD)
+#include "ccm_bench.h"                                      //IMPORTING THE SRAM VS. CCM PLACEMENT BENCHMARKS (ONLY IN THE BENCHMARK BUILD)
+#endif
+#ifdef GYRO_TELEMETRY
+#include "telemetry_frame.h"                                //IMPORTING THE BINARY TELEMETRY FRAME CODEC (ONLY IN THE TELEMETRY BUILD)
+#include "clock_sync.h"                                     //IMPORTING THE TWO-WAY CLOCK SYNC ESTIMATOR (ONLY IN THE TELEMETRY BUILD)
+#endif
 
 
 //=======================================================================================
@@ -24,6 +43,12 @@
                                                              // Y-AXIS ENABLE = 1
                                                              // X-AXIS ENABLE = 1
 
+#define CTRL_REG2 0x21                                       // CTRL_REG2 REGISTER ADDRESS
+#define CTRL_REG2_CONFIG 0b00'00'0000                        // NO SELECTION = 00
+                                                             // HIGH-PASS FILTER MODE = 00 [NORMAL MODE] (RESET VALUE; WRITTEN ONLY
+                                                             // BECAUSE THE CONFIGURATION GOES OUT AS ONE AUTO-INCREMENT BURST 0x20..0x23)
+                                                             // HIGH-PASS CUT-OFF = 0000
+
 #define CTRL_REG4 0x23                                       // CTRL_REG4 REGISTER ADDRESS
 #define CTRL_REG4_CONFIG 0b0'0'01'0'00'0                     // BLOCK DATA UPDATE (BDU) = 0  [CONTINUOUS UPDATE]
                                                              // BIG/LITTLE ENDIAN SELECTION = 0  [DATA AT LSB; LOWER ADDRESS]
@@ -42,19 +67,18 @@
                                                              // FIFO empty interrupt on DRDY/INT2 = 0 [DISABLED]
 
 #define OUT_X_L 0x28                                         // X-AXIS ANGULAR DATA RATE ADDRESS 
+#define SPI_AUTO_INCREMENT 0x40                              // M/Sbar BIT OF THE ADDRESS BYTE: MULTI-BYTE TRANSFER, ADDRESS AUTO-INCREMENTED
 
 
 //=======================================================================================
-//GYROSCOPE STATES:
-#define IDLE 0                                           // WHEN IDLE
-#define MOVING_DATARECORD 1                              // WHEN MOVING [WALK/JOGG/RUN]
+//GYROSCOPE STATES: GP_IDLE / GP_MOVING_DATARECORD (SEE gyro_pipeline.h)
 //=======================================================================================
 
 
 //=======================================================================================
 // GYROSCOPE INTERRUPT CONFIGURATION:
 //=======================================================================================
-//We are using the Ticker Timer Interrupt in the code to check at every 0.5seconds.
+//Samples are driven by the DRDY signal on INT2 (see CTRL_REG3); a 0.5 second tick on the acquisition event queue only recovers a missed edge.
 //Additionally the designer can also configure these registers of the gyroscope if needed to be more specific, which are as follows (From the I3G4250D datasheet):
 // 1. INT1_CFG (30h)				
 // 2. INT1_SRC (31h)				
@@ -71,36 +95,48 @@
 //=======================================================================================
 // CUSTOMIZABLE CONSTANTS FOR THE CODE: [USER-DEFINED CONSTANTS]
 //=======================================================================================
-#define ScalingFactor (1.0f* 0.017453292519943295769236907684886f / 1000.0f)            // SCALING FACTOR FOR ANGULAR TO DEGREE CONVERSION
-#define Radius 0.5f                                                                     // RADIUS IN METERS
-#define WINDOW_SIZE 6                                                                   // MAXIMUM INTEGRATING LIMIT FOR EACH X,Y,Z CO-ORDINATE LINEAR VELOCITY
-#define DUR_SAMPLE_COUNT 40                                                             // TOTAL SAMPLE COUNT = 40 (SAMPLE AT 0.5s FOR 20s)
+// (THE SIGNAL PROCESSING CONSTANTS LIVE WITH THE PIPELINE IN lib/GyroDSP/gyro_pipeline.h)
 #define DIM_COUNT 3                                                                     // DIMENSIONS COUNT = 3 [X,Y,Z]
-#define RESET_TIMERLIMIT 20                                                             // RESET TIMER CONFIG (RESET FOR EVERY 20s)
-#define TICKER_LIMIT 500ms                                                              // TICKER LIMIT = 0.5s (SAMPLE GYROSCOPE VALUES AT EVERY 0.5s)
-#define GRYOMULFACTOR1 1000000                                                          // GYROSCOPE MULTIPLICATION FACTOR 1 FOR PROPER SCALING OF INDIVIDUAL CO-ORDINATE DISTANCE VALUE 
-#define GRYOMULFACTOR2 100                                                              // GYROSCOPE MULTIPLICATION FACTOR 2 FOR PROPER SCALING OF RESULTANT DISTANCE VALUE 
-#define GYRO_THRESHOLD 104.85f                                                          // GYROSCOPE THRESHOLD DISTANCE TO TRANSITION FROM THE IDLE STATE INTO MOVING_DATARECORD STATE
+#define RESET_TIMERLIMIT 20                                                             // RESET TIMER CONFIG (RESET FOR EVERY 20s; NOT IN THE CONTINUOUS BUILD)
+#define WINDOW_SHORT_S 20                                                               // CONTINUOUS BUILD: "LAST 20s" DISTANCE WINDOW (CLOSED SECONDS)
+#define WINDOW_LONG_S 60                                                                // CONTINUOUS BUILD: "LAST MIN" DISTANCE WINDOW (AT MOST RS_SECONDS_RING)
+#define TICKER_LIMIT 500ms                                                              // TICKER LIMIT = 0.5s (DRDY RECOVERY; THE PIPELINE'S OWN 0.5s STEP IS GP_FSM_PERIOD_US)
 
 
 //=======================================================================================
-// INITIALIZING THE CODE VARIABLES
+// CORE-COUPLED MEMORY:
 //=======================================================================================
-int i_cnt=0;                                                          // Global variable for iteratively storing the angular velocity of each co-ordinate into 'angularVelocity' memory array
-int j_cnt=0;                                                          // Global variable for iteratively storing the linear velocity of each co-ordinate into 'linearVelocity' memory array
-float angularVelocity[DUR_SAMPLE_COUNT][DIM_COUNT];                   // Angular Velocity Memory array 40x3 (Data points over 20s duration with 0.5s sampling rate = 40, Dimensions = 3)
-float linearVelocity[DUR_SAMPLE_COUNT][DIM_COUNT];                    // Linear Velocity Memory array 40x3 (Data points over 20s duration with 0.5s sampling rate = 40, Dimensions = 3)
-volatile int8_t state_chk = IDLE;                                     // Global declaration for state variable
-volatile float totalDist = 0.0f;                                      // Global variable declaration for total distance travelled so far
-int8_t step_cnt=0;                                                    // Global variable declaration for total step count so far
-float window_gx[WINDOW_SIZE] = {0};                                   // Temporary register to store current x co-ordinate linear velocity value. Initializing the register with all values as '0'
-float window_gy[WINDOW_SIZE] = {0};                                   // Temporary register to store current y co-ordinate linear velocity value. Initializing the register with all values as '0'
-float window_gz[WINDOW_SIZE] = {0};                                   // Temporary register to store current z co-ordinate linear velocity value. Initializing the register with all values as '0'
-int window_index = 0;                                                 // Global index variable declaration for the temporary register
-float filtered_gx = 0.0f, filtered_gy = 0.0f, filtered_gz = 0.0f;     // Global variables to store filtered linear velocity values if we use LPF Low Pass Filter
-volatile float gX_ref=0.0f, gY_ref=0.0f, gZ_ref=0.0f;                 // Global variables for intial distance reference points for all 3 co-ordinates. Distance in meters 
+// With GYRO_CCM (linker/stm32f429xi_ccm.ld) the DSP state, the acq/dsp thread stacks and the
+// per-sample lookup tables live in the 64 KB CCM RAM, off the bus matrix the DMA2D and LTDC
+// keep busy. The startup code only initializes .data and .bss, so the CCM sections are
+// loaded / cleared here from .preinit_array: before any C++ constructor, so objects placed
+// there are constructed into zeroed memory like any other global.
+#ifdef GYRO_CCM
+extern "C" uint32_t __ccm_data_start__, __ccm_data_end__, __ccm_data_load__;   // FROM THE LINKER SCRIPT
+extern "C" uint32_t __ccm_bss_start__, __ccm_bss_end__;
+
+static void ccmInit()
+{
+    const uint32_t *src = &__ccm_data_load__;
+    for (uint32_t *dst = &__ccm_data_start__; dst < &__ccm_data_end__; dst++)
+    {
+        *dst = *src++;
+    }
+    for (uint32_t *dst = &__ccm_bss_start__; dst < &__ccm_bss_end__; dst++)
+    {
+        *dst = 0;
+    }
+}
+
+__attribute__((used, section(".preinit_array"))) static void (*const ccmInitEntry)() = ccmInit;
+#endif
 
 
+//=======================================================================================
+// INITIALIZING THE CODE VARIABLES
+//=======================================================================================
+GyroPipeline gyro CCM_BSS;                                            // Glitch filter, moving average, classifier, tuner, rolling statistics and distance FSM state (owned by the DSP thread, CCM when enabled)
+
 //=======================================================================================
 //  DECLARING A FILE TO OUTPUT THE STORED LINEAR-VELOCITIES ONTO A CSV FILE:
 //FILE *file = fopen("output.csv", "w");
@@ -117,58 +153,704 @@ volatile float gX_ref=0.0f, gY_ref=0.0f, gZ_ref=0.0f;                 // Global
 // TIME HAL DEFINITIONS:
 //=======================================================================================
 
-Ticker t;             // TICKER HAL TO CALL FUNCTION BLOCK AT EACH SAMPLE POINT OF 0.5s
 Timer resetTimer;     // TIMER HAL TO RESET THE CODE LOGIC ONCE AFTER 20s DURATION 
 
 
 //=======================================================================================
 // SPI INTERFACE PIN CONFIGURATIONS:
 //=======================================================================================
-EventFlags flags;                        // FLAG DECLARATION
 #define MOSI_PIN PF_9                    // MASTER OUT SLAVE IN PIN CONFIG  
 #define MISO_PIN PF_8                    // MASTER IN SLAVE OUT PIN CONFIG
 #define SCLK_PIN PF_7                    // SERIAL CLOCK PIN CONFIG
-#define CS_PIN  PC_1                     // CHIP SELECT PIN CONFIG [DEFAULT:0]
-#define SPI_FLAG 1
-#define DATA_READY_FLAG 2                // FLAG DEFINITIONS
+#define CS_PIN  PC_1                     // CHIP SELECT PIN CONFIG OF THE ON-BOARD GYRO [ACTIVE LOW]
+#define DRDY_PIN PA_2                    // ITS INT2 = DATA READY LINE
 #define WRITELIMIT_SIZE 2                // SPI TRANSFER WRITE LIMIT IN BYTES
+#define CONFIG_WRITE_SIZE 5              // CONTROL REGISTER BURST: ADDRESS BYTE + CTRL_REG1..CTRL_REG4
+#define SPI_FREQUENCY 1'000'000          // GYRO SPI CLOCK (1MHz)
 #define READLIMIT_SIZE 2                 // SPI TRANSFER READ LIMIT IN BYTES
 #define WRITELIMIT_SIZE1 7
 #define READLIMIT_SIZE1 7
 
 
-uint8_t write_buf[32];                   // WRITE BUFFER ARRAY
-uint8_t read_buf[32];                    // READ BUFFER ARRAY
-volatile int flag = 0;                   // VOLATILE FLAG DECLARATION
-float result[3];                         // ARRAY FOR STORING LINEAR VELOCITIES [X,Y,Z] FOR EACH SAMPLE
 
 
 //SPI INITIALIZATION:
-SPI spi(MOSI_PIN, MISO_PIN, SCLK_PIN, CS_PIN, use_gpio_ssel);  //MOSI, MISO, SCLK, CS, SEL_CONFIG (CAN BE CONFIGURED IN CODE USING "spi.select()" and "spi.deselect()")
+SPI spi(MOSI_PIN, MISO_PIN, SCLK_PIN);   //MOSI, MISO, SCLK (EVERY GYRO HAS ITS OWN CHIP SELECT, DRIVEN PER TRANSACTION)
+
+
+//=======================================================================================
+// GYROSCOPES ON THE SPI BUS:
+//=======================================================================================
+// Every gyro has its own chip select and belongs to one DRDY group (one data-ready line
+// triggers reads of all the gyros in its group); the sensor manager (lib/GyroDSP/
+// sensor_manager.h) queues their burst reads so a group's reads go out back to back.
+// Sensor 0 is the on-board gyro and feeds the DSP pipeline through the sample blocks; any
+// further sensors are read into their own streams, which the DSP thread aligns onto the
+// primary's sample grid. To add a gyro (e.g. on the other shank): give it a DigitalOut chip
+// select and list it in sensorCs, add its SmDeviceConfig (its own group and DRDY line in
+// drdyLine, or group 0 if it runs off the same ODR), and raise SENSOR_COUNT / DRDY_GROUP_COUNT.
+#define SENSOR_COUNT 1                   // GYROS ON THE BUS (AT MOST SM_MAX_DEVICES)
+#define DRDY_GROUP_COUNT 1               // DATA READY LINES (AT MOST SM_MAX_GROUPS)
+#define PRIMARY_SENSOR 0                 // THE GYRO THE DISTANCE / STEP PIPELINE RUNS ON
+
+DigitalOut gyroCs(CS_PIN, 1);                                     // ON-BOARD GYRO CHIP SELECT, IDLE HIGH
+InterruptIn int2(DRDY_PIN, PullDown);                             // ON-BOARD GYRO INT2 = DATA READY
+DigitalOut *const sensorCs[SENSOR_COUNT] = { &gyroCs };
+InterruptIn *const drdyLine[DRDY_GROUP_COUNT] = { &int2 };
+const SmDeviceConfig sensorConfig[SENSOR_COUNT] =
+{
+    { 0, SENSOR_COUNT > 1 },                                      // PRIMARY: ITS FRAMES LAND IN THE SAMPLE BLOCKS; STREAMED ONLY FOR ALIGNMENT
+};
+const uint8_t drdyGroupId[SM_MAX_GROUPS] = { 0, 1, 2, 3 };        // CALLBACK ARGUMENT PER DRDY LINE
+SensorManager sensors;                                            // OWNED BY THE ACQUISITION THREAD (STREAMS: POPPED BY THE DSP THREAD)
 
 
-// CALL BACK FUNCTION TO SET SPI FLAG (TO INDICATE SPI COMMENCEMENT / SPI TRANSFER COMPLETE)
-void spi_cb(int event)
+
+//=======================================================================================
+// PIPELINE: THREADS, QUEUES AND STATISTICS
+//=======================================================================================
+// The work is split into four RTOS threads so a slow LCD frame or a blocking printf can
+// no longer delay the next sensor read:
+//   ACQUISITION (realtime)      EventQueue: DRDY -> SPI read into block ----> fullBlocks
+//   DSP         (above normal)  glitch filter, averaging, FSM, distance ----> uiQueue, logQueue
+//   UI          (normal)        redraws at most once per UI_FRAME_PERIOD
+//   LOGGING     (low)           all serial output, CPU/queue report every CPU_REPORT_PERIOD
+// Every message comes from a fixed BlockPool and travels as a pointer through an rtos::Queue,
+// so steady-state operation never touches the heap (the report shows the heap allocation
+// count since start-up). Producers never block: when a pool is empty the message is
+// dropped and counted, so backpressure is visible in the report instead of stalling the
+// acquisition.
+#define SAMPLE_BLOCK_LEN 8                       // SAMPLES PER ACQUISITION BLOCK (~42ms AT 190Hz)
+#define SAMPLE_BLOCK_COUNT 2                     // BLOCKS IN CIRCULATION (2 = PING-PONG)
+#define SPI_FRAME_SIZE 8                         // BYTES PER SAMPLE FRAME (ADDRESS + 6 DATA BYTES, PADDED)
+#define UI_QUEUE_LEN 2                           // DSP -> UI MESSAGES
+#define LOG_QUEUE_LEN 32                         // DSP -> LOGGING MESSAGES
+#define UI_FRAME_PERIOD 100ms                    // UI FRAME RATE CAP (10 FPS)
+#define CPU_REPORT_PERIOD 5s                     // PER-THREAD CPU UTILIZATION REPORT INTERVAL
+#define ACQ_STACK_SIZE 1024                      // THREAD STACK SIZES IN BYTES
+#define DSP_STACK_SIZE 3072
+#define UI_STACK_SIZE 2048
+#define LOG_STACK_SIZE 2048
+
+// RAW SAMPLE AS DECODED FROM ONE SPI FRAME
+struct RawSampleMsg
+{
+    uint32_t t_us;                               // CAPTURE TIME SINCE SESSION START
+    int16_t raw[DIM_COUNT];                      // RAW X, Y, Z COUNTS
+};
+
+// BLOCK OF SAMPLE FRAMES (ACQUISITION -> DSP)
+// The SPI transfers write the sensor frames straight into the block and the DSP decodes the
+// whole block at once. While the DSP works on one block the sensor fills the other one.
+struct SampleBlock
+{
+    uint8_t frame[SAMPLE_BLOCK_LEN][SPI_FRAME_SIZE]; // RAW SPI FRAMES, WRITTEN BY THE TRANSFER ITSELF
+    uint32_t t_us[SAMPLE_BLOCK_LEN];             // DRDY TIME OF EACH FRAME
+    uint8_t issued;                              // READS STARTED INTO THIS BLOCK
+    uint8_t count;                               // READS COMPLETED
+    uint32_t complete_us;                        // TIME THE BLOCK WAS HANDED TO THE DSP
+};
+
+// BLOCK-COMPLETE LATENCY (HANDED OVER -> PICKED UP BY THE DSP) AND OVERRUNS
+struct BlockStats
+{
+    uint32_t blocks;                             // BLOCKS DECODED SINCE THE LAST REPORT
+    uint32_t latencySumUs;                       // SUM OF THEIR LATENCIES
+    uint32_t latencyMaxUs;                       // WORST LATENCY THIS SESSION
+    uint32_t overruns;                           // SAMPLES LOST BECAUSE NO BLOCK WAS FREE
+};
+
+// WHEN THE SAMPLE BEHIND A SNAPSHOT PASSED EACH STAGE (us SINCE SESSION START)
+struct SampleLineage
 {
-    //sem.acquire();
-    flags.set(SPI_FLAG);                // SET SPI FLAG
-    //sem.release();
+    uint32_t capture_us;                         // DRDY INTERRUPT
+    uint32_t decode_us;                          // ITS BLOCK DECODED
+    uint32_t filter_us;                          // GLITCH FILTER + AVERAGING DONE
+    uint32_t fsm_us;                             // FSM / DISTANCE / STEP UPDATE DONE
+};
+
+// SNAPSHOT OF THE VALUES SHOWN ON THE LCD (DSP -> UI)
+struct UiMsg
+{
+    float totalDist;
+    uint32_t stepcnt;
+    ActivityClass activity;
+    float speed;                                 // MEAN SPEED OVER THE LAST COMPLETED SECOND
+#ifdef GYRO_CONTINUOUS
+    uint32_t session_s;                          // SECONDS CLOSED SINCE THE SESSION STARTED
+    float dist_short;                            // DISTANCE OVER THE LAST WINDOW_SHORT_S SECONDS
+    float dist_long;                             // DISTANCE OVER THE LAST WINDOW_LONG_S SECONDS
+#endif
+    SampleLineage lineage;                       // OF THE NEWEST SAMPLE IN THE SNAPSHOT
+};
+
+// LATENCY HOPS FROM THE DRDY INTERRUPT TO THE VALUE ON SCREEN. THE FIRST THREE ARE RECORDED
+// FOR EVERY SAMPLE BY THE DSP THREAD, THE REST FOR EVERY DRAWN FRAME BY THE UI THREAD
+enum LatHop
+{
+    HOP_CAPTURE_DECODE = 0,                      // DRDY -> BLOCK DECODED (BLOCK FILL + HANDOVER)
+    HOP_DECODE_FILTER,                           // DECODED -> FILTERED
+    HOP_FILTER_FSM,                              // FILTERED -> FSM DONE
+    HOP_FSM_RENDER,                              // FSM DONE -> UI STARTS DRAWING (QUEUE + FRAME PACING)
+    HOP_RENDER_PRESENT,                          // DRAWING -> FRAMEBUFFER COMPLETE
+    HOP_END_TO_END,                              // DRDY -> FRAMEBUFFER COMPLETE
+    HOP_COUNT
+};
+
+// LOG RECORD, FORMATTED ONLY BY THE LOGGING THREAD (DSP -> LOGGING)
+// THE PIPELINE'S OWN TRACE RECORDS (GpTrace) KEEP THEIR VALUES, SO THEY ARE POSTED AS THEY ARE
+enum LogKind : uint8_t
+{
+    LOG_ANG_VEL = GP_TRACE_ANG_VEL,              // v[0..2] = x,y,z ANGULAR VELOCITY, v[3] = AVERAGE
+    LOG_LIN_VEL = GP_TRACE_LIN_VEL,              // v[0..2] = x,y,z LINEAR VELOCITY, v[3] = AVERAGE
+    LOG_CALC = GP_TRACE_CALC,                    // v[0] = CURRENT RESULTANT DISTANCE
+    LOG_TOTAL = GP_TRACE_TOTAL,                  // v[0] = TOTAL DISTANCE, i = STEP COUNT
+    LOG_ACTIVITY = GP_TRACE_ACTIVITY,            // i = ActivityClass, v[0] = MEAN, v[1] = PEAK RATE, v[2] = WORST CYCLES
+    LOG_INPUT                                    // v[0..2] = x,y,z CO-ORDINATE DISTANCE
+};
+
+struct LogMsg
+{
+    LogKind kind;
+    int32_t i;
+    float v[4];
+};
+
+// PER-EDGE COUNTERS (UPDATED ATOMICALLY, PRODUCER AND CONSUMER RUN ON DIFFERENT THREADS)
+struct PipeEdge
+{
+    const char *name;
+    uint32_t sent;                               // MESSAGES ACCEPTED
+    uint32_t dropped;                            // MESSAGES REJECTED BECAUSE THE EDGE WAS FULL
+    uint32_t inFlight;                           // MESSAGES QUEUED NOW
+    uint32_t highWater;                          // MAXIMUM 'inFlight' SEEN
+};
+
+// PER-STAGE CPU ACCOUNTING (BUSY CYCLES SINCE THE LAST REPORT)
+struct StageStats
+{
+    const char *name;
+    uint32_t busyCycles;
+    uint32_t items;
+};
+
+enum PipeStage { STAGE_ACQ = 0, STAGE_DSP, STAGE_UI, STAGE_LOG, STAGE_COUNT };
+
+BlockPool<SampleBlock, SAMPLE_BLOCK_COUNT> blockPool;  // FREE BLOCKS, READY TO FILL
+Queue<SampleBlock, SAMPLE_BLOCK_COUNT + 1> fullBlocks;  // FILLED, WAITING FOR THE DSP (+1 FOR THE STOP MARKER)
+BlockStats blockStats = { 0, 0, 0, 0 };
+LatencyHist latHist[HOP_COUNT];
+BlockPool<UiMsg, UI_QUEUE_LEN> uiPool;
+Queue<UiMsg, UI_QUEUE_LEN> uiQueue;
+BlockPool<LogMsg, LOG_QUEUE_LEN> logPool;
+Queue<LogMsg, LOG_QUEUE_LEN> logQueue;
+uint32_t heapAllocsAtStart = 0;                  // HEAP ALLOCATION COUNT WHEN THE PIPELINE STARTED
+
+PipeEdge sampleEdge = { "acq->dsp", 0, 0, 0, 0 };  // COUNTS BLOCKS
+PipeEdge uiEdge     = { "dsp->ui", 0, 0, 0, 0 };
+PipeEdge logEdge    = { "dsp->log", 0, 0, 0, 0 };
+StageStats stageStats[STAGE_COUNT] = { { "acq", 0, 0 }, { "dsp", 0, 0 }, { "ui", 0, 0 }, { "log", 0, 0 } };
+
+volatile bool session_running = true;           // CLEARED BY main() WHEN THE SESSION ENDS
+
+#define BOOT_SETTLE_SAMPLES 8                    // TURN-ON SAMPLES DISCARDED (~42ms AT 190Hz)
+#define BOOT_CAL_SAMPLES 16                      // REST SAMPLES FOR THE BIAS / NOISE ESTIMATE (~84ms, AFTER THE GLITCH FILTER WINDOW FILLS)
+#define BOOT_TARGET_MS 200                       // TIME-TO-FIRST-VALID-SAMPLE GOAL (WARM BOOT)
+
+// BOOT MILESTONES: us OF THE SESSION TIMER (STARTED AT THE TOP OF main()), 0 = NOT REACHED YET
+struct BootTimeline
+{
+    uint32_t main_ms;                            // RESET -> main() (KERNEL CLOCK, ms)
+    uint32_t configured_us;                      // CONTROL REGISTERS WRITTEN
+    uint32_t display_us;                         // PANEL UP, SPLASH DRAWN
+    uint32_t first_valid_us;                     // CAPTURE OF THE FIRST SAMPLE AFTER CALIBRATION
+    uint32_t first_fsm_us;                       // THAT SAMPLE THROUGH THE FSM
+};
+
+BootTimeline boot = { 0, 0, 0, 0, 0 };
+Semaphore bootFirstValid(0);                     // RELEASED BY THE DSP THREAD WITH THE FIRST VALID SAMPLE
+
+// STATICALLY ALLOCATED THREAD STACKS (THE REALTIME PATH IN CCM WHEN ENABLED; NO DMA BUFFER LIVES ON THEM)
+MBED_ALIGN(8) unsigned char acq_stack[ACQ_STACK_SIZE] CCM_BSS;
+MBED_ALIGN(8) unsigned char dsp_stack[DSP_STACK_SIZE] CCM_BSS;
+MBED_ALIGN(8) unsigned char ui_stack[UI_STACK_SIZE];
+MBED_ALIGN(8) unsigned char log_stack[LOG_STACK_SIZE];
+
+Thread acqThread(osPriorityRealtime, ACQ_STACK_SIZE, acq_stack, "acq");
+Thread dspThread(osPriorityAboveNormal, DSP_STACK_SIZE, dsp_stack, "dsp");
+Thread uiThread(osPriorityNormal, UI_STACK_SIZE, ui_stack, "ui");
+Thread logThread(osPriorityLow, LOG_STACK_SIZE, log_stack, "log");
+
+
+void edgeSent(PipeEdge *e)
+{
+    core_util_atomic_incr_u32(&e->sent, 1);
+    uint32_t depth = core_util_atomic_incr_u32(&e->inFlight, 1);
+    if (depth > core_util_atomic_load_u32(&e->highWater))
+    {
+        core_util_atomic_store_u32(&e->highWater, depth);          // Only the producer writes highWater
+    }
 }
 
+void edgeDropped(PipeEdge *e)
+{
+    core_util_atomic_incr_u32(&e->dropped, 1);
+}
 
-//CALLBACK FUNCTION FOR THE TICKER HAL:
-void cb()
+void edgeReceived(PipeEdge *e)
 {
-    spi_cb(0); // CALL 'spi_cb' WITH DEFAULT EVENT VALUE
+    core_util_atomic_decr_u32(&e->inFlight, 1);
 }
 
+// ADD THE CYCLES SPENT ON ONE ITEM TO A STAGE
+void stageAccount(PipeStage stage, uint32_t startCycles)
+{
+    core_util_atomic_fetch_add_u32(&stageStats[stage].busyCycles, cycleCounterNow() - startCycles);
+    core_util_atomic_incr_u32(&stageStats[stage].items, 1);
+}
+
+// POST A LOG RECORD WITHOUT BLOCKING (DROPPED AND COUNTED WHEN THE LOGGER IS BEHIND)
+void logPost(LogKind kind, int32_t i, float v0, float v1 = 0.0f, float v2 = 0.0f, float v3 = 0.0f)
+{
+    LogMsg *m = logPool.alloc();
+    if (m == NULL)
+    {
+        edgeDropped(&logEdge);
+        return;
+    }
+    m->kind = kind;
+    m->i = i;
+    m->v[0] = v0;
+    m->v[1] = v1;
+    m->v[2] = v2;
+    m->v[3] = v3;
+    logQueue.try_put(m);                         // Holds as many messages as the pool, so this cannot fail
+    edgeSent(&logEdge);
+}
 
-// DATA READY CALLBACK FUNCTION TO SET DATA READY FLAG:
-void data_cb()
+// TRACE CALLBACK OF THE PIPELINE: ITS RECORDS GO TO THE LOGGING THREAD LIKE EVERY OTHER LOG
+void gyroTrace(void *ctx, GpTrace kind, int32_t i, float v0, float v1, float v2, float v3)
 {
-    //sem.acquire();
-    flags.set(DATA_READY_FLAG);
-    //sem.release();
+    logPost((LogKind)kind, i, v0, v1, v2, v3);
+}
+
+
+//=======================================================================================
+// EVENT-DRIVEN ACQUISITION CORE:
+//=======================================================================================
+// The acquisition thread dispatches an mbed EventQueue. Interrupt handlers only post a
+// typed event; the handlers then run one at a time on the acquisition thread:
+//   DataReady   (DRDY rising edge)        queue a 7-byte OUT_X_L..OUT_Z_H burst read of every gyro in the line's group
+//   SpiComplete (SPI asynch callback)     finish that transaction, start the next queued one
+//   Tick        (every TICKER_LIMIT)      recover a DRDY edge missed while the line stayed high
+//   Button      (blue user button)        finish the session early
+// Every SPI transaction owns its buffers, its chip select and its completion handler, so
+// reads of several gyros and register writes can be queued at once and a completion can
+// only ever finish the transaction it belongs to. Only the acquisition thread touches the
+// transaction lists and the sensor manager.
+// SPI5 is shared with the LCD controller. While the panel is brought up (the UI thread, at
+// boot) every one of its register accesses borrows the bus through LCD_IO_BusAcquire() /
+// LCD_IO_BusRelease(): the bus is lent once the transfer on it completes, reads queue up
+// meanwhile, and the gyro's SPI format is re-applied when it comes back.
+// The queue is sized for every event that can be pending at once, and an interrupt whose
+// post still fails is counted per source. None of them may be lost for good: a missed DRDY
+// is recovered by the tick (the line stays high), a missed button press ends the session
+// from the interrupt itself, and a missed SPI completion - after which nothing would ever
+// start the next transfer - is parked for the tick to finish.
+#define SPI_TXN_COUNT (3 * SENSOR_COUNT + 1)     // SPI TRANSACTIONS THAT CAN BE QUEUED OR IN FLIGHT (READS QUEUE UP WHILE THE LCD BORROWS THE BUS)
+#define SPI_TXN_BUF_SIZE 8                       // BYTES PER TRANSACTION BUFFER
+#define ACQ_EVENT_BURST (DRDY_GROUP_COUNT + 6)   // MOST EVENTS PENDING AT ONCE: ONE DRDY PER LINE (HIGH UNTIL READ), ONE SPI COMPLETION (ONE TRANSFER
+                                                 // ON THE BUS), ONE BUTTON (NOT RE-POSTED WHILE PENDING), THE TICK, ONE BUS BORROW / RETURN, ONE
+                                                 // BUS REPORT, configureSensor
+#define ACQ_EVENT_SLOTS (2 * ACQ_EVENT_BURST)    // EVENTS THE ACQUISITION QUEUE CAN HOLD (x2: EVENTS WITH ARGUMENTS CAN OUTGROW EVENTS_EVENT_SIZE)
+
+struct SpiTransaction;
+typedef void (*SpiDoneFn)(SpiTransaction *txn);
+
+struct SpiTransaction
+{
+    uint8_t tx[SPI_TXN_BUF_SIZE];                // WRITE BUFFER OF THIS TRANSACTION
+    uint8_t rx_buf[SPI_TXN_BUF_SIZE];            // READ BUFFER FOR REGISTER ACCESSES
+    uint8_t *rx;                                 // WHERE THE READ BYTES LAND ('rx_buf' OR A BLOCK FRAME)
+    uint8_t len;                                 // BYTES TO CLOCK
+    uint8_t device;                              // SENSOR (CHIP SELECT) ADDRESSED
+    uint32_t start_us;                           // WHEN IT WENT ON THE BUS
+    uint32_t busy_us;                            // HOW LONG IT HELD THE BUS (SET BEFORE 'done' RUNS)
+    SampleBlock *block;                          // BLOCK BEING FILLED (PRIMARY SENSOR READS)
+    SpiDoneFn done;                              // COMPLETION HANDLER, RUN ON THE EVENT QUEUE
+    SpiTransaction *next;                        // LINK IN THE PENDING FIFO
+};
+
+// TYPED EVENT PAYLOADS
+struct DataReadyEvent { uint8_t group; uint32_t t_us; };
+struct SpiCompleteEvent { SpiTransaction *txn; int event; };
+struct ButtonEvent { uint32_t t_us; };
+
+// INTERRUPT EVENTS THE QUEUE REJECTED, PER SOURCE
+enum AcqPostSource : uint8_t
+{
+    POST_DRDY = 0,
+    POST_SPI,
+    POST_BUTTON,
+    POST_SOURCE_COUNT
+};
+static const char *const kPostSourceNames[POST_SOURCE_COUNT] = { "drdy", "spi", "button" };
+uint32_t acqPostsFailed[POST_SOURCE_COUNT] = { 0, 0, 0 };
+
+BlockPool<SpiTransaction, SPI_TXN_COUNT> spiTxnPool;
+SpiTransaction *spiPendingHead = NULL;           // WAITING FOR THE BUS (FIFO)
+SpiTransaction *spiPendingTail = NULL;
+SpiTransaction *spiActive = NULL;                // ON THE BUS NOW
+SampleBlock *fillBlock = NULL;                   // BLOCK THE NEXT SAMPLE READ GOES INTO
+uint32_t spiOverruns = 0;                        // SAMPLE READS WITH NO FREE TRANSACTION
+uint32_t drdyRecovered = 0;                      // MISSED DRDY EDGES RECOVERED BY THE TICK
+uint32_t sampleReadsOutstanding = 0;             // SAMPLE READS QUEUED OR IN FLIGHT
+volatile bool session_end_requested = false;     // SET BY THE BUTTON EVENT
+volatile bool buttonPosted = false;              // A BUTTON EVENT IS WAITING IN THE QUEUE
+SpiCompleteEvent spiLostCompletion;              // COMPLETION WHOSE EVENT COULD NOT BE POSTED ...
+volatile bool spiCompletionLost = false;         // ... AND THE TICK HAS TO FINISH (AT MOST ONE: ONE TRANSFER IS ON THE BUS)
+
+EventQueue acqQueue(ACQ_EVENT_SLOTS * EVENTS_EVENT_SIZE);
+InterruptIn userButton(BUTTON1);                 // BLUE USER BUTTON
+Semaphore sensorConfigured(0);                   // RELEASED WHEN THE CONTROL REGISTERS ARE WRITTEN
+volatile bool acqRunning = false;                // THE ACQUISITION QUEUE IS DISPATCHING (THE BUS MUST BE BORROWED THROUGH IT)
+bool spiLendPending = false;                     // THE LCD ASKED FOR THE BUS: START NOTHING NEW
+bool spiLent = false;                            // THE LCD HOLDS THE BUS
+Semaphore spiLentOut(0);                         // RELEASED WHEN THE BUS IS HANDED TO THE LCD
+
+void onSpiComplete(SpiCompleteEvent ev);
+void acqPump();
+
+SpiTransaction *spiAlloc()
+{
+    SpiTransaction *txn = spiTxnPool.alloc();
+    if (txn != NULL)
+    {
+        txn->next = NULL;
+        txn->rx = txn->rx_buf;
+        txn->device = PRIMARY_SENSOR;
+        txn->block = NULL;
+    }
+    return txn;
+}
+
+// SPI ASYNCH CALLBACK (INTERRUPT CONTEXT): HAND THE COMPLETION BACK TO THE QUEUE, OR TO THE TICK IF THE QUEUE IS FULL
+void spiIsrDone(SpiTransaction *txn, int event)
+{
+    sensorCs[txn->device]->write(1);
+    if (acqQueue.call(onSpiComplete, SpiCompleteEvent{ txn, event }) == 0)
+    {
+        core_util_atomic_incr_u32(&acqPostsFailed[POST_SPI], 1);
+        spiLostCompletion = SpiCompleteEvent{ txn, event };
+        core_util_atomic_store_bool(&spiCompletionLost, true);
+    }
+}
+
+void spiStart(SpiTransaction *txn)
+{
+    spiActive = txn;
+    txn->start_us = (uint32_t)resetTimer.elapsed_time().count();
+    sensorCs[txn->device]->write(0);
+    spi.transfer(txn->tx, txn->len, txn->rx, txn->len, callback(spiIsrDone, txn), SPI_EVENT_COMPLETE);
+}
+
+// START THE OLDEST QUEUED TRANSACTION (IF ANY)
+void spiStartNext()
+{
+    if (spiPendingHead != NULL)
+    {
+        SpiTransaction *next = spiPendingHead;
+        spiPendingHead = next->next;
+        if (spiPendingHead == NULL)
+        {
+            spiPendingTail = NULL;
+        }
+        spiStart(next);
+    }
+}
+
+// HAND THE BUS TO THE LCD ONCE NOTHING IS ON IT
+void spiLendIfIdle()
+{
+    if (spiLendPending && spiActive == NULL)
+    {
+        spiLendPending = false;
+        spiLent = true;
+        spiLentOut.release();
+    }
+}
+
+// START NOW IF THE BUS IS IDLE, OTHERWISE QUEUE BEHIND THE CURRENT TRANSFER
+void spiSubmit(SpiTransaction *txn)
+{
+    if (spiActive == NULL && !spiLent && !spiLendPending)
+    {
+        spiStart(txn);
+        return;
+    }
+    if (spiPendingTail == NULL)
+    {
+        spiPendingHead = txn;
+    }
+    else
+    {
+        spiPendingTail->next = txn;
+    }
+    spiPendingTail = txn;
+}
+
+void onSpiComplete(SpiCompleteEvent ev)
+{
+    uint32_t start = cycleCounterNow();
+    spiActive = NULL;
+    if (!spiLendPending)
+    {
+        spiStartNext();                          // Keep the bus busy before running the completion
+    }
+    ev.txn->busy_us = (uint32_t)resetTimer.elapsed_time().count() - ev.txn->start_us;
+    ev.txn->done(ev.txn);
+    spiTxnPool.free(ev.txn);
+    acqPump();                                   // Its sensor may have signalled DRDY again while the read was in flight
+    spiLendIfIdle();
+    stageAccount(STAGE_ACQ, start);
+}
+
+// THE LCD WANTS THE BUS FOR ONE REGISTER ACCESS
+void onBusBorrow()
+{
+    spiLendPending = true;
+    spiLendIfIdle();
+}
+
+// THE LCD IS DONE: ITS DRIVER LEFT ITS OWN SPI CONFIGURATION, SO RE-APPLY THE GYRO'S BEFORE THE NEXT TRANSFER
+void onBusReturn()
+{
+    spiLent = false;
+    spi.format(8, 3);
+    spi.frequency(SPI_FREQUENCY);
+    spiStartNext();
+}
+
+// OVERRIDES OF THE BSP'S SHARED-BUS HOOKS (src/drivers/stm32f429i_discovery.c), CALLED ON THE LCD'S THREAD
+extern "C" void LCD_IO_BusAcquire(void)
+{
+    if (acqRunning)
+    {
+        while (acqQueue.call(onBusBorrow) == 0)
+        {
+            ThisThread::sleep_for(1ms);          // Event queue full: the acquisition thread is draining it
+        }
+        spiLentOut.acquire();
+    }
+}
+
+extern "C" void LCD_IO_BusRelease(void)
+{
+    if (acqRunning)
+    {
+        while (acqQueue.call(onBusReturn) == 0)
+        {
+            ThisThread::sleep_for(1ms);
+        }
+    }
+}
+
+// HAND A BLOCK TO THE DSP (THE FULL QUEUE HOLDS EVERY BLOCK, SO THIS CANNOT FAIL)
+void blockPost(SampleBlock *b)
+{
+    b->complete_us = (uint32_t)resetTimer.elapsed_time().count();
+    fullBlocks.try_put(b);
+    edgeSent(&sampleEdge);
+}
+
+// SAMPLE READ FINISHED: THE SENSOR MANAGER STAMPS AND STREAMS IT; A PRIMARY FRAME IS ALREADY IN
+// ITS BLOCK, WHICH IS HANDED OVER ONCE IT IS FULL
+void onSampleRead(SpiTransaction *txn)
+{
+    sampleReadsOutstanding--;
+    smReadDone(&sensors, txn->device, txn->rx, txn->busy_us);
+    SampleBlock *b = txn->block;
+    if (b == NULL)
+    {
+        return;
+    }
+    b->count++;                                  // Reads complete in the order they were queued
+    if (b->count == SAMPLE_BLOCK_LEN)
+    {
+        blockPost(b);
+    }
+}
+
+// QUEUE EVERY READ THE SENSOR MANAGER HAS PENDING; THE BUS FIFO RUNS THEM BACK TO BACK
+void acqPump()
+{
+    SmRead read;
+    while (smNextRead(&sensors, (uint32_t)resetTimer.elapsed_time().count(), &read))
+    {
+        SpiTransaction *txn = spiAlloc();
+        if (txn == NULL)
+        {
+            spiOverruns++;                       // Every transaction is busy: this sample is lost
+            smReadCancel(&sensors, read.device);
+            continue;
+        }
+        memcpy(txn->tx, read.tx, read.len);      // SDI --> R/Wbar  M/Sbar AD5 AD4 AD3 AD2 AD1 AD0  [0x80 | 0x40 | OUT_X_L]
+        txn->len = read.len;                     // 1 address byte + 6 data bytes (OUT_X_L..OUT_Z_H)
+        txn->device = read.device;
+        txn->rx = read.rx;
+        txn->done = onSampleRead;
+        if (read.device == PRIMARY_SENSOR)
+        {
+            if (fillBlock == NULL)
+            {
+                fillBlock = blockPool.alloc();
+                if (fillBlock == NULL)
+                {
+                    core_util_atomic_incr_u32(&blockStats.overruns, 1);   // The DSP still holds every block: this sample is lost
+                    smReadCancel(&sensors, read.device);
+                    spiTxnPool.free(txn);
+                    continue;
+                }
+                fillBlock->issued = 0;
+                fillBlock->count = 0;
+            }
+            uint8_t slot = fillBlock->issued++;
+            fillBlock->t_us[slot] = read.drdyUs;
+            txn->rx = fillBlock->frame[slot];    // The transfer writes straight into the block
+            txn->block = fillBlock;
+            if (fillBlock->issued == SAMPLE_BLOCK_LEN)
+            {
+                fillBlock = NULL;                // The next DRDY starts filling the other block
+            }
+        }
+        sampleReadsOutstanding++;
+        spiSubmit(txn);
+    }
+}
+
+void onDataReady(DataReadyEvent ev)
+{
+    uint32_t start = cycleCounterNow();
+    smDataReady(&sensors, ev.group, ev.t_us);
+    acqPump();
+    stageAccount(STAGE_ACQ, start);
+}
+
+void onTick()
+{
+    // A completion the interrupt could not post: nothing else would ever start the next transfer
+    if (core_util_atomic_exchange_bool(&spiCompletionLost, false))
+    {
+        onSpiComplete(spiLostCompletion);
+    }
+
+    // DRDY is level-high until the output registers are read. If the edge was missed (e.g.
+    // the line was already high at start-up) no new edge will come, so read it from here.
+    for (uint8_t g = 0; g < DRDY_GROUP_COUNT; g++)
+    {
+        if (drdyLine[g]->read() == 1 && !smGroupBusy(&sensors, g))
+        {
+            drdyRecovered++;
+            onDataReady(DataReadyEvent{ g, (uint32_t)resetTimer.elapsed_time().count() });
+        }
+    }
+}
+
+// BUS UTILIZATION SNAPSHOT FOR THE REPORT, TAKEN ON THE ACQUISITION THREAD THAT OWNS THE COUNTERS. EVERY REQUEST
+// CARRIES A SEQUENCE NUMBER: A REPLY TO A REQUEST THAT TIMED OUT ARRIVES LATE, AND MUST NOT BE TAKEN FOR THE NEXT ONE
+SmBusReport busReport;
+uint32_t busReportAsked = 0;                     // LAST REQUEST (REPORTING THREAD ONLY)
+volatile uint32_t busReportSeq = 0;              // REQUEST 'busReport' ANSWERS
+Semaphore busReportReady(0);
+
+void onBusReport(uint32_t seq)
+{
+    smBusReport(&sensors, (uint32_t)resetTimer.elapsed_time().count(), &busReport);
+    core_util_atomic_store_u32(&busReportSeq, seq);
+    busReportReady.release();
+}
+
+// ASK THE ACQUISITION THREAD FOR A SNAPSHOT; FALSE IF IT DID NOT ANSWER IN TIME. The queue runs requests in order, so
+// once this one's reply is in, the late ones are all spent and nothing writes 'busReport' until the next request.
+bool bus_report_fetch()
+{
+    uint32_t seq = ++busReportAsked;
+    if (acqQueue.call(onBusReport, seq) == 0)
+    {
+        return false;
+    }
+    while (busReportReady.try_acquire_for(20ms))
+    {
+        if (core_util_atomic_load_u32(&busReportSeq) == seq)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void onButton(ButtonEvent ev)
+{
+    buttonPosted = false;
+    session_end_requested = true;
+}
+
+void onRegisterWritten(SpiTransaction *txn)
+{
+    smBusTransfer(&sensors, txn->len, txn->busy_us);
+}
+
+void onSensorConfigured(SpiTransaction *txn)
+{
+    smBusTransfer(&sensors, txn->len, txn->busy_us);
+    boot.configured_us = (uint32_t)resetTimer.elapsed_time().count();
+    sensorConfigured.release();
+}
+
+// QUEUE ONE CONTROL REGISTER BURST PER GYRO (CTRL_REG1..CTRL_REG4 IN ONE AUTO-INCREMENT WRITE); THE LAST COMPLETION RELEASES 'sensorConfigured'
+void configureSensor()
+{
+    static const uint8_t config[CONFIG_WRITE_SIZE] =
+    {
+        CTRL_REG1 | SPI_AUTO_INCREMENT,          // SDI --> R/Wbar = 0 [WRITE]  M/Sbar = 1  AD5..AD0 = 0x20
+        CTRL_REG1_CONFIG,                        // 0x20: POWER-UP, 190 Hz, ALL AXES (THE REST FOLLOW WITHIN MICROSECONDS, LONG BEFORE THE FIRST SAMPLE)
+        CTRL_REG2_CONFIG,                        // 0x21
+        CTRL_REG3_CONFIG,                        // 0x22: DRDY ON INT2
+        CTRL_REG4_CONFIG,                        // 0x23: 500 DPS
+    };
+    for (uint8_t dev = 0; dev < SENSOR_COUNT; dev++)
+    {
+        SpiTransaction *txn = spiAlloc();        // The pool is idle at boot and holds a write per gyro, so this cannot fail
+        memcpy(txn->tx, config, CONFIG_WRITE_SIZE);
+        txn->len = CONFIG_WRITE_SIZE;
+        txn->device = dev;
+        txn->done = (dev == SENSOR_COUNT - 1) ? onSensorConfigured : onRegisterWritten;
+        spiSubmit(txn);
+    }
+}
+
+// INTERRUPT HANDLERS: TIMESTAMP AND POST, NOTHING ELSE
+void data_cb(const uint8_t *group)
+{
+    if (acqQueue.call(onDataReady, DataReadyEvent{ *group, (uint32_t)resetTimer.elapsed_time().count() }) == 0)
+    {
+        core_util_atomic_incr_u32(&acqPostsFailed[POST_DRDY], 1);   // The line stays high: the tick reads it
+    }
+}
+
+void button_cb()
+{
+    if (buttonPosted)
+    {
+        return;                                  // Contact bounce: one press is already on its way
+    }
+    buttonPosted = true;
+    if (acqQueue.call(onButton, ButtonEvent{ (uint32_t)resetTimer.elapsed_time().count() }) == 0)
+    {
+        core_util_atomic_incr_u32(&acqPostsFailed[POST_BUTTON], 1);
+        buttonPosted = false;
+        session_end_requested = true;            // Nothing else to do on the queue for a press
+    }
 }
 
 
@@ -179,7 +861,12 @@ void data_cb()
 #define FOREGROUND 0
 
 // LCD OBJECT:
-LCD_DISCO_F429ZI lcd;
+// Its constructor brings up the SDRAM, the LTDC and the panel (~0.4 s of power-up delays in
+// ili9341_Init), so it is not a plain global constructed before main(): display_boot()
+// constructs it in place, on the UI thread, while the sensor starts up.
+alignas(LCD_DISCO_F429ZI) unsigned char lcdStorage[sizeof(LCD_DISCO_F429ZI)];
+LCD_DISCO_F429ZI &lcd = *reinterpret_cast<LCD_DISCO_F429ZI *>(lcdStorage);
+bool displayReady = false;
 
 // SETUP OF LCD DISPLAY BACKGROUND LAYER 
 void setup_background_layer(){
@@ -200,8 +887,46 @@ void setup_foreground_layer(){
 }
 
 // Function Prototype/Declaration:
+void display_boot();
 void Initial_ScreenDisp();
-void CALC_ScreenDisp(float totalDist);
+void CALC_ScreenDisp(float totalDist, uint32_t stepcnt, const char *activityName, float speed);
+#ifdef GYRO_CONTINUOUS
+void CALC_Continuous_ScreenDisp(const UiMsg *m);
+#endif
+void CALC_Final_ScreenDisp(float totalDist, uint32_t stepcnt, const RollingStats *stats);
+
+// INCREMENTAL TEXT LINES:
+// The live screens redraw a text line only when its text changed since the last frame
+// (ClearStringLine + DisplayStringAt of that line), instead of clearing the whole layer and
+// drawing every line on every frame: at 10 FPS most lines are unchanged most of the time.
+// ui_lines_reset() after anything else drew on the layer (the splash) forces a full redraw.
+#define UI_LINES 20                              // LINE(0)..LINE(19): 320 PIXELS OF FONT16
+#define UI_LINE_LEN 32                           // LONGEST LINE TEXT + 1
+
+char uiLineText[UI_LINES][UI_LINE_LEN];          // TEXT ON EACH LINE NOW (UI THREAD)
+bool uiLinesValid = false;                       // FALSE: THE LAYER HAS TO BE CLEARED FIRST
+
+void ui_lines_reset()
+{
+  uiLinesValid = false;
+}
+
+void ui_line(uint8_t line, const char *text)
+{
+  if (!uiLinesValid)
+  {
+    lcd.Clear(LCD_COLOR_BLACK);
+    memset(uiLineText, 0, sizeof(uiLineText));
+    uiLinesValid = true;
+  }
+  if (line >= UI_LINES || strncmp(uiLineText[line], text, UI_LINE_LEN - 1) == 0)
+  {
+    return;
+  }
+  lcd.ClearStringLine(line);
+  lcd.DisplayStringAt(0, LINE(line), (uint8_t *)text, CENTER_MODE);
+  strncpy(uiLineText[line], text, UI_LINE_LEN - 1);
+}
 
 // UI CONFIGURATION:
 // Function to display the initial screen on an LCD
@@ -213,53 +938,107 @@ void Initial_ScreenDisp()
   lcd.DisplayStringAt(0, LINE(7), (uint8_t *)"Embedded Gyrometer", CENTER_MODE); // Display the string "Embedded Gyrometer" at line 7, centered on the screen
   lcd.DisplayStringAt(0, LINE(8), (uint8_t *)"Need for Speed", CENTER_MODE);     // Display the string "Need for Speed" at line 8, centered on the screen
   lcd.DisplayStringAt(0, LINE(10), (uint8_t *)"Group: 14", CENTER_MODE);         // Display the string "Group: 14" at line 10, centered on the screen
-  lcd.DisplayStringAt(0, LINE(15), (uint8_t *)"Auto Starting...", CENTER_MODE);  // Display the string "Auto Starting..." at line 15, centered on the screen
-  HAL_Delay(1500);                                                               // Pause for 1500 milliseconds (1.5 seconds) using HAL_Delay
+  lcd.DisplayStringAt(0, LINE(15), (uint8_t *)"Calibrating...", CENTER_MODE);    // Display the string "Calibrating..." at line 15: shown while the gyro settles and its bias is measured
+  lcd.DisplayStringAt(0, LINE(16), (uint8_t *)"Keep Still", CENTER_MODE);        // Display the string "Keep Still" at line 16 (the first live frame replaces the splash)
+  ui_lines_reset();                                                              // The first live frame clears the splash
 }
 
 
-// Function to display current distance and step count on an LCD while in moving state
-void CALC_ScreenDisp(float totalDist, int8_t stepcnt)      
+// Function to display current distance and step count on an LCD while in moving state (incremental: see ui_line)
+void CALC_ScreenDisp(float totalDist, uint32_t stepcnt, const char *activityName, float speed)
 {
-//HAL_Delay(20);
 float distance = totalDist;      // Pass to Local variable 'distance'
-lcd.Clear(LCD_COLOR_BLACK);
 
 char distance_buf[50];           // Declare a character array to hold the formatted distance string with size 50
 char stepcnt_buf[50];            // Declare a character array to hold the formatted step count string with size 50
+char activity_buf[50];           // Declare a character array to hold the formatted activity string with size 50
+char speed_buf[50];              // Declare a character array to hold the formatted speed string with size 50
 
-
-// Display a message indicating that computation is in progress for 20 seconds on LCD
-lcd.DisplayStringAt(LINE(0),LINE(10), (uint8_t *)"Computing for 20 sec...", CENTER_MODE);
 snprintf(distance_buf, 50, "Current Calc: %.3f m", distance);   // To display current distance message and store the string into 'distance_buf'
-snprintf(stepcnt_buf, 50, "Current Step Cnt: %d", stepcnt);     // To display current step count message and store the string into 'stepcnt_buf'
+snprintf(stepcnt_buf, 50, "Current Step Cnt: %lu", (unsigned long)stepcnt);     // To display current step count message and store the string into 'stepcnt_buf'
+snprintf(activity_buf, 50, "Activity: %s", activityName);       // To display the current activity class and store the string into 'activity_buf'
+snprintf(speed_buf, 50, "Speed: %.2f m/s", speed);              // To display the speed over the last second and store the string into 'speed_buf'
+
+// Display a message indicating that computation is in progress for 20 seconds, then the current distance and current step count
+ui_line(8, "Computing for 20 sec...");
+ui_line(10, distance_buf);    //DISPLAYING Distance Calculation.
+ui_line(11, stepcnt_buf);     // Displaying the Step Cnt Taken while moving.
+ui_line(13, activity_buf);    // Displaying the current activity class (IDLE/WALK/JOG/RUN).
+ui_line(14, speed_buf);       // Displaying the speed over the last completed second.
+}
+
 
+#ifdef GYRO_CONTINUOUS
+// Session time as HH:MM:SS into 'out' (at least 12 bytes). The zero padding is written by hand: minimal-printf
+// has no flags or field widths, so "%02lu" would print 7:5:3 instead of 07:05:03.
+void format_hms(char *out, size_t len, uint32_t s)
+{
+unsigned long h = s / 3600, m = s / 60 % 60, sec = s % 60;
+snprintf(out, len, "%s%lu:%s%lu:%s%lu", h < 10 ? "0" : "", h, m < 10 ? "0" : "", m, sec < 10 ? "0" : "", sec);
+}
 
-// Display the current distance and current step count string at specific postion on the LCD screen
-lcd.DisplayStringAt(LINE(0),LINE(10), (uint8_t *)distance_buf, CENTER_MODE); //DISPLAYING Distance Calculation.
-lcd.DisplayStringAt(LINE(0),LINE(11), (uint8_t *)stepcnt_buf, CENTER_MODE); // Displaying the Step Cnt Taken while moving.
+// Function to display the running session on an LCD (continuous build): elapsed time, totals, rolling windows, activity
+void CALC_Continuous_ScreenDisp(const UiMsg *m)
+{
+char buf[6][50];                 // Session time, total distance, step count, last 20s, last minute, activity / speed
+char hms[16];                    // Elapsed session time as HH:MM:SS
+
+format_hms(hms, sizeof(hms), m->session_s);
+snprintf(buf[0], 50, "Session %s", hms);
+snprintf(buf[1], 50, "Total: %.2f m", m->totalDist);
+snprintf(buf[2], 50, "Steps: %lu", (unsigned long)m->stepcnt);
+snprintf(buf[3], 50, "Last 20s: %.2f m", m->dist_short);
+snprintf(buf[4], 50, "Last min: %.2f m", m->dist_long);
+snprintf(buf[5], 50, "%s %.2f m/s", actName(m->activity), m->speed);
+
+ui_line(3, buf[0]);              // Elapsed session time (closed seconds)
+ui_line(6, buf[1]);              // Session total distance
+ui_line(7, buf[2]);              // Session step count
+ui_line(9, buf[3]);              // Distance over the last WINDOW_SHORT_S seconds
+ui_line(10, buf[4]);             // Distance over the last WINDOW_LONG_S seconds
+ui_line(12, buf[5]);             // Current activity class and the speed over the last completed second
+ui_line(15, "Press Blue Button"); // The USER button (userButton) ends the session; the black one resets
+ui_line(16, "To Stop");
 }
+#endif
 
 
-void CALC_Final_ScreenDisp(float totalDist, int8_t stepcnt)     // Function to display final calculated total distance and final total step count on the LCD covered for 20s duration.
+void CALC_Final_ScreenDisp(float totalDist, uint32_t stepcnt, const RollingStats *stats)     // Function to display final calculated total distance and final total step count on the LCD covered for 20s duration.
 {
 float distance = totalDist;                                     // Passing by value to the local variable 'distance'
 
 char distance_buf[50];                                          // Declare a character array to hold the formatted distance string
 char stepcnt_buf[50];                                           // Declare a character array to hold the formatted step count string
+char speed_buf[50];                                             // Declare a character array to hold the formatted session speed string
+char cadence_buf[50];                                           // Declare a character array to hold the formatted session cadence string
+RsSummary speed, cadence;                                       // Session summaries from the rolling statistics engine
 
 // Display a message on LCD to show final total distance value and final step count covered in 20s duration
 snprintf(distance_buf, 50, "Distance: %.2f m", distance); //Distance String
-snprintf(stepcnt_buf, 50, "Step Count: %d", stepcnt); //Step Cnt String
+snprintf(stepcnt_buf, 50, "Step Count: %lu", (unsigned long)stepcnt); //Step Cnt String
+rsCurrent(stats, RS_SPEED, RS_LEVEL_SESSION, &speed);
+rsCurrent(stats, RS_CADENCE, RS_LEVEL_SESSION, &cadence);
+snprintf(speed_buf, 50, "Avg Speed: %.2f m/s", rsMean(&speed)); //Session average speed String
+snprintf(cadence_buf, 50, "Peak Cadence: %.0f spm", cadence.max); //Session peak cadence String
 
 lcd.Clear(LCD_COLOR_BLACK);
 
 // Display the final total distance and final step count string at specific postion on the LCD screen
 lcd.DisplayStringAt(LINE(0),LINE(8), (uint8_t *)distance_buf, CENTER_MODE); //Distance Display on LCD.
 lcd.DisplayStringAt(LINE(0),LINE(9), (uint8_t *)stepcnt_buf, CENTER_MODE); //Step Cnt Display on LCD.
+lcd.DisplayStringAt(LINE(0),LINE(10), (uint8_t *)speed_buf, CENTER_MODE); //Average Speed Display on LCD.
+lcd.DisplayStringAt(LINE(0),LINE(11), (uint8_t *)cadence_buf, CENTER_MODE); //Peak Cadence Display on LCD.
 
 //Additional Data Display on the screen to make it more user friendly:
+#ifdef GYRO_CONTINUOUS
+char session_buf[50];                                           // Session length (closed seconds)
+char hms[16];
+format_hms(hms, sizeof(hms), stats->secondsClosed);
+snprintf(session_buf, 50, "[Session %s]", hms);
+lcd.DisplayStringAt(0, LINE(5), (uint8_t *)session_buf, CENTER_MODE);
+#else
 lcd.DisplayStringAt(0, LINE(5), (uint8_t *)"[Result in 20 sec]", CENTER_MODE);
+#endif
 
 //Additional Instruction for reset to be displayed on LCD after covering the 20s duration:
 lcd.DisplayStringAt(0, LINE(13), (uint8_t *)"Press Black Button", CENTER_MODE); 
@@ -268,292 +1047,757 @@ lcd.DisplayStringAt(0, LINE(14), (uint8_t *)"To Restart", CENTER_MODE);
 
 
 //=======================================================================================
-// FUNCTION TO RECEIVE GYROSCOPE DATA AND CALCULATE THE LINEAR DISTANCE OF 3 CO-ORDINATES
+// BOOT SEQUENCER:
 //=======================================================================================
-float* getGyroData(int32_t StartingAddress)          
+// Nothing at boot waits for work it does not depend on:
+//   main          SPI, sensor manager and acquisition thread; queues the control registers
+//   ACQUISITION   one auto-increment CTRL_REG1..CTRL_REG4 write per gyro, then sampling
+//   UI            constructs the LCD (SDRAM, LTDC, panel power-up), the layers, the splash
+//   DSP           drops the gyro's turn-on samples and measures its bias and noise at
+//                 rest (gpCalibrate), then runs the FSM from the first valid sample on
+// so the panel's power-up delays overlap the gyro's turn-on settling and calibration
+// instead of preceding them, and no fixed splash delay remains. The splash stays up until
+// the first live frame replaces it; the 20 s session starts at the first valid sample.
+// The timeline is printed with every pipeline report. The time to the first valid sample
+// counts from reset: the kernel clock starts before the C++ constructors run. The
+// timings and the milestones (BOOT_*, BootTimeline boot) are with the pipeline globals.
+// PANEL BRING-UP AND SPLASH (UI THREAD; main() IN THE BENCHMARK BUILD)
+void display_boot()
 {
-    int16_t raw_gx, raw_gy, raw_gz;                                         // Declare the variables to get raw angular velocities from Gyroscope
-    float gx, gy, gz;                                                       // Declared variables to store the filtered angular velocities data
+    new (lcdStorage) LCD_DISCO_F429ZI();         // BSP_LCD_Init: its register writes borrow the SPI bus from the acquisition thread
+    setup_background_layer();                    // Setting up the Background of the LCD layer to Black
+    setup_foreground_layer();                    // Setting up the foreground of the LCD layer to Green
+    Initial_ScreenDisp();                        // Welcome message, up until the first live frame
+    displayReady = true;
+    boot.display_us = (uint32_t)resetTimer.elapsed_time().count();
+}
 
+void print_boot_report()
+{
+    static const char *const calNames[] = { "off", "settling", "priming", "measuring", "seeded", "moved (online warm-up)" };
+    printf("  boot: main at %lu ms, sensor configured +%lu us, display +%lu us, calibration %s\n", (unsigned long)boot.main_ms,
+           (unsigned long)boot.configured_us, (unsigned long)boot.display_us, calNames[gyro.calState]);
+    if (boot.first_fsm_us != 0)
+    {
+        uint32_t ttfvs_ms = boot.main_ms + boot.first_valid_us / 1000;
+        printf("  boot: first valid sample %lu ms after reset (through the FSM +%lu ms), target %d ms%s\n", (unsigned long)ttfvs_ms,
+               (unsigned long)((boot.first_fsm_us - boot.first_valid_us) / 1000), BOOT_TARGET_MS, ttfvs_ms > BOOT_TARGET_MS ? "  <-- ABOVE TARGET" : "");
+    }
+}
 
-    flags.wait_all(DATA_READY_FLAG);                                        // Wait for the Data Ready flag to be set up to commence the SPI transfer
 
-    write_buf[0] = StartingAddress | 0x80 | 0x40;                           // Providing SPI Protocol for SDI [Read=1, Master=1]
-                                                                            // SDI --> R/Wbar  Master/Slavebar AD5 AD4 AD3 AD2 AD1 AD0 
-                                                                            //           1           1          0   0   0   0   0   0                [0x80 | 0x40]
+#ifdef GYRO_TELEMETRY
+//=======================================================================================
+// TELEMETRY LINK AND CLOCK SYNC (GYRO_TELEMETRY BUILD):
+//=======================================================================================
+// The telemetry build streams every decoded sample block as a binary frame
+// (lib/GyroDSP/telemetry_frame) on the serial port instead of the text log, for
+// host/agg_server. The same link carries the two-way time sync (lib/GyroDSP/clock_sync):
+// the logging thread sends a request when one is due and matches the host's responses, and
+// once the estimate has converged every frame is stamped in the host's timebase and flagged
+// TF_FLAG_SYNCED, so frames from several units line up. The pipeline itself keeps running
+// on resetTimer; only the frames carry shared time.
+//
+// t4 is taken when the logging thread reads a response. It is woken by the port's sigio
+// callback, so this is normally prompt; an exchange it read late only has a longer round
+// trip, which the estimator's delay filter discards.
+#define TELEMETRY_BAUD 921600                    // SERIAL RATE OF THE LINK (THE ST-LINK VIRTUAL COM PORT)
+#define TELEMETRY_QUEUE_LEN 4                    // DSP -> LOGGING FRAMES
+#define TELEMETRY_RX_LEN 64                      // RECEIVE BUFFER FOR SYNC RESPONSES
+#define TELEMETRY_PERIOD_US 5263                 // NOMINAL SAMPLE SPACING IN A FRAME (190 Hz ODR)
+#define TELEMETRY_POLL 10ms                      // LONGEST WAIT OF THE LOGGING THREAD (SYNC REQUESTS FALL DUE)
+#define TLM_FLAG_FRAME 0x1                       // EVENT FLAGS: A FRAME WAS QUEUED
+#define TLM_FLAG_RX 0x2                          // THE PORT CHANGED STATE (BYTES ARRIVED)
+
+// SAMPLES OF ONE BLOCK (DSP -> LOGGING); THE HEADER IS COMPLETED AND ENCODED BY THE LOGGING THREAD
+struct TelemetryMsg
+{
+    TfHeader header;
+    int16_t raw[SAMPLE_BLOCK_LEN][DIM_COUNT];
+};
+
+BufferedSerial telemetryPort(CONSOLE_TX, CONSOLE_RX, TELEMETRY_BAUD);
+BlockPool<TelemetryMsg, TELEMETRY_QUEUE_LEN> telemetryPool;
+Queue<TelemetryMsg, TELEMETRY_QUEUE_LEN> telemetryQueue;
+PipeEdge telemetryEdge = { "dsp->tlm", 0, 0, 0, 0 };
+EventFlags telemetryFlags;
+uint16_t telemetryDeviceId = 0;                  // FROM THE MCU UNIQUE ID
+uint16_t telemetrySeq = 0;                       // NEXT FRAME SEQUENCE NUMBER (DSP THREAD ONLY)
+ClockSync clockSync;                             // ESTIMATOR STATE (LOGGING THREAD ONLY)
+CsModel syncModel;                               // PUBLISHED ESTIMATE, COPIED UNDER A CRITICAL SECTION
+
+// THE CONSOLE IS THE TELEMETRY PORT, SO ANY STRAY printf CANNOT OPEN A SECOND DRIVER ON THE SAME UART
+FileHandle *mbed::mbed_override_console(int fd)
+{
+    return &telemetryPort;
+}
 
-    spi.transfer(write_buf, WRITELIMIT_SIZE1, read_buf, READLIMIT_SIZE1, spi_cb,SPI_EVENT_COMPLETE);  // SPI Transfer protocol with different byte limits for write and read buffers. WRITELIMIT_SIZE1 = 7, READLIMIT_SIZE1 = 7
-    flags.wait_all(SPI_FLAG);                                                 // Setup 'SPI_flag' flag to indicate the transfer is complete
+CsModel syncModelNow()
+{
+    CriticalSectionLock lock;
+    return syncModel;
+}
 
+// DEVICE ID: THE 96-BIT UNIQUE ID FOLDED TO 16 BITS (0 IS RESERVED FOR "UNSET")
+uint16_t telemetryMakeDeviceId()
+{
+    uint32_t h = HAL_GetUIDw0() ^ (HAL_GetUIDw1() * 0x9E3779B1u) ^ (HAL_GetUIDw2() * 0x85EBCA77u);
+    uint16_t id = (uint16_t)(h ^ (h >> 16));
+    return id != 0 ? id : 1;
+}
 
-    // Processing the raw data from the Gyroscope
-    raw_gx = (((uint16_t)read_buf[2]) << 8) | ((uint16_t)read_buf[1]);        // Store first 2 bytes from read_buf into raw_gx which is of 16bits (2 bytes)
-    raw_gy = (((uint16_t)read_buf[4]) << 8) | ((uint16_t)read_buf[3]);        // Store further 2 bytes from read_buf into raw_gy which is of 16bits (2 bytes)
-    raw_gz = (((uint16_t)read_buf[6]) << 8) | ((uint16_t)read_buf[5]);        // Store further 2 bytes from read_buf into raw_gz which is of 16bits (2 bytes)
+// SIGIO CALLBACK (INTERRUPT CONTEXT): WAKE THE LOGGING THREAD
+void telemetry_sigio()
+{
+    telemetryFlags.set(TLM_FLAG_RX);
+}
 
+// HAND A DECODED BLOCK TO THE LOGGING THREAD AS ONE FRAME (DSP THREAD). A FRAME DROPPED FOR
+// LACK OF A BUFFER STILL USES UP ITS SEQUENCE NUMBER, SO THE HOST COUNTS IT AS LOST
+void telemetryPost(const RawSampleMsg *samples, int n)
+{
+    uint16_t seq = telemetrySeq++;
+    TelemetryMsg *t = telemetryPool.alloc();
+    if (t == NULL || n == 0)
+    {
+        if (t != NULL)
+        {
+            telemetryPool.free(t);
+        }
+        edgeDropped(&telemetryEdge);
+        return;
+    }
+    CsModel model = syncModelNow();
+    memset(&t->header, 0, sizeof(t->header));
+    t->header.count = (uint8_t)n;
+    t->header.deviceId = telemetryDeviceId;
+    t->header.seq = seq;
+    t->header.t0Us = csToShared(&model, samples[0].t_us);
+    t->header.periodUs = TELEMETRY_PERIOD_US;
+    t->header.flags = model.synced ? TF_FLAG_SYNCED : 0;
+    for (int i = 0; i < n; i++)
+    {
+        memcpy(t->raw[i], samples[i].raw, sizeof(t->raw[i]));
+    }
+    telemetryQueue.try_put(t);
+    edgeSent(&telemetryEdge);
+    telemetryFlags.set(TLM_FLAG_FRAME);
+}
 
-    //Storing the Filtered Angular Velocity values for each sample into the 'angularVelocity' memory array:
-    angularVelocity[i_cnt][0]=raw_gx;
-    angularVelocity[i_cnt][1]=raw_gy;
-    angularVelocity[i_cnt][2]=raw_gy;
+// MATCH EVERY COMPLETE SYNC RESPONSE IN THE RECEIVE BUFFER; OTHER BYTES ARE SKIPPED
+void telemetryParseRx(uint8_t *rx, size_t *len, uint32_t t4)
+{
+    size_t off = 0;
+    while (off < *len)
+    {
+        TfView v;
+        size_t used;
+        TfStatus st = tfParse(rx + off, *len - off, &v, &used);
+        off += used;
+        if (st == TF_NEED_MORE)
+        {
+            break;
+        }
+        if (st == TF_OK && (v.header.flags & TF_FLAG_SYNC_RESP) && v.header.deviceId == telemetryDeviceId &&
+            csResponse(&clockSync, v.header.seq, v.header.t0Us, v.header.sendUs, t4))
+        {
+            CriticalSectionLock lock;
+            syncModel = clockSync.model;
+        }
+    }
+    memmove(rx, rx + off, *len - off);
+    *len -= off;
+}
 
-    // Calculating and displaying the current filtered angular velocity values of all 3 co-ordinates as well as the Average angular velocity:
-    float avg_AngVel= angularVelocity[i_cnt][0]+angularVelocity[i_cnt][1]+angularVelocity[i_cnt][2]/DIM_COUNT;
-    printf("\nFiltered Angular Velocity:-> \tgx_AngVel: %f \t gy_AngVel: %f \t gz_AngVel: %f\t Avg_AngVel:%f\n",angularVelocity[i_cnt][0],angularVelocity[i_cnt][1],angularVelocity[i_cnt][2], avg_AngVel );
-    i_cnt++;
+// LOGGING THREAD OF THE TELEMETRY BUILD: FRAMES OUT, SYNC REQUESTS OUT, SYNC RESPONSES IN
+void telemetry_thread()
+{
+    uint8_t frame[TF_FRAME_SIZE(SAMPLE_BLOCK_LEN)];
+    uint8_t rx[TELEMETRY_RX_LEN];
+    size_t rxLen = 0;
 
-    if(i_cnt==DUR_SAMPLE_COUNT)       // Checking if i_cnt == 40 for the Array Index
+    while (true)
     {
-        i_cnt=0;                      // Set i_cnt to '0' as the 'angularVelocity' memory is full, as it covered all the values for 20s duarion! [20/0.5 = 40]
-    }
+        telemetryFlags.wait_any_for(TLM_FLAG_FRAME | TLM_FLAG_RX, TELEMETRY_POLL);
+
+        // Responses first, so t4 is read as soon as the thread wakes
+        while (telemetryPort.readable())
+        {
+            if (rxLen == sizeof(rx))
+            {
+                rxLen = 0;                       // Nothing but noise: start over
+            }
+            ssize_t got = telemetryPort.read(rx + rxLen, sizeof(rx) - rxLen);
+            uint32_t t4 = (uint32_t)resetTimer.elapsed_time().count();
+            if (got <= 0)
+            {
+                break;
+            }
+            rxLen += (size_t)got;
+            telemetryParseRx(rx, &rxLen, t4);
+        }
 
+        LogMsg *m;
+        while (logQueue.try_get(&m))             // The text records have no place on a binary link
+        {
+            edgeReceived(&logEdge);
+            logPool.free(m);
+        }
 
-    //Conversion of Filtered Angular Velocity to Linear Velocity using the scaling factor of all 3 co-ordinates:
-    gx = ((float)raw_gx) * ScalingFactor;       //X-Dimension
-    gy = ((float)raw_gy) * ScalingFactor;       //Y-Dimension
-    gz = ((float)raw_gz) * ScalingFactor;       //Z-Dimension
+        TelemetryMsg *t;
+        while (telemetryQueue.try_get(&t))
+        {
+            edgeReceived(&telemetryEdge);
+            uint32_t start = cycleCounterNow();
+            CsModel model = syncModelNow();
+            if ((t->header.flags & TF_FLAG_SYNCED) && model.synced)
+            {
+                t->header.sendUs = csToShared(&model, (uint32_t)resetTimer.elapsed_time().count());   // Unsynced frames leave it 0 (unknown)
+            }
+            size_t n = tfEncode(frame, &t->header, t->raw);
+            telemetryPool.free(t);
+            telemetryPort.write(frame, n);
+            stageAccount(STAGE_LOG, start);
+        }
 
-    // Temporary registers to store current linear velocity values of all 3 co-ordinates:
-    window_gx[window_index]  = gx;              //X-Dimension
-    window_gy[window_index]  = gy;              //Y-Dimension
-    window_gz[window_index]  = gz;              //Z-Dimension
+        uint16_t seq;
+        uint32_t t1 = (uint32_t)resetTimer.elapsed_time().count();
+        if (csPoll(&clockSync, t1, &seq))
+        {
+            TfHeader h = {};
+            h.deviceId = telemetryDeviceId;
+            h.seq = seq;
+            h.flags = TF_FLAG_SYNC_REQ;
+            h.sendUs = t1;
+            size_t n = tfEncode(frame, &h, NULL);
+            telemetryPort.write(frame, n);
+        }
+    }
+}
+#endif
 
 
-    // LPF LOW PASS FILTER: (This can also be used to the replacement of the Moving Average Filter, but might not be accurate enough)
-    // filtered_gx = FILTER_COEFFICIENT * gx + (1 - FILTER_COEFFICIENT) * filtered_gx;
-    // filtered_gy = FILTER_COEFFICIENT * gy + (1 - FILTER_COEFFICIENT) * filtered_gy;
-    // filtered_gz = FILTER_COEFFICIENT * gz + (1 - FILTER_COEFFICIENT) * filtered_gz;
+//=======================================================================================
+// PIPELINE THREAD BODIES:
+//=======================================================================================
+#define SESSION_STOP_BLOCK NULL                  // BLOCK POINTER THAT STOPS THE DSP THREAD
+#define ALIGN_PERIOD_US 5263                     // MULTI-SENSOR ALIGNMENT GRID = THE 190 Hz ODR
 
+#if SENSOR_COUNT > 1
+SmAligner aligner;                               // ALL GYROS RESAMPLED ONTO ONE GRID (DSP THREAD ONLY)
+uint32_t alignedFrames = 0;
+uint32_t alignSpanMaxUs = 0;                     // WIDEST SAMPLE GAP INTERPOLATED ACROSS
+#endif
 
-    // Introducing the Moving Average Filter to Filter the linear velocity values of all 3 co-ordinates. 
-    // Moving Average Filter will smoothen the graph for linear velocity values of all 3 co-ordinates when we observe it on TelePlot. 
-    float avg_gx = 0.0f, avg_gy = 0.0f, avg_gz = 0.0f;   // Declare local variables to store the Average values of all 3 co-ordinates.
-    for (int i = 0; i < WINDOW_SIZE; i++)                // Averaging Algorithm TO SMOOTHEN the coefficients of the gyroscope readings, reducing noise impacts
+// BULK DECODE: EVERY COMPLETED FRAME OF A BLOCK INTO X, Y, Z COUNTS. RETURNS THE SAMPLE COUNT
+int decodeSampleBlock(const SampleBlock *b, RawSampleMsg *out)
+{
+    for (int i = 0; i < b->count; i++)
     {
-        avg_gx += window_gx[i];                          // Integrating the x co-ordinate linear velocity values for each sample time
-        avg_gy += window_gy[i];                          // Integrating the y co-ordinate linear velocity values for each sample time
-        avg_gz += window_gz[i];                          // Integrating the z co-ordinate linear velocity values for each sample time
+        out[i].t_us = b->t_us[i];
+        gpDecodeFrame(b->frame[i], out[i].raw);
     }
-    avg_gx /= WINDOW_SIZE;                               // Averaged x co-ordinate linear velocity value for the current sample time
-    avg_gy /= WINDOW_SIZE;                               // Averaged y co-ordinate linear velocity value for the current sample time
-    avg_gz /= WINDOW_SIZE;                               // Averaged z co-ordinate linear velocity value for the current sample time
+    return b->count;
+}
 
-    // Storing the Filtered Linear Velocity values for each sample into the 'linearVelocity' memory array:
-    linearVelocity[j_cnt][0]=avg_gx;
-    linearVelocity[j_cnt][1]=avg_gy;
-    linearVelocity[j_cnt][2]=avg_gz;
+void blockLatency(uint32_t latency_us)
+{
+    core_util_atomic_incr_u32(&blockStats.blocks, 1);
+    core_util_atomic_fetch_add_u32(&blockStats.latencySumUs, latency_us);
+    if (latency_us > blockStats.latencyMaxUs)
+    {
+        blockStats.latencyMaxUs = latency_us;    // Only the DSP thread writes the maximum
+    }
+}
 
-    // Calculating and displaying the current filtered linear velocity values of all 3 co-ordinates as well as the Average linear velocity:
-    float avg_LinVel= linearVelocity[j_cnt][0]+linearVelocity[j_cnt][1]+linearVelocity[j_cnt][2]/DIM_COUNT;
-    printf("\nFiltered Linear Velocity:-> \tgx_LinVel: %f \t gy_LinVel: %f \t gz_LinVel: %f\t Avg_LinVel:%f\n",linearVelocity[j_cnt][0],linearVelocity[j_cnt][1],linearVelocity[j_cnt][2], avg_LinVel );
-    j_cnt++;
+#ifdef GYRO_CONTINUOUS
+// ROLLING WINDOWS FOR THE UI SNAPSHOTS, RECOMPUTED ONLY WHEN A SECOND CLOSES (DSP THREAD)
+struct UiWindows
+{
+    uint32_t secondsClosed;                      // gyro.stats.secondsClosed THEY WERE COMPUTED AT
+    float distShort;                             // LAST WINDOW_SHORT_S CLOSED SECONDS
+    float distLong;                              // LAST WINDOW_LONG_S CLOSED SECONDS
+};
+UiWindows uiWindows CCM_BSS;                     // ZERO = NOTHING CLOSED YET
 
-    if(j_cnt==DUR_SAMPLE_COUNT)       // if j_cnt == 40
+void ui_windows_update()
+{
+    if (uiWindows.secondsClosed == gyro.stats.secondsClosed)
     {
-        j_cnt=0;                      // Set j_cnt to '0' as the 'linearVelocity' memory is full, as it covered all the values for 20s duarion!  [20/0.5 = 40]
+        return;
     }
+    RsSummary recent;
+    rsRecent(&gyro.stats, RS_DISTANCE, RS_LEVEL_SECOND, WINDOW_SHORT_S, &recent);
+    uiWindows.distShort = (float)recent.sum;
+    rsRecent(&gyro.stats, RS_DISTANCE, RS_LEVEL_SECOND, WINDOW_LONG_S, &recent);
+    uiWindows.distLong = (float)recent.sum;
+    uiWindows.secondsClosed = gyro.stats.secondsClosed;
+}
+#endif
 
+// DSP STAGE FOR ONE DECODED SAMPLE: FILTERS, FSM (ONCE PER GP_FSM_PERIOD_US) AND THE UI SNAPSHOT
+void process_sample(const RawSampleMsg *sample, uint32_t decode_us, uint32_t *last_ui_us, uint32_t ui_period_us)
+{
+    if (gpCalibrating(&gyro))
+    {
+        gpCalibrate(&gyro, sample->t_us, sample->raw);                                   // Turn-on settling and rest calibration: nothing reaches the FSM yet
+        return;
+    }
 
+    SampleLineage lineage;
+    lineage.capture_us = sample->t_us;
+    lineage.decode_us = decode_us;
 
-    // The filtered linear velocity readings can also be outputted onto the file:
-    //Commented this section, as we have used arrays to store the readings and display them.
-    // if (file == NULL) {
-    //     fprintf(stderr, "Error opening file for writing.\n");
-       
-    // }
-    // fprintf(file, "%f, %f, %f", avg_gx, avg_gy, avg_gz);
-    // fflush(file);
-   
-   
-    // Individual co-ordinates distance Determination:  
-    // Single co-ordinate distance = (Filtered/Averaged) Linear Velocity * Radius * Time; where Time = 0.5s
-    float gx_length = (avg_gx)* (Radius) * 0.5; //Length in Dimension acorss-X
-    float gy_length = (avg_gy)* (Radius) * 0.5; //Length in Dimension acorss-Y
-    float gz_length = (avg_gz)* (Radius) * 0.5; //Length in Dimension acorss-Z
+    float *gyroCurrDimData = gpFilter(&gyro, sample->t_us, sample->raw);                 // Get the Gyroscope Data (individual x,y,z co-ordinate distance; NULL between 0.5s FSM steps)
+    lineage.filter_us = (uint32_t)resetTimer.elapsed_time().count();
+    if (gyroCurrDimData != NULL)
+    {
+        logPost(LOG_INPUT, 0, gyroCurrDimData[0], gyroCurrDimData[1], gyroCurrDimData[2]);   // Print the x, y, z co-ordinate distance onto the terminal
+    }
+    gpRunFSM(&gyro, gyroCurrDimData, sample->t_us);
+    lineage.fsm_us = (uint32_t)resetTimer.elapsed_time().count();
 
-    //WE can also display the above readings onto the serial monitor, as follows:
-    //printf("\nFiltered LENGTH:-> \tgx: %f \t gy: %f \t gz: %f\n", gx_length, gy_length, gz_length);
-    
-    //Thread Sleep -Optional Section: Can be omitted as well
-    // thread_sleep_for(500); //When added, the displaying of the values can be seen comfortably.
+    lhAdd(&latHist[HOP_CAPTURE_DECODE], lineage.decode_us - lineage.capture_us);
+    lhAdd(&latHist[HOP_DECODE_FILTER], lineage.filter_us - lineage.decode_us);
+    lhAdd(&latHist[HOP_FILTER_FSM], lineage.fsm_us - lineage.filter_us);
+    if (boot.first_fsm_us == 0)
+    {
+        boot.first_valid_us = lineage.capture_us;
+        boot.first_fsm_us = lineage.fsm_us;
+        bootFirstValid.release();                                                        // Starts the session clock in main()
+    }
 
-    result[0]=gx_length;               // Storing the x co-ordinate distance in the 'result' register final array
-    result[1]=gy_length;               // Storing the y co-ordinate distance in the 'result' register final array
-    result[2]=gz_length;               // Storing the z co-ordinate distance in the 'result' register final array
+    // Snapshot for the UI, rate-matched to the UI frame rate so the edge only fills up when the UI really falls behind
+    if ((uint32_t)(sample->t_us - *last_ui_us) >= ui_period_us)
+    {
+        UiMsg *u = uiPool.alloc();
+        if (u == NULL)
+        {
+            edgeDropped(&uiEdge);
+        }
+        else
+        {
+            RsSummary lastSecondSpeed;
+            rsLast(&gyro.stats, RS_SPEED, RS_LEVEL_SECOND, &lastSecondSpeed);
+            u->totalDist = gyro.totalDist;
+            u->stepcnt = gyro.stepCnt;
+            u->activity = gyro.activity.current;
+            u->speed = rsMean(&lastSecondSpeed);
+#ifdef GYRO_CONTINUOUS
+            ui_windows_update();
+            u->session_s = uiWindows.secondsClosed;
+            u->dist_short = uiWindows.distShort;
+            u->dist_long = uiWindows.distLong;
+#endif
+            u->lineage = lineage;
+            uiQueue.try_put(u);
+            edgeSent(&uiEdge);
+            *last_ui_us = sample->t_us;
+        }
+    }
+}
 
+// DSP THREAD: ONE BLOCK AT A TIME, BULK DECODE THEN FILTERING FOR EVERY SAMPLE, FSM AND DISTANCE/STEP LOGIC ONCE PER GP_FSM_PERIOD_US
+void dsp_thread()
+{
+    uint32_t last_ui_us = 0;
+    const uint32_t ui_period_us = (uint32_t)chrono::duration_cast<chrono::microseconds>(UI_FRAME_PERIOD).count();
+    RawSampleMsg samples[SAMPLE_BLOCK_LEN];
 
-    //Resetting the window index for the Moving Average Filter to zero, to repeat the averaging on new set of readings:
-    window_index = (window_index + 1) % WINDOW_SIZE;
+    while (true)
+    {
+        SampleBlock *b = SESSION_STOP_BLOCK;
+        fullBlocks.try_get_for(Kernel::wait_for_u32_forever, &b);
+        edgeReceived(&sampleEdge);
+        if (b == SESSION_STOP_BLOCK)
+        {
+            return;
+        }
+        uint32_t start = cycleCounterNow();
+        blockLatency((uint32_t)resetTimer.elapsed_time().count() - b->complete_us);
+        int n = decodeSampleBlock(b, samples);
+        uint32_t decode_us = (uint32_t)resetTimer.elapsed_time().count();
+        blockPool.free(b);                       // Return the block before the heavy work so acquisition can refill it
 
-    //Consolidated array return at the state machine:
-    return result;                    // Returning the 'result' register which holds individual co-ordinate distance values.
+        for (int k = 0; k < n; k++)
+        {
+            process_sample(&samples[k], decode_us, &last_ui_us, ui_period_us);
+        }
+#ifdef GYRO_TELEMETRY
+        telemetryPost(samples, n);
+#endif
+#if SENSOR_COUNT > 1
+        SmAligned aligned;
+        while (smAlignNext(&aligner, &sensors, &aligned))   // Drain the other gyros' streams, time-aligned with the primary
+        {
+            alignedFrames++;
+            if (aligned.spanUs > alignSpanMaxUs)
+            {
+                alignSpanMaxUs = aligned.spanUs;
+            }
+        }
+#endif
+        stageAccount(STAGE_DSP, start);
+    }
 }
 
-
-//Function to calculate the resultant distance using all the 3 individual co-ordinate distances by passing the 'result' register
-float calculateDist3Dim(float gyroDimDegRes[])    
+// UI THREAD: REDRAWS THE LATEST SNAPSHOT, AT MOST ONCE PER UI_FRAME_PERIOD
+void ui_thread()
 {
-    //Distance Calculation using the 3 Dimensional Distance Formula:
-    float xSqr=(gyroDimDegRes[0]-gX_ref)*(gyroDimDegRes[0]-gX_ref);   // Squaring the x co-ordinate distance.
-    float ySqr=(gyroDimDegRes[1]-gY_ref)*(gyroDimDegRes[1]-gY_ref);   // Squaring the y co-ordinate distance.
-    float zSqr=(gyroDimDegRes[2]-gZ_ref)*(gyroDimDegRes[2]-gZ_ref);   // Squaring the z co-ordinate distance.
-    float distcalc=sqrt(xSqr+ ySqr + zSqr);                           // The resultant distance is calculated by taking squareroot of all three integrated squared co-ordinate distances.
+    if (!displayReady)
+    {
+        display_boot();                                              // Panel power-up overlaps the gyro's turn-on and calibration
+    }
+    Kernel::Clock::time_point next_frame = Kernel::Clock::now();
+    while (session_running)
+    {
+        next_frame += UI_FRAME_PERIOD;
+        if (next_frame < Kernel::Clock::now())
+        {
+            next_frame = Kernel::Clock::now();                       // A frame overran: skip ahead instead of bursting to catch up
+        }
+        ThisThread::sleep_until(next_frame);
+
+        UiMsg latest;
+        bool have_frame = false;
+        UiMsg *u;
+        while (uiQueue.try_get(&u))                                  // Only the newest snapshot is drawn
+        {
+            latest = *u;
+            uiPool.free(u);
+            edgeReceived(&uiEdge);
+            have_frame = true;
+        }
+        if (!have_frame)
+        {
+            continue;
+        }
 
-    printf("\nCurrent Input Calc: \t%f\n", distcalc);                 // Statement to print the current resultant distance while moving.
+        uint32_t start = cycleCounterNow();
+        uint32_t render_us = (uint32_t)resetTimer.elapsed_time().count();
+#ifdef GYRO_CONTINUOUS
+        CALC_Continuous_ScreenDisp(&latest);                                                         // Function to display the session totals and the rolling windows onto the LCD screen
+#else
+        CALC_ScreenDisp(latest.totalDist, latest.stepcnt, actName(latest.activity), latest.speed);   // Function to display current total distance travelled and current total step count within 20s duration onto the LCD screen
+#endif
+        uint32_t present_us = (uint32_t)resetTimer.elapsed_time().count();                           // The LTDC scans the framebuffer directly, so the frame is live once drawn
+        lhAdd(&latHist[HOP_FSM_RENDER], render_us - latest.lineage.fsm_us);
+        lhAdd(&latHist[HOP_RENDER_PRESENT], present_us - render_us);
+        lhAdd(&latHist[HOP_END_TO_END], present_us - latest.lineage.capture_us);
+        stageAccount(STAGE_UI, start);
+    }
+}
 
-    //Updating the Reference points to the newly moved point as the person moves:
-    gX_ref=gyroDimDegRes[0];                                          // Updating x-cordinate reference point for resultant distance calculation
-    gY_ref=gyroDimDegRes[1];                                          // Updating y-cordinate reference point for resultant distance calculation
-    gZ_ref=gyroDimDegRes[2];                                          // Updating z-cordinate reference point for resultant distance calculation
+#define REPORT_CELL_LEN 16                       // ONE REPORT TABLE CELL, PADDING AND TERMINATOR INCLUDED
 
+// REPORT TABLE CELL: 'fmt' FORMATTED, THEN PADDED WITH SPACES TO |width| (RIGHT-ALIGNED, LEFT-ALIGNED WHEN width < 0).
+// minimal-printf HAS NO FLAGS OR FIELD WIDTHS, SO THE REPORT TABLES PAD THEIR OWN COLUMNS. RETURNS 'out'.
+const char *report_cell(char out[REPORT_CELL_LEN], int width, const char *fmt, ...)
+{
+    char text[REPORT_CELL_LEN];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+
+    int len = (int)strlen(text);
+    int pad = (width < 0 ? -width : width) - len;
+    pad = pad < 0 ? 0 : (pad > REPORT_CELL_LEN - 1 - len ? REPORT_CELL_LEN - 1 - len : pad);
+    memcpy(width < 0 ? out : out + pad, text, len);
+    memset(width < 0 ? out + len : out, ' ', pad);
+    out[len + pad] = '\0';
+    return out;
+}
 
-    //Logic for incrementing the Step Count:
-    if(distcalc>=0.00280)   //Post multiple trials, we observed this threshold value to efficient in determining the step count
+// PER-THREAD CPU UTILIZATION AND PER-EDGE QUEUE REPORT (PRINTED BY THE LOGGING THREAD)
+template <typename T, uint16_t N>
+void print_pool_stats(const char *name, const BlockPool<T, N> *pool)
+{
+    BlockPoolStats st;
+    pool->stats(&st);
+    char c[7][REPORT_CELL_LEN];
+    printf("  %s %s %s/%s %s %s %s\n", report_cell(c[0], -9, "%s", name), report_cell(c[1], 6, "%u", st.inUse),
+           report_cell(c[2], 8, "%u", st.highWater), report_cell(c[3], -6, "%u", st.capacity), report_cell(c[4], 9, "%lu", (unsigned long)st.allocs),
+           report_cell(c[5], 7, "%lu", (unsigned long)st.failures), report_cell(c[6], 9, "%lu", (unsigned long)st.badFrees));
+}
+
+void print_pipeline_report(uint32_t interval_cycles)
+{
+    printf("\n[PIPELINE] interval %.2f s", (float)interval_cycles / cycleCounterHz());
+#if defined(MBED_CPU_STATS_ENABLED)
+    static uint64_t last_uptime = 0, last_idle = 0;
+    mbed_stats_cpu_t cpu;
+    mbed_stats_cpu_get(&cpu);
+    uint64_t d_up = cpu.uptime - last_uptime, d_idle = cpu.idle_time - last_idle;
+    last_uptime = cpu.uptime;
+    last_idle = cpu.idle_time;
+    printf(", idle %.1f%%", d_up ? 100.0f * (float)d_idle / (float)d_up : 0.0f);
+#endif
+    printf("\n  stage   busy%%    items\n");
+    for (int i = 0; i < STAGE_COUNT; i++)
+    {
+        uint32_t busy = core_util_atomic_exchange_u32(&stageStats[i].busyCycles, 0);
+        uint32_t items = core_util_atomic_exchange_u32(&stageStats[i].items, 0);
+        char c[3][REPORT_CELL_LEN];
+        printf("  %s %s %s\n", report_cell(c[0], -5, "%s", stageStats[i].name),
+               report_cell(c[1], 6, "%.2f", interval_cycles ? 100.0f * (float)busy / (float)interval_cycles : 0.0f), report_cell(c[2], 8, "%lu", (unsigned long)items));
+    }
+    printf("  edge        sent  dropped  high-water\n");
+    PipeEdge *edges[] = { &sampleEdge, &uiEdge, &logEdge };
+    for (PipeEdge *e : edges)
+    {
+        char c[4][REPORT_CELL_LEN];
+        printf("  %s %s %s %s\n", report_cell(c[0], -9, "%s", e->name), report_cell(c[1], 7, "%lu", (unsigned long)e->sent),
+               report_cell(c[2], 8, "%lu", (unsigned long)e->dropped), report_cell(c[3], 11, "%lu", (unsigned long)e->highWater));
+    }
+    printf("  spi overruns %lu, drdy recovered %lu\n", (unsigned long)spiOverruns, (unsigned long)drdyRecovered);
+    printf("  acq events lost:");
+    for (int i = 0; i < POST_SOURCE_COUNT; i++)
+    {
+        printf(" %s %lu", kPostSourceNames[i], (unsigned long)core_util_atomic_load_u32(&acqPostsFailed[i]));
+    }
+    printf("\n");
+    printf("  sensor grp   samples   missed  stream-drops  max-wait-us\n");
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++)
+    {
+        const SmDevice *d = &sensors.dev[i];
+        char c[6][REPORT_CELL_LEN];
+        printf("  %s %s %s %s %s %s\n", report_cell(c[0], 6, "%u", i), report_cell(c[1], 3, "%u", d->config.group),
+               report_cell(c[2], 9, "%lu", (unsigned long)d->samples), report_cell(c[3], 8, "%lu", (unsigned long)d->missed),
+               report_cell(c[4], 13, "%lu", (unsigned long)d->streamDrops), report_cell(c[5], 12, "%lu", (unsigned long)d->maxWaitUs));
+    }
+    print_boot_report();
+    if (bus_report_fetch())
     {
-        ++step_cnt;                                                   // if the resultant distance is greater than 0.0028m, the person has moved by one step.
+        printf("  spi bus %.1f%% busy, %lu transfers, %lu bytes\n", 100.0f * busReport.utilization, (unsigned long)busReport.transfers,
+               (unsigned long)busReport.bytes);
     }
-    
-    // else
-    // {
-    //     step_cnt=step_cnt;
-    // }
+#if SENSOR_COUNT > 1
+    printf("  aligned frames %lu, widest interpolation span %lu us\n", (unsigned long)alignedFrames, (unsigned long)alignSpanMaxUs);
+#endif
+    uint32_t blocks = core_util_atomic_exchange_u32(&blockStats.blocks, 0);
+    uint32_t latency_sum = core_util_atomic_exchange_u32(&blockStats.latencySumUs, 0);
+    printf("  blocks %lu, block-complete latency mean %lu us max %lu us, block overruns %lu\n", (unsigned long)blocks,
+           (unsigned long)(blocks ? latency_sum / blocks : 0), (unsigned long)blockStats.latencyMaxUs, (unsigned long)blockStats.overruns);
+    printf("  pool      in-use  high-water/size    allocs  failed  bad-free\n");
+    print_pool_stats("spi-txn", &spiTxnPool);
+    print_pool_stats("block", &blockPool);
+    print_pool_stats("ui", &uiPool);
+    print_pool_stats("log", &logPool);
+    printf("  font glyphs unpacked %lu of %u, drawn outside the subset %lu\n", (unsigned long)Font16.Packed->Unpacked,
+           (unsigned)Font16.Packed->Count, (unsigned long)Font16.Packed->Misses);
+    lhPrintHeader();
+    for (int i = 0; i < HOP_COUNT; i++)
+    {
+        lhPrint(&latHist[i]);
+    }
+    for (int i = 0; i < HOP_COUNT; i++)
+    {
+        lhDump(&latHist[i]);                     // Machine-readable copy for host tools
+    }
+#if defined(MBED_HEAP_STATS_ENABLED)
+    mbed_stats_heap_t heap;
+    mbed_stats_heap_get(&heap);
+    printf("  heap allocs since start %lu (current %lu bytes)%s\n", (unsigned long)(heap.alloc_cnt - heapAllocsAtStart),
+           (unsigned long)heap.current_size, heap.alloc_cnt != heapAllocsAtStart ? "  <-- HEAP USED IN STEADY STATE" : "");
+#endif
+}
 
-   return distcalc;                                                   // Returning the resultant distance value.
+// LOGGING THREAD: ALL SERIAL OUTPUT, SO BLOCKING printf NEVER STALLS ACQUISITION OR DSP
+void logging_thread()
+{
+    const uint32_t report_cycles = (uint32_t)(cycleCounterHz() * (uint64_t)chrono::duration_cast<chrono::milliseconds>(CPU_REPORT_PERIOD).count() / 1000);
+    uint32_t last_report = cycleCounterNow();
 
-   //Also the code can be modififed to return the stepcnt with the distance, but not doing it as it was not critical part of the requirement of challenge.
+    while (true)
+    {
+        LogMsg *m;
+        if (logQueue.try_get_for(50ms, &m))
+        {
+            edgeReceived(&logEdge);
+            uint32_t start = cycleCounterNow();
+            switch (m->kind)
+            {
+                case LOG_ANG_VEL:
+                    printf("\nFiltered Angular Velocity:-> \tgx_AngVel: %f \t gy_AngVel: %f \t gz_AngVel: %f\t Avg_AngVel:%f\n", m->v[0], m->v[1], m->v[2], m->v[3]);
+                    break;
+                case LOG_LIN_VEL:
+                    printf("\nFiltered Linear Velocity:-> \tgx_LinVel: %f \t gy_LinVel: %f \t gz_LinVel: %f\t Avg_LinVel:%f\n", m->v[0], m->v[1], m->v[2], m->v[3]);
+                    break;
+                case LOG_INPUT:
+                    printf("\nInput Gyro Data: %f\t%f\t%f", m->v[0], m->v[1], m->v[2]);
+                    break;
+                case LOG_CALC:
+                    printf("\nCurrent Input Calc: \t%f\n", m->v[0]);
+                    break;
+                case LOG_TOTAL:
+                    printf("\nTotal Distance Travelled So Far:%f\t", m->v[0]);
+                    printf("\nTotal Step Counts So Far:\t %lu", (unsigned long)(uint32_t)m->i);
+                    break;
+                case LOG_ACTIVITY:
+                    printf("\nActivity: %s \t(mean %.2f rad/s, peaks %.2f /s, worst %lu cycles/sample)\n", actName((ActivityClass)m->i), m->v[0], m->v[1], (unsigned long)m->v[2]);
+                    break;
+            }
+            logPool.free(m);
+            stageAccount(STAGE_LOG, start);
+        }
+
+        uint32_t now = cycleCounterNow();
+        if ((uint32_t)(now - last_report) >= report_cycles)
+        {
+            print_pipeline_report(now - last_report);
+            last_report = now;
+        }
+    }
 }
 
+
 //======================================================================
 //MAIN FUNCTION:
 //======================================================================
 int main()
  {  
-    // Setting up the Background of the LCD layer to Black:
-    setup_background_layer();
-   
-    // Setting up the foreground of the LCD layer to Green:
-    setup_foreground_layer();
-
-    // Interrupt Initialization:
-    InterruptIn int2(PA_2, PullDown);           // Declaring a PullDown event centric Interrupts
-    int2.rise(&data_cb);                        // Configuring the rise transition interrupt to trigger 'data_cb' callback function to implicitly set the data ready 'DATA_READY_FLAG' flag.
-
-    // Sampling the data every 0.5seconds using the Ticker HAL Interrupts:
-    t.attach(&cb, TICKER_LIMIT);                // TICKER_LIMIT = 500ms
-   
-    // Setting up the SPI format and frequency
-    spi.format(8, 3);                           // Transferable bits = 8, SPI MODE = 3 [Clock starting position = High, Data received on rising edge of the clock]
-    spi.frequency(1'000'000);                   // SPI frequency set to 1MHz
-
-
-    // Writing the Control Register 1 address and configuration onto write buffer
-    write_buf[0] = CTRL_REG1;
-    write_buf[1] = CTRL_REG1_CONFIG;
-    spi.transfer(write_buf, WRITELIMIT_SIZE, read_buf, READLIMIT_SIZE, spi_cb,SPI_EVENT_COMPLETE);   // SPI transfer using WRITELIMIT_SIZE = 2 and READLIMIT_SIZE = 2
-    flags.wait_all(SPI_FLAG);                                                                        // Setup 'SPI_flag' flag to indicate the transfer is complete
-
-    // Writing the Control Register 4 address and configuration onto write buffer
-    write_buf[0] = CTRL_REG4;
-    write_buf[1] = CTRL_REG4_CONFIG;
-    spi.transfer(write_buf, WRITELIMIT_SIZE, read_buf, READLIMIT_SIZE, spi_cb,SPI_EVENT_COMPLETE);   // SPI transfer using WRITELIMIT_SIZE = 2 and READLIMIT_SIZE = 2
-    flags.wait_all(SPI_FLAG);                                                                        // Setup 'SPI_flag' flag to indicate the transfer is complete
-
-    // Writing the Control Register 1 address and configuration onto write buffer
-    write_buf[0] = CTRL_REG3;
-    write_buf[1] = CTRL_REG3_CONFIG;
-    spi.transfer(write_buf, WRITELIMIT_SIZE, read_buf, READLIMIT_SIZE, spi_cb,SPI_EVENT_COMPLETE);  // SPI transfer using WRITELIMIT_SIZE = 2 and READLIMIT_SIZE = 2
-    flags.wait_all(SPI_FLAG);                                                                       // Setup 'SPI_flag' flag to indicate the transfer is complete
-
-    write_buf[1] = 0xFF;                                                                            // To mark end of writing. 0xFF = Reserved
+    // Boot timeline origin: the kernel clock has been running since reset, the session timer starts now
+    boot.main_ms = (uint32_t)Kernel::Clock::now().time_since_epoch().count();
+    resetTimer.start();
 
+#ifdef GYRO_BENCH
+    // Benchmark build: report the kernel costs in CPU cycles before starting the application.
+    cycleCounterInit();
+    printf("\nON-TARGET BENCHMARKS [%s/op]\n", BENCH_UNIT);
+    benchRunVecMath();
+    benchRunHampel();
+    benchRunPipeline();
+    benchRunFormat();
+    benchRunFft();
+#endif
+
+    // Cycle counter for the per-thread CPU accounting:
+    cycleCounterInit();
+
+#ifdef GYRO_BENCH
+    // Benchmark build: the rendering cases need the panel and the layers up (nothing else is on the bus yet); then dump every result as JSON between markers for the host.
+    display_boot();
+    benchRunLcd(&lcd);
+    benchRunCcm();
+    printf("\n--- BENCH JSON BEGIN ---\n");
+    benchWriteJson(stdout, "disco_f429zi");
+    printf("--- BENCH JSON END ---\n");
+#endif
 
-    //Polling data ready flag:
-    if (!(flags.get() & DATA_READY_FLAG) && (int2.read() == 1))
+    // Setting up the SPI format and frequency
+    spi.format(8, 3);                           // Transferable bits = 8, SPI MODE = 3 [Clock starting position = High, Data received on rising edge of the clock]
+    spi.frequency(SPI_FREQUENCY);               // SPI frequency set to 1MHz
+    spi.set_dma_usage(DMA_USAGE_ALWAYS);        // Asynch transfers move the frame bytes by DMA where the target supports it
+
+
+    // Scheduling state of every gyro on the bus:
+    smInit(&sensors, SENSOR_COUNT, sensorConfig, 0);
+#if SENSOR_COUNT > 1
+    smAlignInit(&aligner, ALIGN_PERIOD_US);
+#endif
+
+    // Starting the event-driven acquisition core; from here on the SPI bus belongs to its queue and the LCD driver borrows it:
+    acqThread.start(callback(&acqQueue, &EventQueue::dispatch_forever));
+    acqRunning = true;
+
+    // Writing the Control Registers 1 to 4 of every gyro (one burst each); the DSP thread waits out the turn-on and calibrates, nobody waits here:
+    acqQueue.call(configureSensor);
+
+    //Resetting the processing pipeline (glitch filters, classifier, threshold tuner, statistics and FSM) for this session, starting with the rest calibration:
+    gpInit(&gyro, GP_ACT_WINDOW_MS, gyroTrace, NULL);
+    gpStartCalibration(&gyro, BOOT_SETTLE_SAMPLES, BOOT_CAL_SAMPLES);
+    lhInit(&latHist[HOP_CAPTURE_DECODE], "drdy->decode");
+    lhInit(&latHist[HOP_DECODE_FILTER], "decode->filter");
+    lhInit(&latHist[HOP_FILTER_FSM], "filter->fsm");
+    lhInit(&latHist[HOP_FSM_RENDER], "fsm->render");
+    lhInit(&latHist[HOP_RENDER_PRESENT], "render->present");
+    lhInit(&latHist[HOP_END_TO_END], "drdy->screen");
+
+#if defined(MBED_HEAP_STATS_ENABLED)
+    //Everything the pipeline needs is allocated by now; the report proves no allocation happens after this point:
+    mbed_stats_heap_t heap;
+    mbed_stats_heap_get(&heap);
+    heapAllocsAtStart = heap.alloc_cnt;
+#endif
+
+    //Starting the pipeline threads (the logger first so nothing printed at start-up is lost):
+#ifdef GYRO_TELEMETRY
+    telemetryDeviceId = telemetryMakeDeviceId();
+    csInit(&clockSync);
+    telemetryPort.sigio(callback(telemetry_sigio));
+    logThread.start(telemetry_thread);
+#else
+    logThread.start(logging_thread);
+#endif
+    uiThread.start(ui_thread);                  // Brings up the panel and the splash
+    dspThread.start(dsp_thread);
+
+    // Sampling starts once the control registers are written:
+    sensorConfigured.acquire();
+
+    // Interrupt Initialization: DRDY on the rising edge of every data ready line, the user button, and the periodic tick
+    for (uint8_t g = 0; g < DRDY_GROUP_COUNT; g++)
     {
-        flags.set(DATA_READY_FLAG);
+        drdyLine[g]->rise(callback(data_cb, &drdyGroupId[g]));
     }
+    userButton.rise(&button_cb);
+    acqQueue.call_every(TICKER_LIMIT, onTick);  // TICKER_LIMIT = 500ms; also picks up a DRDY that was already high before the edge handler was attached
 
 
-    //Initial welcome message on LCD:
-    Initial_ScreenDisp();
-
-    //Commencing the reset timer:
-    resetTimer.start();
-
-
-    //while(1){} => for infinite duration if its to be implemented.
-
-
-    //While loop to execute only for 20 second duration:
-    while (chrono::duration_cast<chrono::seconds>(resetTimer.elapsed_time()).count() <= RESET_TIMERLIMIT)          // RESET_TIMERLIMIT = 20
+#ifdef GYRO_CONTINUOUS
+    //Continuous session: runs until the user button is pressed. The totals, the step count and the statistics
+    //are sized for an unbounded session (gyro_pipeline.h) and all storage is rings, so nothing grows with time:
+    while (!session_end_requested)
     {
-        float *gyroCurrDimData=getGyroData(OUT_X_L);                                                               // Get the Gyroscope Data (individual x,y,z co-ordinate distance) onto the local variable 'gyroCurrDimData'
-        printf("\nInput Gyro Data: %f\t%f\t%f", gyroCurrDimData[0], gyroCurrDimData[1], gyroCurrDimData[2] );      // Print the x, y, z co-ordinate distance onto the terminal
-        //thread_sleep_for(500); //Can be added to see the results slowly at the monitor
-       
-        //sem.acquire();
-       
-       //----------------------------------FSM Implementation for the Distance Calculation:----------------------------------------------
-        // State Transitioning Logic:
-        switch(state_chk)
-        {
-            case IDLE:                                  // IDLE State if the person is at rest.
-            {
-                //sem.acquire();
-
-                //These volatile global declarations have been made initalized to zero at the beginning of the code at the gyroscope section:
-                totalDist=totalDist;                    // If the person is at rest, no change in the total distance computed within this 20 sec timer.
-                step_cnt=step_cnt;                      // If the person is at rest, no change in the step_cnt computed within this 20 sec timer.
-
-                //Will move into the next state only when the value read is greater than or equal to the threshold.
-                //Post multiple trials, we have declared the value in the macro: GYRO_THRESHOLD
-                //The threshold can be also be changed but that will impact tremendously on the accuracy of the measurements.
-                //We have used a multiplication factor just to increase the magnitude scale of low intensity gyroscope readings:
-                if((abs(gyroCurrDimData[0]*GRYOMULFACTOR1)>=GYRO_THRESHOLD) || (abs(gyroCurrDimData[1]*GRYOMULFACTOR1)>=GYRO_THRESHOLD) || (abs(gyroCurrDimData[2]*GRYOMULFACTOR1)>=GYRO_THRESHOLD))     // Multiplying the individual x,y,z co-ordinate distance with GYROMULFACTOR1 for proper scaling of all 3 individual co-ordinates distance
-                {
-                    state_chk=MOVING_DATARECORD;        // If any of the current distance of x or y or z co-ordinate is equal to or greater than the threshold distance 'GYRO_THRESHOLD' then the state transitions to 'MOVING_DATARECORD' state
-                }
-                else
-                {
-                    state_chk=IDLE;                     // Else remain in the same state with zero readings to have no impact on the distance calculations:
-                    gyroCurrDimData[0]=0.0f;            // Updating the x co-ordinate distance to 0.0m
-                    gyroCurrDimData[1]=0.0f;            // Updating the y co-ordinate distance to 0.0m
-                    gyroCurrDimData[2]=0.0f;            // Updating the z co-ordinate distance to 0.0m
-                }
-                //sem.release();
-
-            }
-            break;
-
-            case MOVING_DATARECORD:                     //In this state, the values beyond threshold are used in reocrding of total distance calculation along with stepcnt.
-            {
-                //sem.acquire();
-
-                totalDist=totalDist+ (calculateDist3Dim(gyroCurrDimData)*GRYOMULFACTOR2);        // Calculate the resultant distance by passing the local variable 'gyroCurrDimData' along with stepcnt estimation.
-                printf("\nTotal Distance Travelled So Far:%f\t", totalDist);                     // Print Current total distance travelled so far within 20s in the terminal
-                printf("\nTotal Step Counts So Far:\t %d",step_cnt);                             // Print Current total step count so far within 20s in the terminal
-                //thread_sleep_for(5000);                                                        // Optional to use.
-                
-                //Post determining ht
-                state_chk=IDLE;                                                                  // Transition back to IDLE state
+        ThisThread::sleep_for(100ms);
+    }
+#else
+    //The session starts with the first valid sample (a silent sensor still ends it after RESET_TIMERLIMIT):
+    bootFirstValid.try_acquire_for(chrono::seconds(RESET_TIMERLIMIT));
+    const chrono::microseconds session_start(boot.first_fsm_us != 0 ? boot.first_valid_us : resetTimer.elapsed_time().count());
 
-                //sem.release()
-            }
-            break;
-        }
+    //Main thread only supervises the 20 second session; all the work happens in the pipeline threads:
+    while (!session_end_requested && chrono::duration_cast<chrono::seconds>(resetTimer.elapsed_time() - session_start).count() <= RESET_TIMERLIMIT)          // RESET_TIMERLIMIT = 20, or until the user button is pressed
+    {
+        ThisThread::sleep_for(100ms);
+    }
+#endif
 
-        //sem.release();
+    //The LCD driver may still be borrowing the bus from the acquisition thread (session ended by the button during boot):
+    while (!displayReady)
+    {
+        ThisThread::sleep_for(10ms);
+    }
 
-        CALC_ScreenDisp(totalDist, step_cnt);                                                    // Function to display current total distance travelled and current total step count within 20s duration onto the LCD screen
+    //Stopping the pipeline in order: acquisition, then DSP once it has drained its queue, then the UI:
+    acqRunning = false;
+    session_running = false;
+    for (uint8_t g = 0; g < DRDY_GROUP_COUNT; g++)
+    {
+        drdyLine[g]->rise(NULL);
+    }
+    userButton.rise(NULL);
+    acqQueue.break_dispatch();
+    acqThread.join();
+    if (fillBlock != NULL && fillBlock->count > 0)
+    {
+        blockPost(fillBlock);                                                                   // Hand over the partly filled last block
     }
+    fullBlocks.try_put(SESSION_STOP_BLOCK);
+    edgeSent(&sampleEdge);
+    dspThread.join();
+    uiThread.join();
 
-    CALC_Final_ScreenDisp(totalDist, step_cnt);                                                  // Function to display final total distance travelled and final total step count covered for the 20s duration onto the LCD screen
+    rsAdvance(&gyro.stats, gpSessionMs(&gyro, (uint32_t)resetTimer.elapsed_time().count()));     // Close the last complete second before reading the session summaries (on the statistics' own clock)
+    CALC_Final_ScreenDisp(gyro.totalDist, gyro.stepCnt, &gyro.stats);                                                  // Function to display final total distance travelled and final total step count covered for the 20s duration onto the LCD screen
 
     resetTimer.stop();                                                                           // Stop the reset timer to indicate end of 20s duration                               
 
-    //state_chk=IDLE;                                                                              // Transition back to IDLE state after the 20 second duration to restart if needed.
+    //gyro.state=GP_IDLE;                                                                            // Transition back to IDLE state after the 20 second duration to restart if needed.
 
     //The following statement is with regards to file which had the velocity values outputted:
     //fclose(file);                                                                              // Close the file if the current and final total distance and total step count are streaming onto a csv file located in the project working directory
 
- }
\ No newline at end of file
+    ThisThread::sleep_for(CPU_REPORT_PERIOD);                                                    // Let the logging thread print the last pipeline report
+ }
@@ -0,0 +1,135 @@
+//=======================================================================================
+// ACTIVITY CLASSIFIER BATCH EVALUATOR (HOST):
+//=======================================================================================
+// Replays labelled raw traces through the streaming classifier and reports the window
+// confusion matrix, accuracy and throughput.
+//
+//   activity_eval [--window MS] trace1.csv [trace2.csv ...]
+//
+// The reference label of a window is the majority label of its samples; windows with no
+// labelled samples are not scored.
+//=======================================================================================
+#include "activity_classifier.h"
+#include "gyro_units.h"
+#include "trace_io.h"
+#include "vec_math.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// RAW COUNT -> rad/s FOR THE FULL-SCALE SETTING RECORDED IN THE TRACE
+static float rawToRads(float fsDps)
+{
+    float mdps = GYRO_SENS_500DPS_MDPS;
+    if (fsDps <= 250.0f)
+    {
+        mdps = GYRO_SENS_250DPS_MDPS;
+    }
+    else if (fsDps >= 2000.0f)
+    {
+        mdps = GYRO_SENS_2000DPS_MDPS;
+    }
+    return mdps * 1.0e-3f * GYRO_DEG_TO_RAD;
+}
+
+int main(int argc, char **argv)
+{
+    uint16_t window = ACT_DEFAULT_WINDOW_MS;
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "--window") == 0)
+    {
+        window = (uint16_t)atoi(argv[2]);
+        first = 3;
+    }
+    if (first >= argc)
+    {
+        fprintf(stderr, "usage: %s [--window MS] trace.csv [...]\n", argv[0]);
+        return 2;
+    }
+
+    uint32_t confusion[ACT_CLASS_COUNT][ACT_CLASS_COUNT] = {};   // [truth][predicted]
+    uint64_t totalSamples = 0;
+    double totalNs = 0.0;
+    uint32_t worstUpdate = 0;
+
+    for (int f = first; f < argc; f++)
+    {
+        Trace trace;
+        if (!traceLoad(argv[f], &trace))
+        {
+            return 1;
+        }
+
+        ActivityClassifier c;
+        actInit(&c, window);
+        float scale = rawToRads(trace.fsDps);
+        uint32_t labelCount[ACT_CLASS_COUNT] = {};
+        uint32_t fileHits = 0, fileWindows = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (const TraceSample &s : trace.samples)
+        {
+            if (s.label >= 0)
+            {
+                labelCount[s.label]++;
+            }
+            float mag = vmNorm3F(s.g[0] * scale, s.g[1] * scale, s.g[2] * scale);
+            if (actUpdate(&c, mag, s.tUs))
+            {
+                int truth = -1;
+                uint32_t best = 0;
+                for (int a = 0; a < ACT_CLASS_COUNT; a++)
+                {
+                    if (labelCount[a] > best)
+                    {
+                        best = labelCount[a];
+                        truth = a;
+                    }
+                    labelCount[a] = 0;
+                }
+                if (truth >= 0)
+                {
+                    confusion[truth][c.current]++;
+                    fileWindows++;
+                    fileHits += (truth == c.current);
+                }
+            }
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        totalSamples += trace.samples.size();
+        totalNs += ns;
+        if (c.maxCycles > worstUpdate)
+        {
+            worstUpdate = c.maxCycles;
+        }
+        printf("%-40s samples %8zu  windows %6lu  accuracy %6.2f%%\n", argv[f], trace.samples.size(),
+               (unsigned long)fileWindows, fileWindows ? 100.0 * fileHits / fileWindows : 0.0);
+    }
+
+    uint32_t hits = 0, scored = 0;
+    printf("\nconfusion (rows = truth, cols = predicted)\n%8s", "");
+    for (int p = 0; p < ACT_CLASS_COUNT; p++)
+    {
+        printf("%8s", actName((ActivityClass)p));
+    }
+    printf("\n");
+    for (int t = 0; t < ACT_CLASS_COUNT; t++)
+    {
+        printf("%8s", actName((ActivityClass)t));
+        for (int p = 0; p < ACT_CLASS_COUNT; p++)
+        {
+            printf("%8lu", (unsigned long)confusion[t][p]);
+            scored += confusion[t][p];
+            hits += (t == p) ? confusion[t][p] : 0;
+        }
+        printf("\n");
+    }
+
+    printf("\naccuracy   %.2f%% over %lu windows\n", scored ? 100.0 * hits / scored : 0.0, (unsigned long)scored);
+    printf("throughput %.2f Msamples/s  (%.1f ns/sample incl. conversion, worst update %lu ns)\n",
+           totalNs > 0.0 ? totalSamples * 1.0e3 / totalNs : 0.0,
+           totalSamples ? totalNs / totalSamples : 0.0, (unsigned long)worstUpdate);
+    return 0;
+}
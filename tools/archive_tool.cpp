@@ -0,0 +1,543 @@
+//=======================================================================================
+// SESSION ARCHIVE TOOL (HOST):
+//=======================================================================================
+//   archive_tool pack <trace.csv|synth:...> <out.gsa> [--block N]
+//   archive_tool unpack <in.gsa> <out.csv>
+//   archive_tool info <in.gsa>
+//   archive_tool query <in.gsa> "<predicates>"
+//   archive_tool bench <trace.csv|synth:...> ["<predicates>"]
+//
+// pack runs the pipeline (lib/GyroDSP/gyro_pipeline) over the samples and stores its
+// step, state and activity changes as events next to the raw columns.
+//
+// Predicates are comma separated, all must hold ("AND"):
+//   label=idle|walk|jog|run    per sample, pushed down through the block label set
+//   gx|gy|gz <op> N            per sample raw counts, pushed down through block min/max
+//   t <op> S                   seconds from the start of the session, through block times
+//   cadence <op> SPM           per block: step events * 60 / block duration
+// with <op> one of > >= < <= =. Blocks whose index statistics rule a predicate out are
+// skipped without touching their columns; the rest decode only the columns the
+// predicates need. The result is the list of matching segments (runs of matching
+// samples), e.g.  query run.gsa "label=run,cadence>160".
+//
+// bench packs the trace into a temporary archive and compares it with the CSV file for
+// size, full load time and the query time (CSV has to be parsed in full to answer it).
+//=======================================================================================
+#include "activity_classifier.h"
+#include "gait_synth.h"
+#include "gyro_pipeline.h"
+#include "session_archive.h"
+#include "trace_io.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static long long fileSize(const char *path)
+{
+    struct stat st;
+    return stat(path, &st) == 0 ? (long long)st.st_size : -1;
+}
+
+static bool loadAny(const char *spec, Trace *out)
+{
+    return gsIsSpec(spec) ? gsLoadSpec(spec, out) : traceLoad(spec, out);
+}
+
+//---------------------------------------------------------------------------------------
+// PACK
+//---------------------------------------------------------------------------------------
+static GyroPipeline pipeline;                       // ~25KB, kept off the stack
+
+static bool pack(const Trace &trace, const char *outPath, uint32_t blockLen)
+{
+    SaWriter w;
+    if (!saWriterOpen(&w, outPath, trace, blockLen))
+    {
+        return false;
+    }
+    gpInit(&pipeline, GP_ACT_WINDOW_MS);
+    GpState state = pipeline.state;
+    uint8_t activity = pipeline.activity.current;
+    for (size_t i = 0; i < trace.samples.size(); i++)
+    {
+        const TraceSample &s = trace.samples[i];
+        uint32_t steps = pipeline.stepCnt;
+        gpProcess(&pipeline, s.tUs, s.g);
+        saWriterAdd(&w, s);
+
+        if (pipeline.stepCnt != steps)
+        {
+            saWriterEvent(&w, { i, SA_EVENT_STEP, 0, 0, pipeline.stepCnt - steps });
+        }
+        if (pipeline.state != state)
+        {
+            state = pipeline.state;
+            saWriterEvent(&w, { i, SA_EVENT_STATE, (uint8_t)state, 0, 0 });
+        }
+        if (pipeline.activity.current != activity)
+        {
+            activity = pipeline.activity.current;
+            saWriterEvent(&w, { i, SA_EVENT_ACTIVITY, activity, 0, 0 });
+        }
+    }
+    return saWriterClose(&w);
+}
+
+//---------------------------------------------------------------------------------------
+// QUERY
+//---------------------------------------------------------------------------------------
+enum PredKey : uint8_t
+{
+    PRED_LABEL = 0,
+    PRED_GX,
+    PRED_GY,
+    PRED_GZ,
+    PRED_T,
+    PRED_CADENCE
+};
+
+enum PredOp : uint8_t
+{
+    OP_GT = 0,
+    OP_GE,
+    OP_LT,
+    OP_LE,
+    OP_EQ
+};
+
+struct Predicate
+{
+    PredKey key;
+    PredOp op;
+    double value;
+};
+
+static bool compare(double v, PredOp op, double ref)
+{
+    switch (op)
+    {
+        case OP_GT: return v > ref;
+        case OP_GE: return v >= ref;
+        case OP_LT: return v < ref;
+        case OP_LE: return v <= ref;
+        default: return v == ref;
+    }
+}
+
+// COULD ANY VALUE IN [lo, hi] SATISFY 'v <op> ref'?
+static bool rangeMayMatch(double lo, double hi, PredOp op, double ref)
+{
+    switch (op)
+    {
+        case OP_GT: return hi > ref;
+        case OP_GE: return hi >= ref;
+        case OP_LT: return lo < ref;
+        case OP_LE: return lo <= ref;
+        default: return lo <= ref && ref <= hi;
+    }
+}
+
+static bool parsePredicates(const char *text, std::vector<Predicate> *out)
+{
+    static const char *const keys[] = { "label", "gx", "gy", "gz", "t", "cadence" };
+    std::string all(text);
+    size_t pos = 0;
+    while (pos < all.size())
+    {
+        size_t end = all.find(',', pos);
+        end = end == std::string::npos ? all.size() : end;
+        std::string p = all.substr(pos, end - pos);
+        pos = end + 1;
+
+        size_t opAt = p.find_first_of("<>=");
+        if (opAt == std::string::npos)
+        {
+            fprintf(stderr, "predicate '%s': no operator\n", p.c_str());
+            return false;
+        }
+        Predicate pred;
+        std::string key = p.substr(0, opAt);
+        size_t k = 0;
+        while (k < sizeof(keys) / sizeof(keys[0]) && key != keys[k])
+        {
+            k++;
+        }
+        if (k == sizeof(keys) / sizeof(keys[0]))
+        {
+            fprintf(stderr, "predicate '%s': unknown column '%s'\n", p.c_str(), key.c_str());
+            return false;
+        }
+        pred.key = (PredKey)k;
+        const char *op = p.c_str() + opAt;
+        size_t opLen = (op[1] == '=') ? 2 : 1;
+        pred.op = op[0] == '=' ? OP_EQ : op[0] == '>' ? (opLen == 2 ? OP_GE : OP_GT) : (opLen == 2 ? OP_LE : OP_LT);
+        const char *val = op + opLen;
+        if (pred.key == PRED_LABEL)
+        {
+            int8_t label = traceLabelParse(val);
+            if (label == TRACE_LABEL_NONE || pred.op != OP_EQ)
+            {
+                fprintf(stderr, "predicate '%s': use label=idle|walk|jog|run\n", p.c_str());
+                return false;
+            }
+            pred.value = label;
+        }
+        else
+        {
+            pred.value = atof(val);
+        }
+        out->push_back(pred);
+    }
+    return !out->empty();
+}
+
+struct QueryStats
+{
+    uint32_t blocks, skipped;
+    uint64_t bytesDecoded;
+    uint64_t samplesScanned, samplesMatched;
+    uint32_t segments;
+    double seconds;
+};
+
+static double blockCadence(const SaBlockIndex &bi)
+{
+    double s = (bi.lastUs - bi.firstUs) * 1.0e-6;
+    return s > 0.0 ? bi.steps * 60.0 / s : 0.0;
+}
+
+static bool blockMayMatch(const SaBlockIndex &bi, uint64_t originUs, const std::vector<Predicate> &preds)
+{
+    for (const Predicate &p : preds)
+    {
+        bool may = true;
+        switch (p.key)
+        {
+            case PRED_LABEL:
+                may = (bi.labelMask & (1u << (int)p.value)) != 0;
+                break;
+            case PRED_GX:
+            case PRED_GY:
+            case PRED_GZ:
+                may = rangeMayMatch(bi.min[p.key - PRED_GX], bi.max[p.key - PRED_GX], p.op, p.value);
+                break;
+            case PRED_T:
+                may = rangeMayMatch((bi.firstUs - originUs) * 1.0e-6, (bi.lastUs - originUs) * 1.0e-6, p.op, p.value);
+                break;
+            case PRED_CADENCE:
+                may = compare(blockCadence(bi), p.op, p.value);
+                break;
+        }
+        if (!may)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void printSegment(bool print, double startS, double endS, uint64_t samples)
+{
+    if (print)
+    {
+        printf("  %10.2f s .. %10.2f s  (%8.2f s, %llu samples)\n", startS, endS, endS - startS, (unsigned long long)samples);
+    }
+}
+
+static void query(const SaReader *r, const std::vector<Predicate> &preds, bool print, QueryStats *st)
+{
+    memset(st, 0, sizeof(*st));
+    auto start = Clock::now();
+    uint32_t columns = SA_COL_BIT(SA_COL_T);
+    for (const Predicate &p : preds)
+    {
+        if (p.key == PRED_LABEL)
+        {
+            columns |= SA_COL_BIT(SA_COL_LABEL);
+        }
+        else if (p.key >= PRED_GX && p.key <= PRED_GZ)
+        {
+            columns |= SA_COL_BIT(SA_COL_GX + (p.key - PRED_GX));
+        }
+    }
+
+    uint64_t originUs = r->header->blockCount ? r->index[0].firstUs : 0;
+    bool open = false;
+    double segStart = 0.0, segEnd = 0.0;
+    uint64_t segSamples = 0;
+    SaBlock b;
+    st->blocks = r->header->blockCount;
+    for (uint32_t k = 0; k < r->header->blockCount; k++)
+    {
+        const SaBlockIndex &bi = r->index[k];
+        if (!blockMayMatch(bi, originUs, preds) || !saDecodeBlock(r, k, columns, &b))
+        {
+            st->skipped++;
+            if (open)
+            {
+                printSegment(print, segStart, segEnd, segSamples);
+                open = false;
+            }
+            continue;
+        }
+        for (int c = 0; c < SA_COL_COUNT; c++)
+        {
+            st->bytesDecoded += (columns & SA_COL_BIT(c)) ? bi.colBytes[c] : 0;
+        }
+        for (uint32_t i = 0; i < b.count; i++)
+        {
+            double tS = (b.t[i] - originUs) * 1.0e-6;
+            bool match = true;
+            for (size_t q = 0; q < preds.size() && match; q++)
+            {
+                const Predicate &p = preds[q];
+                switch (p.key)
+                {
+                    case PRED_LABEL: match = b.label[i] == (int8_t)p.value; break;
+                    case PRED_GX:
+                    case PRED_GY:
+                    case PRED_GZ: match = compare(b.g[p.key - PRED_GX][i], p.op, p.value); break;
+                    case PRED_T: match = compare(tS, p.op, p.value); break;
+                    case PRED_CADENCE: break;   // Whole block, already decided
+                }
+            }
+            st->samplesScanned++;
+            if (match)
+            {
+                st->samplesMatched++;
+                if (!open)
+                {
+                    open = true;
+                    segStart = tS;
+                    segSamples = 0;
+                    st->segments++;
+                }
+                segEnd = tS;
+                segSamples++;
+            }
+            else if (open)
+            {
+                printSegment(print, segStart, segEnd, segSamples);
+                open = false;
+            }
+        }
+    }
+    if (open)
+    {
+        printSegment(print, segStart, segEnd, segSamples);
+    }
+    st->seconds = secondsSince(start);
+}
+
+// THE SAME PER-SAMPLE PREDICATES OVER A LOADED TRACE (NO INDEX, NO cadence)
+static uint64_t queryTrace(const Trace &trace, const std::vector<Predicate> &preds)
+{
+    uint64_t matched = 0;
+    uint32_t t0 = trace.samples.empty() ? 0 : trace.samples[0].tUs;
+    for (const TraceSample &s : trace.samples)
+    {
+        bool match = true;
+        for (size_t q = 0; q < preds.size() && match; q++)
+        {
+            const Predicate &p = preds[q];
+            switch (p.key)
+            {
+                case PRED_LABEL: match = s.label == (int8_t)p.value; break;
+                case PRED_GX:
+                case PRED_GY:
+                case PRED_GZ: match = compare(s.g[p.key - PRED_GX], p.op, p.value); break;
+                case PRED_T: match = compare((uint32_t)(s.tUs - t0) * 1.0e-6, p.op, p.value); break;
+                case PRED_CADENCE: break;
+            }
+        }
+        matched += match ? 1 : 0;
+    }
+    return matched;
+}
+
+//---------------------------------------------------------------------------------------
+// COMMANDS
+//---------------------------------------------------------------------------------------
+static int cmdInfo(const char *path)
+{
+    SaReader r;
+    if (!saOpen(&r, path))
+    {
+        return 1;
+    }
+    const SaHeader *h = r.header;
+    uint64_t colTotal[SA_COL_COUNT] = {};
+    for (uint32_t k = 0; k < h->blockCount; k++)
+    {
+        for (int c = 0; c < SA_COL_COUNT; c++)
+        {
+            colTotal[c] += r.index[k].colBytes[c];
+        }
+    }
+    uint64_t steps = 0;
+    for (uint64_t e = 0; e < h->eventCount; e++)
+    {
+        steps += r.events[e].kind == SA_EVENT_STEP ? r.events[e].count : 0;
+    }
+    printf("%s: version %u, \"%s\"\n", path, h->version, h->name);
+    printf("  %llu samples @ %g Hz, fs %g dps, %u blocks of %u, %llu events (%llu steps)\n", (unsigned long long)h->sampleCount, h->odrHz,
+           h->fsDps, h->blockCount, h->blockLen, (unsigned long long)h->eventCount, (unsigned long long)steps);
+    if (h->truthSteps >= 0)
+    {
+        printf("  ground truth: %lld steps, %.1f m\n", (long long)h->truthSteps, h->truthDistanceM);
+    }
+    static const char *const names[SA_COL_COUNT] = { "t", "gx", "gy", "gz", "label" };
+    for (int c = 0; c < SA_COL_COUNT; c++)
+    {
+        printf("  column %-6s %10llu bytes  %6.3f bytes/sample\n", names[c], (unsigned long long)colTotal[c],
+               h->sampleCount ? colTotal[c] / (double)h->sampleCount : 0.0);
+    }
+    printf("  file %llu bytes, %.3f bytes/sample (raw int16 xyz + u32 t = 10)\n", (unsigned long long)r.size,
+           h->sampleCount ? r.size / (double)h->sampleCount : 0.0);
+    saClose(&r);
+    return 0;
+}
+
+static int cmdQuery(const char *path, const char *text)
+{
+    std::vector<Predicate> preds;
+    SaReader r;
+    if (!parsePredicates(text, &preds) || !saOpen(&r, path))
+    {
+        return 1;
+    }
+    printf("%s: %s\n", path, text);
+    QueryStats st;
+    query(&r, preds, true, &st);
+    printf("%u segments, %llu of %llu samples; %u of %u blocks skipped by the index, %llu bytes decoded, %.3f ms\n", st.segments,
+           (unsigned long long)st.samplesMatched, (unsigned long long)r.header->sampleCount, st.skipped, st.blocks,
+           (unsigned long long)st.bytesDecoded, st.seconds * 1.0e3);
+    saClose(&r);
+    return 0;
+}
+
+static int cmdBench(const char *spec, const char *text)
+{
+    std::vector<Predicate> preds;
+    if (!parsePredicates(text, &preds))
+    {
+        return 2;
+    }
+    Trace trace;
+    if (!loadAny(spec, &trace))
+    {
+        return 1;
+    }
+    std::string csvPath = "/tmp/archive_bench.csv", gsaPath = "/tmp/archive_bench.gsa";
+    auto t = Clock::now();
+    if (!traceSave(csvPath.c_str(), trace))
+    {
+        return 1;
+    }
+    double csvWriteS = secondsSince(t);
+    t = Clock::now();
+    if (!pack(trace, gsaPath.c_str(), SA_DEFAULT_BLOCK_LEN))
+    {
+        return 1;
+    }
+    double packS = secondsSince(t);
+
+    t = Clock::now();
+    Trace fromCsv;
+    traceLoad(csvPath.c_str(), &fromCsv);
+    double csvLoadS = secondsSince(t);
+    t = Clock::now();
+    uint64_t csvMatched = queryTrace(fromCsv, preds);
+    double csvQueryS = csvLoadS + secondsSince(t);
+
+    SaReader r;
+    t = Clock::now();
+    if (!saOpen(&r, gsaPath.c_str()))
+    {
+        return 1;
+    }
+    Trace fromGsa;
+    saLoadTrace(&r, &fromGsa);
+    double gsaLoadS = secondsSince(t);
+    bool same = fromGsa.samples.size() == fromCsv.samples.size();
+    for (size_t i = 0; same && i < fromGsa.samples.size(); i++)
+    {
+        same = memcmp(fromGsa.samples[i].g, fromCsv.samples[i].g, sizeof(fromGsa.samples[i].g)) == 0 &&
+               fromGsa.samples[i].tUs == fromCsv.samples[i].tUs && fromGsa.samples[i].label == fromCsv.samples[i].label;
+    }
+    QueryStats st;
+    query(&r, preds, false, &st);
+
+    printf("%s: %zu samples, query \"%s\"\n", spec, trace.samples.size(), text);
+    printf("%-8s %12s %10s %10s %12s %10s\n", "format", "bytes", "write[ms]", "load[ms]", "query[ms]", "matched");
+    printf("%-8s %12lld %10.1f %10.1f %12.3f %10llu\n", "csv", fileSize(csvPath.c_str()), csvWriteS * 1.0e3, csvLoadS * 1.0e3,
+           csvQueryS * 1.0e3, (unsigned long long)csvMatched);
+    printf("%-8s %12lld %10.1f %10.1f %12.3f %10llu\n", "archive", fileSize(gsaPath.c_str()), packS * 1.0e3, gsaLoadS * 1.0e3,
+           st.seconds * 1.0e3, (unsigned long long)st.samplesMatched);
+    printf("archive query skipped %u of %u blocks, decoded %llu bytes; round trip %s\n", st.skipped, st.blocks,
+           (unsigned long long)st.bytesDecoded, same ? "identical" : "MISMATCH");
+    saClose(&r);
+    remove(csvPath.c_str());
+    remove(gsaPath.c_str());
+    return same ? 0 : 1;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s pack <trace.csv|synth:...> <out.gsa> [--block N]\n"
+            "       %s unpack <in.gsa> <out.csv>\n"
+            "       %s info <in.gsa>\n"
+            "       %s query <in.gsa> \"label=run,cadence>160\"\n"
+            "       %s bench <trace.csv|synth:...> [\"predicates\"]\n",
+            prog, prog, prog, prog, prog);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+    const char *cmd = argv[1];
+    if (strcmp(cmd, "pack") == 0 && argc >= 4)
+    {
+        uint32_t blockLen = (argc >= 6 && strcmp(argv[4], "--block") == 0) ? (uint32_t)atoi(argv[5]) : SA_DEFAULT_BLOCK_LEN;
+        Trace trace;
+        return (loadAny(argv[2], &trace) && pack(trace, argv[3], blockLen)) ? cmdInfo(argv[3]) : 1;
+    }
+    if (strcmp(cmd, "unpack") == 0 && argc >= 4)
+    {
+        SaReader r;
+        Trace trace;
+        bool ok = saOpen(&r, argv[2]) && saLoadTrace(&r, &trace) && traceSave(argv[3], trace);
+        saClose(&r);
+        return ok ? 0 : 1;
+    }
+    if (strcmp(cmd, "info") == 0)
+    {
+        return cmdInfo(argv[2]);
+    }
+    if (strcmp(cmd, "query") == 0 && argc >= 4)
+    {
+        return cmdQuery(argv[2], argv[3]);
+    }
+    if (strcmp(cmd, "bench") == 0)
+    {
+        return cmdBench(argv[2], argc >= 4 ? argv[3] : "label=run,gx>3000");
+    }
+    usage(argv[0]);
+    return 2;
+}
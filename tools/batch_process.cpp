@@ -0,0 +1,260 @@
+//=======================================================================================
+// PARALLEL BATCH REPROCESSING (HOST):
+//=======================================================================================
+// Re-runs the device pipeline (lib/GyroDSP/gyro_pipeline: glitch filter, moving average,
+// auto-tuned FSM, distance and step counting, activity classifier) over many recorded
+// sessions at once, one session per task on a work-stealing pool (tools/work_pool).
+// Every session gets its own GyroPipeline, so sessions share nothing but the code.
+//
+//   batch_process [--threads N] [--scaling] [--csv out.csv] [--list sessions.txt] session...
+//
+// A session is a trace file or a synthetic spec (tools/gait_synth, "synth:seed=N,...");
+// --list reads one per line. Prints one row per session (in input order), the totals and
+// the per-worker load; --csv also writes the session table as CSV. --scaling repeats the
+// batch at 1, 2, 4 ... N threads and prints the speedup of each.
+//=======================================================================================
+#include "activity_classifier.h"
+#include "gait_synth.h"
+#include "gyro_pipeline.h"
+#include "trace_io.h"
+#include "work_pool.h"
+#include <chrono>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct SessionResult
+{
+    bool ok;
+    uint64_t samples;
+    double durationS;                               // TRACE TIME
+    float totalDist;
+    int32_t steps;
+    long truthSteps;                                // -1 IF THE TRACE HAS NO GROUND TRUTH
+    float truthDistanceM;
+    uint64_t moving;                                // SAMPLES IN MOVING_DATARECORD
+    uint64_t activity[ACT_CLASS_COUNT];             // SAMPLES PER CLASSIFIED ACTIVITY
+    double processS;                                // PIPELINE TIME (EXCLUDING LOADING)
+    unsigned worker;
+};
+
+static void processSession(const std::string &spec, unsigned worker, SessionResult *out)
+{
+    *out = SessionResult();
+    out->worker = worker;
+    Trace trace;
+    bool ok = gsIsSpec(spec.c_str()) ? gsLoadSpec(spec.c_str(), &trace) : traceLoad(spec.c_str(), &trace);
+    if (!ok || trace.samples.empty())
+    {
+        return;
+    }
+
+    std::unique_ptr<GyroPipeline> p(new GyroPipeline);   // ~25KB, per session
+    gpInit(p.get(), GP_ACT_WINDOW_MS);
+    auto start = std::chrono::steady_clock::now();
+    for (const TraceSample &s : trace.samples)
+    {
+        gpProcess(p.get(), s.tUs, s.g);
+        out->moving += (p->state == GP_MOVING_DATARECORD) ? 1 : 0;
+        out->activity[p->activity.current]++;
+    }
+    out->processS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    out->ok = true;
+    out->samples = trace.samples.size();
+    out->durationS = (uint32_t)(trace.samples.back().tUs - trace.samples[0].tUs) * 1.0e-6;
+    out->totalDist = p->totalDist;
+    out->steps = p->stepCnt;
+    out->truthSteps = trace.truthSteps;
+    out->truthDistanceM = trace.truthDistanceM;
+}
+
+// RUN THE WHOLE BATCH ON 'threads' WORKERS; RETURNS THE WALL TIME
+static double runBatch(const std::vector<std::string> &sessions, unsigned threads, std::vector<SessionResult> *results,
+                       std::vector<WorkerStats> *workers)
+{
+    results->assign(sessions.size(), SessionResult());
+    auto start = std::chrono::steady_clock::now();
+    WorkPool pool(threads);
+    for (size_t i = 0; i < sessions.size(); i++)
+    {
+        pool.submit([&sessions, results, i](unsigned worker) { processSession(sessions[i], worker, &(*results)[i]); });
+    }
+    pool.wait();
+    double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    workers->clear();
+    for (unsigned w = 0; w < pool.size(); w++)
+    {
+        workers->push_back(pool.stats(w));
+    }
+    return wallS;
+}
+
+static bool readList(const char *path, std::vector<std::string> *out)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+    {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    char line[1024];
+    while (fgets(line, sizeof(line), f))
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] != '\0' && line[0] != '#')
+        {
+            out->push_back(line);
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+static void printSessions(const std::vector<std::string> &sessions, const std::vector<SessionResult> &results)
+{
+    printf("%-40s %9s %8s %10s %6s %6s %7s %5s %5s %5s %5s %8s\n", "session", "samples", "time[s]", "dist[m]", "steps",
+           "truth", "moving", "idle", "walk", "jog", "run", "Ms/s");
+    for (size_t i = 0; i < sessions.size(); i++)
+    {
+        const SessionResult &r = results[i];
+        if (!r.ok)
+        {
+            printf("%-40.40s  FAILED TO LOAD\n", sessions[i].c_str());
+            continue;
+        }
+        double n = (double)r.samples;
+        printf("%-40.40s %9llu %8.1f %10.2f %6ld %6ld %6.1f%% %4.0f%% %4.0f%% %4.0f%% %4.0f%% %8.2f\n", sessions[i].c_str(),
+               (unsigned long long)r.samples, r.durationS, r.totalDist, (long)r.steps, r.truthSteps, r.moving * 100.0 / n,
+               r.activity[ACT_IDLE] * 100.0 / n, r.activity[ACT_WALK] * 100.0 / n, r.activity[ACT_JOG] * 100.0 / n,
+               r.activity[ACT_RUN] * 100.0 / n, r.processS > 0.0 ? n / r.processS * 1.0e-6 : 0.0);
+    }
+}
+
+static bool writeCsv(const char *path, const std::vector<std::string> &sessions, const std::vector<SessionResult> &results)
+{
+    FILE *f = fopen(path, "w");
+    if (f == NULL)
+    {
+        fprintf(stderr, "%s: cannot create\n", path);
+        return false;
+    }
+    fprintf(f, "session,ok,samples,duration_s,total_dist,steps,truth_steps,truth_distance_m,moving,idle,walk,jog,run,process_s,worker\n");
+    for (size_t i = 0; i < sessions.size(); i++)
+    {
+        const SessionResult &r = results[i];
+        fprintf(f, "\"%s\",%d,%llu,%.3f,%.6g,%ld,%ld,%.3f,%llu,%llu,%llu,%llu,%llu,%.6f,%u\n", sessions[i].c_str(), r.ok ? 1 : 0,
+                (unsigned long long)r.samples, r.durationS, r.totalDist, (long)r.steps, r.truthSteps, r.truthDistanceM,
+                (unsigned long long)r.moving, (unsigned long long)r.activity[ACT_IDLE], (unsigned long long)r.activity[ACT_WALK],
+                (unsigned long long)r.activity[ACT_JOG], (unsigned long long)r.activity[ACT_RUN], r.processS, r.worker);
+    }
+    return fclose(f) == 0;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned threads = 0;
+    bool scaling = false;
+    const char *csvPath = NULL;
+    std::vector<std::string> sessions;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--scaling") == 0)
+        {
+            scaling = true;
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && val)
+        {
+            threads = (unsigned)atoi(val);
+            i++;
+        }
+        else if (strcmp(argv[i], "--csv") == 0 && val)
+        {
+            csvPath = val;
+            i++;
+        }
+        else if (strcmp(argv[i], "--list") == 0 && val)
+        {
+            if (!readList(val, &sessions))
+            {
+                return 1;
+            }
+            i++;
+        }
+        else if (argv[i][0] == '-')
+        {
+            sessions.clear();
+            break;
+        }
+        else
+        {
+            sessions.push_back(argv[i]);
+        }
+    }
+    if (sessions.empty())
+    {
+        fprintf(stderr, "usage: %s [--threads N] [--scaling] [--csv out.csv] [--list sessions.txt] session...\n", argv[0]);
+        return 2;
+    }
+    if (threads == 0)
+    {
+        threads = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+    }
+
+    std::vector<SessionResult> results;
+    std::vector<WorkerStats> workers;
+    double wallS = runBatch(sessions, threads, &results, &workers);
+
+    printSessions(sessions, results);
+    uint64_t samples = 0;
+    double traceS = 0.0, processS = 0.0;
+    int failed = 0;
+    for (const SessionResult &r : results)
+    {
+        samples += r.samples;
+        traceS += r.durationS;
+        processS += r.processS;
+        failed += r.ok ? 0 : 1;
+    }
+    printf("\n%zu sessions (%d failed), %llu samples, %.1f h of activity\n", sessions.size(), failed, (unsigned long long)samples, traceS / 3600.0);
+    printf("%u threads: %.3f s wall, %.2f Msamples/s incl. loading, %.2f Msamples/s per thread in the pipeline\n", threads, wallS,
+           wallS > 0.0 ? samples / wallS * 1.0e-6 : 0.0, processS > 0.0 ? samples / processS * 1.0e-6 : 0.0);
+    printf("%-8s %8s %8s %9s\n", "worker", "tasks", "stolen", "busy[s]");
+    for (size_t w = 0; w < workers.size(); w++)
+    {
+        printf("%-8zu %8llu %8llu %9.3f\n", w, (unsigned long long)workers[w].executed, (unsigned long long)workers[w].stolen, workers[w].busyS);
+    }
+
+    if (scaling)
+    {
+        printf("\n%-8s %9s %12s %8s %10s\n", "threads", "wall[s]", "Msamples/s", "speedup", "efficiency");
+        double baseS = 0.0;
+        for (unsigned t = 1;; t = (t * 2 < threads) ? t * 2 : threads)
+        {
+            std::vector<SessionResult> r;
+            std::vector<WorkerStats> w;
+            double s = runBatch(sessions, t, &r, &w);
+            if (t == 1)
+            {
+                baseS = s;
+            }
+            printf("%-8u %9.3f %12.2f %7.2fx %9.0f%%\n", t, s, s > 0.0 ? samples / s * 1.0e-6 : 0.0, s > 0.0 ? baseS / s : 0.0,
+                   s > 0.0 ? baseS / s / t * 100.0 : 0.0);
+            if (t == threads)
+            {
+                break;
+            }
+        }
+    }
+
+    if (csvPath && !writeCsv(csvPath, sessions, results))
+    {
+        return 1;
+    }
+    return failed ? 1 : 0;
+}
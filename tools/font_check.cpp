@@ -0,0 +1,295 @@
+//=======================================================================================
+// PACKED FONT DECODE CHECK (HOST):
+//=======================================================================================
+// Decodes the run-length coded Font16 that tools/font_subset.py generates (format in
+// src/drivers/font_packed.h) with the firmware's own FONT_Glyph() and compares every glyph
+// bit for bit with the stock table in src/drivers/font16.c:
+//   - each glyph of the subset, unpacked cold into the cache and again from the cache
+//   - every character outside the subset: the fallback glyph, counted in Misses
+//   - after FONT_Invalidate() the next draw unpacks again
+// The host build links this against two subsets: font_check the firmware's (the characters
+// the sources draw plus custom_font_chars from platformio.ini), font_check_full every glyph.
+// Synthetic glyphs then cover the corners of the run coding whether the font has them or
+// not: foreground and background runs of exactly 15 (a 15, then an empty run to switch),
+// runs chained past 15, the pad nibble that ends a glyph with an odd number of runs, and a
+// glyph whose last run ends on its last pixel. Their runs are written out by hand as the
+// format defines them and must decode to the pixels they describe.
+//
+//   font_check [--list]       --list prints each glyph's runs and what they cover
+// Exit status 1 if a glyph differs, 2 on bad usage.
+//=======================================================================================
+#include "drivers/font_packed.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+extern "C" const uint8_t Font16_Table[];            // src/drivers/font16.c (its sFONT is renamed in this build)
+
+#define SYN_WIDTH  11                               // SYNTHETIC GLYPHS: FONT16'S WIDTH ...
+#define SYN_HEIGHT 4                                // ... AND FEW ROWS: 44 PIXELS, RUNS OF 15 CROSS ROWS
+#define SYN_MAX_RUNS 8
+#define SYN_MAX_SPANS 2
+#define FONT_CHECK_MAX_FAILURES 20                  // DIFFERING GLYPHS PRINTED BEFORE STOPPING
+
+// A synthetic glyph: its run nibbles and the foreground spans (first pixel, length) they code
+struct SynGlyph
+{
+    const char *what;
+    uint8_t runs[SYN_MAX_RUNS];
+    uint8_t runCount;
+    uint8_t spans[SYN_MAX_SPANS][2];
+    uint8_t spanCount;
+};
+
+static const SynGlyph kSynGlyphs[] = {
+    { "foreground run of exactly 15", { 2, 15, 0, 3, 1, 0 }, 6, { { 2, 15 }, { 20, 1 } }, 2 },
+    { "background run of exactly 15", { 15, 0, 4, 0 }, 4, { { 15, 4 } }, 1 },
+    { "background run of 16", { 15, 1, 2, 0 }, 4, { { 16, 2 } }, 1 },
+    { "foreground run of 30 (15, 15, empty)", { 0, 15, 15, 0, 1, 1 }, 6, { { 0, 30 }, { 31, 1 } }, 2 },
+    { "last run of exactly 15, then the pad", { 15, 14, 15, 0 }, 4, { { 29, 15 } }, 1 },
+    { "foreground on the last pixel", { 15, 15, 13, 1 }, 4, { { 43, 1 } }, 1 },
+    { "all foreground", { 0, 15, 15, 14 }, 4, { { 0, 44 } }, 1 },
+    { "empty glyph, no runs", { 0 }, 0, { { 0, 0 } }, 0 },
+};
+#define SYN_COUNT (sizeof(kSynGlyphs) / sizeof(kSynGlyphs[0]))
+
+// What the runs of one glyph exercise
+struct RunCoverage
+{
+    uint32_t exact15;                               // A 15 FOLLOWED BY AN EMPTY RUN: A RUN OF EXACTLY 15
+    uint32_t chained;                               // A 15 FOLLOWED BY MORE OF THE SAME COLOUR
+    uint32_t padded;                                // GLYPHS ENDING IN AN EMPTY PAD NIBBLE
+};
+
+static uint32_t runNibble(const uint8_t *runs, uint32_t k)
+{
+    return (k & 1u) ? (runs[k >> 1] & 0x0Fu) : (runs[k >> 1] >> 4);
+}
+
+// Counts what the glyph's runs cover; returns the pixels they code
+static uint32_t coverRuns(const FontPacked *p, uint8_t index, RunCoverage *cov)
+{
+    uint32_t first = (uint32_t)p->Offset[index] * 2u, last = (uint32_t)p->Offset[index + 1] * 2u;
+    uint32_t pixels = 0;
+    for (uint32_t k = first; k < last; k++)
+    {
+        uint32_t run = runNibble(p->Runs, k);
+        pixels += run;
+        if (run == 15u && k + 1 < last)
+        {
+            if (runNibble(p->Runs, k + 1) == 0u)
+            {
+                cov->exact15++;
+            }
+            else
+            {
+                cov->chained++;
+            }
+        }
+    }
+    if (last > first && runNibble(p->Runs, last - 1) == 0u)
+    {
+        cov->padded++;
+    }
+    return pixels;
+}
+
+// Row masks (bit 0 the leftmost column) of a glyph of a stock BSP table: rows of (Width + 7) / 8 bytes, MSB leftmost
+static void tableRows(const uint8_t *table, const sFONT *font, uint8_t ascii, uint32_t *rows)
+{
+    uint32_t perRow = (font->Width + 7u) / 8u;
+    const uint8_t *glyph = table + (uint32_t)(ascii - FONT_PACKED_FIRST) * font->Height * perRow;
+    for (uint32_t y = 0; y < font->Height; y++)
+    {
+        uint32_t bits = 0;
+        for (uint32_t b = 0; b < perRow; b++)
+        {
+            bits = (bits << 8) | glyph[y * perRow + b];
+        }
+        rows[y] = 0;
+        for (uint32_t x = 0; x < font->Width; x++)
+        {
+            rows[y] |= ((bits >> (perRow * 8u - 1u - x)) & 1u) << x;
+        }
+    }
+}
+
+static bool sameRows(const char *what, uint8_t ascii, const uint32_t *got, const uint32_t *want, uint16_t height, int *failures)
+{
+    for (uint32_t y = 0; y < height; y++)
+    {
+        if (got[y] != want[y])
+        {
+            if (*failures < FONT_CHECK_MAX_FAILURES)
+            {
+                printf("FAIL %s '%c': row %lu decodes to 0x%03lx, expected 0x%03lx\n", what, ascii, (unsigned long)y,
+                       (unsigned long)got[y], (unsigned long)want[y]);
+            }
+            (*failures)++;
+            return false;
+        }
+    }
+    return true;
+}
+
+static void listRuns(const FontPacked *p, uint8_t index, const char *label)
+{
+    printf("  %-40s", label);
+    for (uint32_t k = (uint32_t)p->Offset[index] * 2u; k < (uint32_t)p->Offset[index + 1] * 2u; k++)
+    {
+        printf(" %lu", (unsigned long)runNibble(p->Runs, k));
+    }
+    printf("\n");
+}
+
+// Every glyph of Font16 against font16.c: subset glyphs cold and cached, the rest as the fallback
+static void checkFont(bool list, RunCoverage *cov, int *failures)
+{
+    FontPacked *p = Font16.Packed;
+    uint32_t want[FONT_PACKED_MAX_HEIGHT], fallback[FONT_PACKED_MAX_HEIGHT];
+    tableRows(Font16_Table, &Font16, '?', fallback);
+
+    for (uint32_t c = 0; c < FONT_PACKED_CHARS; c++)
+    {
+        uint8_t ascii = (uint8_t)(FONT_PACKED_FIRST + c);
+        uint8_t index = p->Map[c];
+        uint32_t misses = p->Misses, unpacked = p->Unpacked;
+        bool warm = (index != FONT_PACKED_NONE) && p->Valid[index];   // '?' is unpacked by the misses before it
+        const uint32_t *cold = FONT_Glyph(&Font16, ascii);
+        if (index == FONT_PACKED_NONE)
+        {
+            sameRows("fallback for", ascii, cold, fallback, Font16.Height, failures);
+            if (p->Misses != misses + 1)
+            {
+                printf("FAIL '%c' is outside the subset but Misses went %lu -> %lu\n", ascii, (unsigned long)misses,
+                       (unsigned long)p->Misses);
+                (*failures)++;
+            }
+            continue;
+        }
+
+        char label[48];
+        snprintf(label, sizeof(label), "'%c'", ascii);
+        if (list)
+        {
+            listRuns(p, index, label);
+        }
+        uint32_t pixels = coverRuns(p, index, cov);
+        if (pixels > (uint32_t)Font16.Width * Font16.Height)
+        {
+            printf("FAIL '%c': runs code %lu pixels, the glyph has %u\n", ascii, (unsigned long)pixels,
+                   Font16.Width * Font16.Height);
+            (*failures)++;
+        }
+        tableRows(Font16_Table, &Font16, ascii, want);
+        sameRows("cold", ascii, cold, want, Font16.Height, failures);
+        uint32_t expected = unpacked + (warm ? 0u : 1u);
+        if (p->Misses != misses || p->Unpacked != expected)
+        {
+            printf("FAIL '%c': a first draw of a subset glyph left Misses %lu -> %lu, Unpacked %lu -> %lu\n", ascii,
+                   (unsigned long)misses, (unsigned long)p->Misses, (unsigned long)unpacked, (unsigned long)p->Unpacked);
+            (*failures)++;
+        }
+        const uint32_t *cached = FONT_Glyph(&Font16, ascii);
+        if (cached != cold || p->Unpacked != expected)
+        {
+            printf("FAIL '%c': a second draw unpacked again\n", ascii);
+            (*failures)++;
+        }
+        sameRows("cached", ascii, cached, want, Font16.Height, failures);
+    }
+
+    FONT_Invalidate(&Font16);
+    const uint32_t *again = FONT_Glyph(&Font16, '?');
+    if (p->Unpacked != 1)
+    {
+        printf("FAIL FONT_Invalidate: %lu glyphs unpacked after one draw\n", (unsigned long)p->Unpacked);
+        (*failures)++;
+    }
+    sameRows("after FONT_Invalidate", '?', again, fallback, Font16.Height, failures);
+}
+
+// The synthetic glyphs, as one packed font mapped from 'a'
+static void checkSynthetic(bool list, RunCoverage *cov, int *failures)
+{
+    static uint8_t map[FONT_PACKED_CHARS];
+    static uint16_t offset[SYN_COUNT + 1];
+    static uint8_t runs[SYN_COUNT * SYN_MAX_RUNS / 2];
+    static uint8_t valid[SYN_COUNT];
+    memset(map, FONT_PACKED_NONE, sizeof(map));
+    uint16_t bytes = 0;
+    for (uint32_t i = 0; i < SYN_COUNT; i++)
+    {
+        map['a' - FONT_PACKED_FIRST + i] = (uint8_t)i;
+        offset[i] = bytes;
+        for (uint32_t k = 0; k < kSynGlyphs[i].runCount; k += 2)
+        {
+            runs[bytes++] = (uint8_t)((kSynGlyphs[i].runs[k] << 4) | kSynGlyphs[i].runs[k + 1]);
+        }
+    }
+    offset[SYN_COUNT] = bytes;
+    static FontPacked packed = { (uint8_t)SYN_COUNT, 0, map, offset, runs, valid, NULL, 0, 0 };
+    static sFONT syn = { NULL, SYN_WIDTH, SYN_HEIGHT, &packed };
+
+    for (uint32_t i = 0; i < SYN_COUNT; i++)
+    {
+        const SynGlyph &g = kSynGlyphs[i];
+        uint32_t want[SYN_HEIGHT] = { 0 };
+        for (uint32_t s = 0; s < g.spanCount; s++)
+        {
+            for (uint32_t n = g.spans[s][0]; n < (uint32_t)g.spans[s][0] + g.spans[s][1]; n++)
+            {
+                want[n / SYN_WIDTH] |= 1u << (n % SYN_WIDTH);
+            }
+        }
+        if (list)
+        {
+            listRuns(&packed, (uint8_t)i, g.what);
+        }
+        coverRuns(&packed, (uint8_t)i, cov);
+        uint8_t ascii = (uint8_t)('a' + i);
+        if (!sameRows("synthetic", ascii, FONT_Glyph(&syn, ascii), want, SYN_HEIGHT, failures))
+        {
+            printf("     (%s)\n", g.what);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool list = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--list") == 0)
+        {
+            list = true;
+        }
+        else
+        {
+            fprintf(stderr, "usage: font_check [--list]\n");
+            return 2;
+        }
+    }
+
+    int failures = 0;
+    RunCoverage fontCov = { 0, 0, 0 }, synCov = { 0, 0, 0 };
+    const FontPacked *p = Font16.Packed;
+    if (list)
+    {
+        printf("Font16 runs:\n");
+    }
+    checkFont(list, &fontCov, &failures);
+    if (list)
+    {
+        printf("synthetic runs (%dx%d):\n", SYN_WIDTH, SYN_HEIGHT);
+    }
+    checkSynthetic(list, &synCov, &failures);
+
+    printf("font_check: Font16 %u of %d glyphs in %u bytes of runs, decoded against font16.c\n", p->Count,
+           FONT_PACKED_CHARS, p->Offset[p->Count]);
+    printf("  runs of exactly 15 %lu, chained past 15 %lu, padded glyphs %lu (synthetic: %lu, %lu, %lu in %zu glyphs)\n",
+           (unsigned long)fontCov.exact15, (unsigned long)fontCov.chained, (unsigned long)fontCov.padded,
+           (unsigned long)synCov.exact15, (unsigned long)synCov.chained, (unsigned long)synCov.padded, SYN_COUNT);
+    printf("%s: %d failed check%s\n", failures ? "FAIL" : "ok", failures, failures == 1 ? "" : "s");
+    return failures ? 1 : 0;
+}
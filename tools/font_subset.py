@@ -0,0 +1,194 @@
+#=======================================================================================
+# BUILD-TIME FONT SUBSETTING (PLATFORMIO EXTRA SCRIPT):
+#=======================================================================================
+# Reduces one of the BSP bitmap fonts (src/drivers/font*.c) to the characters the firmware
+# can draw and generates it run-length coded (format in src/drivers/font_packed.h), as a C
+# file in the build directory that is compiled with the sources:
+#
+#   extra_scripts = tools/font_subset.py
+#   custom_font = font16                  # src/drivers/font16.c -> Font16 (default)
+#   custom_font_chars = IDLEWALKJOGRUN    # characters only known at run time (%s arguments)
+#
+# The character set is collected from the sources under src/: every string literal passed
+# to DisplayStringAt(), DisplayChar() or ui_line(), and every snprintf() format with each
+# conversion replaced by the characters it can produce (digits, sign, decimal point). Add
+# to custom_font_chars what the sources cannot show, e.g. the strings passed through %s.
+# Space and the fallback '?' are always kept.
+#
+# Standalone, for a look at the subset without a build:
+#   python3 tools/font_subset.py [--font font16] [--chars CHARS] [--all] [--out FILE (default ./font16_subset.c)]
+# --all keeps every glyph (the host decode check, tools/font_check.cpp, builds both).
+#=======================================================================================
+import argparse
+import codecs
+import glob
+import os
+import re
+
+FIRST, CHARS = 0x20, 95                     # ' ' .. '~', as in the BSP tables
+NONE = 0xFF
+
+CALL_RE = re.compile(r'\b(DisplayStringAt|DisplayChar|ui_line|snprintf)\s*\(')
+LITERAL_RE = re.compile(r'"((?:[^"\\\n]|\\.)*)"|\'((?:[^\'\\\n]|\\.)+)\'')
+CONVERSION_RE = re.compile(r'%[-+ #0]*(?:\d+|\*)?(?:\.(?:\d+|\*))?(?:hh|h|ll|l|L|z|j|t)?([diouxXfFeEgGcsp%])')
+DIGITS = '0123456789'
+CONVERSION_CHARS = {
+    'd': DIGITS + '-', 'i': DIGITS + '-', 'u': DIGITS, 'o': '01234567',
+    'x': DIGITS + 'abcdef', 'X': DIGITS + 'ABCDEF', 'p': DIGITS + 'abcdefx',
+    'f': DIGITS + '-.', 'F': DIGITS + '-.', 'e': DIGITS + '-.e+', 'E': DIGITS + '-.E+',
+    'g': DIGITS + '-.e+', 'G': DIGITS + '-.E+', 'c': '', 's': '', '%': '%',
+}
+
+
+def call_arguments(text, start):
+    """Text of a call's argument list, from just after its '(' to the matching ')'."""
+    depth, i = 1, start
+    while i < len(text) and depth > 0:
+        if text[i] in '"\'':
+            m = LITERAL_RE.match(text, i)
+            i = m.end() if m else i + 1
+            continue
+        depth += {'(': 1, ')': -1}.get(text[i], 0)
+        i += 1
+    return text[start:i - 1]
+
+
+def printable(literal):
+    chars = codecs.decode(literal.encode('latin-1'), 'unicode_escape')
+    return {c for c in chars if FIRST <= ord(c) < FIRST + CHARS}
+
+
+def source_chars(paths):
+    """Characters the sources can draw."""
+    found = set()
+    for path in paths:
+        with open(path, encoding='utf-8', errors='replace') as f:
+            text = re.sub(r'//[^\n]*', '', f.read())
+        for call in CALL_RE.finditer(text):
+            args = call_arguments(text, call.end())
+            for m in LITERAL_RE.finditer(args):
+                if m.group(2) is not None:
+                    found |= printable(m.group(2))
+                elif call.group(1) == 'snprintf':
+                    fmt = m.group(1)
+                    for conv in CONVERSION_RE.finditer(fmt):
+                        found |= set(CONVERSION_CHARS[conv.group(1)])
+                    found |= printable(CONVERSION_RE.sub('', fmt))
+                else:
+                    found |= printable(m.group(1))
+    return found
+
+
+def load_font(path, name):
+    """Width, height and the glyph table of a BSP font file."""
+    with open(path, encoding='utf-8', errors='replace') as f:
+        text = f.read()
+    table = re.search(r'%s_Table\[\]\s*=\s*\{(.*?)\};' % name, text, re.S)
+    size = re.search(r'sFONT\s+%s\s*=\s*\{\s*\w+\s*,\s*(\d+)\s*,(?:\s|/\*.*?\*/)*(\d+)' % name, text, re.S)
+    if table is None or size is None:
+        raise SystemExit('font_subset: no %s in %s' % (name, path))
+    data = [int(b, 16) for b in re.findall(r'0x([0-9A-Fa-f]{2})', re.sub(r'//[^\n]*', '', table.group(1)))]
+    width, height = int(size.group(1)), int(size.group(2))
+    if width > 32 or height > 32 or len(data) != CHARS * height * ((width + 7) // 8):
+        raise SystemExit('font_subset: unexpected layout of %s (%dx%d, %d bytes)' % (name, width, height, len(data)))
+    return width, height, data
+
+
+def glyph_runs(data, width, height, ascii_code):
+    """Run nibbles of one glyph: alternating colours from background, 15 = 15 and no switch."""
+    per_row = (width + 7) // 8
+    base = (ascii_code - FIRST) * height * per_row
+    pixels = []
+    for r in range(height):
+        row = 0
+        for b in range(per_row):
+            row = (row << 8) | data[base + r * per_row + b]
+        pixels += [(row >> (per_row * 8 - 1 - j)) & 1 for j in range(width)]
+    while pixels and pixels[-1] == 0:
+        pixels.pop()                        # The rest of the glyph is background
+    runs, color, i = [], 0, 0
+    while i < len(pixels):
+        n = 0
+        while i < len(pixels) and pixels[i] == color and n < 15:
+            n, i = n + 1, i + 1
+        runs.append(n)
+        if n != 15:
+            color ^= 1
+    if len(runs) % 2:
+        runs.append(0)                      # Pad to a byte: an empty run
+    return bytes((runs[k] << 4) | runs[k + 1] for k in range(0, len(runs), 2))
+
+
+def c_array(values, per_line=16, fmt='0x%02X'):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append('  ' + ', '.join(fmt % v for v in values[i:i + per_line]) + ',')
+    return '\n'.join(lines)
+
+
+def generate(project_dir, font, extra_chars, out_path, keep_all=False):
+    name = font[0].upper() + font[1:]
+    width, height, data = load_font(os.path.join(project_dir, 'src', 'drivers', font + '.c'), name)
+    sources = [p for p in glob.glob(os.path.join(project_dir, 'src', '**', '*.c*'), recursive=True)
+               if os.sep + 'drivers' + os.sep not in p]
+    chars = sorted(source_chars(sources) | printable(extra_chars) | {' ', '?'})
+    if keep_all:
+        chars = [chr(FIRST + i) for i in range(CHARS)]
+
+    prefix = font
+    glyph_map = [NONE] * CHARS
+    offsets, runs = [], bytearray()
+    for index, c in enumerate(chars):
+        glyph_map[ord(c) - FIRST] = index
+        offsets.append(len(runs))
+        runs += glyph_runs(data, width, height, ord(c))
+    offsets.append(len(runs))
+    full = len(data)
+
+    subset = ''.join(chars).replace('\\', '\\\\').replace('*/', '*\\/')
+    text = '\n'.join([
+        '/* GENERATED by tools/font_subset.py from src/drivers/%s.c -- do not edit */' % font,
+        '/* %d of %d glyphs, %d bytes of runs (the full table is %d bytes): "%s" */' % (len(chars), CHARS, len(runs), full, subset),
+        '#include "drivers/font_packed.h"',
+        '',
+        'static const uint8_t %sMap[%d] = {\n%s\n};' % (prefix, CHARS, c_array(glyph_map)),
+        '',
+        'static const uint16_t %sOffset[%d] = {\n%s\n};' % (prefix, len(offsets), c_array(offsets, 12, '%5d')),
+        '',
+        'static const uint8_t %sRuns[%d] = {\n%s\n};' % (prefix, len(runs), c_array(list(runs))),
+        '',
+        'static uint8_t %sValid[%d];' % (prefix, len(chars)),
+        '',
+        'FontPacked %sPacked = { %d, %d, %sMap, %sOffset, %sRuns, %sValid, NULL, 0, 0 };'
+        % (prefix, len(chars), chars.index('?'), prefix, prefix, prefix, prefix),
+        'sFONT %s = { NULL, %d, %d, &%sPacked };' % (name, width, height, prefix),
+        '',
+    ])
+    if os.path.dirname(out_path):
+        os.makedirs(os.path.dirname(out_path), exist_ok=True)
+    if not os.path.exists(out_path) or open(out_path).read() != text:
+        with open(out_path, 'w') as f:       # Rewritten only on change: no needless rebuild
+            f.write(text)
+    print('font_subset: %s %d/%d glyphs, %d bytes (%d unpacked) -> %s' % (name, len(chars), CHARS, len(runs), full, out_path))
+
+
+try:
+    Import('env')                           # Run by PlatformIO (SCons)
+except NameError:
+    env = None
+
+if env is not None:
+    font = env.GetProjectOption('custom_font', 'font16')
+    src_dir = os.path.join(env.subst('$BUILD_DIR'), 'font_subset_src')
+    generate(env.subst('$PROJECT_DIR'), font, env.GetProjectOption('custom_font_chars', ''),
+             os.path.join(src_dir, font + '_subset.c'))
+    env.BuildSources(os.path.join('$BUILD_DIR', 'font_subset'), src_dir)
+else:
+    parser = argparse.ArgumentParser(description='Generate a run-length coded subset of a BSP font.')
+    parser.add_argument('--font', default='font16')
+    parser.add_argument('--chars', default='')
+    parser.add_argument('--all', action='store_true', help='keep every glyph, not just the ones the sources draw')
+    parser.add_argument('--out', default=None)
+    args = parser.parse_args()
+    project = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    generate(project, args.font, args.chars, args.out or args.font + '_subset.c', args.all)
@@ -0,0 +1,320 @@
+//=======================================================================================
+// SYNTHETIC GAIT TRACES (HOST TOOLS):
+//=======================================================================================
+#include "gait_synth.h"
+#include "activity_classifier.h"
+#include "gyro_units.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#define GS_PI 3.14159265358979323846
+
+// PER-MODE GAIT PARAMETERS (ADULT AVERAGES)
+struct GaitProfile
+{
+    const char *name;
+    float cadence;                                  // STEPS PER MINUTE
+    float strideDeg;                                // LEG SWING, PEAK TO PEAK (deg)
+    float stepLengthM;                              // METERS PER STEP
+    int8_t label;                                   // ActivityClass
+};
+
+static const GaitProfile profiles[GAIT_MODE_COUNT] = {
+    { "rest", 0.0f, 0.0f, 0.0f, ACT_IDLE },
+    { "walk", 105.0f, 50.0f, 0.70f, ACT_WALK },
+    { "jog", 160.0f, 75.0f, 1.00f, ACT_JOG },
+    { "run", 175.0f, 95.0f, 1.30f, ACT_RUN },
+    { "turn", 95.0f, 40.0f, 0.55f, ACT_WALK },
+};
+
+const char *gsModeName(GaitMode mode)
+{
+    return mode < GAIT_MODE_COUNT ? profiles[mode].name : "?";
+}
+
+void gsDefaults(GaitConfig *cfg)
+{
+    *cfg = GaitConfig();
+    cfg->script = {
+        { GAIT_REST, 5.0f, 0.0f },
+        { GAIT_WALK, 30.0f, 0.0f },
+        { GAIT_TURN, 3.0f, 90.0f },
+        { GAIT_WALK, 15.0f, 0.0f },
+        { GAIT_JOG, 20.0f, 0.0f },
+        { GAIT_RUN, 15.0f, 0.0f },
+        { GAIT_REST, 5.0f, 0.0f },
+    };
+}
+
+bool gsParseScript(const char *text, std::vector<GaitSegment> *out)
+{
+    out->clear();
+    const char *p = text;
+    while (*p)
+    {
+        const char *end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        char item[64];
+        if (len == 0 || len >= sizeof(item))
+        {
+            fprintf(stderr, "script: bad segment near '%s'\n", p);
+            return false;
+        }
+        memcpy(item, p, len);
+        item[len] = '\0';
+
+        char *colon = strchr(item, ':');
+        if (colon == NULL)
+        {
+            fprintf(stderr, "script: '%s' is not mode:seconds\n", item);
+            return false;
+        }
+        *colon = '\0';
+        GaitSegment seg = { GAIT_MODE_COUNT, 0.0f, 0.0f };
+        for (int m = 0; m < GAIT_MODE_COUNT; m++)
+        {
+            if (strcmp(item, profiles[m].name) == 0)
+            {
+                seg.mode = (GaitMode)m;
+            }
+        }
+        char *rest = NULL;
+        seg.seconds = strtof(colon + 1, &rest);
+        if (seg.mode == GAIT_MODE_COUNT || seg.seconds <= 0.0f)
+        {
+            fprintf(stderr, "script: unknown mode or duration in '%s:%s'\n", item, colon + 1);
+            return false;
+        }
+        if (seg.mode == GAIT_TURN)
+        {
+            seg.turnDeg = (rest && *rest == ':') ? strtof(rest + 1, NULL) : 90.0f;
+        }
+        out->push_back(seg);
+        p = end ? end + 1 : p + len;
+    }
+    return !out->empty();
+}
+
+double gsScriptSeconds(const GaitConfig &cfg)
+{
+    double total = 0.0;
+    for (const GaitSegment &seg : cfg.script)
+    {
+        total += seg.seconds;
+    }
+    return total;
+}
+
+// xorshift64*: DETERMINISTIC AND PLATFORM INDEPENDENT, UNLIKE rand()
+static uint64_t gsRand(GaitSynth *s)
+{
+    s->rng ^= s->rng >> 12;
+    s->rng ^= s->rng << 25;
+    s->rng ^= s->rng >> 27;
+    return s->rng * 2685821657736338717ULL;
+}
+
+static double gsUniform(GaitSynth *s)
+{
+    return ((gsRand(s) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+static double gsGauss(GaitSynth *s)
+{
+    return sqrt(-2.0 * log(gsUniform(s))) * cos(2.0 * GS_PI * gsUniform(s));
+}
+
+static uint64_t gsSamples(const GaitSynth *s, float seconds)
+{
+    return (uint64_t)llround(seconds * s->cfg.odrHz);
+}
+
+void gsInit(GaitSynth *s, const GaitConfig &cfg)
+{
+    s->cfg = cfg;
+    s->segment = 0;
+    s->n = 0;
+    s->segmentEnd = cfg.script.empty() ? 0 : gsSamples(s, cfg.script[0].seconds);
+    s->phase = 0.0;
+    s->cadence = 0.0f;
+    s->amplitude = 0.0f;
+    s->stepLength = 0.0f;
+    s->rng = 0x9E3779B97F4A7C15ULL ^ ((uint64_t)cfg.seed << 1 | 1);
+    s->steps = 0;
+    s->distanceM = 0.0;
+}
+
+static int16_t gsQuantise(double dps, float fsDps)
+{
+    float mdps = GYRO_SENS_500DPS_MDPS;
+    if (fsDps <= 250.0f)
+    {
+        mdps = GYRO_SENS_250DPS_MDPS;
+    }
+    else if (fsDps >= 2000.0f)
+    {
+        mdps = GYRO_SENS_2000DPS_MDPS;
+    }
+    double counts = floor(dps * 1000.0 / mdps + 0.5);
+    if (counts > 32767.0)
+    {
+        counts = 32767.0;
+    }
+    else if (counts < -32768.0)
+    {
+        counts = -32768.0;
+    }
+    return (int16_t)counts;
+}
+
+bool gsNext(GaitSynth *s, TraceSample *out)
+{
+    const GaitConfig &cfg = s->cfg;
+    while (s->segment < cfg.script.size() && s->n >= s->segmentEnd)
+    {
+        if (++s->segment < cfg.script.size())
+        {
+            s->segmentEnd += gsSamples(s, cfg.script[s->segment].seconds);
+        }
+    }
+    if (s->segment >= cfg.script.size())
+    {
+        return false;
+    }
+
+    const GaitSegment &seg = cfg.script[s->segment];
+    const GaitProfile &prof = profiles[seg.mode];
+    double dt = 1.0 / cfg.odrHz;
+    double t = s->n * dt;
+
+    // Cadence, swing and step length approach the segment's targets with a first-order lag
+    float alpha = (float)(dt / (cfg.transitionSec + dt));
+    s->cadence += alpha * (prof.cadence * cfg.cadenceScale - s->cadence);
+    s->amplitude += alpha * (prof.strideDeg * cfg.strideScale - s->amplitude);
+    s->stepLength += alpha * (prof.stepLengthM * cfg.strideScale - s->stepLength);
+
+    // Leg swing: theta = A/2 * sin(2*pi*f*t) at f = cadence / 2 (one swing cycle per two steps), so the
+    // pitch rate peaks at pi * f * A. The second harmonic gives the sharper push-off of a real stride.
+    double f = s->cadence / 120.0;
+    double prevPhase = s->phase;
+    s->phase += f * dt;
+    double w = 2.0 * GS_PI * s->phase;
+    double peak = GS_PI * f * s->amplitude;
+    double pitch = peak * (cos(w) + 0.25 * cos(2.0 * w + 0.6));
+    double roll = 0.15 * peak * sin(w + 0.4);
+    double yaw = 0.10 * peak * sin(2.0 * w);
+    if (seg.mode == GAIT_TURN)
+    {
+        yaw += seg.turnDeg / seg.seconds;
+    }
+
+    // A step lands on every half swing cycle
+    long halfCycles = (long)floor(s->phase * 2.0) - (long)floor(prevPhase * 2.0);
+    if (halfCycles > 0 && s->amplitude > 1.0f)
+    {
+        s->steps += halfCycles;
+        s->distanceM += halfCycles * s->stepLength;
+    }
+
+    // Sensor errors: bias + temperature drift + white noise, then the occasional glitch
+    double tempDelta = cfg.tempRampCPerHour * t / 3600.0;
+    double rate[3] = { pitch, roll, yaw };
+    for (int d = 0; d < 3; d++)
+    {
+        rate[d] += cfg.biasDps[d] + cfg.driftDpsPerC[d] * tempDelta + cfg.noiseDps * gsGauss(s);
+    }
+    for (int d = 0; d < 3; d++)
+    {
+        out->g[d] = gsQuantise(rate[d], cfg.fsDps);
+    }
+    if (cfg.glitchPerSec > 0.0f && gsUniform(s) < cfg.glitchPerSec * dt)
+    {
+        int d = (int)(gsRand(s) % 3);
+        out->g[d] = (int16_t)(gsRand(s) & 0xFFFF);
+    }
+
+    out->tUs = (uint32_t)(uint64_t)llround(t * 1.0e6);     // Wraps like the firmware's 32-bit microsecond stamps
+    out->label = prof.label;
+    s->n++;
+    return true;
+}
+
+bool gsIsSpec(const char *spec)
+{
+    return strncmp(spec, GS_SPEC_PREFIX, strlen(GS_SPEC_PREFIX)) == 0;
+}
+
+bool gsLoadSpec(const char *spec, Trace *out)
+{
+    GaitConfig cfg;
+    gsDefaults(&cfg);
+    int repeat = 1;
+    std::string keys(spec + strlen(GS_SPEC_PREFIX));
+    size_t pos = 0;
+    while (pos < keys.size())
+    {
+        size_t end = keys.find(',', pos);
+        if (end == std::string::npos)
+        {
+            end = keys.size();
+        }
+        std::string kv = keys.substr(pos, end - pos);
+        size_t eq = kv.find('=');
+        if (eq == std::string::npos)
+        {
+            fprintf(stderr, "%s: '%s' is not key=value\n", spec, kv.c_str());
+            return false;
+        }
+        std::string key = kv.substr(0, eq);
+        double v = atof(kv.c_str() + eq + 1);
+        if (key == "seed")
+        {
+            cfg.seed = (uint32_t)v;
+        }
+        else if (key == "odr")
+        {
+            cfg.odrHz = (float)v;
+        }
+        else if (key == "glitch")
+        {
+            cfg.glitchPerSec = (float)v;
+        }
+        else if (key == "bias")
+        {
+            cfg.biasDps[0] = cfg.biasDps[1] = cfg.biasDps[2] = (float)v;
+        }
+        else if (key == "repeat")
+        {
+            repeat = (int)v;
+        }
+        else
+        {
+            fprintf(stderr, "%s: unknown key '%s'\n", spec, key.c_str());
+            return false;
+        }
+        pos = end + 1;
+    }
+    std::vector<GaitSegment> once = cfg.script;
+    for (int r = 1; r < repeat; r++)
+    {
+        cfg.script.insert(cfg.script.end(), once.begin(), once.end());
+    }
+
+    GaitSynth synth;
+    gsInit(&synth, cfg);
+    out->name = spec;
+    out->odrHz = cfg.odrHz;
+    out->fsDps = cfg.fsDps;
+    out->samples.clear();
+    TraceSample s;
+    while (gsNext(&synth, &s))
+    {
+        out->samples.push_back(s);
+    }
+    out->truthSteps = synth.steps;
+    out->truthDistanceM = (float)synth.distanceM;
+    return true;
+}
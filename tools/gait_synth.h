@@ -0,0 +1,95 @@
+//=======================================================================================
+// SYNTHETIC GAIT TRACES (HOST TOOLS):
+//=======================================================================================
+// Generates raw L3GD20 samples for a leg-mounted board from a script of activity
+// segments, so the pipeline can be exercised on hours of walking, jogging, running,
+// turning and resting without anyone having to do it:
+//   - leg swing: pitch (X) rate of a pendulum swinging through the stride angle at half
+//     the cadence, with a second harmonic and smaller roll (Y) / yaw (Z) cross-talk
+//   - turns: a yaw rate (Z) on top of the swing
+//   - sensor errors: per-axis zero-rate bias, temperature drift of the bias (linear
+//     temperature ramp, per-axis dps/degC), white noise, and single-sample glitches
+//     (SPI bit errors / impacts) at a given rate
+//   - quantisation to int16 counts at the configured full scale, with saturation
+// Cadence and stride angle move smoothly between segments (first-order lag) instead of
+// jumping, and every sample carries the ground-truth label (rest -> idle, turn -> walk).
+// The generator is deterministic for a given seed and streams one sample at a time, so
+// trace length is bounded only by the disk.
+//=======================================================================================
+#ifndef GAIT_SYNTH_H
+#define GAIT_SYNTH_H
+
+#include "trace_io.h"
+#include <stdint.h>
+#include <vector>
+
+enum GaitMode : uint8_t
+{
+    GAIT_REST = 0,
+    GAIT_WALK,
+    GAIT_JOG,
+    GAIT_RUN,
+    GAIT_TURN,                                      // WALKING WHILE TURNING (SEGMENT CARRIES THE ANGLE)
+    GAIT_MODE_COUNT
+};
+
+struct GaitSegment
+{
+    GaitMode mode;
+    float seconds;
+    float turnDeg;                                  // GAIT_TURN ONLY: TOTAL HEADING CHANGE (+ = LEFT)
+};
+
+struct GaitConfig
+{
+    float odrHz = 190.0f;                           // OUTPUT DATA RATE (ANY, e.g. 95/190/380/760)
+    float fsDps = 500.0f;                           // FULL SCALE: 250, 500 OR 2000
+    uint32_t seed = 1;
+    float cadenceScale = 1.0f;                      // MULTIPLIES THE PER-MODE CADENCE
+    float strideScale = 1.0f;                       // MULTIPLIES THE PER-MODE STRIDE ANGLE (AND LENGTH)
+    float biasDps[3] = { 0.0f, 0.0f, 0.0f };        // ZERO-RATE LEVEL AT tempStartC
+    float noiseDps = 0.03f * 13.8f;                 // RMS NOISE (DATASHEET 0.03 dps/sqrt(Hz) OVER ~190 Hz)
+    float tempStartC = 25.0f;
+    float tempRampCPerHour = 0.0f;
+    float driftDpsPerC[3] = { 0.0f, 0.0f, 0.0f };   // BIAS TEMPERATURE COEFFICIENT PER AXIS
+    float glitchPerSec = 0.0f;                      // MEAN SINGLE-SAMPLE GLITCHES PER SECOND
+    float transitionSec = 0.5f;                     // CADENCE / AMPLITUDE LAG BETWEEN SEGMENTS
+    std::vector<GaitSegment> script;
+};
+
+struct GaitSynth
+{
+    GaitConfig cfg;
+    size_t segment;                                 // CURRENT SCRIPT ENTRY
+    uint64_t n;                                     // SAMPLES GENERATED
+    uint64_t segmentEnd;                            // SAMPLE INDEX WHERE THE CURRENT SEGMENT ENDS
+    double phase;                                   // LEG SWING PHASE (CYCLES), ONE CYCLE = TWO STEPS
+    float cadence;                                  // SMOOTHED STEPS/MIN
+    float amplitude;                                // SMOOTHED STRIDE ANGLE (deg, PEAK TO PEAK)
+    float stepLength;                               // SMOOTHED METERS PER STEP
+    uint64_t rng;
+    long steps;                                     // GROUND TRUTH
+    double distanceM;
+};
+
+// CONFIGURATION WITH A DEFAULT SCRIPT (REST / WALK / TURN / JOG / RUN / REST)
+void gsDefaults(GaitConfig *cfg);
+
+// PARSE "walk:60,rest:10,turn:4:90,jog:30,run:20" (mode:seconds[:turn degrees]); FALSE ON ERROR
+bool gsParseScript(const char *text, std::vector<GaitSegment> *out);
+
+void gsInit(GaitSynth *s, const GaitConfig &cfg);
+
+// NEXT SAMPLE; FALSE WHEN THE SCRIPT IS EXHAUSTED
+bool gsNext(GaitSynth *s, TraceSample *out);
+
+// "synth:seed=N,odr=HZ,glitch=R,bias=DPS,repeat=N" (ALL KEYS OPTIONAL, DEFAULT SCRIPT): A WHOLE
+// SYNTHETIC TRACE NAMED BY ONE STRING, SO TOOLS CAN TAKE IT WHEREVER THEY TAKE A FILE NAME
+#define GS_SPEC_PREFIX "synth:"
+bool gsIsSpec(const char *spec);
+bool gsLoadSpec(const char *spec, Trace *out);
+
+double gsScriptSeconds(const GaitConfig &cfg);
+const char *gsModeName(GaitMode mode);
+
+#endif // GAIT_SYNTH_H
@@ -0,0 +1,490 @@
+//=======================================================================================
+// GOLDEN-TRACE REGRESSION HARNESS (HOST):
+//=======================================================================================
+// Replays a corpus of raw traces through the pipeline (lib/GyroDSP/gyro_pipeline) and
+// compares the results with the golden outputs stored in a golden file:
+//   - final total distance (relative tolerance) and step count (absolute tolerance)
+//   - the IDLE / MOVING state sequence and the activity class sequence, as lists of
+//     transitions (sample index -> new value); the same transitions must happen, each
+//     within a few samples of the golden one
+//   - throughput (Msamples/s, best of --reps runs); a drop beyond --perf-tol fails
+// Next to the golden diff the results are also held against the trace's own ground truth
+// when it has one (synthetic traces always do): the relative error of the distance and of
+// the step count must stay within --truth-dist-tol / --truth-step-tol. --update runs the same gate and writes
+// nothing if a trace fails it, so a corpus that records broken output cannot be saved.
+//
+//   golden_check [options] corpus.golden                check against the goldens
+//   golden_check --update [options] corpus.golden trace...   (re)write the goldens
+//     --dist-tol R      relative distance tolerance (default 1e-4)
+//     --step-tol N      step count tolerance (default 0)
+//     --state-tol N     transition index tolerance in samples (default 0)
+//     --perf-tol R      allowed throughput drop, 0.3 = 30% (default 0.3)
+//     --no-perf         do not check throughput (different or noisy machine)
+//     --reps N          runs per trace for the throughput figure (default 3)
+//     --truth-dist-tol R  relative distance error against ground truth (default 0.25)
+//     --truth-step-tol R  relative step count error against ground truth (default 0.4)
+//
+// The ground-truth defaults are the accuracy of the tuned constants on the synthetic
+// corpus with margin (-18% distance, -34% steps: the FSM counts at most one step per 0.5s
+// step), not a target; they catch a pipeline that has stopped measuring walking at all.
+//
+// A trace is a file path (relative to the golden file, also with --update) or a synthetic
+// trace rendered by tools/gait_synth, "synth:seed=N,odr=HZ,glitch=R,bias=DPS,repeat=N"
+// (all keys optional, default gait script), so a corpus can be checked in without the
+// samples themselves.
+// Exit status: 0 all traces pass, 1 a regression (with --update: a trace off ground truth),
+// 2 usage or I/O error.
+//=======================================================================================
+#include "gait_synth.h"
+#include "gyro_pipeline.h"
+#include "trace_io.h"
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct Transition
+{
+    uint32_t index;                                 // SAMPLE INDEX OF THE CHANGE
+    int32_t value;                                  // NEW VALUE
+};
+
+struct GoldenResult
+{
+    std::string trace;                              // TRACE SPEC AS WRITTEN IN THE GOLDEN FILE
+    uint64_t samples = 0;
+    float totalDist = 0.0f;
+    int32_t steps = 0;
+    double msps = 0.0;                              // THROUGHPUT, MSAMPLES/S
+    std::vector<Transition> states;
+    std::vector<Transition> activity;
+    long truthSteps = -1;                           // FROM THE TRACE, -1 IF UNKNOWN (NOT STORED IN THE GOLDEN FILE)
+    float truthDistanceM = -1.0f;
+};
+
+struct Tolerances
+{
+    double dist = 1.0e-4;
+    int32_t steps = 0;
+    uint32_t stateSamples = 0;
+    double perf = 0.3;
+    bool checkPerf = true;
+    int reps = 3;
+    double truthDist = 0.25;
+    double truthSteps = 0.4;
+};
+
+static GyroPipeline pipeline;                       // ~25KB, kept off the stack
+
+static std::string dirOf(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+    return slash ? std::string(path, slash - path + 1) : std::string();
+}
+
+static bool loadSpec(const std::string &spec, const std::string &baseDir, Trace *out)
+{
+    if (gsIsSpec(spec.c_str()))
+    {
+        return gsLoadSpec(spec.c_str(), out);
+    }
+    std::string path = (spec[0] == '/') ? spec : baseDir + spec;
+    return traceLoad(path.c_str(), out);
+}
+
+static void track(std::vector<Transition> *seq, uint32_t index, int32_t value)
+{
+    if (seq->empty() || seq->back().value != value)
+    {
+        seq->push_back({ index, value });
+    }
+}
+
+// RUN THE PIPELINE OVER THE TRACE 'reps' TIMES; OUTPUTS FROM THE LAST RUN, BEST THROUGHPUT
+static void runTrace(const Trace &trace, int reps, GoldenResult *out)
+{
+    double bestS = 0.0;
+    for (int r = 0; r < reps; r++)
+    {
+        out->states.clear();
+        out->activity.clear();
+        gpInit(&pipeline, GP_ACT_WINDOW_MS);
+        track(&out->states, 0, pipeline.state);
+        track(&out->activity, 0, pipeline.activity.current);
+
+        auto start = std::chrono::steady_clock::now();
+        uint32_t i = 0;
+        for (const TraceSample &s : trace.samples)
+        {
+            gpProcess(&pipeline, s.tUs, s.g);
+            track(&out->states, i, pipeline.state);
+            track(&out->activity, i, pipeline.activity.current);
+            i++;
+        }
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (r == 0 || s < bestS)
+        {
+            bestS = s;
+        }
+    }
+    out->samples = trace.samples.size();
+    out->truthSteps = trace.truthSteps;
+    out->truthDistanceM = trace.truthDistanceM;
+    out->totalDist = pipeline.totalDist;
+    out->steps = pipeline.stepCnt;
+    out->msps = bestS > 0.0 ? out->samples / bestS * 1.0e-6 : 0.0;
+}
+
+static void writeSeq(FILE *f, const char *key, const std::vector<Transition> &seq)
+{
+    fprintf(f, "%s %zu", key, seq.size());
+    for (const Transition &t : seq)
+    {
+        fprintf(f, " %lu:%ld", (unsigned long)t.index, (long)t.value);
+    }
+    fprintf(f, "\n");
+}
+
+static bool readSeq(const char *text, std::vector<Transition> *seq)
+{
+    char *p = NULL;
+    long n = strtol(text, &p, 10);
+    seq->clear();
+    for (long k = 0; k < n; k++)
+    {
+        Transition t;
+        t.index = (uint32_t)strtoul(p, &p, 10);
+        if (*p != ':')
+        {
+            return false;
+        }
+        t.value = (int32_t)strtol(p + 1, &p, 10);
+        seq->push_back(t);
+    }
+    return true;
+}
+
+static bool writeGolden(const char *path, const std::vector<GoldenResult> &results)
+{
+    FILE *f = fopen(path, "w");
+    if (f == NULL)
+    {
+        fprintf(stderr, "%s: cannot create\n", path);
+        return false;
+    }
+    fprintf(f, "# golden pipeline outputs, written by golden_check --update\n");
+    for (const GoldenResult &g : results)
+    {
+        fprintf(f, "trace %s\n", g.trace.c_str());
+        fprintf(f, "samples %llu\n", (unsigned long long)g.samples);
+        fprintf(f, "total_dist %.9g\n", g.totalDist);
+        fprintf(f, "steps %ld\n", (long)g.steps);
+        fprintf(f, "msps %.3f\n", g.msps);
+        writeSeq(f, "states", g.states);
+        writeSeq(f, "activity", g.activity);
+        fprintf(f, "end\n");
+    }
+    return fclose(f) == 0;
+}
+
+static bool readGolden(const char *path, std::vector<GoldenResult> *out)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+    {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    std::string line;
+    GoldenResult cur;
+    bool ok = true;
+    char buf[4096];
+    while (ok && fgets(buf, sizeof(buf), f))
+    {
+        line += buf;
+        if (line.empty() || line.back() != '\n')
+        {
+            continue;                               // Long sequence line, keep reading
+        }
+        line.pop_back();
+        const char *l = line.c_str();
+        const char *sp = strchr(l, ' ');
+        std::string key = sp ? std::string(l, sp - l) : line;
+        const char *val = sp ? sp + 1 : "";
+        if (line.empty() || line[0] == '#')
+        {
+        }
+        else if (key == "trace")
+        {
+            cur = GoldenResult();
+            cur.trace = val;
+        }
+        else if (key == "samples")
+        {
+            cur.samples = strtoull(val, NULL, 10);
+        }
+        else if (key == "total_dist")
+        {
+            cur.totalDist = strtof(val, NULL);
+        }
+        else if (key == "steps")
+        {
+            cur.steps = (int32_t)strtol(val, NULL, 10);
+        }
+        else if (key == "msps")
+        {
+            cur.msps = strtod(val, NULL);
+        }
+        else if (key == "states")
+        {
+            ok = readSeq(val, &cur.states);
+        }
+        else if (key == "activity")
+        {
+            ok = readSeq(val, &cur.activity);
+        }
+        else if (key == "end")
+        {
+            out->push_back(cur);
+        }
+        else
+        {
+            ok = false;
+        }
+        if (!ok)
+        {
+            fprintf(stderr, "%s: bad line '%s'\n", path, l);
+        }
+        line.clear();
+    }
+    fclose(f);
+    return ok;
+}
+
+// COMPARE TWO TRANSITION LISTS; APPENDS THE FIRST MISMATCH TO 'why'
+static bool sameSeq(const char *what, const std::vector<Transition> &golden, const std::vector<Transition> &got, uint32_t tol, std::string *why)
+{
+    char msg[160];
+    size_t n = golden.size() < got.size() ? golden.size() : got.size();
+    for (size_t k = 0; k < n; k++)
+    {
+        uint32_t d = golden[k].index > got[k].index ? golden[k].index - got[k].index : got[k].index - golden[k].index;
+        if (golden[k].value != got[k].value || d > tol)
+        {
+            snprintf(msg, sizeof(msg), "%s transition %zu: golden %lu:%ld, got %lu:%ld; ", what, k,
+                     (unsigned long)golden[k].index, (long)golden[k].value, (unsigned long)got[k].index, (long)got[k].value);
+            *why += msg;
+            return false;
+        }
+    }
+    if (golden.size() != got.size())
+    {
+        snprintf(msg, sizeof(msg), "%s: %zu transitions, golden %zu; ", what, got.size(), golden.size());
+        *why += msg;
+        return false;
+    }
+    return true;
+}
+
+// ERROR AGAINST THE TRACE'S GROUND TRUTH; APPENDS THE FAILURES TO 'why' (NOTHING TO CHECK WITHOUT TRUTH)
+static bool nearTruth(const GoldenResult &got, const Tolerances &tol, std::string *why)
+{
+    char msg[160];
+    bool ok = true;
+    if (got.truthDistanceM > 0.0f)
+    {
+        double err = (got.totalDist - got.truthDistanceM) / got.truthDistanceM;
+        if (fabs(err) > tol.truthDist)
+        {
+            snprintf(msg, sizeof(msg), "distance %.6g, truth %.6g (%+.1f%%); ", got.totalDist, got.truthDistanceM, err * 100.0);
+            *why += msg;
+            ok = false;
+        }
+    }
+    if (got.truthSteps > 0)
+    {
+        double err = (double)(got.steps - got.truthSteps) / (double)got.truthSteps;
+        if (fabs(err) > tol.truthSteps)
+        {
+            snprintf(msg, sizeof(msg), "steps %ld, truth %ld (%+.1f%%); ", (long)got.steps, got.truthSteps, err * 100.0);
+            *why += msg;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [--dist-tol R] [--step-tol N] [--state-tol N] [--perf-tol R] [--no-perf] [--reps N]\n"
+            "          [--truth-dist-tol R] [--truth-step-tol R] corpus.golden\n"
+            "       %s --update [--reps N] [--truth-dist-tol R] [--truth-step-tol R] corpus.golden trace.csv|synth:key=value,... [...]\n",
+            prog, prog);
+}
+
+int main(int argc, char **argv)
+{
+    Tolerances tol;
+    bool update = false;
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++)
+    {
+        const char *opt = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(opt, "--update") == 0)
+        {
+            update = true;
+            continue;
+        }
+        if (strcmp(opt, "--no-perf") == 0)
+        {
+            tol.checkPerf = false;
+            continue;
+        }
+        if (val == NULL)
+        {
+            usage(argv[0]);
+            return 2;
+        }
+        if (strcmp(opt, "--dist-tol") == 0)
+        {
+            tol.dist = atof(val);
+        }
+        else if (strcmp(opt, "--step-tol") == 0)
+        {
+            tol.steps = atoi(val);
+        }
+        else if (strcmp(opt, "--state-tol") == 0)
+        {
+            tol.stateSamples = (uint32_t)atoi(val);
+        }
+        else if (strcmp(opt, "--perf-tol") == 0)
+        {
+            tol.perf = atof(val);
+        }
+        else if (strcmp(opt, "--reps") == 0)
+        {
+            tol.reps = atoi(val) > 0 ? atoi(val) : 1;
+        }
+        else if (strcmp(opt, "--truth-dist-tol") == 0)
+        {
+            tol.truthDist = atof(val);
+        }
+        else if (strcmp(opt, "--truth-step-tol") == 0)
+        {
+            tol.truthSteps = atof(val);
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    if (i >= argc || (update && i + 1 >= argc))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+    const char *goldenPath = argv[i];
+    std::string baseDir = dirOf(goldenPath);
+
+    if (update)
+    {
+        std::vector<GoldenResult> results;
+        int wrong = 0;
+        for (int f = i + 1; f < argc; f++)
+        {
+            Trace trace;
+            if (!loadSpec(argv[f], baseDir, &trace))
+            {
+                return 2;
+            }
+            GoldenResult g;
+            runTrace(trace, tol.reps, &g);
+            g.trace = argv[f];
+            results.push_back(g);
+            printf("%-44s %9llu samples  dist %10.3f  steps %4ld  %3zu state / %3zu activity transitions  %6.2f Msamples/s\n",
+                   argv[f], (unsigned long long)g.samples, g.totalDist, (long)g.steps, g.states.size(), g.activity.size(), g.msps);
+            std::string why;
+            if (!nearTruth(g, tol, &why))
+            {
+                printf("     off ground truth: %s\n", why.c_str());
+                wrong++;
+            }
+        }
+        if (wrong > 0)
+        {
+            printf("%d trace%s off ground truth, %s not written\n", wrong, wrong == 1 ? "" : "s", goldenPath);
+            return 1;
+        }
+        if (!writeGolden(goldenPath, results))
+        {
+            return 2;
+        }
+        printf("wrote %zu goldens to %s\n", results.size(), goldenPath);
+        return 0;
+    }
+
+    std::vector<GoldenResult> goldens;
+    if (!readGolden(goldenPath, &goldens) || goldens.empty())
+    {
+        fprintf(stderr, "%s: no goldens\n", goldenPath);
+        return 2;
+    }
+
+    int failures = 0;
+    for (const GoldenResult &golden : goldens)
+    {
+        Trace trace;
+        if (!loadSpec(golden.trace, baseDir, &trace))
+        {
+            return 2;
+        }
+        GoldenResult got;
+        runTrace(trace, tol.reps, &got);
+
+        std::string why;
+        char msg[160];
+        if (got.samples != golden.samples)
+        {
+            snprintf(msg, sizeof(msg), "samples %llu, golden %llu; ", (unsigned long long)got.samples, (unsigned long long)golden.samples);
+            why += msg;
+        }
+        double distErr = fabs(got.totalDist - golden.totalDist) / (fabs(golden.totalDist) > 1.0e-6 ? fabs(golden.totalDist) : 1.0);
+        if (distErr > tol.dist)
+        {
+            snprintf(msg, sizeof(msg), "distance %.6g, golden %.6g (rel err %.2e); ", got.totalDist, golden.totalDist, distErr);
+            why += msg;
+        }
+        if (abs(got.steps - golden.steps) > tol.steps)
+        {
+            snprintf(msg, sizeof(msg), "steps %ld, golden %ld; ", (long)got.steps, (long)golden.steps);
+            why += msg;
+        }
+        nearTruth(got, tol, &why);
+        sameSeq("state", golden.states, got.states, tol.stateSamples, &why);
+        sameSeq("activity", golden.activity, got.activity, tol.stateSamples, &why);
+        double perfRatio = golden.msps > 0.0 ? got.msps / golden.msps : 1.0;
+        if (tol.checkPerf && perfRatio < 1.0 - tol.perf)
+        {
+            snprintf(msg, sizeof(msg), "throughput %.2f Msamples/s, golden %.2f (%.0f%%); ", got.msps, golden.msps, perfRatio * 100.0);
+            why += msg;
+        }
+
+        printf("%-4s %-44s dist %10.3f  steps %4ld  %6.2f Msamples/s (%3.0f%% of golden)\n", why.empty() ? "ok" : "FAIL",
+               golden.trace.c_str(), got.totalDist, (long)got.steps, got.msps, perfRatio * 100.0);
+        if (!why.empty())
+        {
+            printf("     %s\n", why.c_str());
+            failures++;
+        }
+    }
+
+    printf("%d of %zu traces regressed\n", failures, goldens.size());
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,355 @@
+//=======================================================================================
+// PARAMETER SWEEP TUNER (HOST):
+//=======================================================================================
+// Searches the pipeline's hand-tuned constants (GpParams: moving-average window, motion
+// threshold, step threshold, radius, the two scaling factors) for the settings that best
+// reproduce the ground truth of a trace corpus, and reports how much each setting costs
+// per sample.
+//
+//   param_sweep [--grid | --random N] [--seed S] [--threads N] [--top K] [--csv out.csv]
+//               [--range name=lo:hi[:step]] ... trace...
+//
+// Traces need ground truth ("# truth_steps=... truth_distance_m=..."); synthetic specs
+// (tools/gait_synth, "synth:seed=N,...") always have it. Every trace is decoded once and
+// shared read-only; each configuration is one task on the work-stealing pool (tools/
+// work_pool) with its own GyroPipeline.
+//
+// Parameters and default ranges (--range overrides; a step only matters for --grid):
+//   window     4:8:1            threshold  60:160:20      step  0.0015:0.0045:0.0005
+//   radius     0.5:0.5          mul1       1e6:1e6        mul2  50:150:5
+// Score: error = mean over traces of (|dist - truth| / truth + |steps - truth| / truth) / 2.
+// Cost: pipeline ns per sample for that configuration over the whole corpus. The output is
+// the K best configurations by error and the Pareto front of error versus cost (no other
+// configuration is both more accurate and cheaper).
+//=======================================================================================
+#include "gait_synth.h"
+#include "gyro_pipeline.h"
+#include "trace_io.h"
+#include "work_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+enum SweepParam : uint8_t
+{
+    SP_WINDOW = 0,
+    SP_THRESHOLD,
+    SP_STEP,
+    SP_RADIUS,
+    SP_MUL1,
+    SP_MUL2,
+    SP_COUNT
+};
+
+struct SweepRange
+{
+    const char *name;
+    double lo, hi, step;
+};
+
+struct SweepResult
+{
+    GpParams params;
+    double distErr, stepErr, error;
+    double nsPerSample;
+    bool pareto;
+};
+
+static SweepRange ranges[SP_COUNT] = {
+    { "window", 4, 8, 1 },
+    { "threshold", 60, 160, 20 },
+    { "step", 0.0015, 0.0045, 0.0005 },
+    { "radius", 0.5, 0.5, 0.1 },
+    { "mul1", 1.0e6, 1.0e6, 1.0e6 },
+    { "mul2", 50, 150, 5 },
+};
+
+static GpParams makeParams(const double v[SP_COUNT])
+{
+    GpParams p;
+    p.windowSize = (uint8_t)lround(v[SP_WINDOW]);
+    p.threshold = (float)v[SP_THRESHOLD];
+    p.stepThreshold = (float)v[SP_STEP];
+    p.radius = (float)v[SP_RADIUS];
+    p.mulFactor1 = (float)v[SP_MUL1];
+    p.mulFactor2 = (float)v[SP_MUL2];
+    return p;
+}
+
+static void expandGrid(int k, double v[SP_COUNT], std::vector<GpParams> *out)
+{
+    if (k == SP_COUNT)
+    {
+        out->push_back(makeParams(v));
+        return;
+    }
+    const SweepRange &r = ranges[k];
+    int n = (r.step > 0.0 && r.hi > r.lo) ? (int)floor((r.hi - r.lo) / r.step + 1.0e-9) + 1 : 1;
+    for (int i = 0; i < n; i++)
+    {
+        v[k] = r.lo + i * r.step;
+        expandGrid(k + 1, v, out);
+    }
+}
+
+static void randomConfigs(int count, uint32_t seed, std::vector<GpParams> *out)
+{
+    uint64_t s = 0x9E3779B97F4A7C15ULL ^ seed;
+    for (int i = 0; i < count; i++)
+    {
+        double v[SP_COUNT];
+        for (int k = 0; k < SP_COUNT; k++)
+        {
+            s ^= s >> 12;                           // xorshift64*
+            s ^= s << 25;
+            s ^= s >> 27;
+            double u = ((s * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+            v[k] = ranges[k].lo + u * (ranges[k].hi - ranges[k].lo);
+        }
+        out->push_back(makeParams(v));
+    }
+}
+
+static void evaluate(const std::vector<Trace> &corpus, const GpParams &params, SweepResult *out)
+{
+    std::unique_ptr<GyroPipeline> p(new GyroPipeline);
+    out->params = params;
+    double distErr = 0.0, stepErr = 0.0;
+    uint64_t samples = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const Trace &trace : corpus)
+    {
+        gpInit(p.get(), GP_ACT_WINDOW_MS);
+        gpConfigure(p.get(), &params);
+        for (const TraceSample &s : trace.samples)
+        {
+            gpProcess(p.get(), s.tUs, s.g);
+        }
+        long steps = (long)p->stepCnt;
+        samples += trace.samples.size();
+        distErr += fabs(p->totalDist - trace.truthDistanceM) / (trace.truthDistanceM > 0.0f ? trace.truthDistanceM : 1.0f);
+        stepErr += fabs((double)(steps - trace.truthSteps)) / (trace.truthSteps > 0 ? trace.truthSteps : 1);
+    }
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    out->distErr = distErr / corpus.size();
+    out->stepErr = stepErr / corpus.size();
+    out->error = (out->distErr + out->stepErr) / 2.0;
+    out->nsPerSample = samples ? s * 1.0e9 / samples : 0.0;
+    out->pareto = false;
+}
+
+static void printResult(const SweepResult &r, int rank)
+{
+    printf("%4d  %6u %9.2f %9.5f %7.3f %9.3g %7.2f   %8.2f%% %8.2f%% %8.2f%% %8.1f %s\n", rank, r.params.windowSize, r.params.threshold,
+           r.params.stepThreshold, r.params.radius, r.params.mulFactor1, r.params.mulFactor2, r.distErr * 100.0, r.stepErr * 100.0,
+           r.error * 100.0, r.nsPerSample, r.pareto ? "*" : "");
+}
+
+static void printHeader()
+{
+    printf("%4s  %6s %9s %9s %7s %9s %7s   %9s %9s %9s %8s\n", "rank", "window", "threshold", "step", "radius", "mul1", "mul2",
+           "dist-err", "step-err", "error", "ns/smp");
+}
+
+static bool parseRange(const char *text)
+{
+    const char *eq = strchr(text, '=');
+    if (eq == NULL)
+    {
+        return false;
+    }
+    for (SweepRange &r : ranges)
+    {
+        if (strncmp(text, r.name, eq - text) == 0 && r.name[eq - text] == '\0')
+        {
+            int n = sscanf(eq + 1, "%lf:%lf:%lf", &r.lo, &r.hi, &r.step);
+            if (n == 1)
+            {
+                r.hi = r.lo;
+            }
+            return n >= 1 && r.hi >= r.lo;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    int randomCount = 0;
+    uint32_t seed = 1;
+    unsigned threads = 0;
+    int top = 10;
+    const char *csvPath = NULL;
+    std::vector<std::string> specs;
+    bool ok = true;
+    for (int i = 1; i < argc && ok; i++)
+    {
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--grid") == 0)
+        {
+            randomCount = 0;
+        }
+        else if (argv[i][0] != '-')
+        {
+            specs.push_back(argv[i]);
+        }
+        else if (val == NULL)
+        {
+            ok = false;
+        }
+        else
+        {
+            if (strcmp(argv[i], "--random") == 0)
+            {
+                randomCount = atoi(val);
+            }
+            else if (strcmp(argv[i], "--seed") == 0)
+            {
+                seed = (uint32_t)strtoul(val, NULL, 10);
+            }
+            else if (strcmp(argv[i], "--threads") == 0)
+            {
+                threads = (unsigned)atoi(val);
+            }
+            else if (strcmp(argv[i], "--top") == 0)
+            {
+                top = atoi(val);
+            }
+            else if (strcmp(argv[i], "--csv") == 0)
+            {
+                csvPath = val;
+            }
+            else if (strcmp(argv[i], "--range") == 0)
+            {
+                ok = parseRange(val);
+            }
+            else
+            {
+                ok = false;
+            }
+            i++;
+        }
+    }
+    if (!ok || specs.empty())
+    {
+        fprintf(stderr,
+                "usage: %s [--grid | --random N] [--seed S] [--threads N] [--top K] [--csv out.csv]\n"
+                "          [--range window|threshold|step|radius|mul1|mul2=lo:hi[:step]] ... trace...\n",
+                argv[0]);
+        return 2;
+    }
+
+    // Decode the corpus once
+    std::vector<Trace> corpus(specs.size());
+    uint64_t samples = 0;
+    for (size_t i = 0; i < specs.size(); i++)
+    {
+        const char *spec = specs[i].c_str();
+        if (!(gsIsSpec(spec) ? gsLoadSpec(spec, &corpus[i]) : traceLoad(spec, &corpus[i])))
+        {
+            return 1;
+        }
+        if (corpus[i].truthSteps < 0 || corpus[i].truthDistanceM < 0.0f)
+        {
+            fprintf(stderr, "%s: no ground truth\n", spec);
+            return 1;
+        }
+        samples += corpus[i].samples.size();
+    }
+
+    std::vector<GpParams> configs;
+    if (randomCount > 0)
+    {
+        randomConfigs(randomCount, seed, &configs);
+    }
+    else
+    {
+        double v[SP_COUNT];
+        expandGrid(0, v, &configs);
+    }
+    GpParams defaults;
+    gpDefaultParams(&defaults);
+    configs.push_back(defaults);                    // Always score the current constants too
+
+    printf("%zu configurations x %zu traces (%llu samples)\n", configs.size(), corpus.size(), (unsigned long long)samples);
+    std::vector<SweepResult> results(configs.size());
+    auto start = std::chrono::steady_clock::now();
+    {
+        WorkPool pool(threads);
+        for (size_t i = 0; i < configs.size(); i++)
+        {
+            pool.submit([&corpus, &configs, &results, i](unsigned) { evaluate(corpus, configs[i], &results[i]); });
+        }
+        pool.wait();
+        printf("%u threads, %.2f s, %.1f Msamples/s\n\n", pool.size(),
+               std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+               configs.size() * samples / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1.0e-6);
+    }
+    SweepResult current = results.back();
+
+    // Pareto front: sweep by increasing cost, keep each result more accurate than all cheaper ones
+    std::vector<size_t> byCost(results.size());
+    for (size_t i = 0; i < byCost.size(); i++)
+    {
+        byCost[i] = i;
+    }
+    std::sort(byCost.begin(), byCost.end(), [&results](size_t a, size_t b) {
+        return results[a].nsPerSample != results[b].nsPerSample ? results[a].nsPerSample < results[b].nsPerSample
+                                                                : results[a].error < results[b].error;
+    });
+    double bestError = INFINITY;
+    std::vector<SweepResult> front;
+    for (size_t i : byCost)
+    {
+        if (results[i].error < bestError)
+        {
+            bestError = results[i].error;
+            results[i].pareto = true;
+            front.push_back(results[i]);
+        }
+    }
+
+    std::sort(results.begin(), results.end(), [](const SweepResult &a, const SweepResult &b) { return a.error < b.error; });
+    printf("best %d by error (* = on the Pareto front)\n", top);
+    printHeader();
+    for (int i = 0; i < top && i < (int)results.size(); i++)
+    {
+        printResult(results[i], i + 1);
+    }
+    printf("\ncurrent constants\n");
+    printHeader();
+    printResult(current, 0);
+    printf("\nPareto front, error vs cost (cheapest first)\n");
+    printHeader();
+    for (size_t i = 0; i < front.size(); i++)
+    {
+        printResult(front[i], (int)i + 1);
+    }
+
+    if (csvPath)
+    {
+        FILE *f = fopen(csvPath, "w");
+        if (f == NULL)
+        {
+            fprintf(stderr, "%s: cannot create\n", csvPath);
+            return 1;
+        }
+        fprintf(f, "window,threshold,step,radius,mul1,mul2,dist_err,step_err,error,ns_per_sample,pareto\n");
+        for (const SweepResult &r : results)
+        {
+            fprintf(f, "%u,%g,%g,%g,%g,%g,%.6f,%.6f,%.6f,%.2f,%d\n", r.params.windowSize, r.params.threshold, r.params.stepThreshold,
+                    r.params.radius, r.params.mulFactor1, r.params.mulFactor2, r.distErr, r.stepErr, r.error, r.nsPerSample, r.pareto ? 1 : 0);
+        }
+        if (fclose(f) != 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
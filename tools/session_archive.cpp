@@ -0,0 +1,417 @@
+//=======================================================================================
+// SESSION ARCHIVE: COLUMNAR, MEMORY-MAPPABLE SESSION FILES (HOST TOOLS)
+//=======================================================================================
+#include "session_archive.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//---------------------------------------------------------------------------------------
+// VARINT CODING
+//---------------------------------------------------------------------------------------
+static inline uint64_t zigzag(int64_t v)
+{
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t v)
+{
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static void putVarint(std::vector<uint8_t> *out, uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        out->push_back((uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    out->push_back((uint8_t)v);
+}
+
+// DECODE ONE VARINT FROM [*p, end); FALSE IF IT RUNS OFF THE END
+static inline bool getVarint(const uint8_t **p, const uint8_t *end, uint64_t *v)
+{
+    uint64_t r = 0;
+    for (int shift = 0; *p < end && shift < 64; shift += 7)
+    {
+        uint8_t b = *(*p)++;
+        r |= (uint64_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0)
+        {
+            *v = r;
+            return true;
+        }
+    }
+    return false;
+}
+
+//---------------------------------------------------------------------------------------
+// WRITER
+//---------------------------------------------------------------------------------------
+static void writeBytes(SaWriter *w, const void *data, size_t len)
+{
+    if (len && fwrite(data, 1, len, w->f) != len)
+    {
+        w->ok = false;
+    }
+    w->offset += len;
+}
+
+static void flushBlock(SaWriter *w)
+{
+    const std::vector<TraceSample> &s = w->pending;
+    if (s.empty())
+    {
+        return;
+    }
+    SaBlockIndex bi;
+    memset(&bi, 0, sizeof(bi));
+    bi.offset = w->offset;
+    bi.firstSample = w->header.sampleCount;
+    bi.count = (uint32_t)s.size();
+
+    // Unwrapped timestamps; the first sample of the session starts the clock at its own t_us
+    std::vector<uint64_t> t(s.size());
+    for (size_t i = 0; i < s.size(); i++)
+    {
+        if (w->header.sampleCount == 0 && i == 0)
+        {
+            w->unwrappedUs = s[0].tUs;
+        }
+        else
+        {
+            w->unwrappedUs += (uint32_t)(s[i].tUs - w->lastTUs);
+        }
+        w->lastTUs = s[i].tUs;
+        t[i] = w->unwrappedUs;
+    }
+    bi.firstUs = t.front();
+    bi.lastUs = t.back();
+
+    // t: first value, first delta, then delta-of-delta
+    w->buf.clear();
+    putVarint(&w->buf, t[0]);
+    int64_t prevDelta = 0;
+    for (size_t i = 1; i < t.size(); i++)
+    {
+        int64_t delta = (int64_t)(t[i] - t[i - 1]);
+        putVarint(&w->buf, zigzag(delta - prevDelta));
+        prevDelta = delta;
+    }
+    bi.colBytes[SA_COL_T] = (uint32_t)w->buf.size();
+    writeBytes(w, w->buf.data(), w->buf.size());
+
+    // gx / gy / gz: delta from the previous sample of the block
+    for (int d = 0; d < 3; d++)
+    {
+        w->buf.clear();
+        int16_t lo = s[0].g[d], hi = s[0].g[d];
+        int32_t prev = 0;
+        for (const TraceSample &x : s)
+        {
+            putVarint(&w->buf, zigzag((int64_t)x.g[d] - prev));
+            prev = x.g[d];
+            lo = x.g[d] < lo ? x.g[d] : lo;
+            hi = x.g[d] > hi ? x.g[d] : hi;
+        }
+        bi.min[d] = lo;
+        bi.max[d] = hi;
+        bi.colBytes[SA_COL_GX + d] = (uint32_t)w->buf.size();
+        writeBytes(w, w->buf.data(), w->buf.size());
+    }
+
+    // label: runs
+    w->buf.clear();
+    for (size_t i = 0; i < s.size();)
+    {
+        size_t j = i;
+        while (j < s.size() && s[j].label == s[i].label)
+        {
+            j++;
+        }
+        w->buf.push_back((uint8_t)s[i].label);
+        putVarint(&w->buf, j - i);
+        bi.labelMask |= s[i].label >= 0 ? (uint8_t)(1u << s[i].label) : SA_LABEL_BIT_NONE;
+        i = j;
+    }
+    bi.colBytes[SA_COL_LABEL] = (uint32_t)w->buf.size();
+    writeBytes(w, w->buf.data(), w->buf.size());
+
+    w->index.push_back(bi);
+    w->header.sampleCount += s.size();
+    w->pending.clear();
+}
+
+bool saWriterOpen(SaWriter *w, const char *path, const Trace &meta, uint32_t blockLen)
+{
+    w->f = fopen(path, "wb");
+    if (w->f == NULL)
+    {
+        fprintf(stderr, "%s: cannot create\n", path);
+        return false;
+    }
+    memset(&w->header, 0, sizeof(w->header));
+    memcpy(w->header.magic, SA_MAGIC, 4);
+    w->header.version = SA_VERSION;
+    w->header.headerSize = sizeof(SaHeader);
+    w->header.blockLen = (blockLen == 0 || blockLen > SA_MAX_BLOCK_LEN) ? SA_DEFAULT_BLOCK_LEN : blockLen;
+    w->header.odrHz = meta.odrHz;
+    w->header.fsDps = meta.fsDps;
+    w->header.truthSteps = meta.truthSteps;
+    w->header.truthDistanceM = meta.truthDistanceM;
+    strncpy(w->header.name, meta.name.c_str(), sizeof(w->header.name) - 1);
+    w->index.clear();
+    w->events.clear();
+    w->pending.clear();
+    w->pending.reserve(w->header.blockLen);
+    w->offset = 0;
+    w->unwrappedUs = 0;
+    w->lastTUs = 0;
+    w->ok = true;
+    writeBytes(w, &w->header, sizeof(w->header));   // Placeholder until close
+    return w->ok;
+}
+
+void saWriterAdd(SaWriter *w, const TraceSample &s)
+{
+    w->pending.push_back(s);
+    if (w->pending.size() >= w->header.blockLen)
+    {
+        flushBlock(w);
+    }
+}
+
+void saWriterEvent(SaWriter *w, const SaEvent &e)
+{
+    w->events.push_back(e);
+}
+
+bool saWriterClose(SaWriter *w)
+{
+    flushBlock(w);
+
+    // Attach the events to their blocks (both are in sample order)
+    size_t e = 0;
+    for (SaBlockIndex &bi : w->index)
+    {
+        bi.firstEvent = (uint32_t)e;
+        while (e < w->events.size() && w->events[e].sample < bi.firstSample + bi.count)
+        {
+            bi.steps += w->events[e].kind == SA_EVENT_STEP ? w->events[e].count : 0;
+            e++;
+        }
+        bi.eventCount = (uint32_t)(e - bi.firstEvent);
+    }
+
+    // Keep the index 8-byte aligned so a mapped reader can use it in place
+    static const uint8_t zeros[8] = {};
+    writeBytes(w, zeros, (8 - (w->offset & 7)) & 7);
+    w->header.indexOffset = w->offset;
+    w->header.blockCount = (uint32_t)w->index.size();
+    writeBytes(w, w->index.data(), w->index.size() * sizeof(SaBlockIndex));
+    w->header.eventOffset = w->offset;
+    w->header.eventCount = w->events.size();
+    writeBytes(w, w->events.data(), w->events.size() * sizeof(SaEvent));
+
+    if (fseek(w->f, 0, SEEK_SET) != 0)
+    {
+        w->ok = false;
+    }
+    if (fwrite(&w->header, 1, sizeof(w->header), w->f) != sizeof(w->header))
+    {
+        w->ok = false;
+    }
+    if (fclose(w->f) != 0)
+    {
+        w->ok = false;
+    }
+    w->f = NULL;
+    return w->ok;
+}
+
+//---------------------------------------------------------------------------------------
+// READER
+//---------------------------------------------------------------------------------------
+bool saOpen(SaReader *r, const char *path)
+{
+    memset(r, 0, sizeof(*r));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SaHeader))
+    {
+        fprintf(stderr, "%s: not a session archive\n", path);
+        close(fd);
+        return false;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        fprintf(stderr, "%s: mmap failed\n", path);
+        return false;
+    }
+    r->base = (const uint8_t *)map;
+    r->size = (size_t)st.st_size;
+    r->header = (const SaHeader *)r->base;
+
+    const SaHeader *h = r->header;
+    const char *why = NULL;
+    if (memcmp(h->magic, SA_MAGIC, 4) != 0)
+    {
+        why = "not a session archive";
+    }
+    else if (h->version != SA_VERSION || h->headerSize != sizeof(SaHeader))
+    {
+        why = "unsupported archive version";
+    }
+    else if (h->indexOffset % 8 != 0 || h->indexOffset + (uint64_t)h->blockCount * sizeof(SaBlockIndex) > r->size ||
+             h->eventOffset + h->eventCount * sizeof(SaEvent) > r->size || h->blockLen == 0 || h->blockLen > SA_MAX_BLOCK_LEN)
+    {
+        why = "truncated or corrupt archive";
+    }
+    if (why)
+    {
+        fprintf(stderr, "%s: %s\n", path, why);
+        saClose(r);
+        return false;
+    }
+    r->index = (const SaBlockIndex *)(r->base + h->indexOffset);
+    r->events = (const SaEvent *)(r->base + h->eventOffset);
+    return true;
+}
+
+void saClose(SaReader *r)
+{
+    if (r->base)
+    {
+        munmap((void *)r->base, r->size);
+    }
+    memset(r, 0, sizeof(*r));
+}
+
+bool saDecodeBlock(const SaReader *r, uint32_t block, uint32_t columns, SaBlock *out)
+{
+    if (block >= r->header->blockCount)
+    {
+        return false;
+    }
+    const SaBlockIndex &bi = r->index[block];
+    uint64_t colOffset[SA_COL_COUNT];
+    uint64_t offset = bi.offset;
+    for (int c = 0; c < SA_COL_COUNT; c++)
+    {
+        colOffset[c] = offset;
+        offset += bi.colBytes[c];
+    }
+    if (offset > r->header->indexOffset || bi.count > r->header->blockLen)
+    {
+        return false;
+    }
+    uint32_t n = bi.count;
+    out->count = n;
+
+    if (columns & SA_COL_BIT(SA_COL_T))
+    {
+        const uint8_t *p = r->base + colOffset[SA_COL_T], *end = p + bi.colBytes[SA_COL_T];
+        out->t.resize(n);
+        uint64_t v;
+        if (!getVarint(&p, end, &v))
+        {
+            return false;
+        }
+        uint64_t t = v;
+        int64_t delta = 0;
+        out->t[0] = t;
+        for (uint32_t i = 1; i < n; i++)
+        {
+            if (!getVarint(&p, end, &v))
+            {
+                return false;
+            }
+            delta += unzigzag(v);
+            t += (uint64_t)delta;
+            out->t[i] = t;
+        }
+    }
+    for (int d = 0; d < 3; d++)
+    {
+        if ((columns & SA_COL_BIT(SA_COL_GX + d)) == 0)
+        {
+            continue;
+        }
+        const uint8_t *p = r->base + colOffset[SA_COL_GX + d], *end = p + bi.colBytes[SA_COL_GX + d];
+        out->g[d].resize(n);
+        int64_t prev = 0;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            uint64_t v;
+            if (!getVarint(&p, end, &v))
+            {
+                return false;
+            }
+            prev += unzigzag(v);
+            out->g[d][i] = (int16_t)prev;
+        }
+    }
+    if (columns & SA_COL_BIT(SA_COL_LABEL))
+    {
+        const uint8_t *p = r->base + colOffset[SA_COL_LABEL], *end = p + bi.colBytes[SA_COL_LABEL];
+        out->label.resize(n);
+        uint32_t i = 0;
+        while (i < n)
+        {
+            uint64_t run;
+            if (p >= end)
+            {
+                return false;
+            }
+            int8_t label = (int8_t)*p++;
+            if (!getVarint(&p, end, &run) || run > n - i)
+            {
+                return false;
+            }
+            memset(&out->label[i], (uint8_t)label, run);
+            i += (uint32_t)run;
+        }
+    }
+    return true;
+}
+
+bool saLoadTrace(const SaReader *r, Trace *out)
+{
+    out->name = r->header->name;
+    out->odrHz = r->header->odrHz;
+    out->fsDps = r->header->fsDps;
+    out->truthSteps = (long)r->header->truthSteps;
+    out->truthDistanceM = r->header->truthDistanceM;
+    out->samples.clear();
+    out->samples.reserve(r->header->sampleCount);
+    SaBlock b;
+    for (uint32_t k = 0; k < r->header->blockCount; k++)
+    {
+        if (!saDecodeBlock(r, k, SA_COLS_ALL, &b))
+        {
+            fprintf(stderr, "%s: block %lu is corrupt\n", r->header->name, (unsigned long)k);
+            return false;
+        }
+        for (uint32_t i = 0; i < b.count; i++)
+        {
+            TraceSample s;
+            s.tUs = (uint32_t)b.t[i];
+            s.g[0] = b.g[0][i];
+            s.g[1] = b.g[1][i];
+            s.g[2] = b.g[2][i];
+            s.label = b.label[i];
+            out->samples.push_back(s);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,151 @@
+//=======================================================================================
+// SESSION ARCHIVE: COLUMNAR, MEMORY-MAPPABLE SESSION FILES (HOST TOOLS)
+//=======================================================================================
+// One recorded session per file, laid out so that queries touch only the blocks and
+// columns they need:
+//
+//   SaHeader                 fixed size, at offset 0 (written last)
+//   block 0 columns          t | gx | gy | gz | label, each compressed on its own
+//   block 1 columns          ...
+//   SaBlockIndex[blocks]     offset, column sizes and statistics of every block
+//   SaEvent[events]          step / state / activity events, in sample order
+//
+// A block holds blockLen consecutive samples (the last one may be short). Columns:
+//   t        unwrapped microseconds (64-bit, so sessions can outlive the 32-bit t_us),
+//            delta-of-delta, zigzag, LEB128 varint; a steady ODR costs ~1 byte/sample
+//   gx/gy/gz raw int16 counts, delta, zigzag, varint; smooth gyro data ~1-2 bytes/sample
+//   label    run-length (label byte, varint run length)
+// The block index carries what predicate pushdown needs without touching the columns:
+// time range, per-axis min/max, the set of labels present and the number of step events.
+//
+// All integers are little-endian and the structures are packed to natural alignment, so
+// a reader maps the file and uses the index and events in place. SA_VERSION changes
+// whenever the layout does; readers reject versions they do not know.
+//=======================================================================================
+#ifndef SESSION_ARCHIVE_H
+#define SESSION_ARCHIVE_H
+
+#include "trace_io.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+#define SA_MAGIC "GYSA"
+#define SA_VERSION 1
+#define SA_DEFAULT_BLOCK_LEN 4096                   // SAMPLES PER BLOCK
+#define SA_MAX_BLOCK_LEN 65536
+#define SA_LABEL_BIT_NONE 0x80                      // labelMask BIT FOR UNLABELLED SAMPLES
+
+enum SaColumn : uint8_t
+{
+    SA_COL_T = 0,
+    SA_COL_GX,
+    SA_COL_GY,
+    SA_COL_GZ,
+    SA_COL_LABEL,
+    SA_COL_COUNT
+};
+
+#define SA_COLS_ALL ((1u << SA_COL_COUNT) - 1)
+#define SA_COL_BIT(c) (1u << (c))
+
+enum SaEventKind : uint8_t
+{
+    SA_EVENT_STEP = 0,                              // count = STEPS COUNTED AT THIS SAMPLE
+    SA_EVENT_STATE,                                 // value = NEW GpState
+    SA_EVENT_ACTIVITY                               // value = NEW ActivityClass
+};
+
+struct SaHeader
+{
+    char magic[4];
+    uint16_t version;
+    uint16_t headerSize;                            // sizeof(SaHeader), FOR FORWARD-COMPATIBLE READERS
+    uint32_t blockLen;
+    uint32_t blockCount;
+    uint64_t sampleCount;
+    uint64_t indexOffset;
+    uint64_t eventOffset;
+    uint64_t eventCount;
+    float odrHz;
+    float fsDps;
+    int64_t truthSteps;                             // -1 IF UNKNOWN
+    float truthDistanceM;
+    uint32_t reserved;
+    char name[64];                                  // SOURCE NAME, NUL TERMINATED (TRUNCATED)
+};
+
+struct SaBlockIndex
+{
+    uint64_t offset;                                // FILE OFFSET OF THE FIRST COLUMN
+    uint64_t firstSample;
+    uint64_t firstUs, lastUs;                       // UNWRAPPED TIME RANGE
+    uint32_t count;                                 // SAMPLES IN THE BLOCK
+    uint32_t colBytes[SA_COL_COUNT];                // COLUMNS FOLLOW EACH OTHER IN SaColumn ORDER
+    int16_t min[3], max[3];                         // PER-AXIS RAW COUNT RANGE
+    uint32_t steps;                                 // SUM OF THE STEP EVENTS IN THE BLOCK
+    uint32_t firstEvent, eventCount;
+    uint8_t labelMask;                              // BIT PER ActivityClass PRESENT, SA_LABEL_BIT_NONE
+    uint8_t pad[7];
+};
+
+struct SaEvent
+{
+    uint64_t sample;                                // SAMPLE INDEX IN THE SESSION
+    uint8_t kind;                                   // SaEventKind
+    uint8_t value;
+    uint16_t reserved;
+    uint32_t count;
+};
+
+static_assert(sizeof(SaHeader) == 136, "SaHeader layout");
+static_assert(sizeof(SaBlockIndex) == 88, "SaBlockIndex layout");
+static_assert(sizeof(SaEvent) == 16, "SaEvent layout");
+
+// STREAMING WRITER: SAMPLES AND EVENTS IN ORDER, THEN CLOSE
+struct SaWriter
+{
+    FILE *f;
+    SaHeader header;
+    std::vector<SaBlockIndex> index;
+    std::vector<SaEvent> events;
+    std::vector<TraceSample> pending;               // SAMPLES OF THE OPEN BLOCK
+    std::vector<uint8_t> buf;                       // ENCODE SCRATCH
+    uint64_t offset;                                // NEXT BLOCK'S FILE OFFSET
+    uint64_t unwrappedUs;
+    uint32_t lastTUs;
+    bool ok;
+};
+
+bool saWriterOpen(SaWriter *w, const char *path, const Trace &meta, uint32_t blockLen = SA_DEFAULT_BLOCK_LEN);
+void saWriterAdd(SaWriter *w, const TraceSample &s);
+void saWriterEvent(SaWriter *w, const SaEvent &e);
+bool saWriterClose(SaWriter *w);                    // FALSE IF ANY WRITE FAILED
+
+// MEMORY-MAPPED READER
+struct SaReader
+{
+    const uint8_t *base;
+    size_t size;
+    const SaHeader *header;
+    const SaBlockIndex *index;
+    const SaEvent *events;
+};
+
+// ONE DECODED BLOCK; ONLY THE REQUESTED COLUMNS ARE FILLED
+struct SaBlock
+{
+    uint32_t count;
+    std::vector<uint64_t> t;
+    std::vector<int16_t> g[3];
+    std::vector<int8_t> label;
+};
+
+bool saOpen(SaReader *r, const char *path);         // FALSE (AND THE REASON ON stderr) ON FAILURE
+void saClose(SaReader *r);
+bool saDecodeBlock(const SaReader *r, uint32_t block, uint32_t columns, SaBlock *out);
+
+// WHOLE ARCHIVE BACK TO A TRACE (t_us WRAPS TO 32 BITS AGAIN)
+bool saLoadTrace(const SaReader *r, Trace *out);
+
+#endif // SESSION_ARCHIVE_H
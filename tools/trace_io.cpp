@@ -0,0 +1,150 @@
+//=======================================================================================
+// RAW GYRO TRACE FILES (HOST TOOLS):
+//=======================================================================================
+#include "trace_io.h"
+#include "activity_classifier.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+int8_t traceLabelParse(const char *s)
+{
+    while (*s == ' ')
+    {
+        s++;
+    }
+    for (int a = 0; a < ACT_CLASS_COUNT; a++)
+    {
+        const char *n = actName((ActivityClass)a);
+        size_t len = strlen(n);
+        if (strncasecmp(s, n, len) == 0 && (s[len] == '\0' || s[len] == '\n' || s[len] == '\r' || s[len] == ' '))
+        {
+            return (int8_t)a;
+        }
+    }
+    return TRACE_LABEL_NONE;
+}
+
+const char *traceLabelName(int8_t label)
+{
+    return (label >= 0 && label < ACT_CLASS_COUNT) ? actName((ActivityClass)label) : "-";
+}
+
+bool traceLoad(const char *path, Trace *out)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+    {
+        fprintf(stderr, "trace: cannot open %s\n", path);
+        return false;
+    }
+
+    out->name = path;
+    out->samples.clear();
+    out->truthSteps = -1;
+    out->truthDistanceM = -1.0f;
+    char line[256];
+    unsigned long lineNo = 0;
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        lineNo++;
+        if (line[0] == '#')
+        {
+            const char *p;
+            if ((p = strstr(line, "odr_hz=")) != NULL)
+            {
+                out->odrHz = strtof(p + 7, NULL);
+            }
+            if ((p = strstr(line, "fs_dps=")) != NULL)
+            {
+                out->fsDps = strtof(p + 7, NULL);
+            }
+            if ((p = strstr(line, "truth_steps=")) != NULL)
+            {
+                out->truthSteps = strtol(p + 12, NULL, 10);
+            }
+            if ((p = strstr(line, "truth_distance_m=")) != NULL)
+            {
+                out->truthDistanceM = strtof(p + 17, NULL);
+            }
+            continue;
+        }
+        if (line[0] == '\n' || line[0] == '\r' || line[0] == '\0')
+        {
+            continue;
+        }
+
+        char *p = line;
+        char *end;
+        TraceSample s;
+        s.tUs = (uint32_t)strtoul(p, &end, 10);
+        bool ok = (end != p && *end == ',');
+        for (int a = 0; ok && a < 3; a++)
+        {
+            p = end + 1;
+            long v = strtol(p, &end, 10);
+            ok = (end != p) && v >= -32768 && v <= 32767;
+            s.g[a] = (int16_t)v;
+        }
+        if (!ok)
+        {
+            fprintf(stderr, "trace: %s:%lu: malformed sample\n", path, lineNo);
+            fclose(f);
+            return false;
+        }
+        s.label = (*end == ',') ? traceLabelParse(end + 1) : TRACE_LABEL_NONE;
+        out->samples.push_back(s);
+    }
+    fclose(f);
+    return true;
+}
+
+bool traceSave(const char *path, const Trace &trace)
+{
+    FILE *f = fopen(path, "w");
+    if (f == NULL)
+    {
+        fprintf(stderr, "trace: cannot create %s\n", path);
+        return false;
+    }
+    traceWriteHeader(f, trace);
+    for (const TraceSample &s : trace.samples)
+    {
+        traceWriteSample(f, s);
+    }
+    traceWriteTruth(f, trace);
+    bool ok = (fclose(f) == 0);
+    if (!ok)
+    {
+        fprintf(stderr, "trace: write error on %s\n", path);
+    }
+    return ok;
+}
+
+void traceWriteHeader(FILE *f, const Trace &trace)
+{
+    fprintf(f, "# raw gyro trace: %s\n", trace.name.c_str());
+    fprintf(f, "# odr_hz=%g fs_dps=%g\n", trace.odrHz, trace.fsDps);
+    fprintf(f, "# t_us,gx,gy,gz,label\n");
+}
+
+void traceWriteSample(FILE *f, const TraceSample &s)
+{
+    if (s.label == TRACE_LABEL_NONE)
+    {
+        fprintf(f, "%lu,%d,%d,%d\n", (unsigned long)s.tUs, s.g[0], s.g[1], s.g[2]);
+    }
+    else
+    {
+        fprintf(f, "%lu,%d,%d,%d,%s\n", (unsigned long)s.tUs, s.g[0], s.g[1], s.g[2], traceLabelName(s.label));
+    }
+}
+
+void traceWriteTruth(FILE *f, const Trace &trace)
+{
+    if (trace.truthSteps >= 0)
+    {
+        fprintf(f, "# truth_steps=%ld truth_distance_m=%.3f\n", (long)trace.truthSteps, trace.truthDistanceM);
+    }
+}
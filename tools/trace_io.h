@@ -0,0 +1,51 @@
+//=======================================================================================
+// RAW GYRO TRACE FILES (HOST TOOLS):
+//=======================================================================================
+// Text trace format shared by the host tools, one sample per line:
+//   t_us,gx,gy,gz[,label]
+// gx/gy/gz are raw L3GD20 int16 counts exactly as read from OUT_X_L..OUT_Z_H, t_us is the
+// capture time in microseconds and the optional label is idle|walk|jog|run (any case).
+// Lines starting with '#' are comments; "# odr_hz=<n>" and "# fs_dps=<n>" are parsed, as are
+// "# truth_steps=<n> truth_distance_m=<m>" (ground truth written by synthetic generators).
+//=======================================================================================
+#ifndef TRACE_IO_H
+#define TRACE_IO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#define TRACE_LABEL_NONE (-1)
+
+struct TraceSample
+{
+    uint32_t tUs;                                   // CAPTURE TIME (us)
+    int16_t g[3];                                   // RAW X, Y, Z COUNTS
+    int8_t label;                                   // ActivityClass, OR TRACE_LABEL_NONE
+};
+
+struct Trace
+{
+    std::string name;                               // FILE NAME (OR GENERATOR DESCRIPTION)
+    float odrHz = 0.0f;                             // NOMINAL OUTPUT DATA RATE, 0 IF UNKNOWN
+    float fsDps = 500.0f;                           // FULL-SCALE SETTING THE COUNTS WERE TAKEN AT
+    long truthSteps = -1;                           // GROUND TRUTH, -1 IF UNKNOWN
+    float truthDistanceM = -1.0f;
+    std::vector<TraceSample> samples;
+};
+
+// LOAD / SAVE A TRACE FILE; RETURN FALSE (AND PRINT THE REASON ON stderr) ON FAILURE
+bool traceLoad(const char *path, Trace *out);
+bool traceSave(const char *path, const Trace &trace);
+
+// STREAMING WRITERS (traceSave() = HEADER + SAMPLES + TRUTH), FOR TRACES TOO LONG TO HOLD IN MEMORY
+void traceWriteHeader(FILE *f, const Trace &trace);
+void traceWriteSample(FILE *f, const TraceSample &s);
+void traceWriteTruth(FILE *f, const Trace &trace);
+
+// LABEL NAME <-> ActivityClass INDEX
+int8_t traceLabelParse(const char *s);
+const char *traceLabelName(int8_t label);
+
+#endif // TRACE_IO_H
@@ -0,0 +1,348 @@
+//=======================================================================================
+// VECTOR MATH ERROR BOUND CHECK (HOST):
+//=======================================================================================
+// Holds the kernels of lib/GyroDSP/vec_math.h to the error bounds its header documents,
+// measured against a double-precision reference:
+//   - vmSqrtF        every float in [1, 4) (every mantissa, both exponent parities) and
+//                    random floats across the normal range, correctly rounded
+//   - vmInvSqrtF     the same inputs, relative error of the bit-trick seed + 2 Newton steps
+//   - vmNorm3F       random triples mixing component magnitudes, error in ulps of |v|
+//   - vmNorm3FastF   the same triples, relative error of s * rsqrt(s)
+//   - vmISqrt32      0, 1, every perfect square r^2 and its neighbours r^2 - 1, r^2 + 1,
+//                    0xFFFFFFFF and random words, exact floor(sqrt(v)); --exhaustive
+//                    runs all 2^32 words instead
+//   - vmNorm3I16     the int16 extremes and random raw triples, exact floor(|v|)
+//   - batch forms    bit-identical to the scalar kernels for every length up to a few
+//                    pairs, odd lengths taking the single-sample tail
+// The host build runs vmSqrtF on sqrtf(); VSQRT.F32 is correctly rounded as well, and the
+// other float kernels are the same C on both. The maxima measured are printed next to the
+// bounds so a change that eats into the margin shows before it breaks one.
+//
+//   vec_math_check [--samples N] [--exhaustive]
+//     --samples N      random inputs per kernel (default 1000000)
+//     --exhaustive     vmISqrt32 over every 32-bit word (a minute or two)
+// Exit status 1 if a bound is exceeded, 2 on bad usage.
+//=======================================================================================
+#include "vec_math.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VM_NORM3F_MAX_ULP 2.0                       // BOUNDS AS DOCUMENTED IN vec_math.h
+#define VM_RSQRT_MAX_REL 5.0e-6
+#define VM_CHECK_SAMPLES 1000000u                   // DEFAULT RANDOM INPUTS PER KERNEL
+#define VM_CHECK_MAX_EXP 60                         // |COMPONENT| < 2^60: SQUARES STAY FINITE AND NORMAL
+#define VM_CHECK_MAX_BATCH 9                        // BATCH LENGTHS 0..9
+#define VM_CHECK_MAX_FAILURES 20                    // FAILING INPUTS PRINTED BEFORE GOING QUIET
+
+// Worst case seen by one kernel and the input that produced it
+struct Worst
+{
+    double err;
+    float x, y, z;
+};
+
+static int failures = 0;
+
+// xorshift64*: DETERMINISTIC AND PLATFORM INDEPENDENT, UNLIKE rand()
+static uint64_t rngState = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t vmRand()
+{
+    rngState ^= rngState >> 12;
+    rngState ^= rngState << 25;
+    rngState ^= rngState >> 27;
+    return rngState * 2685821657736338717ULL;
+}
+
+// Random float with a random mantissa, sign and exponent in [-maxExp, maxExp)
+static float randomFloat(int maxExp, bool sign)
+{
+    uint64_t r = vmRand();
+    float m = 1.0f + (float)(r & 0x7FFFFFu) * (1.0f / 8388608.0f);
+    int e = (int)((r >> 23) % (uint64_t)(2 * maxExp)) - maxExp;
+    float f = ldexpf(m, e);
+    return (sign && (r >> 63)) ? -f : f;
+}
+
+static void fail(const char *what)
+{
+    if (++failures <= VM_CHECK_MAX_FAILURES)
+    {
+        printf("  FAIL %s\n", what);
+    }
+}
+
+static void note(Worst *w, double err, float x, float y, float z)
+{
+    if (err > w->err)
+    {
+        w->err = err;
+        w->x = x;
+        w->y = y;
+        w->z = z;
+    }
+}
+
+// |r - exact| in units of the float ulp at the exact result
+static double ulpError(float r, double exact)
+{
+    if (exact == 0.0)
+    {
+        return r == 0.0f ? 0.0 : INFINITY;
+    }
+    int k;
+    frexp(exact, &k);
+    return fabs((double)r - exact) / ldexp(1.0, k - 24);
+}
+
+// One square root input: vmSqrtF must match the correctly rounded double result (a double
+// sqrt rounded to float never double-rounds), vmInvSqrtF must stay inside its bound
+static void checkRoot(float x, Worst *sq, Worst *inv)
+{
+    char what[96];
+    double exact = sqrt((double)x);
+    float r = vmSqrtF(x);
+    note(sq, ulpError(r, exact), x, 0.0f, 0.0f);
+    if (r != (float)exact)
+    {
+        snprintf(what, sizeof(what), "vmSqrtF(%a) = %a, correctly rounded %a", x, r, (float)exact);
+        fail(what);
+    }
+
+    double rel = fabs((double)vmInvSqrtF(x) * exact - 1.0);
+    note(inv, rel, x, 0.0f, 0.0f);
+    if (!(rel <= VM_RSQRT_MAX_REL))
+    {
+        snprintf(what, sizeof(what), "vmInvSqrtF(%a) relative error %.3g", x, rel);
+        fail(what);
+    }
+}
+
+static void checkRoots(uint32_t samples)
+{
+    Worst sq = { 0.0, 0, 0, 0 }, inv = { 0.0, 0, 0, 0 };
+
+    // The seed and both Newton steps only see the mantissa and the exponent's parity, so
+    // [1, 4) covers every case the bit trick has; sqrt is periodic the same way
+    for (float x = 1.0f; x < 4.0f; x = nextafterf(x, 4.0f))
+    {
+        checkRoot(x, &sq, &inv);
+    }
+    for (uint32_t i = 0; i < samples; i++)
+    {
+        checkRoot(randomFloat(2 * VM_CHECK_MAX_EXP, false), &sq, &inv);
+    }
+    printf("  vmSqrtF      max %.3f ulp (bound 0.5, correctly rounded) at %g\n", sq.err, sq.x);
+    printf("  vmInvSqrtF   max %.3g relative (bound %.1e) at %g\n", inv.err, VM_RSQRT_MAX_REL, inv.x);
+}
+
+static void checkNorms(uint32_t samples)
+{
+    Worst norm = { 0.0, 0, 0, 0 }, fast = { 0.0, 0, 0, 0 };
+    char what[128];
+    for (uint32_t i = 0; i < samples; i++)
+    {
+        // Every fourth triple keeps all three components within a few binades of each
+        // other; the rest mix magnitudes freely
+        float x, y, z;
+        if (i & 3u)
+        {
+            x = randomFloat(VM_CHECK_MAX_EXP, true);
+            y = randomFloat(VM_CHECK_MAX_EXP, true);
+            z = randomFloat(VM_CHECK_MAX_EXP, true);
+        }
+        else
+        {
+            float scale = ldexpf(1.0f, (int)(vmRand() % 80u) - 40);
+            x = scale * randomFloat(4, true);
+            y = scale * randomFloat(4, true);
+            z = scale * randomFloat(4, true);
+        }
+        double exact = sqrt((double)x * x + (double)y * y + (double)z * z);
+
+        double ulp = ulpError(vmNorm3F(x, y, z), exact);
+        note(&norm, ulp, x, y, z);
+        if (!(ulp <= VM_NORM3F_MAX_ULP))
+        {
+            snprintf(what, sizeof(what), "vmNorm3F(%a, %a, %a) off by %.3f ulp", x, y, z, ulp);
+            fail(what);
+        }
+
+        double rel = fabs((double)vmNorm3FastF(x, y, z) / exact - 1.0);
+        note(&fast, rel, x, y, z);
+        if (!(rel <= VM_RSQRT_MAX_REL))
+        {
+            snprintf(what, sizeof(what), "vmNorm3FastF(%a, %a, %a) relative error %.3g", x, y, z, rel);
+            fail(what);
+        }
+    }
+    if (vmNorm3F(0.0f, 0.0f, 0.0f) != 0.0f || vmNorm3FastF(0.0f, 0.0f, 0.0f) != 0.0f)
+    {
+        fail("float norm of the zero vector is not 0");
+    }
+    printf("  vmNorm3F     max %.3f ulp (bound %.1f) at (%g, %g, %g)\n", norm.err, VM_NORM3F_MAX_ULP, norm.x,
+           norm.y, norm.z);
+    printf("  vmNorm3FastF max %.3g relative (bound %.1e) at (%g, %g, %g)\n", fast.err, VM_RSQRT_MAX_REL, fast.x,
+           fast.y, fast.z);
+}
+
+// floor(sqrt(v)) is r exactly when r^2 <= v < (r + 1)^2
+static void checkISqrt(uint32_t v)
+{
+    uint64_t r = vmISqrt32(v);
+    if (r * r > v || (r + 1) * (r + 1) <= v)
+    {
+        char what[64];
+        snprintf(what, sizeof(what), "vmISqrt32(%lu) = %lu", (unsigned long)v, (unsigned long)r);
+        fail(what);
+    }
+}
+
+static void checkIntegers(uint32_t samples, bool exhaustive)
+{
+    uint64_t inputs = 0;
+    if (exhaustive)
+    {
+        for (uint64_t v = 0; v <= 0xFFFFFFFFull; v++)
+        {
+            checkISqrt((uint32_t)v);
+        }
+        inputs = 0x100000000ull;
+    }
+    else
+    {
+        checkISqrt(0u);
+        checkISqrt(1u);
+        checkISqrt(0xFFFFFFFFu);
+        for (uint32_t r = 1; r <= 0xFFFFu; r++)
+        {
+            checkISqrt(r * r - 1u);
+            checkISqrt(r * r);
+            checkISqrt(r * r + 1u);
+        }
+        for (uint32_t i = 0; i < samples; i++)
+        {
+            checkISqrt((uint32_t)vmRand());
+        }
+        inputs = 3ull + 3ull * 0xFFFFu + samples;
+    }
+    printf("  vmISqrt32    %llu inputs%s, exact\n", (unsigned long long)inputs, exhaustive ? " (all)" : "");
+
+    static const int16_t kEdges[] = { 0, 1, -1, 181, -182, 32767, -32768 };
+    const uint32_t edgeCount = sizeof(kEdges) / sizeof(kEdges[0]);
+    uint32_t triples = edgeCount * edgeCount * edgeCount + samples;
+    for (uint32_t i = 0; i < triples; i++)
+    {
+        int16_t x, y, z;
+        if (i < edgeCount * edgeCount * edgeCount)
+        {
+            x = kEdges[i % edgeCount];
+            y = kEdges[i / edgeCount % edgeCount];
+            z = kEdges[i / (edgeCount * edgeCount)];
+        }
+        else
+        {
+            uint64_t r = vmRand();
+            x = (int16_t)(uint16_t)r;
+            y = (int16_t)(uint16_t)(r >> 16);
+            z = (int16_t)(uint16_t)(r >> 32);
+        }
+        double exact = floor(sqrt((double)x * x + (double)y * y + (double)z * z));
+        uint16_t n = vmNorm3I16(x, y, z);
+        if ((double)n != exact)
+        {
+            char what[96];
+            snprintf(what, sizeof(what), "vmNorm3I16(%d, %d, %d) = %u, floor(|v|) %.0f", x, y, z, n, exact);
+            fail(what);
+        }
+    }
+    printf("  vmNorm3I16   %lu triples, exact (|(-32768, -32768, -32768)| = %u)\n", (unsigned long)triples,
+           vmNorm3I16(-32768, -32768, -32768));
+}
+
+// The batch forms must return exactly what the scalar kernels do
+static void checkBatches()
+{
+    float x[VM_CHECK_MAX_BATCH], y[VM_CHECK_MAX_BATCH], z[VM_CHECK_MAX_BATCH], out[VM_CHECK_MAX_BATCH + 1];
+    int16_t xyz[3 * VM_CHECK_MAX_BATCH];
+    uint16_t outI[VM_CHECK_MAX_BATCH + 1];
+    char what[64];
+    for (uint32_t n = 0; n <= VM_CHECK_MAX_BATCH; n++)
+    {
+        for (uint32_t i = 0; i < VM_CHECK_MAX_BATCH; i++)
+        {
+            x[i] = randomFloat(8, true);
+            y[i] = randomFloat(8, true);
+            z[i] = randomFloat(8, true);
+            xyz[3 * i] = (int16_t)(uint16_t)vmRand();
+            xyz[3 * i + 1] = (int16_t)(uint16_t)vmRand();
+            xyz[3 * i + 2] = (int16_t)(uint16_t)vmRand();
+        }
+        // One sentinel past the end: the pair loop must not write it
+        out[n] = -1.0f;
+        outI[n] = 0xFFFFu;
+        vmNorm3FBatch(x, y, z, out, n);
+        vmNorm3I16Batch(xyz, outI, n);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            float scalar = vmNorm3F(x[i], y[i], z[i]);
+            if (memcmp(&out[i], &scalar, sizeof(float)) != 0)
+            {
+                snprintf(what, sizeof(what), "vmNorm3FBatch length %lu differs at %lu", (unsigned long)n,
+                         (unsigned long)i);
+                fail(what);
+            }
+            if (outI[i] != vmNorm3I16(xyz[3 * i], xyz[3 * i + 1], xyz[3 * i + 2]))
+            {
+                snprintf(what, sizeof(what), "vmNorm3I16Batch length %lu differs at %lu", (unsigned long)n,
+                         (unsigned long)i);
+                fail(what);
+            }
+        }
+        if (out[n] != -1.0f || outI[n] != 0xFFFFu)
+        {
+            snprintf(what, sizeof(what), "batch of length %lu writes past its end", (unsigned long)n);
+            fail(what);
+        }
+    }
+    printf("  batch forms  lengths 0..%d, bit-identical to the scalar kernels\n", VM_CHECK_MAX_BATCH);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t samples = VM_CHECK_SAMPLES;
+    bool exhaustive = false;
+    for (int i = 1; i < argc; i++)
+    {
+        char *end = NULL;
+        if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+        {
+            samples = (uint32_t)strtoul(argv[++i], &end, 10);
+            if (*end != '\0')
+            {
+                fprintf(stderr, "usage: vec_math_check [--samples N] [--exhaustive]\n");
+                return 2;
+            }
+        }
+        else if (strcmp(argv[i], "--exhaustive") == 0)
+        {
+            exhaustive = true;
+        }
+        else
+        {
+            fprintf(stderr, "usage: vec_math_check [--samples N] [--exhaustive]\n");
+            return 2;
+        }
+    }
+
+    printf("vec_math_check: %lu random inputs per kernel against a double reference\n", (unsigned long)samples);
+    checkRoots(samples);
+    checkNorms(samples);
+    checkIntegers(samples, exhaustive);
+    checkBatches();
+    printf("%s: %d failed check%s\n", failures ? "FAIL" : "ok", failures, failures == 1 ? "" : "s");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+//=======================================================================================
+// WORK-STEALING THREAD POOL (HOST TOOLS):
+//=======================================================================================
+#include "work_pool.h"
+#include <chrono>
+
+WorkPool::WorkPool(unsigned threads)
+    : nextQueue(0), pending(0), stopping(false)
+{
+    if (threads == 0)
+    {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads == 0)
+    {
+        threads = 1;
+    }
+    count = threads;
+    queues.reset(new Queue[threads]);
+    for (unsigned i = 0; i < threads; i++)
+    {
+        workers.emplace_back(&WorkPool::run, this, i);
+    }
+}
+
+WorkPool::~WorkPool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> g(idleLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &t : workers)
+    {
+        t.join();
+    }
+}
+
+void WorkPool::submit(WorkTask task)
+{
+    unsigned q = nextQueue.fetch_add(1, std::memory_order_relaxed) % size();
+    pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> g(queues[q].lock);
+        queues[q].tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> g(idleLock);    // Pairs with the predicate check in run()
+    }
+    wake.notify_one();
+}
+
+void WorkPool::wait()
+{
+    std::unique_lock<std::mutex> g(idleLock);
+    done.wait(g, [this] { return pending.load() == 0; });
+}
+
+bool WorkPool::take(unsigned self, WorkTask *task, bool *stolen)
+{
+    {
+        Queue &own = queues[self];
+        std::lock_guard<std::mutex> g(own.lock);
+        if (!own.tasks.empty())
+        {
+            *task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            *stolen = false;
+            return true;
+        }
+    }
+    for (unsigned k = 1; k < size(); k++)
+    {
+        Queue &victim = queues[(self + k) % size()];
+        std::lock_guard<std::mutex> g(victim.lock);
+        if (!victim.tasks.empty())
+        {
+            *task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            *stolen = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkPool::run(unsigned self)
+{
+    WorkerStats &stats = queues[self].stats;
+    for (;;)
+    {
+        WorkTask task;
+        bool stolen = false;
+        if (take(self, &task, &stolen))
+        {
+            auto start = std::chrono::steady_clock::now();
+            task(self);
+            stats.busyS += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            stats.executed++;
+            stats.stolen += stolen ? 1 : 0;
+            if (pending.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> g(idleLock);
+                done.notify_all();
+            }
+            continue;
+        }
+
+        // Nothing anywhere: sleep until a submit() or shutdown. The timeout covers a task that was
+        // dealt onto another deque between our scan and the wait.
+        std::unique_lock<std::mutex> g(idleLock);
+        if (stopping)
+        {
+            return;
+        }
+        wake.wait_for(g, std::chrono::milliseconds(5));
+    }
+}
@@ -0,0 +1,71 @@
+//=======================================================================================
+// WORK-STEALING THREAD POOL (HOST TOOLS):
+//=======================================================================================
+// One task deque per worker. submit() deals tasks round-robin onto the deques; a worker
+// pops its own deque from the back (most recently dealt, still warm) and, when that is
+// empty, steals from the front of the other workers' deques, starting with its right-hand
+// neighbour. Sessions differ in length by orders of magnitude, so static partitioning
+// leaves cores idle at the end of a batch; stealing keeps them all busy until the last
+// task is taken.
+//
+// Tasks are independent: nothing here orders them or shares state between them. Each
+// deque has its own mutex; a deque is only contended while someone is stealing from it.
+//=======================================================================================
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+typedef std::function<void(unsigned worker)> WorkTask;
+
+// PER-WORKER COUNTERS, VALID AFTER wait()
+struct WorkerStats
+{
+    uint64_t executed;                              // TASKS RUN BY THIS WORKER
+    uint64_t stolen;                                // ...OF WHICH TAKEN FROM ANOTHER WORKER'S DEQUE
+    double busyS;                                   // TIME SPENT INSIDE TASKS
+};
+
+class WorkPool
+{
+public:
+    explicit WorkPool(unsigned threads);            // 0 = std::thread::hardware_concurrency()
+    ~WorkPool();                                    // FINISHES THE SUBMITTED TASKS FIRST
+
+    void submit(WorkTask task);
+    void wait();                                    // UNTIL EVERY SUBMITTED TASK HAS FINISHED
+
+    unsigned size() const { return count; }
+    const WorkerStats &stats(unsigned worker) const { return queues[worker].stats; }
+
+private:
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<WorkTask> tasks;
+        WorkerStats stats = {};
+    };
+
+    bool take(unsigned self, WorkTask *task, bool *stolen);
+    void run(unsigned self);
+
+    unsigned count;                                 // FIXED BEFORE THE WORKERS START
+    std::vector<std::thread> workers;
+    std::unique_ptr<Queue[]> queues;
+    std::atomic<unsigned> nextQueue;
+    std::atomic<uint64_t> pending;                  // SUBMITTED AND NOT YET FINISHED
+    std::mutex idleLock;
+    std::condition_variable wake;                   // NEW WORK OR SHUTDOWN
+    std::condition_variable done;                   // pending REACHED ZERO
+    bool stopping;
+};
+
+#endif // WORK_POOL_H